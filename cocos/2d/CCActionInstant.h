@@ -33,6 +33,7 @@ THE SOFTWARE.
 
 #include "CCStdC.h"
 #include "2d/CCAction.h"
+#include "base/CCAutoreleasePool.h"
 
 NS_CC_BEGIN
 
@@ -47,6 +48,8 @@ the IntervalAction actions.
 */ 
 class CC_DLL ActionInstant : public FiniteTimeAction //<NSCopying>
 {
+    // they are usually done, and deleted, in the frame they run
+    CC_FRAME_ARENA_ALLOCATED;
 public:
     //
     // Overrides
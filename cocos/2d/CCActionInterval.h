@@ -85,6 +85,9 @@ protected:
 
     float _elapsed;
     bool   _firstTick;
+
+    // steps the plain tweens in a batch
+    friend class ActionManager;
 };
 
 /** @brief Runs actions sequentially, one after another
@@ -358,6 +361,8 @@ protected:
     float _startAngleY;
     float _diffAngleY;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(RotateTo);
 };
@@ -435,6 +440,8 @@ protected:
     Vector2 _startPosition;
     Vector2 _previousPosition;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(MoveBy);
 };
@@ -720,6 +727,8 @@ protected:
     float _deltaY;
     float _deltaZ;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(ScaleTo);
 };
@@ -815,6 +824,7 @@ protected:
     GLubyte _fromOpacity;
     friend class FadeOut;
     friend class FadeIn;
+    friend class ActionManager;
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(FadeTo);
 };
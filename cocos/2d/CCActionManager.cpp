@@ -27,31 +27,22 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "2d/CCActionManager.h"
+#include "2d/CCActionInterval.h"
 #include "2d/CCNode.h"
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
-#include "2d/ccCArray.h"
-#include "2d/uthash.h"
+#include "base/CCProfiling.h"
+
+#include <algorithm>
+#include <typeinfo>
 
 NS_CC_BEGIN
-//
-// singleton stuff
-//
-typedef struct _hashElement
-{
-    struct _ccArray             *actions;
-    Node                    *target;
-    int                actionIndex;
-    Action                    *currentAction;
-    bool                        currentActionSalvaged;
-    bool                        paused;
-    UT_hash_handle                hh;
-} tHashElement;
 
 ActionManager::ActionManager(void)
-: _targets(nullptr),
-  _currentTarget(nullptr),
-  _currentTargetSalvaged(false)
+: _currentAction(nullptr),
+  _currentActionSalvaged(false),
+  _updating(false),
+  _needsCompaction(false)
 {
 
 }
@@ -61,60 +52,229 @@ ActionManager::~ActionManager(void)
     CCLOGINFO("deallocing ActionManager: %p", this);
 
     removeAllActions();
+    compact();
 }
 
 // private
 
-void ActionManager::deleteHashElement(tHashElement *element)
+ActionManager::TargetEntry* ActionManager::findTarget(const Node *target)
+{
+    auto iter = _targetIndices.find(target);
+    return iter != _targetIndices.end() ? &_targets[iter->second] : nullptr;
+}
+
+const ActionManager::TargetEntry* ActionManager::findTarget(const Node *target) const
 {
-    ccArrayFree(element->actions);
-    HASH_DEL(_targets, element);
-    element->target->release();
-    free(element);
+    auto iter = _targetIndices.find(target);
+    return iter != _targetIndices.end() ? &_targets[iter->second] : nullptr;
 }
 
-void ActionManager::actionAllocWithHashElement(tHashElement *element)
+void ActionManager::removeActionAtIndex(size_t targetIndex, size_t index)
 {
-    // 4 actions per Node by default
-    if (element->actions == nullptr)
+    TargetEntry& entry = _targets[targetIndex];
+    Action *action = entry.actions[index].action;
+    if (entry.actions[index].batched)
     {
-        element->actions = ccArrayNew(4);
-    }else 
-    if (element->actions->num == element->actions->max)
+        removeTween(action);
+    }
+
+    if (_updating)
     {
-        ccArrayDoubleCapacity(element->actions);
+        // the actions may be iterated, don't move them
+        entry.actions[index].action = nullptr;
+        _needsCompaction = true;
+    }
+    else
+    {
+        entry.actions.erase(entry.actions.begin() + index);
+    }
+    --entry.actionCount;
+
+    if (action == _currentAction && (! _currentActionSalvaged))
+    {
+        // released by update() once the action returns from step()
+        _currentActionSalvaged = true;
+    }
+    else
+    {
+        action->release();
     }
 
+    if (entry.actionCount == 0)
+    {
+        removeTarget(targetIndex);
+    }
 }
 
-void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
+void ActionManager::removeTarget(size_t targetIndex)
 {
-    Action *action = (Action*)element->actions->arr[index];
+    TargetEntry& entry = _targets[targetIndex];
+    _targetIndices.erase(entry.target);
+    entry.removed = true;
+    _needsCompaction = true;
+
+    // release the actions left, they can't add or remove actions of this target any more
+    std::vector<ActionSlot> actions;
+    actions.swap(entry.actions);
+    entry.actionCount = 0;
+    for (const auto& slot : actions)
+    {
+        Action *action = slot.action;
+        if (action == nullptr)
+        {
+            continue;
+        }
+        if (slot.batched)
+        {
+            removeTween(action);
+        }
+        if (action == _currentAction && (! _currentActionSalvaged))
+        {
+            _currentActionSalvaged = true;
+        }
+        else
+        {
+            action->release();
+        }
+    }
 
-    if (action == element->currentAction && (! element->currentActionSalvaged))
+    // During update() the target is released by compact(), so an action being stepped can still use it.
+    // Entries are never erased here, callers may be iterating them.
+    if (! _updating)
     {
-        element->currentAction->retain();
-        element->currentActionSalvaged = true;
+        Node *target = entry.target;
+        entry.target = nullptr;
+        target->release();
     }
+}
 
-    ccArrayRemoveObjectAtIndex(element->actions, index, true);
+void ActionManager::compact()
+{
+    std::vector<Node*> removedTargets;
 
-    // update actionIndex in case we are in tick. looping over the actions
-    if (element->actionIndex >= index)
+    size_t count = 0;
+    for (size_t i = 0; i < _targets.size(); ++i)
     {
-        element->actionIndex--;
+        TargetEntry& entry = _targets[i];
+        if (entry.removed)
+        {
+            if (entry.target)
+            {
+                removedTargets.push_back(entry.target);
+            }
+            continue;
+        }
+
+        if ((ssize_t)entry.actions.size() != entry.actionCount)
+        {
+            entry.actions.erase(std::remove_if(entry.actions.begin(), entry.actions.end(), [](const ActionSlot& slot) {
+                return slot.action == nullptr;
+            }), entry.actions.end());
+        }
+
+        if (count != i)
+        {
+            _targets[count] = std::move(entry);
+            _targetIndices[_targets[count].target] = count;
+        }
+        ++count;
     }
+    _targets.resize(count);
 
-    if (element->actions->num == 0)
+    count = 0;
+    for (size_t i = 0; i < _tweens.size(); ++i)
     {
-        if (_currentTarget == element)
+        if (_tweens[i].removed)
         {
-            _currentTargetSalvaged = true;
+            continue;
         }
-        else
+        if (count != i)
         {
-            deleteHashElement(element);
+            _tweens[count] = _tweens[i];
+            _tweenIndices[_tweens[count].action] = count;
         }
+        ++count;
+    }
+    _tweens.resize(count);
+    _needsCompaction = false;
+
+    // releasing the targets may delete them, which can call back into the action manager
+    for (const auto& target : removedTargets)
+    {
+        target->release();
+    }
+}
+
+bool ActionManager::addTween(Action *action, Node *target)
+{
+    // only the exact classes, subclasses may override update()
+    const std::type_info& type = typeid(*action);
+
+    Tween tween;
+    if (type == typeid(MoveTo) || type == typeid(MoveBy))
+    {
+        MoveBy *move = static_cast<MoveBy*>(action);
+        tween.type = TweenType::MOVE;
+        tween.from[0] = move->_startPosition.x;
+        tween.from[1] = move->_startPosition.y;
+        tween.delta[0] = move->_positionDelta.x;
+        tween.delta[1] = move->_positionDelta.y;
+        tween.previous = move->_previousPosition;
+    }
+    else if (type == typeid(ScaleTo) || type == typeid(ScaleBy))
+    {
+        ScaleTo *scale = static_cast<ScaleTo*>(action);
+        tween.type = TweenType::SCALE;
+        tween.from[0] = scale->_startScaleX;
+        tween.from[1] = scale->_startScaleY;
+        tween.from[2] = scale->_startScaleZ;
+        tween.delta[0] = scale->_deltaX;
+        tween.delta[1] = scale->_deltaY;
+        tween.delta[2] = scale->_deltaZ;
+    }
+    else if (type == typeid(RotateTo))
+    {
+        RotateTo *rotate = static_cast<RotateTo*>(action);
+        tween.type = TweenType::ROTATE;
+        tween.from[0] = rotate->_startAngleX;
+        tween.from[1] = rotate->_startAngleY;
+        tween.delta[0] = rotate->_diffAngleX;
+        tween.delta[1] = rotate->_diffAngleY;
+    }
+    else if (type == typeid(FadeTo) || type == typeid(FadeIn) || type == typeid(FadeOut))
+    {
+        FadeTo *fade = static_cast<FadeTo*>(action);
+        tween.type = TweenType::FADE;
+        tween.from[0] = fade->_fromOpacity;
+        tween.delta[0] = fade->_toOpacity - fade->_fromOpacity;
+    }
+    else
+    {
+        return false;
+    }
+
+    ActionInterval *interval = static_cast<ActionInterval*>(action);
+    tween.action = action;
+    tween.target = target;
+    tween.firstTick = interval->_firstTick;
+    tween.removed = false;
+    tween.elapsed = interval->_elapsed;
+    tween.duration = interval->getDuration();
+
+    _tweenIndices[action] = _tweens.size();
+    _tweens.push_back(tween);
+    return true;
+}
+
+void ActionManager::removeTween(Action *action)
+{
+    auto iter = _tweenIndices.find(action);
+    if (iter != _tweenIndices.end())
+    {
+        // erased by the next compaction, the tween loop may be running
+        _tweens[iter->second].removed = true;
+        _tweenIndices.erase(iter);
+        _needsCompaction = true;
     }
 }
 
@@ -122,21 +282,19 @@ void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
 
 void ActionManager::pauseTarget(Node *target)
 {
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
-    if (element)
+    TargetEntry *entry = findTarget(target);
+    if (entry)
     {
-        element->paused = true;
+        entry->paused = true;
     }
 }
 
 void ActionManager::resumeTarget(Node *target)
 {
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
-    if (element)
+    TargetEntry *entry = findTarget(target);
+    if (entry)
     {
-        element->paused = false;
+        entry->paused = false;
     }
 }
 
@@ -144,12 +302,12 @@ Vector<Node*> ActionManager::pauseAllRunningActions()
 {
     Vector<Node*> idsWithActions;
     
-    for (tHashElement *element=_targets; element != nullptr; element = (tHashElement *)element->hh.next) 
+    for (auto& entry : _targets)
     {
-        if (! element->paused) 
+        if (! entry.removed && ! entry.paused)
         {
-            element->paused = true;
-            idsWithActions.pushBack(element->target);
+            entry.paused = true;
+            idsWithActions.pushBack(entry.target);
         }
     }    
     
@@ -170,36 +328,52 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
     CCASSERT(action != nullptr, "");
     CCASSERT(target != nullptr, "");
 
-    tHashElement *element = nullptr;
-    // we should convert it to Ref*, because we save it as Ref*
-    Ref *tmp = target;
-    HASH_FIND_PTR(_targets, &tmp, element);
-    if (! element)
+    TargetEntry *entry = findTarget(target);
+    if (! entry)
     {
-        element = (tHashElement*)calloc(sizeof(*element), 1);
-        element->paused = paused;
         target->retain();
-        element->target = target;
-        HASH_ADD_PTR(_targets, target, element);
+
+        TargetEntry newEntry;
+        newEntry.target = target;
+        newEntry.actionCount = 0;
+        newEntry.paused = paused;
+        newEntry.removed = false;
+        // 4 actions per Node by default
+        newEntry.actions.reserve(4);
+
+        _targetIndices[target] = _targets.size();
+        _targets.push_back(std::move(newEntry));
+        entry = &_targets.back();
     }
 
-     actionAllocWithHashElement(element);
- 
-     CCASSERT(! ccArrayContainsObject(element->actions, action), "");
-     ccArrayAppendObject(element->actions, action);
- 
-     action->startWithTarget(target);
+    CCASSERT(std::find_if(entry->actions.begin(), entry->actions.end(), [action](const ActionSlot& slot) {
+        return slot.action == action;
+    }) == entry->actions.end(), "");
+    size_t targetIndex = entry - _targets.data();
+    entry->actions.push_back({action, false});
+    ++entry->actionCount;
+    action->retain();
+
+    action->startWithTarget(target);
+
+    // startWithTarget() may have added or removed actions of the target
+    TargetEntry& added = _targets[targetIndex];
+    if (! added.removed && ! added.actions.empty() && added.actions.back().action == action)
+    {
+        added.actions.back().batched = addTween(action, target);
+    }
 }
 
 // remove
 
 void ActionManager::removeAllActions()
 {
-    for (tHashElement *element = _targets; element != nullptr; )
+    for (size_t i = 0; i < _targets.size(); ++i)
     {
-        auto target = element->target;
-        element = (tHashElement*)element->hh.next;
-        removeAllActionsFromTarget(target);
+        if (! _targets[i].removed)
+        {
+            removeTarget(i);
+        }
     }
 }
 
@@ -211,25 +385,10 @@ void ActionManager::removeAllActionsFromTarget(Node *target)
         return;
     }
 
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
-    if (element)
+    auto iter = _targetIndices.find(target);
+    if (iter != _targetIndices.end())
     {
-        if (ccArrayContainsObject(element->actions, element->currentAction) && (! element->currentActionSalvaged))
-        {
-            element->currentAction->retain();
-            element->currentActionSalvaged = true;
-        }
-
-        ccArrayRemoveAllObjects(element->actions);
-        if (_currentTarget == element)
-        {
-            _currentTargetSalvaged = true;
-        }
-        else
-        {
-            deleteHashElement(element);
-        }
+        removeTarget(iter->second);
     }
     else
     {
@@ -245,15 +404,16 @@ void ActionManager::removeAction(Action *action)
         return;
     }
 
-    tHashElement *element = nullptr;
-    Ref *target = action->getOriginalTarget();
-    HASH_FIND_PTR(_targets, &target, element);
-    if (element)
+    auto iter = _targetIndices.find(action->getOriginalTarget());
+    if (iter != _targetIndices.end())
     {
-        auto i = ccArrayGetIndexOfObject(element->actions, action);
-        if (i != CC_INVALID_INDEX)
+        const auto& actions = _targets[iter->second].actions;
+        auto actionIter = std::find_if(actions.begin(), actions.end(), [action](const ActionSlot& slot) {
+            return slot.action == action;
+        });
+        if (actionIter != actions.end())
         {
-            removeActionAtIndex(i, element);
+            removeActionAtIndex(iter->second, actionIter - actions.begin());
         }
     }
     else
@@ -267,19 +427,17 @@ void ActionManager::removeActionByTag(int tag, Node *target)
     CCASSERT(tag != Action::INVALID_TAG, "");
     CCASSERT(target != nullptr, "");
 
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
-
-    if (element)
+    auto iter = _targetIndices.find(target);
+    if (iter != _targetIndices.end())
     {
-        auto limit = element->actions->num;
-        for (int i = 0; i < limit; ++i)
+        const auto& actions = _targets[iter->second].actions;
+        for (size_t i = 0; i < actions.size(); ++i)
         {
-            Action *action = (Action*)element->actions->arr[i];
+            Action *action = actions[i].action;
 
-            if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
+            if (action && action->getTag() == (int)tag && action->getOriginalTarget() == target)
             {
-                removeActionAtIndex(i, element);
+                removeActionAtIndex(iter->second, i);
                 break;
             }
         }
@@ -288,28 +446,18 @@ void ActionManager::removeActionByTag(int tag, Node *target)
 
 // get
 
-// XXX: Passing "const O *" instead of "const O&" because HASH_FIND_IT requries the address of a pointer
-// and, it is not possible to get the address of a reference
 Action* ActionManager::getActionByTag(int tag, const Node *target) const
 {
     CCASSERT(tag != Action::INVALID_TAG, "");
 
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
-
-    if (element)
+    const TargetEntry *entry = findTarget(target);
+    if (entry)
     {
-        if (element->actions != nullptr)
+        for (const auto& slot : entry->actions)
         {
-            auto limit = element->actions->num;
-            for (int i = 0; i < limit; ++i)
+            if (slot.action && slot.action->getTag() == (int)tag)
             {
-                Action *action = (Action*)element->actions->arr[i];
-
-                if (action->getTag() == (int)tag)
-                {
-                    return action;
-                }
+                return slot.action;
             }
         }
         CCLOG("cocos2d : getActionByTag(tag = %d): Action not found", tag);
@@ -322,78 +470,172 @@ Action* ActionManager::getActionByTag(int tag, const Node *target) const
     return nullptr;
 }
 
-// XXX: Passing "const O *" instead of "const O&" because HASH_FIND_IT requries the address of a pointer
-// and, it is not possible to get the address of a reference
 ssize_t ActionManager::getNumberOfRunningActionsInTarget(const Node *target) const
 {
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
-    if (element)
-    {
-        return element->actions ? element->actions->num : 0;
-    }
-
-    return 0;
+    const TargetEntry *entry = findTarget(target);
+    return entry ? entry->actionCount : 0;
 }
 
 // main loop
 void ActionManager::update(float dt)
 {
-    for (tHashElement *elt = _targets; elt != nullptr; )
+    CC_PROFILE_SCOPE("ActionManager::update", "actions");
+
+    _updating = true;
+
+    // Actions may add targets and actions, or remove them, while they are stepped. Nothing is erased
+    // until the loop ends, and entries are accessed by index since adding one may move the others.
+    // Targets and actions added during the loop are stepped in this frame too.
+    for (size_t i = 0; i < _targets.size(); ++i)
     {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
+        if (_targets[i].paused || _targets[i].removed)
+        {
+            continue;
+        }
 
-        if (! _currentTarget->paused)
+        for (size_t j = 0; j < _targets[i].actions.size(); ++j)
         {
-            // The 'actions' MutableArray may change while inside this loop.
-            for (_currentTarget->actionIndex = 0; _currentTarget->actionIndex < _currentTarget->actions->num;
-                _currentTarget->actionIndex++)
+            Action *action = _targets[i].actions[j].action;
+            if (action == nullptr)
+            {
+                continue;
+            }
+
+            if (_targets[i].actions[j].batched)
             {
-                _currentTarget->currentAction = (Action*)_currentTarget->actions->arr[_currentTarget->actionIndex];
-                if (_currentTarget->currentAction == nullptr)
+                // stepped in its place, so it runs in the order it was added with the other actions
+                auto tween = _tweenIndices.find(action);
+                if (tween != _tweenIndices.end())
                 {
-                    continue;
+                    stepTween(tween->second, dt);
                 }
+                continue;
+            }
+
+            _currentAction = action;
+            _currentActionSalvaged = false;
 
-                _currentTarget->currentActionSalvaged = false;
+            action->step(dt);
 
-                _currentTarget->currentAction->step(dt);
+            if (_currentActionSalvaged)
+            {
+                // The action told the node to remove it. It was kept alive until the step was done,
+                // now it's safe to release it.
+                action->release();
+            }
+            else if (action->isDone())
+            {
+                action->stop();
 
-                if (_currentTarget->currentActionSalvaged)
+                // Make currentAction nil to prevent removeAction from salvaging it.
+                _currentAction = nullptr;
+                // stop() may have removed actions of this target, but nothing was moved
+                if (j < _targets[i].actions.size() && _targets[i].actions[j].action == action)
                 {
-                    // The currentAction told the node to remove it. To prevent the action from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    _currentTarget->currentAction->release();
-                } else
-                if (_currentTarget->currentAction->isDone())
+                    removeActionAtIndex(i, j);
+                }
+                else
                 {
-                    _currentTarget->currentAction->stop();
-
-                    Action *action = _currentTarget->currentAction;
-                    // Make currentAction nil to prevent removeAction from salvaging it.
-                    _currentTarget->currentAction = nullptr;
                     removeAction(action);
                 }
-
-                _currentTarget->currentAction = nullptr;
             }
+
+            _currentAction = nullptr;
         }
+    }
+
+    _updating = false;
+
+    // remove the finished actions and the targets without actions in one pass
+    if (_needsCompaction)
+    {
+        compact();
+    }
+}
+
+void ActionManager::stepTween(size_t tweenIndex, float dt)
+{
+    // The setters may add tweens, which can move the array, so the tween isn't used after them
+    Tween& tween = _tweens[tweenIndex];
+    if (tween.removed)
+    {
+        return;
+    }
+
+    // the same as ActionInterval::step()
+    if (tween.firstTick)
+    {
+        tween.firstTick = false;
+        tween.elapsed = 0;
+    }
+    else
+    {
+        tween.elapsed += dt;
+    }
+    float t = MAX(0, MIN(1, tween.elapsed / MAX(tween.duration, FLT_EPSILON)));
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashElement*)(elt->hh.next);
+    // getElapsed() and isDone() keep working on the action
+    Action *action = tween.action;
+    ActionInterval *interval = static_cast<ActionInterval*>(action);
+    interval->_firstTick = false;
+    interval->_elapsed = tween.elapsed;
 
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->actions->num == 0)
+    _currentAction = action;
+    _currentActionSalvaged = false;
+
+    Node *target = tween.target;
+    switch (tween.type)
+    {
+        case TweenType::MOVE:
+        {
+#if CC_ENABLE_STACKABLE_ACTIONS
+            // keep the moves other actions made since the last step
+            const Vector2& current = target->getPosition();
+            tween.from[0] += current.x - tween.previous.x;
+            tween.from[1] += current.y - tween.previous.y;
+#endif // CC_ENABLE_STACKABLE_ACTIONS
+            Vector2 position(tween.from[0] + tween.delta[0] * t, tween.from[1] + tween.delta[1] * t);
+#if CC_ENABLE_STACKABLE_ACTIONS
+            tween.previous = position;
+#endif // CC_ENABLE_STACKABLE_ACTIONS
+            target->setPosition(position);
+            break;
+        }
+        case TweenType::SCALE:
         {
-            deleteHashElement(_currentTarget);
+            float scaleY = tween.from[1] + tween.delta[1] * t;
+            float scaleZ = tween.from[2] + tween.delta[2] * t;
+            target->setScaleX(tween.from[0] + tween.delta[0] * t);
+            target->setScaleY(scaleY);
+            target->setScaleZ(scaleZ);
+            break;
         }
+        case TweenType::ROTATE:
+        {
+            float rotationY = tween.from[1] + tween.delta[1] * t;
+            target->setRotationSkewX(tween.from[0] + tween.delta[0] * t);
+            target->setRotationSkewY(rotationY);
+            break;
+        }
+        case TweenType::FADE:
+            target->setOpacity((GLubyte)(tween.from[0] + tween.delta[0] * t));
+            break;
+    }
+
+    if (_currentActionSalvaged)
+    {
+        // a setter removed the action
+        action->release();
+    }
+    else if (action->isDone())
+    {
+        action->stop();
+
+        _currentAction = nullptr;
+        removeAction(action);
     }
 
-    // issue #635
-    _currentTarget = nullptr;
+    _currentAction = nullptr;
 }
 
 NS_CC_END
@@ -33,9 +33,10 @@ THE SOFTWARE.
 #include "base/CCVector.h"
 #include "base/CCRef.h"
 
-NS_CC_BEGIN
+#include <unordered_map>
+#include <vector>
 
-struct _hashElement;
+NS_CC_BEGIN
 
 /**
  * @addtogroup actions
@@ -50,6 +51,12 @@ struct _hashElement;
  Examples:
     - When you want to run an action where the target is different from a Node. 
     - When you want to pause / resume the actions
+
+ Plain MoveTo, MoveBy, ScaleTo, ScaleBy, RotateTo, FadeTo, FadeIn and FadeOut actions, not subclasses nor
+ actions wrapped in an other action, are tweened in a batch: their state is copied into a flat array and
+ update() sets the node properties from it, instead of calling step() on each of them. The actions stay in
+ the list of their target, so they can be queried and removed as usual, and they are still stepped in the
+ order they were added, with the other actions of their target.
  
  @since v0.8
  */
@@ -125,16 +132,75 @@ public:
     void update(float dt);
     
 protected:
-    // declared in ActionManager.m
-
-    void removeActionAtIndex(ssize_t index, struct _hashElement *element);
-    void deleteHashElement(struct _hashElement *element);
-    void actionAllocWithHashElement(struct _hashElement *element);
+    struct ActionSlot
+    {
+        Action *action;
+        /** the action is stepped by the tween loop */
+        bool batched;
+    };
+
+    struct TargetEntry
+    {
+        Node *target;
+        /** the actions in the order they were added. Actions removed during update() are set to nullptr
+         and erased all at once when update() ends. */
+        std::vector<ActionSlot> actions;
+        /** number of actions that weren't removed */
+        ssize_t actionCount;
+        bool paused;
+        /** the target has no action left, it is erased by the next compaction */
+        bool removed;
+    };
+
+    enum class TweenType
+    {
+        MOVE,
+        SCALE,
+        ROTATE,
+        FADE
+    };
+
+    /** the state of a batched action, the action only gets its elapsed time back */
+    struct Tween
+    {
+        Action *action;
+        Node *target;
+        TweenType type;
+        bool firstTick;
+        /** the action was removed, the tween is erased by the next compaction */
+        bool removed;
+        float elapsed;
+        float duration;
+        float from[3];
+        float delta[3];
+        /** the position set by the last step, for stackable moves */
+        Vector2 previous;
+    };
+
+    TargetEntry* findTarget(const Node *target);
+    const TargetEntry* findTarget(const Node *target) const;
+    void removeActionAtIndex(size_t targetIndex, size_t index);
+    void removeTarget(size_t targetIndex);
+    /** copies the state of plain tween actions into _tweens, returns false for the other actions */
+    bool addTween(Action *action, Node *target);
+    void removeTween(Action *action);
+    /** steps a batched action, in place of step() */
+    void stepTween(size_t tweenIndex, float dt);
+    /** erases removed targets and actions, keeping the order of the others */
+    void compact();
 
 protected:
-    struct _hashElement    *_targets;
-    struct _hashElement    *_currentTarget;
-    bool            _currentTargetSalvaged;
+    /** targets in the order they got their first action, each with its actions stored contiguously */
+    std::vector<TargetEntry> _targets;
+    std::unordered_map<const Node*, size_t> _targetIndices;
+    /** the state of the batched actions of all the targets */
+    std::vector<Tween> _tweens;
+    std::unordered_map<const Action*, size_t> _tweenIndices;
+    /** the action being stepped. If it is removed, it is released after its step returns */
+    Action *_currentAction;
+    bool _currentActionSalvaged;
+    bool _updating;
+    bool _needsCompaction;
 };
 
 // end of actions group
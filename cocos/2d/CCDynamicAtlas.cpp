@@ -0,0 +1,669 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "2d/CCDynamicAtlas.h"
+#include "2d/CCSpriteFrame.h"
+#include "2d/platform/CCImage.h"
+#include "2d/platform/CCFileUtils.h"
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventType.h"
+#include "CCGL.h"
+
+#include <algorithm>
+
+NS_CC_BEGIN
+
+// pixels repeated around each image
+static const int ATLAS_IMAGE_BORDER = 1;
+static const char* ATLAS_REPACK_KEY = "DynamicAtlas::repack";
+
+DynamicAtlas* DynamicAtlas::create(int pageWidth, int pageHeight, Texture2D::PixelFormat pixelFormat)
+{
+    DynamicAtlas* atlas = new DynamicAtlas();
+    if (atlas->init(pageWidth, pageHeight, pixelFormat))
+    {
+        atlas->autorelease();
+        return atlas;
+    }
+    CC_SAFE_DELETE(atlas);
+    return nullptr;
+}
+
+DynamicAtlas::DynamicAtlas()
+: _pageWidth(0)
+, _pageHeight(0)
+, _pixelFormat(Texture2D::PixelFormat::RGBA8888)
+, _repackScheduled(false)
+{
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    _toForegroundListener = nullptr;
+#endif
+}
+
+DynamicAtlas::~DynamicAtlas()
+{
+    if (_repackScheduled)
+    {
+        Director::getInstance()->getScheduler()->unschedule(ATLAS_REPACK_KEY, this);
+    }
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    if (_toForegroundListener)
+    {
+        Director::getInstance()->getEventDispatcher()->removeEventListener(_toForegroundListener);
+        _toForegroundListener = nullptr;
+    }
+#endif
+    removeAllImages();
+}
+
+bool DynamicAtlas::init(int pageWidth, int pageHeight, Texture2D::PixelFormat pixelFormat)
+{
+    auto& formats = Texture2D::getPixelFormatInfoMap();
+    auto it = formats.find(pixelFormat);
+    if (it == formats.end() || it->second.compressed || pageWidth <= 0 || pageHeight <= 0)
+    {
+        CCLOG("cocos2d: DynamicAtlas: invalid page format %d or size %d x %d", (int)pixelFormat, pageWidth, pageHeight);
+        return false;
+    }
+
+    _pageWidth = pageWidth;
+    _pageHeight = pageHeight;
+    _pixelFormat = pixelFormat;
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // the pages are lost with the GL context
+    _toForegroundListener = EventListenerCustom::create(EVENT_COME_TO_FOREGROUND, CC_CALLBACK_1(DynamicAtlas::listenToForeground, this));
+    Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_toForegroundListener, 1);
+#endif
+    return true;
+}
+
+SpriteFrame* DynamicAtlas::addImage(const std::string& filename)
+{
+    auto it = _entries.find(filename);
+    if (it != _entries.end())
+    {
+        return it->second.frame;
+    }
+
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(filename);
+    Image* image = loadImage(fullpath);
+    if (! image)
+    {
+        CCLOG("cocos2d: DynamicAtlas: can't load %s", filename.c_str());
+        return nullptr;
+    }
+
+    SpriteFrame* frame = insert(image, filename, fullpath);
+    image->release();
+    return frame;
+}
+
+SpriteFrame* DynamicAtlas::addImage(Image* image, const std::string& key)
+{
+    CCASSERT(image != nullptr, "DynamicAtlas: image MUST not be nil");
+
+    auto it = _entries.find(key);
+    if (it != _entries.end())
+    {
+        return it->second.frame;
+    }
+
+    return insert(image, key, "");
+}
+
+SpriteFrame* DynamicAtlas::getSpriteFrame(const std::string& key) const
+{
+    auto it = _entries.find(key);
+    return it != _entries.end() ? it->second.frame : nullptr;
+}
+
+void DynamicAtlas::removeImage(const std::string& key)
+{
+    auto it = _entries.find(key);
+    if (it == _entries.end())
+    {
+        return;
+    }
+
+    Entry& entry = it->second;
+    Page* page = entry.page;
+    page->unusedArea += entry.width * entry.height;
+
+    entry.frame->release();
+    CC_SAFE_RELEASE(entry.image);
+    _entries.erase(it);
+
+    removePageIfEmpty(page);
+}
+
+void DynamicAtlas::removeAllImages()
+{
+    for (auto& item : _entries)
+    {
+        item.second.frame->release();
+        CC_SAFE_RELEASE(item.second.image);
+    }
+    _entries.clear();
+
+    releasePages(_pages);
+}
+
+void DynamicAtlas::repack()
+{
+    if (_repackScheduled)
+    {
+        Director::getInstance()->getScheduler()->unschedule(ATLAS_REPACK_KEY, this);
+        _repackScheduled = false;
+    }
+
+    std::vector<Page*> oldPages;
+    oldPages.swap(_pages);
+
+    // the images are copied from the old pages instead of being decoded again
+    std::unordered_map<Page*, std::vector<unsigned char>> pixels;
+    for (auto page : oldPages)
+    {
+        if (! readPage(page, pixels[page]))
+        {
+            pixels.erase(page);
+        }
+    }
+
+    // a page that can't be read back keeps the images that can't be loaded again
+    for (auto& item : _entries)
+    {
+        Page* page = item.second.page;
+        if (item.second.file.empty() && pixels.find(page) == pixels.end()
+            && std::find(_pages.begin(), _pages.end(), page) == _pages.end())
+        {
+            CCLOG("cocos2d: DynamicAtlas: can't read back a page, it isn't repacked");
+            _pages.push_back(page);
+            oldPages.erase(std::find(oldPages.begin(), oldPages.end(), page));
+        }
+    }
+
+    // tallest first, it keeps the skyline flat
+    typedef std::unordered_map<std::string, Entry>::iterator EntryIterator;
+    std::vector<EntryIterator> entries;
+    entries.reserve(_entries.size());
+    for (auto it = _entries.begin(); it != _entries.end(); ++it)
+    {
+        if (std::find(oldPages.begin(), oldPages.end(), it->second.page) != oldPages.end())
+        {
+            entries.push_back(it);
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const EntryIterator& a, const EntryIterator& b) {
+        return a->second.height != b->second.height ? a->second.height > b->second.height : a->second.width > b->second.width;
+    });
+
+    std::vector<EntryIterator> lost;
+    for (auto& it : entries)
+    {
+        Entry* entry = &it->second;
+        Entry from = *entry;
+        int width = from.width - 2 * ATLAS_IMAGE_BORDER;
+        int height = from.height - 2 * ATLAS_IMAGE_BORDER;
+
+        auto read = pixels.find(from.page);
+        Image* image = read == pixels.end() ? loadImage(entry->file) : nullptr;
+        if ((read != pixels.end() || image) && place(*entry, width, height))
+        {
+            if (image)
+            {
+                upload(image, entry->page, entry->x, entry->y);
+            }
+            else
+            {
+                copyPixels(read->second, from, entry->page, entry->x, entry->y);
+            }
+            entry->frame->setTexture(entry->page->texture);
+            entry->frame->setRectInPixels(Rect(entry->x + ATLAS_IMAGE_BORDER, entry->y + ATLAS_IMAGE_BORDER, width, height));
+        }
+        else
+        {
+            CCLOG("cocos2d: DynamicAtlas: can't repack %s", it->first.c_str());
+            lost.push_back(it);
+        }
+        CC_SAFE_RELEASE(image);
+    }
+
+    for (auto& it : lost)
+    {
+        it->second.frame->release();
+        CC_SAFE_RELEASE(it->second.image);
+        _entries.erase(it);
+    }
+
+    // sprites made from the frames before keep the old textures alive as long as they need them
+    releasePages(oldPages);
+}
+
+Texture2D* DynamicAtlas::getPageTexture(ssize_t index) const
+{
+    CCASSERT(index >= 0 && index < (ssize_t)_pages.size(), "DynamicAtlas: invalid page index");
+    return _pages[index]->texture;
+}
+
+int DynamicAtlas::getUnusedArea() const
+{
+    int area = 0;
+    for (auto page : _pages)
+    {
+        area += page->unusedArea;
+    }
+    return area;
+}
+
+SpriteFrame* DynamicAtlas::insert(Image* image, const std::string& key, const std::string& file)
+{
+    if (! canPack(image))
+    {
+        return nullptr;
+    }
+
+    int width = image->getWidth();
+    int height = image->getHeight();
+
+    Entry entry;
+    entry.frame = nullptr;
+    entry.image = nullptr;
+    entry.file = file;
+    entry.page = nullptr;
+
+    if (! place(entry, width, height))
+    {
+        return nullptr;
+    }
+    upload(image, entry.page, entry.x, entry.y);
+
+    entry.frame = SpriteFrame::createWithTexture(entry.page->texture,
+                                                 Rect(entry.x + ATLAS_IMAGE_BORDER, entry.y + ATLAS_IMAGE_BORDER, width, height),
+                                                 false, Vector2::ZERO, Size(width, height));
+    entry.frame->retain();
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // like VolatileTextureMgr, keep the image to fill the page again when the GL context is lost
+    if (file.empty())
+    {
+        entry.image = image;
+        image->retain();
+    }
+#endif
+
+    _entries[key] = entry;
+    return entry.frame;
+}
+
+bool DynamicAtlas::canPack(Image* image) const
+{
+    if (image->isCompressed() || image->getNumberOfMipmaps() > 1)
+    {
+        CCLOG("cocos2d: DynamicAtlas: compressed images can't be packed");
+        return false;
+    }
+    if (image->isPremultipliedAlpha())
+    {
+        CCLOG("cocos2d: DynamicAtlas: images with premultiplied alpha can't be packed");
+        return false;
+    }
+    if (image->getRenderFormat() != _pixelFormat && ! Texture2D::getConvertFunction(image->getRenderFormat(), _pixelFormat))
+    {
+        CCLOG("cocos2d: DynamicAtlas: can't convert format %d to the page format %d", (int)image->getRenderFormat(), (int)_pixelFormat);
+        return false;
+    }
+    if (image->getWidth() + 2 * ATLAS_IMAGE_BORDER > _pageWidth || image->getHeight() + 2 * ATLAS_IMAGE_BORDER > _pageHeight)
+    {
+        CCLOG("cocos2d: DynamicAtlas: image (%d x %d) is bigger than a page", image->getWidth(), image->getHeight());
+        return false;
+    }
+    return true;
+}
+
+DynamicAtlas::Page* DynamicAtlas::newPage()
+{
+    size_t dataLen = (size_t)_pageWidth * _pageHeight * Texture2D::getPixelFormatInfoMap().at(_pixelFormat).bpp / 8;
+    void* data = calloc(dataLen, 1);
+
+    Texture2D* texture = new Texture2D();
+    texture->initWithData(data, dataLen, _pixelFormat, _pageWidth, _pageHeight, Size(_pageWidth, _pageHeight));
+    free(data);
+
+    Page* page = new Page();
+    page->texture = texture;
+    page->skyline.push_back({0, 0, _pageWidth});
+    page->usedArea = 0;
+    page->unusedArea = 0;
+    _pages.push_back(page);
+    return page;
+}
+
+bool DynamicAtlas::findPosition(const Page* page, int width, int height, int& outX, int& outY, int& outIndex) const
+{
+    // bottom-left: the lowest top edge, then the narrowest level
+    int bestTop = _pageHeight + 1;
+    int bestWidth = _pageWidth + 1;
+    outIndex = -1;
+
+    const auto& skyline = page->skyline;
+    for (size_t i = 0; i < skyline.size(); ++i)
+    {
+        int x = skyline[i].x;
+        if (x + width > _pageWidth)
+        {
+            break;
+        }
+
+        // the image rests on the highest level it spans
+        int y = 0;
+        int widthLeft = width;
+        for (size_t j = i; widthLeft > 0; ++j)
+        {
+            y = std::max(y, skyline[j].y);
+            widthLeft -= skyline[j].width;
+        }
+        if (y + height > _pageHeight)
+        {
+            continue;
+        }
+
+        if (y + height < bestTop || (y + height == bestTop && skyline[i].width < bestWidth))
+        {
+            bestTop = y + height;
+            bestWidth = skyline[i].width;
+            outX = x;
+            outY = y;
+            outIndex = (int)i;
+        }
+    }
+    return outIndex >= 0;
+}
+
+void DynamicAtlas::addSkylineLevel(Page* page, int index, int x, int y, int width, int height)
+{
+    auto& skyline = page->skyline;
+    skyline.insert(skyline.begin() + index, {x, y + height, width});
+
+    // cut the levels now covered by the new one
+    for (size_t i = index + 1; i < skyline.size();)
+    {
+        const SkylineNode& previous = skyline[i - 1];
+        SkylineNode& node = skyline[i];
+        int shrink = previous.x + previous.width - node.x;
+        if (shrink <= 0)
+        {
+            break;
+        }
+        if (node.width > shrink)
+        {
+            node.x += shrink;
+            node.width -= shrink;
+            break;
+        }
+        skyline.erase(skyline.begin() + i);
+    }
+
+    // merge neighbours of the same height
+    for (size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+bool DynamicAtlas::place(Entry& entry, int width, int height)
+{
+    int paddedWidth = width + 2 * ATLAS_IMAGE_BORDER;
+    int paddedHeight = height + 2 * ATLAS_IMAGE_BORDER;
+    if (paddedWidth > _pageWidth || paddedHeight > _pageHeight)
+    {
+        return false;
+    }
+
+    int x = 0, y = 0, index = -1;
+    Page* page = nullptr;
+    for (auto candidate : _pages)
+    {
+        if (findPosition(candidate, paddedWidth, paddedHeight, x, y, index))
+        {
+            page = candidate;
+            break;
+        }
+    }
+
+    if (! page)
+    {
+        // a page worth of removed images: compact them on the next frame rather than in the middle of addImage
+        if (getUnusedArea() >= _pageWidth * _pageHeight)
+        {
+            scheduleRepack();
+        }
+        page = newPage();
+        findPosition(page, paddedWidth, paddedHeight, x, y, index);
+    }
+
+    addSkylineLevel(page, index, x, y, paddedWidth, paddedHeight);
+    page->usedArea += paddedWidth * paddedHeight;
+
+    entry.page = page;
+    entry.x = x;
+    entry.y = y;
+    entry.width = paddedWidth;
+    entry.height = paddedHeight;
+    return true;
+}
+
+void DynamicAtlas::upload(Image* image, Page* page, int x, int y)
+{
+    int width = image->getWidth();
+    int height = image->getHeight();
+    Texture2D::PixelFormat format = image->getRenderFormat();
+    int pixelSize = Texture2D::getPixelFormatInfoMap().at(_pixelFormat).bpp / 8;
+    int sourceRowBytes = width * Texture2D::getPixelFormatInfoMap().at(format).bpp / 8;
+    Texture2D::ConvertFunction convert = format != _pixelFormat ? Texture2D::getConvertFunction(format, _pixelFormat) : nullptr;
+
+    int paddedWidth = width + 2 * ATLAS_IMAGE_BORDER;
+    int paddedHeight = height + 2 * ATLAS_IMAGE_BORDER;
+    int rowBytes = paddedWidth * pixelSize;
+    std::vector<unsigned char> buffer(rowBytes * paddedHeight);
+
+    const unsigned char* source = image->getData();
+    for (int row = 0; row < height; ++row)
+    {
+        unsigned char* out = &buffer[(row + ATLAS_IMAGE_BORDER) * rowBytes];
+        unsigned char* pixels = out + ATLAS_IMAGE_BORDER * pixelSize;
+        if (convert)
+        {
+            convert(source + row * sourceRowBytes, sourceRowBytes, pixels);
+        }
+        else
+        {
+            memcpy(pixels, source + row * sourceRowBytes, sourceRowBytes);
+        }
+
+        // repeat the edge pixels into the border
+        for (int i = 0; i < ATLAS_IMAGE_BORDER; ++i)
+        {
+            memcpy(out + i * pixelSize, pixels, pixelSize);
+            memcpy(pixels + (width + i) * pixelSize, pixels + (width - 1) * pixelSize, pixelSize);
+        }
+    }
+    for (int i = 0; i < ATLAS_IMAGE_BORDER; ++i)
+    {
+        memcpy(&buffer[i * rowBytes], &buffer[ATLAS_IMAGE_BORDER * rowBytes], rowBytes);
+        memcpy(&buffer[(paddedHeight - 1 - i) * rowBytes], &buffer[(paddedHeight - 1 - ATLAS_IMAGE_BORDER) * rowBytes], rowBytes);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    page->texture->updateWithData(buffer.data(), x, y, paddedWidth, paddedHeight);
+}
+
+bool DynamicAtlas::readPage(const Page* page, std::vector<unsigned char>& outPixels) const
+{
+    if (_pixelFormat != Texture2D::PixelFormat::RGBA8888 && ! Texture2D::getConvertFunction(Texture2D::PixelFormat::RGBA8888, _pixelFormat))
+    {
+        return false;
+    }
+
+    GLint oldFBO = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFBO);
+    GLuint fbo = 0;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, page->texture->getName(), 0);
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (complete)
+    {
+        outPixels.resize((size_t)_pageWidth * _pageHeight * 4);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, _pageWidth, _pageHeight, GL_RGBA, GL_UNSIGNED_BYTE, outPixels.data());
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, oldFBO);
+    glDeleteFramebuffers(1, &fbo);
+    CHECK_GL_ERROR_DEBUG();
+    return complete;
+}
+
+void DynamicAtlas::copyPixels(const std::vector<unsigned char>& pixels, const Entry& from, Page* page, int x, int y)
+{
+    // the rect includes the border, it is copied as it is
+    int pixelSize = Texture2D::getPixelFormatInfoMap().at(_pixelFormat).bpp / 8;
+    int sourceRowBytes = from.width * 4;
+    int rowBytes = from.width * pixelSize;
+    Texture2D::ConvertFunction convert = _pixelFormat != Texture2D::PixelFormat::RGBA8888
+        ? Texture2D::getConvertFunction(Texture2D::PixelFormat::RGBA8888, _pixelFormat) : nullptr;
+    std::vector<unsigned char> buffer(rowBytes * from.height);
+
+    for (int row = 0; row < from.height; ++row)
+    {
+        const unsigned char* source = &pixels[((size_t)(from.y + row) * _pageWidth + from.x) * 4];
+        if (convert)
+        {
+            convert(source, sourceRowBytes, &buffer[row * rowBytes]);
+        }
+        else
+        {
+            memcpy(&buffer[row * rowBytes], source, sourceRowBytes);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    page->texture->updateWithData(buffer.data(), x, y, from.width, from.height);
+}
+
+void DynamicAtlas::scheduleRepack()
+{
+    if (_repackScheduled)
+    {
+        return;
+    }
+    _repackScheduled = true;
+    Director::getInstance()->getScheduler()->schedule([this](float) {
+        // the timer runs once and removes itself
+        _repackScheduled = false;
+        repack();
+    }, this, 0, 0, 0, false, ATLAS_REPACK_KEY);
+}
+
+Image* DynamicAtlas::loadImage(const std::string& file) const
+{
+    Image* image = new Image();
+    image->setTargetPixelFormat(_pixelFormat);
+    if (! image->initWithImageFile(file))
+    {
+        image->release();
+        return nullptr;
+    }
+    return image;
+}
+
+void DynamicAtlas::removePageIfEmpty(Page* page)
+{
+    if (page->usedArea > page->unusedArea)
+    {
+        return;
+    }
+
+    _pages.erase(std::find(_pages.begin(), _pages.end(), page));
+    page->texture->release();
+    delete page;
+}
+
+void DynamicAtlas::releasePages(std::vector<Page*>& pages)
+{
+    for (auto page : pages)
+    {
+        page->texture->release();
+        delete page;
+    }
+    pages.clear();
+}
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+void DynamicAtlas::listenToForeground(EventCustom* event)
+{
+    // the page textures were lost with the GL context, fill them again in place
+    // so the sprites using them keep working
+    size_t dataLen = (size_t)_pageWidth * _pageHeight * Texture2D::getPixelFormatInfoMap().at(_pixelFormat).bpp / 8;
+    void* data = calloc(dataLen, 1);
+    for (auto page : _pages)
+    {
+        page->texture->initWithData(data, dataLen, _pixelFormat, _pageWidth, _pageHeight, Size(_pageWidth, _pageHeight));
+    }
+    free(data);
+
+    for (auto& item : _entries)
+    {
+        Entry& entry = item.second;
+        Image* image = entry.image;
+        if (image)
+        {
+            image->retain();
+        }
+        else
+        {
+            image = loadImage(entry.file);
+        }
+        if (image)
+        {
+            upload(image, entry.page, entry.x, entry.y);
+            image->release();
+        }
+    }
+}
+#endif
+
+NS_CC_END
@@ -0,0 +1,192 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCDYNAMIC_ATLAS_H__
+#define __CCDYNAMIC_ATLAS_H__
+
+#include "base/CCRef.h"
+#include "2d/CCTexture2D.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+NS_CC_BEGIN
+
+class Image;
+class SpriteFrame;
+class EventCustom;
+class EventListenerCustom;
+
+/**
+ * @addtogroup textures
+ * @{
+ */
+
+/** @brief DynamicAtlas packs small images into shared textures at runtime.
+
+ Every image loaded with TextureCache::addImage gets its own GL texture, so sprites made from
+ different images can't be batched. DynamicAtlas copies images into a few large pages instead and
+ returns SpriteFrames that point into them. Sprites using frames of the same page share a texture
+ and are drawn together.
+
+ Images are placed with a skyline bottom-left allocator and get a 1 pixel border that repeats their
+ edge pixels, so linear filtering doesn't bleed between neighbours.
+
+ Removing an image doesn't reuse its space right away. Sprites made from the frame earlier still
+ show that part of the page. The space is given back by repack(), which copies the images that are
+ left into new pages. Sprites keep their old page textures until they stop using them.
+ When an image doesn't fit and at least a page worth of space is unused, the image goes into a new
+ page and repack() is scheduled for the next frame.
+
+ SpriteFrameCache::getDynamicAtlas() returns the shared atlas used by
+ SpriteFrameCache::addSpriteFrameToDynamicAtlas().
+ @since v3.1
+ */
+class CC_DLL DynamicAtlas : public Ref
+{
+public:
+    /** creates an atlas with pages of the given size and pixel format */
+    static DynamicAtlas* create(int pageWidth = 1024, int pageHeight = 1024, Texture2D::PixelFormat pixelFormat = Texture2D::PixelFormat::RGBA8888);
+    /**
+     * @js ctor
+     */
+    DynamicAtlas();
+    /**
+     * @js NA
+     * @lua NA
+     */
+    virtual ~DynamicAtlas();
+
+    bool init(int pageWidth, int pageHeight, Texture2D::PixelFormat pixelFormat);
+
+    /** Packs an image file into the atlas and returns its frame, using the file name as key.
+     If the file was added before, its frame is returned.
+     Returns nullptr if the file can't be loaded, is compressed, or is larger than a page.
+     The file is only loaded again when the pages are lost with the GL context.
+     */
+    SpriteFrame* addImage(const std::string& filename);
+
+    /** Packs an image into the atlas with the given key and returns its frame.
+     The image isn't kept, except on platforms that lose the GL context, where it is retained to fill
+     the page again.
+     Returns nullptr if the image is compressed, its format can't be converted to the page format,
+     or it is larger than a page.
+     */
+    SpriteFrame* addImage(Image* image, const std::string& key);
+
+    /** Returns the frame of the key, or nullptr if it isn't in the atlas */
+    SpriteFrame* getSpriteFrame(const std::string& key) const;
+
+    /** Removes the image of the key. Its space is given back when the atlas is repacked. */
+    void removeImage(const std::string& key);
+
+    /** Removes all images and releases the pages */
+    void removeAllImages();
+
+    /** Copies the images that are left into new pages, so that removed images stop using space.
+     The frames are updated to point into the new pages.
+     The pixels are read back from the old pages, no image is decoded again. A page that can't be read
+     back, because its format can't be attached to a framebuffer, reloads the images added from files
+     and is kept as it is if it holds images that were added directly.
+     */
+    void repack();
+
+    /** Number of pages, that is textures, the atlas uses */
+    ssize_t getPageCount() const { return _pages.size(); }
+
+    /** Texture of a page */
+    Texture2D* getPageTexture(ssize_t index) const;
+
+    /** Number of images in the atlas */
+    ssize_t getImageCount() const { return _entries.size(); }
+
+    /** Pixels of the pages that are taken by removed images */
+    int getUnusedArea() const;
+
+protected:
+    struct SkylineNode
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    struct Page
+    {
+        Texture2D* texture;
+        std::vector<SkylineNode> skyline;
+        // pixels of the images placed in the page, including the ones that were removed
+        int usedArea;
+        // pixels of the removed images
+        int unusedArea;
+    };
+
+    struct Entry
+    {
+        SpriteFrame* frame;
+        // retained when the image was added directly and the GL context can be lost
+        Image* image;
+        std::string file;
+        Page* page;
+        // the rect in the page, including the border
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    SpriteFrame* insert(Image* image, const std::string& key, const std::string& file);
+    bool canPack(Image* image) const;
+    Page* newPage();
+    bool findPosition(const Page* page, int width, int height, int& outX, int& outY, int& outIndex) const;
+    void addSkylineLevel(Page* page, int index, int x, int y, int width, int height);
+    bool place(Entry& entry, int width, int height);
+    void upload(Image* image, Page* page, int x, int y);
+    bool readPage(const Page* page, std::vector<unsigned char>& outPixels) const;
+    void copyPixels(const std::vector<unsigned char>& pixels, const Entry& from, Page* page, int x, int y);
+    void scheduleRepack();
+    Image* loadImage(const std::string& file) const;
+    void removePageIfEmpty(Page* page);
+    void releasePages(std::vector<Page*>& pages);
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    void listenToForeground(EventCustom* event);
+    EventListenerCustom* _toForegroundListener;
+#endif
+
+    int _pageWidth;
+    int _pageHeight;
+    Texture2D::PixelFormat _pixelFormat;
+    bool _repackScheduled;
+    std::vector<Page*> _pages;
+    std::unordered_map<std::string, Entry> _entries;
+};
+
+// end of textures group
+/// @}
+
+NS_CC_END
+
+#endif //__CCDYNAMIC_ATLAS_H__
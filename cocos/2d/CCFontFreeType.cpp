@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include "ccUTF8.h"
 #include "2d/CCFontFreeType.h"
 #include "2d/platform/CCFileUtils.h"
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
 #include "edtaa3func.h"
 #include FT_BBOX_H
 
@@ -46,6 +48,8 @@ typedef struct _DataRef
 }DataRef;
 
 static std::unordered_map<std::string, DataRef> s_cacheFontData;
+// read by preloadFontDataAsync, until a font is created with it
+static std::unordered_map<std::string, Data> s_preloadedFontData;
 
 FontFreeType * FontFreeType::create(const std::string &fontName, int fontSize, GlyphCollection glyphs, const char *customGlyphs,bool distanceFieldEnabled /* = false */,int outline /* = 0 */)
 {
@@ -78,8 +82,29 @@ bool FontFreeType::initFreeType()
     return  _FTInitialized;
 }
 
+void FontFreeType::preloadFontDataAsync(const std::string& fontName, const std::function<void(bool)>& callback)
+{
+    FileUtils::getInstance()->addIOTask([fontName, callback]() {
+        auto data = std::make_shared<Data>(FileUtils::getInstance()->getMappedDataFromFile(fontName));
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([fontName, data, callback]() {
+            bool loaded = !data->isNull();
+            // a font created meanwhile already holds its own data
+            if (loaded && s_cacheFontData.find(fontName) == s_cacheFontData.end())
+            {
+                s_preloadedFontData[fontName] = std::move(*data);
+            }
+            if (callback)
+            {
+                callback(loaded);
+            }
+        });
+    });
+}
+
 void FontFreeType::shutdownFreeType()
 {
+    s_preloadedFontData.clear();
+
     if (_FTInitialized == true)
     {
         FT_Done_FreeType(_FTlibrary);
@@ -124,7 +149,16 @@ bool FontFreeType::createFontObject(const std::string &fontName, int fontSize)
     else
     {
         s_cacheFontData[fontName].referenceCount = 1;
-        s_cacheFontData[fontName].data = FileUtils::getInstance()->getDataFromFile(fontName);    
+        auto preloaded = s_preloadedFontData.find(fontName);
+        if (preloaded != s_preloadedFontData.end())
+        {
+            s_cacheFontData[fontName].data = std::move(preloaded->second);
+            s_preloadedFontData.erase(preloaded);
+        }
+        else
+        {
+            s_cacheFontData[fontName].data = FileUtils::getInstance()->getMappedDataFromFile(fontName);
+        }
 
         if (s_cacheFontData[fontName].data.isNull())
         {
@@ -30,6 +30,7 @@
 #include "base/CCData.h"
 
 #include <string>
+#include <functional>
 #include <ft2build.h>
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_WP8) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
@@ -57,6 +58,11 @@ public:
 
     static void shutdownFreeType();
 
+    /** Reads a font file on an I/O thread of FileUtils, the first font created from it uses the data read.
+     callback is called on the cocos thread, with false if the file can't be read.
+     */
+    static void preloadFontDataAsync(const std::string& fontName, const std::function<void(bool)>& callback);
+
     bool     isDistanceFieldEnabled() const { return _distanceFieldEnabled;}
     int      getOutlineSize() const { return _outlineSize; }
     void     renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight); 
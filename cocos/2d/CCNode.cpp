@@ -706,6 +706,34 @@ void Node::cleanup()
         child->cleanup();
 }
 
+void Node::resetForReuse()
+{
+    this->stopAllActions();
+    this->unscheduleAllSelectors();
+    _eventDispatcher->removeAddedEventListenersForTarget(this);
+
+    setPosition(Vector2::ZERO);
+    setPositionZ(0.0f);
+    setRotation3D(Vector3::ZERO);
+    setRotationSkewY(0.0f);
+    setScale(1.0f);
+    setScaleZ(1.0f);
+    setSkewX(0.0f);
+    setSkewY(0.0f);
+    setAdditionalTransform(nullptr);
+    setVisible(true);
+
+    _localZOrder = 0;
+    setGlobalZOrder(0);
+    _tag = Node::INVALID_TAG;
+    _name.clear();
+    _userData = nullptr;
+    setUserObject(nullptr);
+
+    setColor(Color3B::WHITE);
+    setOpacity(255);
+}
+
 
 std::string Node::getDescription() const
 {
@@ -915,6 +915,19 @@ public:
      */
     virtual void cleanup();
 
+    /**
+     * Sets the node back to the state it had after it was created, so that a NodePool can hand it out again.
+     * Actions and schedulers are removed. Transform, color, opacity,
+     * visibility, z orders, tag, name and user data get their default values.
+     * The anchor point, the children and what subclasses were initialized with are kept,
+     * they are part of what was built when the node was created.
+     * Event listeners are removed, except the ones marked with EventDispatcher::markEventListenersBuiltWithTarget(),
+     * like the ones Label, Menu or ui::Widget register for themselves when a NodePool creates them.
+     * Subclasses with more state override it and call their parent's one.
+     * @since v3.1
+     */
+    virtual void resetForReuse();
+
     /**
      * Override this method to draw your own node.
      * The following GL states will be enabled by default:
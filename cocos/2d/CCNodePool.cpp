@@ -0,0 +1,98 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "2d/CCNodePool.h"
+
+NS_CC_BEGIN
+
+// blocks are aligned like memory from operator new
+static const size_t SLAB_ALIGNMENT = 16;
+
+SlabAllocator::SlabAllocator(size_t blockSize, size_t blocksPerChunk)
+: _blockSize((std::max(blockSize, sizeof(FreeBlock)) + SLAB_ALIGNMENT - 1) & ~(SLAB_ALIGNMENT - 1))
+, _blocksPerChunk(blocksPerChunk)
+, _blocksInUse(0)
+, _freeList(nullptr)
+, _requestedSize(blockSize)
+{
+}
+
+SlabAllocator::~SlabAllocator()
+{
+    // static allocators can be destroyed before the last nodes at exit, keep their memory valid then
+    if (_blocksInUse == 0)
+    {
+        for (auto chunk : _chunks)
+        {
+            ::operator delete(chunk);
+        }
+    }
+}
+
+void* SlabAllocator::allocate(size_t size)
+{
+    if (size != _requestedSize)
+    {
+        return ::operator new(size);
+    }
+
+    if (_freeList == nullptr)
+    {
+        char* chunk = static_cast<char*>(::operator new(_blockSize * _blocksPerChunk));
+        _chunks.push_back(chunk);
+
+        // thread the new blocks into the free list, first block first
+        for (size_t i = _blocksPerChunk; i > 0; --i)
+        {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + (i - 1) * _blockSize);
+            block->next = _freeList;
+            _freeList = block;
+        }
+    }
+
+    FreeBlock* block = _freeList;
+    _freeList = block->next;
+    ++_blocksInUse;
+    return block;
+}
+
+void SlabAllocator::deallocate(void* ptr, size_t size)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+    if (size != _requestedSize)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = _freeList;
+    _freeList = block;
+    --_blocksInUse;
+}
+
+NS_CC_END
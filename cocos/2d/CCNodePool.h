@@ -0,0 +1,248 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCNODE_POOL_H__
+#define __CCNODE_POOL_H__
+
+#include "2d/CCNode.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCVector.h"
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup base_nodes
+ * @{
+ */
+
+/** @brief NodePool keeps nodes that are no longer used, so they can be handed out again without being created.
+
+ Creating a Sprite allocates the node, its render command and its containers, and initializing it
+ looks up the texture and shader. Games that create and remove many nodes every frame, like bullets,
+ damage numbers or effects, can recycle them instead:
+
+ @code
+ NodePool<Sprite> bullets([]() { return Sprite::create("bullet.png"); }, 200);
+ bullets.reserve(100);
+
+ auto bullet = bullets.obtain();    // autoreleased, like Sprite::create()
+ layer->addChild(bullet);
+ ...
+ bullets.recycle(bullet);           // removes it from its parent and calls resetForReuse()
+ @endcode
+
+ A recycled node is removed from its parent with cleanup and reset with Node::resetForReuse().
+ The event listeners a node has when the factory returns it are kept, the ones added later are removed.
+ Only recycle nodes that were obtained from the pool.
+ Only the first `capacity` recycled nodes are kept; the others are released.
+ @since v3.1
+ */
+template <class T>
+class NodePool
+{
+public:
+    /** the function that creates a new node, it returns an autoreleased node like T::create() */
+    typedef std::function<T*()> Factory;
+
+    NodePool(const Factory& factory, ssize_t capacity = 64)
+    : _factory(factory)
+    , _capacity(capacity)
+    {
+        static_assert(std::is_convertible<T*, Node*>::value, "Invalid Type for cocos2d::NodePool<T>!");
+    }
+
+    ~NodePool()
+    {
+        clear();
+    }
+
+    /** Returns a recycled node, or a new one if there is none. The node is autoreleased. */
+    T* obtain()
+    {
+        if (_nodes.empty())
+        {
+            return create();
+        }
+
+        T* node = _nodes.back();
+        node->retain();
+        node->autorelease();
+        _nodes.popBack();
+        return node;
+    }
+
+    /** Removes the node from its parent, resets it, and keeps it if the pool isn't full */
+    void recycle(T* node)
+    {
+        CCASSERT(node != nullptr, "NodePool: node MUST not be nil");
+        CCASSERT(! _nodes.contains(node), "NodePool: the node was already recycled");
+
+        if (_nodes.size() >= _capacity)
+        {
+            node->removeFromParentAndCleanup(true);
+            return;
+        }
+
+        // the pool retains it first, so removing it can't free it
+        _nodes.pushBack(node);
+        node->removeFromParentAndCleanup(true);
+        node->resetForReuse();
+    }
+
+    /** Creates nodes until the pool has `count` of them, so that the first obtain() calls don't create any */
+    void reserve(ssize_t count)
+    {
+        count = std::min(count, _capacity);
+        _nodes.reserve(count);
+        while (_nodes.size() < count)
+        {
+            T* node = create();
+            if (node == nullptr)
+            {
+                break;
+            }
+            _nodes.pushBack(node);
+        }
+    }
+
+    /** Releases the nodes of the pool */
+    void clear()
+    {
+        _nodes.clear();
+    }
+
+    /** Number of nodes that obtain() can return without creating one */
+    ssize_t size() const { return _nodes.size(); }
+
+    /** Maximum number of nodes the pool keeps */
+    ssize_t getCapacity() const { return _capacity; }
+    void setCapacity(ssize_t capacity)
+    {
+        _capacity = capacity;
+        while (_nodes.size() > _capacity)
+        {
+            _nodes.popBack();
+        }
+    }
+
+protected:
+    T* create()
+    {
+        T* node = _factory();
+        if (node != nullptr)
+        {
+            // what the node registered while it was built survives resetForReuse()
+            node->getEventDispatcher()->markEventListenersBuiltWithTarget(node);
+        }
+        return node;
+    }
+
+    Factory _factory;
+    ssize_t _capacity;
+    Vector<T*> _nodes;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(NodePool);
+};
+
+/** @brief SlabAllocator hands out memory blocks of one size from large chunks.
+
+ Freed blocks go to a free list and are reused by the next allocation. The chunks are only
+ given back when the allocator is destroyed with no block in use.
+ It isn't thread safe, nodes are created and destroyed in the cocos thread.
+ Use CC_NODE_SLAB_ALLOCATED() to allocate a Node subclass with it.
+ @since v3.1
+ */
+class CC_DLL SlabAllocator
+{
+public:
+    SlabAllocator(size_t blockSize, size_t blocksPerChunk = 64);
+    ~SlabAllocator();
+
+    /** Returns a block, or memory from operator new if size isn't the block size (a subclass of the type) */
+    void* allocate(size_t size);
+    /** Gives back memory returned by allocate(size) */
+    void deallocate(void* ptr, size_t size);
+
+    /** Number of blocks in use */
+    size_t getBlocksInUse() const { return _blocksInUse; }
+    /** Number of blocks in the chunks */
+    size_t getBlockCount() const { return _chunks.size() * _blocksPerChunk; }
+
+protected:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    // rounded up for alignment
+    size_t _blockSize;
+    size_t _blocksPerChunk;
+    size_t _blocksInUse;
+    FreeBlock* _freeList;
+    // the size blocks are handed out for
+    size_t _requestedSize;
+    std::vector<void*> _chunks;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(SlabAllocator);
+};
+
+/** Allocates a Node subclass from its own SlabAllocator, so that creating and deleting instances
+ doesn't go to the system allocator. Put it in the class declaration:
+
+ @code
+ class Bullet : public Sprite
+ {
+     CC_NODE_SLAB_ALLOCATED(Bullet);
+ public:
+     ...
+ };
+ @endcode
+ Subclasses that don't use the macro themselves are bigger and get their memory from operator new.
+ */
+#define CC_NODE_SLAB_ALLOCATED(__TYPE__) \
+public: \
+    static cocos2d::SlabAllocator& getSlabAllocator() \
+    { \
+        static cocos2d::SlabAllocator allocator(sizeof(__TYPE__)); \
+        return allocator; \
+    } \
+    static void* operator new(size_t size) { return getSlabAllocator().allocate(size); } \
+    static void operator delete(void* ptr, size_t size) { getSlabAllocator().deallocate(ptr, size); } \
+    static void* operator new(size_t, void* where) { return where; } \
+    static void operator delete(void*, void*) {} \
+private:
+
+// end of base_nodes group
+/// @}
+
+NS_CC_END
+
+#endif // __CCNODE_POOL_H__
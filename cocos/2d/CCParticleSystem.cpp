@@ -628,6 +628,14 @@ void ParticleSystem::onExit()
     Node::onExit();
 }
 
+void ParticleSystem::resetForReuse()
+{
+    Node::resetForReuse();
+
+    // emit again from the start, the update is scheduled again by onEnter()
+    resetSystem();
+}
+
 void ParticleSystem::stopSystem()
 {
     _isActive = false;
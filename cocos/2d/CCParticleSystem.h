@@ -357,6 +357,7 @@ public:
     virtual void onEnter() override;
     virtual void onExit() override;
     virtual void update(float dt) override;
+    virtual void resetForReuse() override;
     virtual Texture2D* getTexture() const override;
     virtual void setTexture(Texture2D *texture) override;
     /**
@@ -41,6 +41,7 @@ THE SOFTWARE.
 #include "base/CCProfiling.h"
 #include "base/CCDirector.h"
 #include "base/CCDirector.h"
+#include "CCGLView.h"
 #include "base/ccConfig.h"
 #include "math/CCGeometry.h"
 #include "math/CCAffineTransform.h"
@@ -592,6 +593,20 @@ void Sprite::draw(Renderer *renderer, const Matrix &transform, bool transformUpd
     {
         _quadCommand.init(_globalZOrder, _texture->getName(), getGLProgramState(), _blendFunc, &_quad, 1, transform);
         renderer->addCommand(&_quadCommand);
+
+        if (_texture->getBaseMipLevel() > 0)
+        {
+            // The texture is still streaming its mipmap levels in, tell it how big it is drawn.
+            // One point of the sprite maps to content scale factor texels, and a design resolution point
+            // to the scale of the GL view in pixels.
+            float scale = sqrtf(transform.m[0] * transform.m[0] + transform.m[1] * transform.m[1]);
+            auto glview = Director::getInstance()->getOpenGLView();
+            if (glview)
+            {
+                scale *= std::max(glview->getScaleX(), glview->getScaleY());
+            }
+            _texture->setDrawnScale(scale / CC_CONTENT_SCALE_FACTOR());
+        }
 #if CC_SPRITE_DEBUG_DRAW
         _customDebugDrawCommand.init(_globalZOrder);
         _customDebugDrawCommand.func = CC_CALLBACK_0(Sprite::drawDebugData, this);
@@ -915,6 +930,15 @@ bool Sprite::isOpacityModifyRGB(void) const
     return _opacityModifyRGB;
 }
 
+void Sprite::resetForReuse()
+{
+    Node::resetForReuse();
+
+    // texture, rect, blend function and shader are kept, they are what a pool of sprites shares
+    setFlippedX(false);
+    setFlippedY(false);
+}
+
 // Frames
 
 void Sprite::setSpriteFrame(const std::string &spriteFrameName)
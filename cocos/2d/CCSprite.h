@@ -423,6 +423,7 @@ public:
     virtual void draw(Renderer *renderer, const Matrix &transform, bool transformUpdated) override;
     virtual void setOpacityModifyRGB(bool modify) override;
     virtual bool isOpacityModifyRGB(void) const override;
+    virtual void resetForReuse() override;
     /// @}
 
 CC_CONSTRUCTOR_ACCESS:
@@ -33,11 +33,15 @@ THE SOFTWARE.
 #include "2d/CCSpriteFrameCache.h"
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCSprite.h"
+#include "2d/CCDynamicAtlas.h"
 #include "math/TransformUtils.h"
 #include "2d/platform/CCFileUtils.h"
 #include "deprecated/CCString.h"
 #include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include <memory>
 #include <vector>
+#include <string.h>
 
 using namespace std;
 
@@ -45,6 +49,129 @@ NS_CC_BEGIN
 
 static SpriteFrameCache *_sharedSpriteFrameCache = nullptr;
 
+/*
+ Binary sprite sheet, as written by tools/spriteframes/plist_to_binary.py. All fields are 32 bit little endian:
+
+ header, frameCount frames, aliasCount aliases, then stringsSize bytes of '\0' terminated strings.
+ Names are offsets into the strings. A frame holds the values passed to SpriteFrame::initWithTexture,
+ so loading it doesn't have to parse anything.
+ */
+static const char BINARY_SPRITE_FRAMES_MAGIC[4] = { 'C', 'C', 'S', 'F' };
+static const uint32_t BINARY_SPRITE_FRAMES_VERSION = 1;
+static const uint32_t BINARY_SPRITE_FRAMES_NO_STRING = 0xffffffff;
+
+struct BinarySpriteFramesHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t frameCount;
+    uint32_t aliasCount;
+    uint32_t stringsSize;
+    uint32_t textureFileName;
+};
+
+struct BinarySpriteFrame
+{
+    uint32_t name;
+    float x, y, width, height;
+    float offsetX, offsetY;
+    float sourceWidth, sourceHeight;
+    uint32_t rotated;
+};
+
+struct BinarySpriteFrameAlias
+{
+    uint32_t name;
+    uint32_t frame;
+};
+
+static_assert(sizeof(BinarySpriteFramesHeader) == 24 && sizeof(BinarySpriteFrame) == 40 && sizeof(BinarySpriteFrameAlias) == 8,
+              "binary sprite frames structs must not be padded");
+
+static bool isBinarySpriteFramesData(const Data& data)
+{
+    return data.getSize() >= (ssize_t)sizeof(BinarySpriteFramesHeader)
+        && memcmp(data.getBytes(), BINARY_SPRITE_FRAMES_MAGIC, sizeof(BINARY_SPRITE_FRAMES_MAGIC)) == 0;
+}
+
+// The data may be mapped from a file or a zip at any address, so the records are copied
+// out instead of being read in place: unaligned float loads fault on ARMv7.
+static size_t getBinarySpriteFrameAliasesOffset(const BinarySpriteFramesHeader& header)
+{
+    return sizeof(BinarySpriteFramesHeader) + header.frameCount * sizeof(BinarySpriteFrame);
+}
+
+static size_t getBinarySpriteFramesStringsOffset(const BinarySpriteFramesHeader& header)
+{
+    return getBinarySpriteFrameAliasesOffset(header) + header.aliasCount * sizeof(BinarySpriteFrameAlias);
+}
+
+static BinarySpriteFrame readBinarySpriteFrame(const Data& data, uint32_t index)
+{
+    BinarySpriteFrame frame;
+    memcpy(&frame, data.getBytes() + sizeof(BinarySpriteFramesHeader) + index * sizeof(BinarySpriteFrame), sizeof(frame));
+    return frame;
+}
+
+static BinarySpriteFrameAlias readBinarySpriteFrameAlias(const Data& data, const BinarySpriteFramesHeader& header, uint32_t index)
+{
+    BinarySpriteFrameAlias alias;
+    memcpy(&alias, data.getBytes() + getBinarySpriteFrameAliasesOffset(header) + index * sizeof(BinarySpriteFrameAlias), sizeof(alias));
+    return alias;
+}
+
+static const char* getBinarySpriteFramesStrings(const Data& data, const BinarySpriteFramesHeader& header)
+{
+    return reinterpret_cast<const char*>(data.getBytes() + getBinarySpriteFramesStringsOffset(header));
+}
+
+// checks every offset once, so the loaders can index the file directly
+static bool readBinarySpriteFramesHeader(const Data& data, BinarySpriteFramesHeader& header)
+{
+    if (!isBinarySpriteFramesData(data))
+    {
+        return false;
+    }
+
+    memcpy(&header, data.getBytes(), sizeof(header));
+    if (header.version != BINARY_SPRITE_FRAMES_VERSION)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: unsupported binary sprite frames version %u", header.version);
+        return false;
+    }
+
+    uint64_t expectedSize = sizeof(BinarySpriteFramesHeader)
+        + (uint64_t)header.frameCount * sizeof(BinarySpriteFrame)
+        + (uint64_t)header.aliasCount * sizeof(BinarySpriteFrameAlias)
+        + header.stringsSize;
+    if ((uint64_t)data.getSize() < expectedSize || header.stringsSize == 0)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: truncated binary sprite frames");
+        return false;
+    }
+
+    auto strings = getBinarySpriteFramesStrings(data, header);
+
+    bool valid = strings[header.stringsSize - 1] == '\0'
+        && (header.textureFileName == BINARY_SPRITE_FRAMES_NO_STRING || header.textureFileName < header.stringsSize);
+    for (uint32_t i = 0; valid && i < header.frameCount; ++i)
+    {
+        valid = readBinarySpriteFrame(data, i).name < header.stringsSize;
+    }
+    for (uint32_t i = 0; valid && i < header.aliasCount; ++i)
+    {
+        BinarySpriteFrameAlias alias = readBinarySpriteFrameAlias(data, header, i);
+        valid = alias.name < header.stringsSize && alias.frame < header.frameCount;
+    }
+
+    if (!valid)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: corrupted binary sprite frames");
+        return false;
+    }
+    return true;
+}
+
 SpriteFrameCache* SpriteFrameCache::getInstance()
 {
     if (! _sharedSpriteFrameCache)
@@ -66,12 +193,14 @@ bool SpriteFrameCache::init(void)
     _spriteFrames.reserve(20);
     _spriteFramesAliases.reserve(20);
     _loadedFileNames = new std::set<std::string>();
+    _dynamicAtlas = nullptr;
     return true;
 }
 
 SpriteFrameCache::~SpriteFrameCache(void)
 {
     CC_SAFE_DELETE(_loadedFileNames);
+    CC_SAFE_RELEASE(_dynamicAtlas);
 }
 
 void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D* texture)
@@ -196,9 +325,102 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Textu
     }
 }
 
+void SpriteFrameCache::addSpriteFramesWithBinaryData(const Data& data, Texture2D* texture)
+{
+    BinarySpriteFramesHeader header;
+    if (!readBinarySpriteFramesHeader(data, header))
+    {
+        return;
+    }
+
+    auto strings = getBinarySpriteFramesStrings(data, header);
+
+    _spriteFrames.reserve(_spriteFrames.size() + header.frameCount);
+
+    for (uint32_t i = 0; i < header.frameCount; ++i)
+    {
+        BinarySpriteFrame frame = readBinarySpriteFrame(data, i);
+        std::string spriteFrameName(strings + frame.name);
+        if (_spriteFrames.at(spriteFrameName))
+        {
+            continue;
+        }
+
+        SpriteFrame* spriteFrame = new SpriteFrame();
+        spriteFrame->initWithTexture(texture,
+                                     Rect(frame.x, frame.y, frame.width, frame.height),
+                                     frame.rotated != 0,
+                                     Vector2(frame.offsetX, frame.offsetY),
+                                     Size(frame.sourceWidth, frame.sourceHeight));
+
+        _spriteFrames.insert(spriteFrameName, spriteFrame);
+        spriteFrame->release();
+    }
+
+    for (uint32_t i = 0; i < header.aliasCount; ++i)
+    {
+        BinarySpriteFrameAlias alias = readBinarySpriteFrameAlias(data, header, i);
+        std::string oneAlias(strings + alias.name);
+        if (_spriteFramesAliases.find(oneAlias) != _spriteFramesAliases.end())
+        {
+            CCLOGWARN("cocos2d: WARNING: an alias with name %s already exists", oneAlias.c_str());
+        }
+
+        _spriteFramesAliases[oneAlias] = Value(strings + readBinarySpriteFrame(data, alias.frame).name);
+    }
+}
+
+void SpriteFrameCache::removeSpriteFramesFromBinaryData(const Data& data)
+{
+    BinarySpriteFramesHeader header;
+    if (!readBinarySpriteFramesHeader(data, header))
+    {
+        return;
+    }
+
+    auto strings = getBinarySpriteFramesStrings(data, header);
+
+    std::vector<std::string> keysToRemove;
+    for (uint32_t i = 0; i < header.frameCount; ++i)
+    {
+        std::string key(strings + readBinarySpriteFrame(data, i).name);
+        if (_spriteFrames.at(key))
+        {
+            keysToRemove.push_back(key);
+        }
+    }
+
+    _spriteFrames.erase(keysToRemove);
+}
+
+Data SpriteFrameCache::getBinaryDataFromFile(const std::string& fullPath)
+{
+    // plists are parsed by FileUtils, don't read them twice
+    size_t dot = fullPath.find_last_of('.');
+    if (dot != std::string::npos && fullPath.compare(dot, std::string::npos, ".plist") == 0)
+    {
+        return Data::Null;
+    }
+
+    Data data = FileUtils::getInstance()->getMappedDataFromFile(fullPath);
+    if (!isBinarySpriteFramesData(data))
+    {
+        return Data::Null;
+    }
+    return data;
+}
+
 void SpriteFrameCache::addSpriteFramesWithFile(const std::string& pszPlist, Texture2D *pobTexture)
 {
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(pszPlist);
+
+    Data data = getBinaryDataFromFile(fullPath);
+    if (!data.isNull())
+    {
+        addSpriteFramesWithBinaryData(data, pobTexture);
+        return;
+    }
+
     ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
 
     addSpriteFramesWithDictionary(dict, pobTexture);
@@ -219,6 +441,47 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, const s
     }
 }
 
+void SpriteFrameCache::addSpriteFramesWithFileAsync(const std::string& plist, const std::string& textureFileName, const std::function<void(bool)>& callback)
+{
+    CCASSERT(textureFileName.size()>0, "texture name should not be null");
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
+
+    FileUtils::getInstance()->addIOTask([fullPath, textureFileName, callback]() {
+        auto data = std::make_shared<Data>(getBinaryDataFromFile(fullPath));
+        auto dict = std::make_shared<ValueMap>();
+        if (data->isNull())
+        {
+            *dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
+        }
+
+        // the cache is looked up again on the cocos thread, it may have been purged meanwhile
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([data, dict, textureFileName, callback]() {
+            Director::getInstance()->getTextureCache()->addImageAsync(textureFileName, [data, dict, textureFileName, callback](Texture2D* texture) {
+                if (texture)
+                {
+                    if (!data->isNull())
+                    {
+                        SpriteFrameCache::getInstance()->addSpriteFramesWithBinaryData(*data, texture);
+                    }
+                    else
+                    {
+                        SpriteFrameCache::getInstance()->addSpriteFramesWithDictionary(*dict, texture);
+                    }
+                }
+                else
+                {
+                    CCLOG("cocos2d: SpriteFrameCache: couldn't load texture file. File not found %s", textureFileName.c_str());
+                }
+
+                if (callback)
+                {
+                    callback(texture != nullptr);
+                }
+            });
+        });
+    });
+}
+
 void SpriteFrameCache::addSpriteFramesWithFile(const std::string& pszPlist)
 {
     CCASSERT(pszPlist.size()>0, "plist filename should not be nullptr");
@@ -226,11 +489,26 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& pszPlist)
     if (_loadedFileNames->find(pszPlist) == _loadedFileNames->end())
     {
         std::string fullPath = FileUtils::getInstance()->fullPathForFilename(pszPlist);
-        ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
+
+        Data data = getBinaryDataFromFile(fullPath);
+        ValueMap dict;
+        if (data.isNull())
+        {
+            dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
+        }
 
         string texturePath("");
 
-        if (dict.find("metadata") != dict.end())
+        BinarySpriteFramesHeader header;
+        bool binary = readBinarySpriteFramesHeader(data, header);
+        if (binary)
+        {
+            if (header.textureFileName != BINARY_SPRITE_FRAMES_NO_STRING)
+            {
+                texturePath = getBinarySpriteFramesStrings(data, header) + header.textureFileName;
+            }
+        }
+        else if (dict.find("metadata") != dict.end())
         {
             ValueMap& metadataDict = dict["metadata"].asValueMap();
             // try to read  texture file name from meta data
@@ -261,7 +539,14 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& pszPlist)
 
         if (texture)
         {
-            addSpriteFramesWithDictionary(dict, texture);
+            if (binary)
+            {
+                addSpriteFramesWithBinaryData(data, texture);
+            }
+            else
+            {
+                addSpriteFramesWithDictionary(dict, texture);
+            }
             _loadedFileNames->insert(pszPlist);
         }
         else
@@ -276,11 +561,36 @@ void SpriteFrameCache::addSpriteFrame(SpriteFrame* frame, const std::string& fra
     _spriteFrames.insert(frameName, frame);
 }
 
+SpriteFrame* SpriteFrameCache::addSpriteFrameToDynamicAtlas(const std::string& filename)
+{
+    SpriteFrame* frame = getDynamicAtlas()->addImage(filename);
+    if (frame)
+    {
+        _spriteFrames.insert(filename, frame);
+    }
+    return frame;
+}
+
+DynamicAtlas* SpriteFrameCache::getDynamicAtlas()
+{
+    if (! _dynamicAtlas)
+    {
+        _dynamicAtlas = DynamicAtlas::create();
+        _dynamicAtlas->retain();
+    }
+    return _dynamicAtlas;
+}
+
 void SpriteFrameCache::removeSpriteFrames()
 {
     _spriteFrames.clear();
     _spriteFramesAliases.clear();
     _loadedFileNames->clear();
+
+    if (_dynamicAtlas)
+    {
+        _dynamicAtlas->removeAllImages();
+    }
 }
 
 void SpriteFrameCache::removeUnusedSpriteFrames()
@@ -291,7 +601,8 @@ void SpriteFrameCache::removeUnusedSpriteFrames()
     for (auto iter = _spriteFrames.begin(); iter != _spriteFrames.end(); ++iter)
     {
         SpriteFrame* spriteFrame = iter->second;
-        if( spriteFrame->getReferenceCount() == 1 )
+        bool inAtlas = _dynamicAtlas && _dynamicAtlas->getSpriteFrame(iter->first) == spriteFrame;
+        if( spriteFrame->getReferenceCount() == (inAtlas ? 2 : 1) )
         {
             toRemoveFrames.push_back(iter->first);
             CCLOG("cocos2d: SpriteFrameCache: removing unused frame: %s", iter->first.c_str());
@@ -300,6 +611,14 @@ void SpriteFrameCache::removeUnusedSpriteFrames()
     }
 
     _spriteFrames.erase(toRemoveFrames);
+
+    if (_dynamicAtlas)
+    {
+        for (const auto& name : toRemoveFrames)
+        {
+            _dynamicAtlas->removeImage(name);
+        }
+    }
     
     // XXX. Since we don't know the .plist file that originated the frame, we must remove all .plist from the cache
     if( removed )
@@ -328,6 +647,11 @@ void SpriteFrameCache::removeSpriteFrameByName(const std::string& name)
         _spriteFrames.erase(name);
     }
 
+    if (_dynamicAtlas)
+    {
+        _dynamicAtlas->removeImage(key.empty() ? name : key);
+    }
+
     // XXX. Since we don't know the .plist file that originated the frame, we must remove all .plist from the cache
     _loadedFileNames->clear();
 }
@@ -335,13 +659,22 @@ void SpriteFrameCache::removeSpriteFrameByName(const std::string& name)
 void SpriteFrameCache::removeSpriteFramesFromFile(const std::string& plist)
 {
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
-    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
-    if (dict.empty())
+
+    Data data = getBinaryDataFromFile(fullPath);
+    if (!data.isNull())
     {
-        CCLOG("cocos2d:SpriteFrameCache:removeSpriteFramesFromFile: create dict by %s fail.",plist.c_str());
-        return;
+        removeSpriteFramesFromBinaryData(data);
+    }
+    else
+    {
+        ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
+        if (dict.empty())
+        {
+            CCLOG("cocos2d:SpriteFrameCache:removeSpriteFramesFromFile: create dict by %s fail.",plist.c_str());
+            return;
+        }
+        removeSpriteFramesFromDictionary(dict);
     }
-    removeSpriteFramesFromDictionary(dict);
 
     // remove it from the cache
     set<string>::iterator ret = _loadedFileNames->find(plist);
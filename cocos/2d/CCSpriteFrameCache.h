@@ -40,13 +40,16 @@ THE SOFTWARE.
 #include "base/CCRef.h"
 #include "base/CCValue.h"
 #include "base/CCMap.h"
+#include "base/CCData.h"
 
 #include <set>
 #include <string>
+#include <functional>
 
 NS_CC_BEGIN
 
 class Sprite;
+class DynamicAtlas;
 
 /**
  * @addtogroup sprite_nodes
@@ -88,6 +91,8 @@ public:
     /** Adds multiple Sprite Frames from a plist file.
      * A texture will be loaded automatically. The texture name will composed by replacing the .plist suffix with .png
      * If you want to use another texture, you should use the addSpriteFramesWithFile(const std::string& plist, const std::string& textureFileName) method.
+     * Files that don't end with .plist may also be binary sprite sheets written by tools/spriteframes/plist_to_binary.py,
+     * they are loaded without building a ValueMap.
      * @js addSpriteFrames
      * @lua addSpriteFrames
      */
@@ -106,11 +111,32 @@ public:
      */
     void addSpriteFramesWithFile(const std::string&plist, Texture2D *texture);
 
+    /** Like addSpriteFramesWithFile(plist, textureFileName), but the file is read and parsed on an I/O thread
+     and the texture is loaded with TextureCache::addImageAsync(). callback is called on the cocos thread
+     once the frames are added, with false if the texture couldn't be loaded.
+     @since v3.1
+     * @js NA
+     * @lua NA
+     */
+    void addSpriteFramesWithFileAsync(const std::string& plist, const std::string& textureFileName, const std::function<void(bool)>& callback);
+
     /** Adds an sprite frame with a given name.
      If the name already exists, then the contents of the old name will be replaced with the new one.
      */
     void addSpriteFrame(SpriteFrame *frame, const std::string& frameName);
 
+    /** Packs a small image file into the shared DynamicAtlas and adds its frame with the file name as name.
+     Sprites made from frames of the atlas share a few textures and can be batched.
+     Returns nullptr if the image can't be packed; use TextureCache::addImage() for it instead.
+     @since v3.1
+     */
+    SpriteFrame* addSpriteFrameToDynamicAtlas(const std::string& filename);
+
+    /** Returns the atlas used by addSpriteFrameToDynamicAtlas(), it is created the first time it's used.
+     @since v3.1
+     */
+    DynamicAtlas* getDynamicAtlas();
+
     /** Purges the dictionary of loaded sprite frames.
      * Call this method if you receive the "Memory Warning".
      * In the short term: it will free some resources preventing your app from being killed.
@@ -121,6 +147,7 @@ public:
 
     /** Removes unused sprite frames.
      * Sprite Frames that have a retain count of 1 will be deleted.
+     * Frames of the dynamic atlas, which also retains them, are removed from the atlas at a retain count of 2.
      * It is convenient to call this method after when starting a new Scene.
      */
     void removeUnusedSpriteFrames();
@@ -162,10 +189,20 @@ private:
     */
     void removeSpriteFramesFromDictionary(ValueMap& dictionary);
 
+    /** Adds the Sprite Frames of a binary sprite sheet. The texture will be associated with the created sprite frames. */
+    void addSpriteFramesWithBinaryData(const Data& data, Texture2D *texture);
+
+    /** Removes the Sprite Frames of a binary sprite sheet. */
+    void removeSpriteFramesFromBinaryData(const Data& data);
+
+    /** Reads a sprite sheet file, data is left null for plist files. It can be called from any thread. */
+    static Data getBinaryDataFromFile(const std::string& fullPath);
+
 protected:
     Map<std::string, SpriteFrame*> _spriteFrames;
     ValueMap _spriteFramesAliases;
     std::set<std::string>*  _loadedFileNames;
+    DynamicAtlas* _dynamicAtlas;
 };
 
 // end of sprite_nodes group
@@ -33,6 +33,12 @@ THE SOFTWARE.
 #include "renderer/CCGLProgramState.h"
 #include "renderer/CCGLProgram.h"
 #include "base/CCDirector.h"
+#include "base/CCConfiguration.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventType.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/ccGLStateCache.h"
 
 #include "deprecated/CCString.h" // For StringUtils::format
 
@@ -41,6 +47,8 @@ NS_CC_BEGIN
 
 // TMXLayer - init & alloc & dealloc
 
+static const int TILE_SPRITES_CAPACITY = 29;
+
 TMXLayer * TMXLayer::create(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *layerInfo, TMXMapInfo *mapInfo)
 {
     TMXLayer *ret = new TMXLayer();
@@ -53,10 +61,7 @@ TMXLayer * TMXLayer::create(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *layerInfo
 }
 bool TMXLayer::initWithTilesetInfo(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *layerInfo, TMXMapInfo *mapInfo)
 {    
-    // XXX: is 35% a good estimate ?
     Size size = layerInfo->_layerSize;
-    float totalNumberOfTiles = size.width * size.height;
-    float capacity = totalNumberOfTiles * 0.35f + 1; // 35 percent is occupied ?
 
     Texture2D *texture = nullptr;
     if( tilesetInfo )
@@ -64,7 +69,8 @@ bool TMXLayer::initWithTilesetInfo(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *la
         texture = Director::getInstance()->getTextureCache()->addImage(tilesetInfo->_sourceImage.c_str());
     }
 
-    if (SpriteBatchNode::initWithTexture(texture, static_cast<ssize_t>(capacity)))
+    // the atlas only holds the tiles asked for with getTileAt, the others are drawn by the chunks
+    if (SpriteBatchNode::initWithTexture(texture, TILE_SPRITES_CAPACITY))
     {
         // layerInfo
         _layerName = layerInfo->_name;
@@ -86,12 +92,23 @@ bool TMXLayer::initWithTilesetInfo(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *la
         Vector2 offset = this->calculateLayerOffset(layerInfo->_offset);
         this->setPosition(CC_POINT_PIXELS_TO_POINTS(offset));
 
-        _atlasIndexArray = ccCArrayNew(totalNumberOfTiles);
-
         this->setContentSize(CC_SIZE_PIXELS_TO_POINTS(Size(_layerSize.width * _mapTileSize.width, _layerSize.height * _mapTileSize.height)));
 
         _useAutomaticVertexZ = false;
         _vertexZvalue = 0;
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+        // the buffers are gone with the GL context, build them again from the GIDs
+        auto listener = EventListenerCustom::create(EVENT_COME_TO_FOREGROUND, [this](EventCustom* event){
+            for (auto& chunk : _chunks)
+            {
+                chunk.vbo = 0;
+                chunk.dirty = true;
+            }
+            _quadIndicesVBO = 0;
+        });
+        _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, this);
+#endif
         
         return true;
     }
@@ -103,8 +120,12 @@ TMXLayer::TMXLayer()
 ,_opacity(0)
 ,_vertexZvalue(0)
 ,_useAutomaticVertexZ(false)
-,_reusedTile(nullptr)
-,_atlasIndexArray(nullptr)
+,_chunkWidth(0)
+,_chunkHeight(0)
+,_chunksPerRow(0)
+,_overlappingTiles(false)
+,_drawSpritesWithChunks(false)
+,_quadIndicesVBO(0)
 ,_contentScaleFactor(1.0f)
 ,_layerSize(Size::ZERO)
 ,_mapTileSize(Size::ZERO)
@@ -116,30 +137,54 @@ TMXLayer::TMXLayer()
 TMXLayer::~TMXLayer()
 {
     CC_SAFE_RELEASE(_tileSet);
-    CC_SAFE_RELEASE(_reusedTile);
 
-    if (_atlasIndexArray)
+    for (auto& chunk : _chunks)
+    {
+        if (chunk.vbo)
+        {
+            glDeleteBuffers(1, &chunk.vbo);
+        }
+    }
+    if (_quadIndicesVBO)
     {
-        ccCArrayFree(_atlasIndexArray);
-        _atlasIndexArray = nullptr;
+        glDeleteBuffers(1, &_quadIndicesVBO);
     }
 
-    CC_SAFE_DELETE_ARRAY(_tiles);
+    // the tiles are allocated by TMXMapInfo with malloc
+    CC_SAFE_FREE(_tiles);
 }
 
 void TMXLayer::releaseMap()
 {
-    if (_tiles)
+    if (!_tiles)
     {
-        delete [] _tiles;
-        _tiles = nullptr;
+        return;
     }
 
-    if (_atlasIndexArray)
+#if !CC_ENABLE_CACHE_TEXTURE_DATA
+    // the chunks that weren't drawn yet are built from a copy of their GIDs
+    int width = static_cast<int>(_layerSize.width);
+    for (size_t i = 0; i < _chunks.size(); ++i)
     {
-        ccCArrayFree(_atlasIndexArray);
-        _atlasIndexArray = nullptr;
+        TileChunk& chunk = _chunks[i];
+        if (!chunk.dirty)
+        {
+            continue;
+        }
+
+        int x0 = (static_cast<int>(i) % _chunksPerRow) * _chunkWidth;
+        int y0 = (static_cast<int>(i) / _chunksPerRow) * _chunkHeight;
+        int x1 = std::min(x0 + _chunkWidth, width);
+        int y1 = std::min(y0 + _chunkHeight, static_cast<int>(_layerSize.height));
+        chunk.gids.reserve((x1 - x0) * (y1 - y0));
+        for (int y = y0; y < y1; ++y)
+        {
+            chunk.gids.insert(chunk.gids.end(), _tiles + x0 + y * width, _tiles + x1 + y * width);
+        }
     }
+
+    CC_SAFE_FREE(_tiles);
+#endif
 }
 
 // TMXLayer - setup Tiles
@@ -155,31 +200,21 @@ void TMXLayer::setupTiles()
     //  - difficult to scale / rotate / etc.
     _textureAtlas->getTexture()->setAliasTexParameters();
 
-    //CFByteOrder o = CFByteOrderGetCurrent();
-
     // Parse cocos2d properties
     this->parseInternalProperties();
 
-    for (int y=0; y < _layerSize.height; y++)
+    // same as the color of a Sprite with the layer opacity
+    if (_textureAtlas->getTexture()->hasPremultipliedAlpha())
     {
-        for (int x=0; x < _layerSize.width; x++)
-        {
-            int pos = static_cast<int>(x + _layerSize.width * y);
-            int gid = _tiles[ pos ];
-
-            // gid are stored in little endian.
-            // if host is big endian, then swap
-            //if( o == CFByteOrderBigEndian )
-            //    gid = CFSwapInt32( gid );
-            /* We support little endian.*/
-
-            // XXX: gid == 0 --> empty tile
-            if (gid != 0) 
-            {
-                this->appendTileForGID(gid, Vector2(x, y));
-            }
-        }
+        _tileColor = Color4B(_opacity, _opacity, _opacity, _opacity);
+    }
+    else
+    {
+        _tileColor = Color4B(255, 255, 255, _opacity);
     }
+
+    // the chunks are built when they are first drawn
+    setupChunks();
 }
 
 // TMXLayer - Properties
@@ -280,208 +315,511 @@ void TMXLayer::setupTileSprite(Sprite* sprite, Vector2 pos, int gid)
     }
 }
 
-Sprite* TMXLayer::reusedTileWithRect(Rect rect)
+// TMXLayer - chunks
+
+// GLushort indices address at most this many quads
+static const int MAX_CHUNK_QUADS = 65536 / 4;
+static const int CHUNK_SIZE = 32;
+static const GLushort NO_QUAD = 0xffff;
+// marks the tiles of the sprites while a chunk is built
+static const GLushort SPRITE_TILE = 0xfffe;
+
+void TMXLayer::setupChunks()
 {
-    if (! _reusedTile) 
+    int width = static_cast<int>(_layerSize.width);
+    int height = static_cast<int>(_layerSize.height);
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    // Overlapping tiles have to be drawn in the order of the map, so their chunks are whole rows.
+    // Others use square chunks to cull on both axes.
+    _overlappingTiles = _layerOrientation != TMXOrientationOrtho
+        || _tileSet->_tileSize.width > _mapTileSize.width
+        || _tileSet->_tileSize.height > _mapTileSize.height;
+    if (_overlappingTiles)
     {
-        _reusedTile = Sprite::createWithTexture(_textureAtlas->getTexture(), rect);
-        _reusedTile->setBatchNode(this);
-        _reusedTile->retain();
+        _chunkWidth = std::min(width, MAX_CHUNK_QUADS);
+        _chunkHeight = std::max(1, std::min(height, CHUNK_SIZE * CHUNK_SIZE / _chunkWidth));
     }
     else
     {
-        // XXX HACK: Needed because if "batch node" is nil,
-		// then the Sprite'squad will be reset
-        _reusedTile->setBatchNode(nullptr);
-        
-		// Re-init the sprite
-        _reusedTile->setTextureRect(rect, false, rect.size);
-        
-		// restore the batch node
-        _reusedTile->setBatchNode(this);
+        _chunkWidth = std::min(width, CHUNK_SIZE);
+        _chunkHeight = std::min(height, CHUNK_SIZE);
     }
+    _chunksPerRow = (width + _chunkWidth - 1) / _chunkWidth;
+    int chunkRows = (height + _chunkHeight - 1) / _chunkHeight;
+
+    // a tile is drawn from its position up to the size of the tileset's tiles, flipped ones may be rotated
+    Size tileSize = CC_SIZE_PIXELS_TO_POINTS(_tileSet->_tileSize);
+    Size mapTileSize = CC_SIZE_PIXELS_TO_POINTS(_mapTileSize);
+    float extent = std::max(std::max(tileSize.width, tileSize.height), std::max(mapTileSize.width, mapTileSize.height));
 
-    return _reusedTile;
+    _chunks.resize(_chunksPerRow * chunkRows);
+    for (int i = 0; i < (int)_chunks.size(); ++i)
+    {
+        TileChunk& chunk = _chunks[i];
+        chunk.vbo = 0;
+        chunk.quadCount = 0;
+        chunk.dirty = true;
+
+        int x0 = (i % _chunksPerRow) * _chunkWidth;
+        int y0 = (i / _chunksPerRow) * _chunkHeight;
+        int x1 = std::min(x0 + _chunkWidth, width) - 1;
+        int y1 = std::min(y0 + _chunkHeight, height) - 1;
+
+        // positions are linear in the tile coordinates, so the corner tiles bound the others
+        Vector2 corners[4] = {
+            getPositionAt(Vector2(x0, y0)), getPositionAt(Vector2(x1, y0)),
+            getPositionAt(Vector2(x0, y1)), getPositionAt(Vector2(x1, y1))
+        };
+        float minX = corners[0].x, maxX = corners[0].x, minY = corners[0].y, maxY = corners[0].y;
+        for (int c = 1; c < 4; ++c)
+        {
+            minX = std::min(minX, corners[c].x);
+            maxX = std::max(maxX, corners[c].x);
+            minY = std::min(minY, corners[c].y);
+            maxY = std::max(maxY, corners[c].y);
+        }
+
+        // hexagonal maps shift every other column down by half a tile
+        minY -= mapTileSize.height / 2;
+        chunk.bounds = Rect(minX, minY, maxX - minX + extent, maxY - minY + extent);
+    }
 }
 
-// TMXLayer - obtaining tiles/gids
-Sprite * TMXLayer::getTileAt(const Vector2& pos)
+void TMXLayer::setupQuadIndices()
 {
-    CCASSERT(pos.x < _layerSize.width && pos.y < _layerSize.height && pos.x >=0 && pos.y >=0, "TMXLayer: invalid position");
-    CCASSERT(_tiles && _atlasIndexArray, "TMXLayer: the tiles map has been released");
+    int maxQuads = _chunkWidth * _chunkHeight;
+    std::vector<GLushort> indices(maxQuads * 6);
+    for (int i = 0; i < maxQuads; i++)
+    {
+        indices[i * 6 + 0] = (GLushort) (i * 4 + 0);
+        indices[i * 6 + 1] = (GLushort) (i * 4 + 1);
+        indices[i * 6 + 2] = (GLushort) (i * 4 + 2);
+        indices[i * 6 + 3] = (GLushort) (i * 4 + 3);
+        indices[i * 6 + 4] = (GLushort) (i * 4 + 2);
+        indices[i * 6 + 5] = (GLushort) (i * 4 + 1);
+    }
 
-    Sprite *tile = nullptr;
-    int gid = this->getTileGIDAt(pos);
+    if (_quadIndicesVBO == 0)
+    {
+        glGenBuffers(1, &_quadIndicesVBO);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadIndicesVBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * indices.size(), &indices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
 
-    // if GID == 0, then no tile is present
-    if (gid) 
+void TMXLayer::buildChunk(TileChunk& chunk, int chunkIndex)
+{
+    int width = static_cast<int>(_layerSize.width);
+    int x0 = (chunkIndex % _chunksPerRow) * _chunkWidth;
+    int y0 = (chunkIndex / _chunksPerRow) * _chunkHeight;
+    int x1 = std::min(x0 + _chunkWidth, width);
+    int y1 = std::min(y0 + _chunkHeight, static_cast<int>(_layerSize.height));
+
+    std::vector<V3F_C4B_T2F_Quad> quads;
+    chunk.quadIndices.assign((x1 - x0) * (y1 - y0), NO_QUAD);
+
+    // tiles that became a Sprite with getTileAt are drawn by the batch node
+    for (const auto& child : _children)
     {
-        int z = (int)(pos.x + pos.y * _layerSize.width);
-        tile = static_cast<Sprite*>(this->getChildByTag(z));
+        int z = child->getTag();
+        int x = z % width;
+        int y = z / width;
+        if (z >= 0 && x >= x0 && x < x1 && y >= y0 && y < y1)
+        {
+            chunk.quadIndices[(y - y0) * (x1 - x0) + (x - x0)] = SPRITE_TILE;
+        }
+    }
 
-        // tile not created yet. create it
-        if (! tile) 
+    for (int y = y0; y < y1; ++y)
+    {
+        for (int x = x0; x < x1; ++x)
         {
-            Rect rect = _tileSet->getRectForGID(gid);
-            rect = CC_RECT_PIXELS_TO_POINTS(rect);
+            int tile = (y - y0) * (x1 - x0) + (x - x0);
+            uint32_t gid = _tiles ? _tiles[x + y * width] : chunk.gids[tile];
 
-            tile = Sprite::createWithTexture(this->getTexture(), rect);
-            tile->setBatchNode(this);
-            tile->setPosition(getPositionAt(pos));
-            tile->setPositionZ((float)getVertexZForPos(pos));
-            tile->setAnchorPoint(Vector2::ZERO);
-            tile->setOpacity(_opacity);
-
-            ssize_t indexForZ = atlasIndexForExistantZ(z);
-            this->addSpriteWithoutQuad(tile, static_cast<int>(indexForZ), z);
+            // XXX: gid == 0 --> empty tile
+            if (gid == 0 || chunk.quadIndices[tile] == SPRITE_TILE)
+            {
+                chunk.quadIndices[tile] = NO_QUAD;
+                continue;
+            }
+
+            V3F_C4B_T2F_Quad quad;
+            if (fillTileQuad(Vector2(x, y), gid, &quad))
+            {
+                chunk.quadIndices[tile] = static_cast<GLushort>(quads.size());
+                quads.push_back(quad);
+            }
         }
     }
-    
-    return tile;
+    std::vector<uint32_t>().swap(chunk.gids);
+
+    if (chunk.vbo == 0)
+    {
+        glGenBuffers(1, &chunk.vbo);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(V3F_C4B_T2F_Quad) * quads.size(), quads.empty() ? nullptr : &quads[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    chunk.quadCount = static_cast<int>(quads.size());
+    chunk.dirty = false;
 }
 
-uint32_t TMXLayer::getTileGIDAt(const Vector2& pos, TMXTileFlags* flags/* = nullptr*/)
+bool TMXLayer::fillTileQuad(const Vector2& pos, uint32_t gid, V3F_C4B_T2F_Quad* quad)
 {
-    CCASSERT(pos.x < _layerSize.width && pos.y < _layerSize.height && pos.x >=0 && pos.y >=0, "TMXLayer: invalid position");
-    CCASSERT(_tiles && _atlasIndexArray, "TMXLayer: the tiles map has been released");
+    if ((static_cast<int>((gid & kTMXFlippedMask)) - _tileSet->_firstGid) < 0)
+    {
+        return false;
+    }
 
-    ssize_t idx = static_cast<int>((pos.x + pos.y * _layerSize.width));
-    // Bits on the far end of the 32-bit global tile ID are used for tile flags
-    uint32_t tile = _tiles[idx];
+    Rect rect = _tileSet->getRectForGID(gid);
+    Texture2D* texture = _textureAtlas->getTexture();
+    float atlasWidth = (float)texture->getPixelsWide();
+    float atlasHeight = (float)texture->getPixelsHigh();
+
+    float left, right, top, bottom;
+#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+    left    = (2*rect.origin.x+1)/(2*atlasWidth);
+    right   = left + (rect.size.width*2-2)/(2*atlasWidth);
+    top     = (2*rect.origin.y+1)/(2*atlasHeight);
+    bottom  = top + (rect.size.height*2-2)/(2*atlasHeight);
+#else
+    left    = rect.origin.x/atlasWidth;
+    right   = (rect.origin.x + rect.size.width) / atlasWidth;
+    top     = rect.origin.y/atlasHeight;
+    bottom  = (rect.origin.y + rect.size.height) / atlasHeight;
+#endif // CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+
+    Size size = CC_SIZE_PIXELS_TO_POINTS(rect.size);
+    if (gid & kTMXTileDiagonalFlag)
+    {
+        std::swap(size.width, size.height);
+    }
 
-    // issue1264, flipped tiles can be changed dynamically
-    if (flags) 
+    Vector2 origin = getPositionAt(pos);
+    float vertexZ = (float)getVertexZForPos(pos);
+
+    V3F_C4B_T2F* corners[4] = { &quad->bl, &quad->br, &quad->tl, &quad->tr };
+    for (int i = 0; i < 4; ++i)
     {
-        *flags = (TMXTileFlags)(tile & kTMXFlipedAll);
+        int cornerX = i & 1;
+        int cornerY = i >> 1;
+
+        corners[i]->vertices = Vector3(origin.x + cornerX * size.width, origin.y + cornerY * size.height, vertexZ);
+        corners[i]->colors = _tileColor;
+
+        // Tiled flips diagonally first, then horizontally and vertically.
+        // s and t go right and down in the tile's image.
+        float s = (float)cornerX;
+        float t = 1.0f - cornerY;
+        if (gid & kTMXTileVerticalFlag)
+        {
+            t = 1.0f - t;
+        }
+        if (gid & kTMXTileHorizontalFlag)
+        {
+            s = 1.0f - s;
+        }
+        if (gid & kTMXTileDiagonalFlag)
+        {
+            std::swap(s, t);
+        }
+
+        corners[i]->texCoords.u = left + s * (right - left);
+        corners[i]->texCoords.v = top + t * (bottom - top);
     }
-    
-    return (tile & kTMXFlippedMask);
+
+    return true;
 }
 
-// TMXLayer - adding helper methods
-Sprite * TMXLayer::insertTileForGID(uint32_t gid, const Vector2& pos)
+void TMXLayer::updateTileQuad(const Vector2& pos, bool hasSprite)
 {
-    if (gid != 0 && (static_cast<int>((gid & kTMXFlippedMask)) - _tileSet->_firstGid) >= 0)
+    if (_chunks.empty())
     {
-        Rect rect = _tileSet->getRectForGID(gid);
-        rect = CC_RECT_PIXELS_TO_POINTS(rect);
-        
-        intptr_t z = (intptr_t)(pos.x + pos.y * _layerSize.width);
-        
-        Sprite *tile = reusedTileWithRect(rect);
-        
-        setupTileSprite(tile, pos, gid);
-        
-        // get atlas index
-        ssize_t indexForZ = atlasIndexForNewZ(static_cast<int>(z));
-        
-        // Optimization: add the quad without adding a child
-        this->insertQuadFromSprite(tile, indexForZ);
-        
-        // insert it into the local atlasindex array
-        ccCArrayInsertValueAtIndex(_atlasIndexArray, (void*)z, indexForZ);
-        
-        // update possible children
-        
-        for(const auto &child : _children) {
-            Sprite* sp = static_cast<Sprite*>(child);
-            ssize_t ai = sp->getAtlasIndex();
-            if ( ai >= indexForZ )
-            {
-                sp->setAtlasIndex(ai+1);
-            }
+        return;
+    }
+
+    int width = static_cast<int>(_layerSize.width);
+    int x = static_cast<int>(pos.x);
+    int y = static_cast<int>(pos.y);
+    int chunkX = x / _chunkWidth;
+    int chunkY = y / _chunkHeight;
+
+    TileChunk& chunk = _chunks[chunkY * _chunksPerRow + chunkX];
+    if (chunk.dirty)
+    {
+        // it is built from the GIDs before it's drawn
+        return;
+    }
+
+    int x0 = chunkX * _chunkWidth;
+    int chunkTilesWide = std::min(_chunkWidth, width - x0);
+    GLushort quadIndex = chunk.quadIndices[(y - chunkY * _chunkHeight) * chunkTilesWide + (x - x0)];
+
+    uint32_t gid = _tiles[x + y * width];
+    V3F_C4B_T2F_Quad quad;
+    bool visible = gid != 0 && !hasSprite && fillTileQuad(pos, gid, &quad);
+
+    if (quadIndex == NO_QUAD)
+    {
+        // the tile had no quad, the buffer has to grow
+        if (visible)
+        {
+            chunk.dirty = true;
         }
-        
-        _tiles[z] = gid;
-        return tile;
+        return;
     }
-    
-    return nullptr;
+
+    if (!visible)
+    {
+        // an empty quad draws nothing
+        quad = V3F_C4B_T2F_Quad();
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, quadIndex * sizeof(V3F_C4B_T2F_Quad), sizeof(V3F_C4B_T2F_Quad), &quad);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-Sprite * TMXLayer::updateTileForGID(uint32_t gid, const Vector2& pos)
+void TMXLayer::cullChunks(const Matrix& transform)
 {
-    Rect rect = _tileSet->getRectForGID(gid);
-    rect = Rect(rect.origin.x / _contentScaleFactor, rect.origin.y / _contentScaleFactor, rect.size.width/ _contentScaleFactor, rect.size.height/ _contentScaleFactor);
-    int z = (int)(pos.x + pos.y * _layerSize.width);
+    _visibleChunks.clear();
 
-    Sprite *tile = reusedTileWithRect(rect);
+    Matrix worldToLayer = transform;
+    if (!worldToLayer.inverse())
+    {
+        return;
+    }
 
-    setupTileSprite(tile ,pos ,gid);
+    Director* director = Director::getInstance();
+    Vector2 origin = director->getVisibleOrigin();
+    Size size = director->getVisibleSize();
 
-    // get atlas index
-    ssize_t indexForZ = atlasIndexForExistantZ(z);
-    tile->setAtlasIndex(indexForZ);
-    tile->setDirty(true);
-    tile->updateTransform();
-    _tiles[z] = gid;
+    Vector3 corners[4] = {
+        Vector3(origin.x, origin.y, 0), Vector3(origin.x + size.width, origin.y, 0),
+        Vector3(origin.x, origin.y + size.height, 0), Vector3(origin.x + size.width, origin.y + size.height, 0)
+    };
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (auto& corner : corners)
+    {
+        worldToLayer.transformPoint(&corner);
+        minX = std::min(minX, corner.x);
+        maxX = std::max(maxX, corner.x);
+        minY = std::min(minY, corner.y);
+        maxY = std::max(maxY, corner.y);
+    }
+    Rect view(minX, minY, maxX - minX, maxY - minY);
 
-    return tile;
+    for (int i = 0; i < (int)_chunks.size(); ++i)
+    {
+        if (_chunks[i].bounds.intersectsRect(view))
+        {
+            _visibleChunks.push_back(i);
+        }
+    }
 }
 
-// used only when parsing the map. useless after the map was parsed
-// since lot's of assumptions are no longer true
-Sprite * TMXLayer::appendTileForGID(uint32_t gid, const Vector2& pos)
+void TMXLayer::draw(Renderer *renderer, const Matrix &transform, bool transformUpdated)
 {
-    if (gid != 0 && (static_cast<int>((gid & kTMXFlippedMask)) - _tileSet->_firstGid) >= 0)
+    if (!_chunks.empty())
     {
-        Rect rect = _tileSet->getRectForGID(gid);
-        rect = CC_RECT_PIXELS_TO_POINTS(rect);
-        
-        intptr_t z = (intptr_t)(pos.x + pos.y * _layerSize.width);
-        
-        Sprite *tile = reusedTileWithRect(rect);
-        
-        setupTileSprite(tile ,pos ,gid);
-        
-        // optimization:
-        // The difference between appendTileForGID and insertTileforGID is that append is faster, since
-        // it appends the tile at the end of the texture atlas
-        ssize_t indexForZ = _atlasIndexArray->num;
-        
-        // don't add it using the "standard" way.
-        insertQuadFromSprite(tile, indexForZ);
-        
-        // append should be after addQuadFromSprite since it modifies the quantity values
-        ccCArrayInsertValueAtIndex(_atlasIndexArray, (void*)z, indexForZ);
-        
-        return tile;
+        cullChunks(transform);
+    }
+
+    // the tiles asked for with getTileAt
+    _drawSpritesWithChunks = _overlappingTiles && _textureAtlas->getTotalQuads() > 0;
+    if (_drawSpritesWithChunks)
+    {
+        for (const auto& child : _children)
+        {
+            child->updateTransform();
+        }
+    }
+
+    if (!_visibleChunks.empty() || _drawSpritesWithChunks)
+    {
+        _chunksCommand.init(_globalZOrder);
+        _chunksCommand.func = CC_CALLBACK_0(TMXLayer::onDrawChunks, this, transform);
+        renderer->addCommand(&_chunksCommand);
+    }
+
+    if (!_drawSpritesWithChunks)
+    {
+        SpriteBatchNode::draw(renderer, transform, transformUpdated);
     }
-    
-    return nullptr;
 }
 
-// TMXLayer - atlasIndex and Z
-static inline int compareInts(const void * a, const void * b)
+void TMXLayer::onDrawChunks(const Matrix& transform)
 {
-    return ((*(int*)a) - (*(int*)b));
+    auto glProgram = getGLProgram();
+    glProgram->use();
+    glProgram->setUniformsForBuiltins(transform);
+
+    GL::bindTexture2D(_textureAtlas->getTexture()->getName());
+    GL::blendFunc(_blendFunc.src, _blendFunc.dst);
+
+    if (Configuration::getInstance()->supportsShareableVAO())
+    {
+        GL::bindVAO(0);
+    }
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+
+    if (_quadIndicesVBO == 0)
+    {
+        setupQuadIndices();
+    }
+
+    // The sprites of getTileAt are in the atlas in z order, which is the order of the tiles.
+    // Chunks of overlapping tiles are whole rows, so each sprite goes between the quads of its chunk.
+    ssize_t totalSprites = _drawSpritesWithChunks ? _textureAtlas->getTotalQuads() : 0;
+    ssize_t nextSprite = 0;
+    int width = static_cast<int>(_layerSize.width);
+
+    for (int index : _visibleChunks)
+    {
+        TileChunk& chunk = _chunks[index];
+        if (chunk.dirty)
+        {
+            buildChunk(chunk, index);
+        }
+
+        int firstTile = (index % _chunksPerRow) * _chunkWidth + (index / _chunksPerRow) * _chunkHeight * width;
+        int tileCount = static_cast<int>(chunk.quadIndices.size());
+
+        // the sprites of the chunks before this one, even if they were culled
+        ssize_t spriteCount = 0;
+        while (nextSprite + spriteCount < totalSprites && getTileSpriteZOrder(nextSprite + spriteCount) < firstTile)
+        {
+            ++spriteCount;
+        }
+        _textureAtlas->drawNumberOfQuads(spriteCount, nextSprite);
+        nextSprite += spriteCount;
+
+        int drawnQuads = 0;
+        while (nextSprite < totalSprites)
+        {
+            int tile = getTileSpriteZOrder(nextSprite) - firstTile;
+            if (tile >= tileCount)
+            {
+                break;
+            }
+
+            // the quads of the tiles before the sprite's one
+            int quadsBefore = chunk.quadCount;
+            for (int t = tile; t < tileCount; ++t)
+            {
+                if (chunk.quadIndices[t] != NO_QUAD)
+                {
+                    quadsBefore = chunk.quadIndices[t];
+                    break;
+                }
+            }
+            drawChunkQuads(chunk, drawnQuads, quadsBefore - drawnQuads);
+            drawnQuads = std::max(drawnQuads, quadsBefore);
+
+            _textureAtlas->drawNumberOfQuads(1, nextSprite);
+            ++nextSprite;
+        }
+        drawChunkQuads(chunk, drawnQuads, chunk.quadCount - drawnQuads);
+    }
+    _textureAtlas->drawNumberOfQuads(totalSprites - nextSprite, nextSprite);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
 }
 
-ssize_t TMXLayer::atlasIndexForExistantZ(int z)
+void TMXLayer::drawChunkQuads(const TileChunk& chunk, int start, int count)
 {
-    int key=z;
-    int *item = (int*)bsearch((void*)&key, (void*)&_atlasIndexArray->arr[0], _atlasIndexArray->num, sizeof(void*), compareInts);
+    if (count <= 0)
+    {
+        return;
+    }
+
+    // drawing the sprites binds the VAO of the atlas
+    if (Configuration::getInstance()->supportsShareableVAO())
+    {
+        GL::bindVAO(0);
+    }
 
-    CCASSERT(item, "TMX atlas index not found. Shall not happen");
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid *)offsetof(V3F_C4B_T2F, vertices));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid *)offsetof(V3F_C4B_T2F, colors));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid *)offsetof(V3F_C4B_T2F, texCoords));
 
-    ssize_t index = ((size_t)item - (size_t)_atlasIndexArray->arr) / sizeof(void*);
-    return index;
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadIndicesVBO);
+    glDrawElements(GL_TRIANGLES, (GLsizei)(count * 6), GL_UNSIGNED_SHORT, (GLvoid *)(start * 6 * sizeof(GLushort)));
+
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, count * 4);
 }
 
-ssize_t TMXLayer::atlasIndexForNewZ(int z)
+int TMXLayer::getTileSpriteZOrder(ssize_t atlasIndex) const
 {
-    // XXX: This can be improved with a sort of binary search
-    ssize_t i=0;
-    for (i=0; i< _atlasIndexArray->num ; i++) 
+    // children of the tile sprites are in the atlas too
+    Node* sprite = _descendants[atlasIndex];
+    while (sprite->getParent() != this)
     {
-        ssize_t val = (size_t) _atlasIndexArray->arr[i];
-        if (z < val)
+        sprite = sprite->getParent();
+    }
+    return sprite->getLocalZOrder();
+}
+
+// TMXLayer - obtaining tiles/gids
+Sprite * TMXLayer::getTileAt(const Vector2& pos)
+{
+    CCASSERT(pos.x < _layerSize.width && pos.y < _layerSize.height && pos.x >=0 && pos.y >=0, "TMXLayer: invalid position");
+    CCASSERT(_tiles, "TMXLayer: the tiles map has been released");
+
+    Sprite *tile = nullptr;
+    int gid = this->getTileGIDAt(pos);
+
+    // if GID == 0, then no tile is present
+    if (gid) 
+    {
+        int z = (int)(pos.x + pos.y * _layerSize.width);
+        tile = static_cast<Sprite*>(this->getChildByTag(z));
+
+        // tile not created yet. create it
+        if (! tile) 
         {
-            break;
+            Rect rect = _tileSet->getRectForGID(gid);
+            rect = CC_RECT_PIXELS_TO_POINTS(rect);
+
+            tile = Sprite::createWithTexture(this->getTexture(), rect);
+            SpriteBatchNode::addChild(tile, z, z);
+            setupTileSprite(tile, pos, _tiles[z]);
+
+            // the sprite draws the tile from now on
+            updateTileQuad(pos, true);
         }
-    } 
+    }
+    
+    return tile;
+}
+
+uint32_t TMXLayer::getTileGIDAt(const Vector2& pos, TMXTileFlags* flags/* = nullptr*/)
+{
+    CCASSERT(pos.x < _layerSize.width && pos.y < _layerSize.height && pos.x >=0 && pos.y >=0, "TMXLayer: invalid position");
+    CCASSERT(_tiles, "TMXLayer: the tiles map has been released");
+
+    ssize_t idx = static_cast<int>((pos.x + pos.y * _layerSize.width));
+    // Bits on the far end of the 32-bit global tile ID are used for tile flags
+    uint32_t tile = _tiles[idx];
+
+    // issue1264, flipped tiles can be changed dynamically
+    if (flags) 
+    {
+        *flags = (TMXTileFlags)(tile & kTMXFlipedAll);
+    }
     
-    return i;
+    return (tile & kTMXFlippedMask);
 }
 
 // TMXLayer - adding / remove tiles
@@ -493,7 +831,7 @@ void TMXLayer::setTileGID(uint32_t gid, const Vector2& pos)
 void TMXLayer::setTileGID(uint32_t gid, const Vector2& pos, TMXTileFlags flags)
 {
     CCASSERT(pos.x < _layerSize.width && pos.y < _layerSize.height && pos.x >=0 && pos.y >=0, "TMXLayer: invalid position");
-    CCASSERT(_tiles && _atlasIndexArray, "TMXLayer: the tiles map has been released");
+    CCASSERT(_tiles, "TMXLayer: the tiles map has been released");
     CCASSERT(gid == 0 || (int)gid >= _tileSet->_firstGid, "TMXLayer: invalid gid" );
 
     TMXTileFlags currentFlags;
@@ -507,33 +845,24 @@ void TMXLayer::setTileGID(uint32_t gid, const Vector2& pos, TMXTileFlags flags)
         if (gid == 0)
         {
             removeTileAt(pos);
+            return;
         }
-        // empty tile. create a new one
-        else if (currentGID == 0)
+
+        int z = pos.x + pos.y * _layerSize.width;
+        _tiles[z] = gidAndFlags;
+
+        Sprite *sprite = static_cast<Sprite*>(getChildByTag(z));
+        if (sprite)
         {
-            insertTileForGID(gidAndFlags, pos);
-        }
-        // modifying an existing tile with a non-empty tile
+            Rect rect = _tileSet->getRectForGID(gid);
+            rect = CC_RECT_PIXELS_TO_POINTS(rect);
+
+            sprite->setTextureRect(rect, false, rect.size);
+            setupTileSprite(sprite, pos, gidAndFlags);
+        } 
         else 
         {
-            int z = pos.x + pos.y * _layerSize.width;
-            Sprite *sprite = static_cast<Sprite*>(getChildByTag(z));
-            if (sprite)
-            {
-                Rect rect = _tileSet->getRectForGID(gid);
-                rect = CC_RECT_PIXELS_TO_POINTS(rect);
-
-                sprite->setTextureRect(rect, false, rect.size);
-                if (flags) 
-                {
-                    setupTileSprite(sprite, sprite->getPosition(), gidAndFlags);
-                }
-                _tiles[z] = gidAndFlags;
-            } 
-            else 
-            {
-                updateTileForGID(gidAndFlags, pos);
-            }
+            updateTileQuad(pos, false);
         }
     }
 }
@@ -557,32 +886,30 @@ void TMXLayer::removeChild(Node* node, bool cleanup)
 
     CCASSERT(_children.contains(sprite), "Tile does not belong to TMXLayer");
 
-    ssize_t atlasIndex = sprite->getAtlasIndex();
-    ssize_t zz = (ssize_t)_atlasIndexArray->arr[atlasIndex];
-    _tiles[zz] = 0;
-    ccCArrayRemoveValueAtIndex(_atlasIndexArray, atlasIndex);
+    // the sprite was drawing the tile, its quad is hidden already
+    int z = sprite->getTag();
+    if (_tiles && z >= 0 && z < _layerSize.width * _layerSize.height)
+    {
+        _tiles[z] = 0;
+    }
     SpriteBatchNode::removeChild(sprite, cleanup);
 }
 
 void TMXLayer::removeTileAt(const Vector2& pos)
 {
     CCASSERT(pos.x < _layerSize.width && pos.y < _layerSize.height && pos.x >=0 && pos.y >=0, "TMXLayer: invalid position");
-    CCASSERT(_tiles && _atlasIndexArray, "TMXLayer: the tiles map has been released");
+    CCASSERT(_tiles, "TMXLayer: the tiles map has been released");
 
     int gid = getTileGIDAt(pos);
 
     if (gid) 
     {
         int z = pos.x + pos.y * _layerSize.width;
-        ssize_t atlasIndex = atlasIndexForExistantZ(z);
 
         // remove tile from GID map
         _tiles[z] = 0;
 
-        // remove tile from atlas position array
-        ccCArrayRemoveValueAtIndex(_atlasIndexArray, atlasIndex);
-
-        // remove it from sprites and/or texture atlas
+        // remove it from sprites or from its chunk
         Sprite *sprite = (Sprite*)getChildByTag(z);
         if (sprite)
         {
@@ -590,17 +917,7 @@ void TMXLayer::removeTileAt(const Vector2& pos)
         }
         else 
         {
-            _textureAtlas->removeQuadAtIndex(atlasIndex);
-
-            // update possible children
-            for(const auto &obj : _children) {
-                Sprite* child = static_cast<Sprite*>(obj);
-                ssize_t ai = child->getAtlasIndex();
-                if ( ai >= atlasIndex )
-                {
-                    child->setAtlasIndex(ai-1);
-                }
-            }
+            updateTileQuad(pos, false);
         }
     }
 }
@@ -32,6 +32,8 @@ THE SOFTWARE.
 #include "2d/CCSpriteBatchNode.h"
 #include "CCTMXXMLParser.h"
 #include "2d/ccCArray.h"
+#include "renderer/CCCustomCommand.h"
+#include <vector>
 NS_CC_BEGIN
 
 class TMXMapInfo;
@@ -46,8 +48,12 @@ struct _ccCArray;
 
 /** @brief TMXLayer represents the TMX layer.
 
-It is a subclass of SpriteBatchNode. By default the tiles are rendered using a TextureAtlas.
-If you modify a tile on runtime, then, that tile will become a Sprite, otherwise no Sprite objects are created.
+It is a subclass of SpriteBatchNode. The layer only keeps the GIDs of its tiles. They are rendered from static
+vertex buffers built for chunks of tiles when a chunk first comes into view, chunks out of view aren't drawn.
+Changing a tile patches its vertices in place.
+A Sprite is only created for a tile when getTileAt is called, it is then rendered by the batch node instead.
+On maps where tiles overlap (isometric, hexagonal or tiles taller than the map grid) the sprites are drawn between
+the tiles in the order of the map, on the others they are drawn over the tiles.
 The benefits of using Sprite objects as tiles are:
 - tiles (Sprite) can be rotated/scaled/moved with a nice API
 
@@ -94,6 +100,8 @@ public:
     /** dealloc the map that contains the tile position from memory.
     Unless you want to know at runtime the tiles positions, you can safely call this method.
     If you are going to call layer->tileGIDAt() then, don't release the map
+    The chunks that weren't drawn yet keep a copy of their GIDs until they are built. Where the GL context can be
+    lost (CC_ENABLE_CACHE_TEXTURE_DATA) the map is kept to rebuild them.
     */
     void releaseMap();
 
@@ -191,6 +199,7 @@ public:
     // super method
     void removeChild(Node* child, bool cleanup) override;
     virtual std::string getDescription() const override;
+    virtual void draw(Renderer *renderer, const Matrix &transform, bool transformUpdated) override;
 
 private:
     Vector2 getPositionForIsoAt(const Vector2& pos);
@@ -199,20 +208,38 @@ private:
 
     Vector2 calculateLayerOffset(const Vector2& offset);
 
-    /* optimization methods */
-    Sprite* appendTileForGID(uint32_t gid, const Vector2& pos);
-    Sprite* insertTileForGID(uint32_t gid, const Vector2& pos);
-    Sprite* updateTileForGID(uint32_t gid, const Vector2& pos);
-
     /* The layer recognizes some special properties, like cc_vertez */
     void parseInternalProperties();
     void setupTileSprite(Sprite* sprite, Vector2 pos, int gid);
-    Sprite* reusedTileWithRect(Rect rect);
     int getVertexZForPos(const Vector2& pos);
 
-    // index
-    ssize_t atlasIndexForExistantZ(int z);
-    ssize_t atlasIndexForNewZ(int z);
+    /** A block of tiles drawn with one vertex buffer */
+    struct TileChunk
+    {
+        GLuint vbo;
+        int quadCount;
+        /** the buffer has to be built from the GIDs before drawing */
+        bool dirty;
+        /** in points, holds every tile the chunk can have */
+        Rect bounds;
+        /** the quad of each tile in the buffer, row by row, NO_QUAD if it has none */
+        std::vector<GLushort> quadIndices;
+        /** the GIDs of the chunk, row by row, when the map was released before it was built */
+        std::vector<uint32_t> gids;
+    };
+
+    /* chunk rendering */
+    void setupChunks();
+    void buildChunk(TileChunk& chunk, int chunkIndex);
+    void setupQuadIndices();
+    bool fillTileQuad(const Vector2& pos, uint32_t gid, V3F_C4B_T2F_Quad* quad);
+    /** Writes the quad of the tile at pos again after its GID changed. hasSprite hides it since the Sprite draws it. */
+    void updateTileQuad(const Vector2& pos, bool hasSprite);
+    void cullChunks(const Matrix& transform);
+    void onDrawChunks(const Matrix& transform);
+    void drawChunkQuads(const TileChunk& chunk, int start, int count);
+    /** the z order of the tile sprite whose quad is at this index of the atlas */
+    int getTileSpriteZOrder(ssize_t atlasIndex) const;
     
 protected:
     //! name of the layer
@@ -224,9 +251,22 @@ protected:
     int                    _vertexZvalue;
     bool                _useAutomaticVertexZ;
 
-    //! used for optimization
-    Sprite            *_reusedTile;
-    ccCArray            *_atlasIndexArray;
+    //! tiles are drawn in chunks of _chunkWidth x _chunkHeight tiles
+    std::vector<TileChunk> _chunks;
+    int _chunkWidth;
+    int _chunkHeight;
+    int _chunksPerRow;
+    //! the chunks in view, found in draw
+    std::vector<int> _visibleChunks;
+    //! tiles can cover their neighbours, the chunks are whole rows drawn in the order of the map
+    bool _overlappingTiles;
+    //! the sprites of getTileAt are drawn between the quads of the chunks instead of by the batch node
+    bool _drawSpritesWithChunks;
+    //! shared by all the chunks
+    GLuint _quadIndicesVBO;
+    //! color of the tile vertices, with the layer opacity
+    Color4B _tileColor;
+    CustomCommand _chunksCommand;
     
     // used for retina display
     float               _contentScaleFactor;
@@ -48,6 +48,18 @@ TMXTiledMap * TMXTiledMap::create(const std::string& tmxFile)
     return nullptr;
 }
 
+TMXTiledMap* TMXTiledMap::createWithTileRegion(const std::string& tmxFile, const Rect& tileRegion)
+{
+    TMXTiledMap *ret = new TMXTiledMap();
+    if (ret->initWithTMXFile(tmxFile, tileRegion))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
 TMXTiledMap* TMXTiledMap::createWithXML(const std::string& tmxString, const std::string& resourcePath)
 {
     TMXTiledMap *ret = new TMXTiledMap();
@@ -61,12 +73,17 @@ TMXTiledMap* TMXTiledMap::createWithXML(const std::string& tmxString, const std:
 }
 
 bool TMXTiledMap::initWithTMXFile(const std::string& tmxFile)
+{
+    return initWithTMXFile(tmxFile, Rect::ZERO);
+}
+
+bool TMXTiledMap::initWithTMXFile(const std::string& tmxFile, const Rect& tileRegion)
 {
     CCASSERT(tmxFile.size()>0, "TMXTiledMap: tmx file should not be empty");
     
     setContentSize(Size::ZERO);
 
-    TMXMapInfo *mapInfo = TMXMapInfo::create(tmxFile);
+    TMXMapInfo *mapInfo = TMXMapInfo::createWithTileRegion(tmxFile, tileRegion);
 
     if (! mapInfo)
     {
@@ -173,7 +190,8 @@ void TMXTiledMap::buildWithMapInfo(TMXMapInfo* mapInfo)
 
     auto& layers = mapInfo->getLayers();
     for(const auto &layerInfo : layers) {
-        if (layerInfo->_visible)
+        // layers whose data couldn't be decoded have no tiles
+        if (layerInfo->_visible && layerInfo->_tiles)
         {
             TMXLayer *child = parseLayer(layerInfo, mapInfo);
             addChild(child, idx, idx);
@@ -117,6 +117,13 @@ public:
     /** initializes a TMX Tiled Map with a TMX formatted XML string and a path to TMX resources */
     static TMXTiledMap* createWithXML(const std::string& tmxString, const std::string& resourcePath);
 
+    /** creates a TMX Tiled Map with a TMX file, only creating the tiles inside tileRegion (in tiles).
+     Useful to draw a part of a huge map, the other tiles are empty. It saves the vertex data of the tiles
+     outside the region only: the layers still decode and keep a GID array of their full size, so the peak
+     memory of loading the map doesn't go down.
+     */
+    static TMXTiledMap* createWithTileRegion(const std::string& tmxFile, const Rect& tileRegion);
+
     /** return the TMXLayer for the specific layer */
     TMXLayer* getLayer(const std::string& layerName) const;
     /**
@@ -190,6 +197,9 @@ CC_CONSTRUCTOR_ACCESS:
     
     /** initializes a TMX Tiled Map with a TMX file */
     bool initWithTMXFile(const std::string& tmxFile);
+
+    /** initializes a TMX Tiled Map with the tiles inside tileRegion of a TMX file */
+    bool initWithTMXFile(const std::string& tmxFile, const Rect& tileRegion);
     
     /** initializes a TMX Tiled Map with a TMX formatted XML string and a path to TMX resources */
     bool initWithXML(const std::string& tmxString, const std::string& resourcePath);
@@ -32,14 +32,228 @@ THE SOFTWARE.
 #include "CCTMXTiledMap.h"
 #include "base/ccMacros.h"
 #include "2d/platform/CCFileUtils.h"
-#include "base/ZipUtils.h"
-#include "base/base64.h"
 #include "base/CCDirector.h"
+#include <zlib.h>
 
 using namespace std;
 
 NS_CC_BEGIN
 
+// Decodes the text of a <data> element into the layer's tiles as the parser hands it over, so the
+// text, the base64 decoded bytes and the inflated bytes are never held in memory all at once.
+class TMXTileDataDecoder
+{
+public:
+    enum class Encoding
+    {
+        BASE64,
+        CSV
+    };
+
+    TMXTileDataDecoder(uint32_t* tiles, size_t tileCount, Encoding encoding, bool compressed)
+    : _tiles(tiles)
+    , _tileCount(tileCount)
+    , _encoding(encoding)
+    , _compressed(compressed)
+    , _error(false)
+    , _outputOffset(0)
+    , _quad(0)
+    , _quadLength(0)
+    , _csvValue(0)
+    , _csvHasDigits(false)
+    {
+        if (_compressed)
+        {
+            memset(&_stream, 0, sizeof(_stream));
+            // 15 + 32 detects both zlib and gzip headers
+            if (inflateInit2(&_stream, 15 + 32) != Z_OK)
+            {
+                CCLOG("cocos2d: TiledMap: inflate init error");
+                _compressed = false;
+                _error = true;
+            }
+            _stream.next_out = reinterpret_cast<Bytef*>(_tiles);
+            _stream.avail_out = static_cast<uInt>(_tileCount * sizeof(uint32_t));
+        }
+    }
+
+    ~TMXTileDataDecoder()
+    {
+        if (_compressed)
+        {
+            inflateEnd(&_stream);
+        }
+    }
+
+    void feed(const char* text, int length)
+    {
+        if (_error)
+        {
+            return;
+        }
+
+        if (_encoding == Encoding::CSV)
+        {
+            feedCSV(text, length);
+            return;
+        }
+
+        unsigned char decoded[1024];
+        size_t decodedLength = 0;
+
+        for (int i = 0; i < length; ++i)
+        {
+            int value = base64Value(text[i]);
+            if (value < 0)
+            {
+                // whitespace, line breaks and the '=' padding
+                continue;
+            }
+
+            _quad = (_quad << 6) | value;
+            if (++_quadLength == 4)
+            {
+                decoded[decodedLength++] = (_quad >> 16) & 0xff;
+                decoded[decodedLength++] = (_quad >> 8) & 0xff;
+                decoded[decodedLength++] = _quad & 0xff;
+                _quad = 0;
+                _quadLength = 0;
+
+                if (decodedLength + 3 > sizeof(decoded))
+                {
+                    write(decoded, decodedLength);
+                    decodedLength = 0;
+                }
+            }
+        }
+
+        write(decoded, decodedLength);
+    }
+
+    // returns false if the data was broken or didn't fill the layer
+    bool finish()
+    {
+        if (_encoding == Encoding::CSV)
+        {
+            flushCSVValue();
+        }
+        else if (_quadLength > 1)
+        {
+            // the last quad was padded with '='
+            unsigned char decoded[2];
+            unsigned int bits = _quad << (6 * (4 - _quadLength));
+            decoded[0] = (bits >> 16) & 0xff;
+            decoded[1] = (bits >> 8) & 0xff;
+            write(decoded, _quadLength - 1);
+        }
+
+        size_t expected = _tileCount * sizeof(uint32_t);
+        if (_compressed)
+        {
+            return !_error && _stream.total_out == expected;
+        }
+        return !_error && _outputOffset == expected;
+    }
+
+private:
+    static int base64Value(char c)
+    {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    }
+
+    void write(const unsigned char* bytes, size_t length)
+    {
+        if (length == 0 || _error)
+        {
+            return;
+        }
+
+        if (!_compressed)
+        {
+            size_t capacity = _tileCount * sizeof(uint32_t) - _outputOffset;
+            if (length > capacity)
+            {
+                CCLOG("cocos2d: TiledMap: layer data is larger than the layer");
+                length = capacity;
+            }
+            memcpy(reinterpret_cast<unsigned char*>(_tiles) + _outputOffset, bytes, length);
+            _outputOffset += length;
+            return;
+        }
+
+        _stream.next_in = const_cast<Bytef*>(bytes);
+        _stream.avail_in = static_cast<uInt>(length);
+        while (_stream.avail_in > 0)
+        {
+            uInt availableBefore = _stream.avail_in;
+            int err = inflate(&_stream, Z_NO_FLUSH);
+            if (err == Z_STREAM_END)
+            {
+                break;
+            }
+            // no progress means the layer is full but the stream goes on
+            if ((err != Z_OK && err != Z_BUF_ERROR) || _stream.avail_in == availableBefore)
+            {
+                CCLOG("cocos2d: TiledMap: inflate data error");
+                _error = true;
+                break;
+            }
+        }
+    }
+
+    void feedCSV(const char* text, int length)
+    {
+        for (int i = 0; i < length; ++i)
+        {
+            char c = text[i];
+            if (c >= '0' && c <= '9')
+            {
+                _csvValue = _csvValue * 10 + (c - '0');
+                _csvHasDigits = true;
+            }
+            else if (c == ',')
+            {
+                flushCSVValue();
+            }
+        }
+    }
+
+    void flushCSVValue()
+    {
+        if (_csvHasDigits)
+        {
+            if (_outputOffset < _tileCount * sizeof(uint32_t))
+            {
+                _tiles[_outputOffset / sizeof(uint32_t)] = _csvValue;
+            }
+            _outputOffset += sizeof(uint32_t);
+        }
+        _csvValue = 0;
+        _csvHasDigits = false;
+    }
+
+    uint32_t* _tiles;
+    size_t _tileCount;
+    Encoding _encoding;
+    bool _compressed;
+    bool _error;
+    // bytes written to _tiles when not compressed
+    size_t _outputOffset;
+
+    unsigned int _quad;
+    int _quadLength;
+
+    uint32_t _csvValue;
+    bool _csvHasDigits;
+
+    z_stream _stream;
+};
+
 // implementation TMXLayerInfo
 TMXLayerInfo::TMXLayerInfo()
 : _name("")
@@ -110,6 +324,19 @@ TMXMapInfo * TMXMapInfo::create(const std::string& tmxFile)
     return nullptr;
 }
 
+TMXMapInfo * TMXMapInfo::createWithTileRegion(const std::string& tmxFile, const Rect& tileRegion)
+{
+    TMXMapInfo *ret = new TMXMapInfo();
+    ret->setTileRegion(tileRegion);
+    if(ret->initWithTMXFile(tmxFile))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
 TMXMapInfo * TMXMapInfo::createWithXML(const std::string& tmxString, const std::string& resourcePath)
 {
     TMXMapInfo *ret = new TMXMapInfo();
@@ -163,12 +390,42 @@ TMXMapInfo::TMXMapInfo()
 , _xmlTileIndex(0)
 , _currentFirstGID(-1)
 , _recordFirstGID(true)
+, _tileDataDecoder(nullptr)
+, _tileRegion(Rect::ZERO)
 {
 }
 
 TMXMapInfo::~TMXMapInfo()
 {
     CCLOGINFO("deallocing TMXMapInfo: %p", this);
+    CC_SAFE_DELETE(_tileDataDecoder);
+}
+
+void TMXMapInfo::clipTilesToRegion(TMXLayerInfo* layer)
+{
+    if (_tileRegion.size.width <= 0 || _tileRegion.size.height <= 0 || !layer->_tiles)
+    {
+        return;
+    }
+
+    int width = layer->_layerSize.width;
+    int height = layer->_layerSize.height;
+    int minX = std::max(0, (int)_tileRegion.getMinX());
+    int minY = std::max(0, (int)_tileRegion.getMinY());
+    int maxX = std::min(width, (int)ceilf(_tileRegion.getMaxX()));
+    int maxY = std::min(height, (int)ceilf(_tileRegion.getMaxY()));
+
+    for (int y = 0; y < height; ++y)
+    {
+        uint32_t* row = layer->_tiles + y * width;
+        if (y < minY || y >= maxY || minX >= maxX)
+        {
+            memset(row, 0, width * sizeof(uint32_t));
+            continue;
+        }
+        memset(row, 0, minX * sizeof(uint32_t));
+        memset(row + maxX, 0, (width - maxX) * sizeof(uint32_t));
+    }
 }
 
 bool TMXMapInfo::parseXMLString(const std::string& xmlString)
@@ -409,12 +666,22 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
 
             layer->_tiles = tiles;
         }
-        else if (encoding == "base64")
+        else if (encoding == "base64" || encoding == "csv")
         {
             int layerAttribs = tmxMapInfo->getLayerAttribs();
             tmxMapInfo->setLayerAttribs(layerAttribs | TMXLayerAttribBase64);
             tmxMapInfo->setStoringCharacters(true);
 
+            // the tiles are decoded straight into their final array while the text is parsed
+            TMXLayerInfo* layer = tmxMapInfo->getLayers().back();
+            size_t tilesAmount = (size_t)layer->_layerSize.width * (size_t)layer->_layerSize.height;
+            layer->_tiles = (uint32_t*) calloc(tilesAmount, sizeof(uint32_t));
+
+            CC_SAFE_DELETE(_tileDataDecoder);
+            _tileDataDecoder = new TMXTileDataDecoder(layer->_tiles, tilesAmount,
+                                                      encoding == "csv" ? TMXTileDataDecoder::Encoding::CSV : TMXTileDataDecoder::Encoding::BASE64,
+                                                      compression == "gzip" || compression == "zlib");
+
             if( compression == "gzip" )
             {
                 layerAttribs = tmxMapInfo->getLayerAttribs();
@@ -617,56 +884,31 @@ void TMXMapInfo::endElement(void *ctx, const char *name)
     TMXMapInfo *tmxMapInfo = this;
     std::string elementName = (char*)name;
 
-    int len = 0;
 
     if(elementName == "data")
     {
-        if (tmxMapInfo->getLayerAttribs() & TMXLayerAttribBase64)
+        if (_tileDataDecoder)
         {
             tmxMapInfo->setStoringCharacters(false);
-            
+
             TMXLayerInfo* layer = tmxMapInfo->getLayers().back();
-            
-            std::string currentString = tmxMapInfo->getCurrentString();
-            unsigned char *buffer;
-            len = base64Decode((unsigned char*)currentString.c_str(), (unsigned int)currentString.length(), &buffer);
-            if( ! buffer )
+            bool decoded = _tileDataDecoder->finish();
+            CC_SAFE_DELETE(_tileDataDecoder);
+            if (!decoded)
             {
-                CCLOG("cocos2d: TiledMap: decode data error");
+                // like a layer whose data couldn't be decoded at all, it's left without tiles
+                CCLOG("cocos2d: TiledMap: decode data error in layer %s", layer->_name.c_str());
+                free(layer->_tiles);
+                layer->_tiles = nullptr;
                 return;
             }
-            
-            if( tmxMapInfo->getLayerAttribs() & (TMXLayerAttribGzip | TMXLayerAttribZlib) )
-            {
-                unsigned char *deflated = nullptr;
-                Size s = layer->_layerSize;
-                // int sizeHint = s.width * s.height * sizeof(uint32_t);
-                ssize_t sizeHint = s.width * s.height * sizeof(unsigned int);
-                
-                ssize_t CC_UNUSED inflatedLen = ZipUtils::inflateMemoryWithHint(buffer, len, &deflated, sizeHint);
-                CCASSERT(inflatedLen == sizeHint, "");
-                
-                free(buffer);
-                buffer = nullptr;
-                
-                if( ! deflated )
-                {
-                    CCLOG("cocos2d: TiledMap: inflate data error");
-                    return;
-                }
-                
-                layer->_tiles = reinterpret_cast<uint32_t*>(deflated);
-            }
-            else
-            {
-                layer->_tiles = reinterpret_cast<uint32_t*>(buffer);
-            }
-            
-            tmxMapInfo->setCurrentString("");
+
+            clipTilesToRegion(layer);
         }
         else if (tmxMapInfo->getLayerAttribs() & TMXLayerAttribNone)
         {
             _xmlTileIndex = 0;
+            clipTilesToRegion(tmxMapInfo->getLayers().back());
         }
 
     }
@@ -700,13 +942,17 @@ void TMXMapInfo::textHandler(void *ctx, const char *ch, int len)
 {
     CC_UNUSED_PARAM(ctx);
     TMXMapInfo *tmxMapInfo = this;
-    std::string text((char*)ch,0,len);
 
     if (tmxMapInfo->isStoringCharacters())
     {
-        std::string currentString = tmxMapInfo->getCurrentString();
-        currentString += text;
-        tmxMapInfo->setCurrentString(currentString.c_str());
+        if (_tileDataDecoder)
+        {
+            _tileDataDecoder->feed(ch, len);
+        }
+        else
+        {
+            _currentString.append(ch, len);
+        }
     }
 }
 
@@ -41,6 +41,7 @@ NS_CC_BEGIN
 class TMXLayerInfo;
 class TMXObjectGroup;
 class TMXTilesetInfo;
+class TMXTileDataDecoder;
 
 /** @file
 * Internal TMX parser
@@ -170,6 +171,10 @@ public:
     static TMXMapInfo * create(const std::string& tmxFile);
     /** creates a TMX Format with an XML string and a TMX resource path */
     static TMXMapInfo * createWithXML(const std::string& tmxString, const std::string& resourcePath);
+    /** creates a TMX Format with a tmx file, keeping only the tiles inside tileRegion, see setTileRegion.
+     The layers keep full size tile arrays.
+     */
+    static TMXMapInfo * createWithTileRegion(const std::string& tmxFile, const Rect& tileRegion);
     
     /** creates a TMX Format with a tmx file */
     CC_DEPRECATED_ATTRIBUTE static TMXMapInfo * formatWithTMXFile(const char *tmxFile) { return TMXMapInfo::create(tmxFile); };
@@ -249,6 +254,14 @@ public:
     CC_DEPRECATED_ATTRIBUTE inline bool getStoringCharacters() const { return isStoringCharacters(); };
     inline void setStoringCharacters(bool storingCharacters) { _storingCharacters = storingCharacters; };
 
+    /** Only the tiles inside region, in tile coordinates, are kept, the others are left empty so no sprites
+     are created for them. It has to be set before parsing. An empty region keeps the whole map.
+     Every layer is still decoded into a GID array of the full layer size, so it saves the vertex data and
+     draw time of the tiles outside the region, not the memory of the tile data.
+     */
+    inline const Rect& getTileRegion() const { return _tileRegion; };
+    inline void setTileRegion(const Rect& region) { _tileRegion = region; };
+
     /// properties
     inline const ValueMap& getProperties() const { return _properties; }
     inline ValueMap& getProperties() { return _properties; }
@@ -280,6 +293,8 @@ public:
 
 protected:
     void internalInit(const std::string& tmxFileName, const std::string& resourcePath);
+    /** Empties the tiles of layer that are outside _tileRegion */
+    void clipTilesToRegion(TMXLayerInfo* layer);
 
     /// map orientation
     int    _orientation;
@@ -316,6 +331,10 @@ protected:
     ValueMapIntKey _tileProperties;
     int _currentFirstGID;
     bool _recordFirstGID;
+    //! decodes the <data> element being parsed as its text arrives
+    TMXTileDataDecoder* _tileDataDecoder;
+    //! tiles to keep
+    Rect _tileRegion;
 };
 
 // end of tilemap_parallax_nodes group
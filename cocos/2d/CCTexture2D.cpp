@@ -48,8 +48,15 @@ THE SOFTWARE.
 #include "deprecated/CCString.h"
 
 
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-    #include "2d/CCTextureCache.h"
+#include "2d/CCTextureCache.h"
+
+// the pixel format converters use SSE2 or NEON when the target always has them
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CC_TEXTURE2D_CONVERT_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    #define CC_TEXTURE2D_CONVERT_NEON 1
+    #include <arm_neon.h>
 #endif
 
 NS_CC_BEGIN
@@ -122,6 +129,236 @@ static Texture2D::PixelFormat g_defaultAlphaPixelFormat = Texture2D::PixelFormat
 
 static bool _PVRHaveAlphaPremultiplied = false;
 
+//////////////////////////////////////////////////////////////////////////
+// vectorized converters
+//
+// Each one converts as many whole pixels as fit in its vectors and returns how many it converted,
+// the scalar converters below do the rest. They return 0 when there is no SIMD support.
+
+namespace {
+
+#if CC_TEXTURE2D_CONVERT_SSE2
+    // packs the low 16 bits of the 32 bit lanes, _mm_packs_epi32 saturates signed values
+    inline __m128i packLow16(__m128i lo, __m128i hi)
+    {
+        lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+        hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+        return _mm_packs_epi32(lo, hi);
+    }
+
+    // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRGGGGBBBBAAAA, on the pixels as little endian 32 bit lanes
+    inline __m128i packRGBA4444(__m128i p)
+    {
+        return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF0)), 8),
+                                         _mm_srli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF000)), 4)),
+                            _mm_or_si128(_mm_srli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF00000)), 16),
+                                         _mm_srli_epi32(p, 28)));
+    }
+
+    // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGGBBBBB
+    inline __m128i packRGB565(__m128i p)
+    {
+        return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF8)), 8),
+                                         _mm_srli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xFC00)), 5)),
+                            _mm_srli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF80000)), 19));
+    }
+
+    // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGBBBBBA
+    inline __m128i packRGB5A1(__m128i p)
+    {
+        return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF8)), 8),
+                                         _mm_srli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF800)), 5)),
+                            _mm_or_si128(_mm_srli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF80000)), 18),
+                                         _mm_srli_epi32(p, 31)));
+    }
+
+    template <__m128i (*PACK)(__m128i)>
+    inline ssize_t convertRGBA8888To16SSE2(const unsigned char* data, ssize_t pixels, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 8 <= pixels; i += 8)
+        {
+            __m128i lo = _mm_loadu_si128((const __m128i*)(data + i * 4));
+            __m128i hi = _mm_loadu_si128((const __m128i*)(data + i * 4 + 16));
+            _mm_storeu_si128((__m128i*)(outData + i * 2), packLow16(PACK(lo), PACK(hi)));
+        }
+        return i;
+    }
+#endif
+
+#if CC_TEXTURE2D_CONVERT_NEON
+    template <uint16x8_t (*PACK)(uint8x8x4_t)>
+    inline ssize_t convertRGBA8888To16NEON(const unsigned char* data, ssize_t pixels, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 8 <= pixels; i += 8)
+        {
+            vst1q_u16((uint16_t*)(outData + i * 2), PACK(vld4_u8(data + i * 4)));
+        }
+        return i;
+    }
+
+    inline uint16x8_t packRGBA4444(uint8x8x4_t p)
+    {
+        uint8x8_t mask = vdup_n_u8(0xF0);
+        return vorrq_u16(vorrq_u16(vshll_n_u8(vand_u8(p.val[0], mask), 8), vshll_n_u8(vand_u8(p.val[1], mask), 4)),
+                         vorrq_u16(vmovl_u8(vand_u8(p.val[2], mask)), vmovl_u8(vshr_n_u8(p.val[3], 4))));
+    }
+
+    inline uint16x8_t packRGB565(uint8x8x4_t p)
+    {
+        return vorrq_u16(vorrq_u16(vshll_n_u8(vand_u8(p.val[0], vdup_n_u8(0xF8)), 8), vshll_n_u8(vand_u8(p.val[1], vdup_n_u8(0xFC)), 3)),
+                         vmovl_u8(vshr_n_u8(p.val[2], 3)));
+    }
+
+    inline uint16x8_t packRGB5A1(uint8x8x4_t p)
+    {
+        uint8x8_t mask = vdup_n_u8(0xF8);
+        return vorrq_u16(vorrq_u16(vshll_n_u8(vand_u8(p.val[0], mask), 8), vshll_n_u8(vand_u8(p.val[1], mask), 3)),
+                         vorrq_u16(vshll_n_u8(vshr_n_u8(p.val[2], 3), 1), vmovl_u8(vshr_n_u8(p.val[3], 7))));
+    }
+#endif
+
+    ssize_t convertRGBA8888ToRGBA4444SIMD(const unsigned char* data, ssize_t pixels, unsigned char* outData)
+    {
+#if CC_TEXTURE2D_CONVERT_SSE2
+        return convertRGBA8888To16SSE2<packRGBA4444>(data, pixels, outData);
+#elif CC_TEXTURE2D_CONVERT_NEON
+        return convertRGBA8888To16NEON<packRGBA4444>(data, pixels, outData);
+#else
+        return 0;
+#endif
+    }
+
+    ssize_t convertRGBA8888ToRGB565SIMD(const unsigned char* data, ssize_t pixels, unsigned char* outData)
+    {
+#if CC_TEXTURE2D_CONVERT_SSE2
+        return convertRGBA8888To16SSE2<packRGB565>(data, pixels, outData);
+#elif CC_TEXTURE2D_CONVERT_NEON
+        return convertRGBA8888To16NEON<packRGB565>(data, pixels, outData);
+#else
+        return 0;
+#endif
+    }
+
+    ssize_t convertRGBA8888ToRGB5A1SIMD(const unsigned char* data, ssize_t pixels, unsigned char* outData)
+    {
+#if CC_TEXTURE2D_CONVERT_SSE2
+        return convertRGBA8888To16SSE2<packRGB5A1>(data, pixels, outData);
+#elif CC_TEXTURE2D_CONVERT_NEON
+        return convertRGBA8888To16NEON<packRGB5A1>(data, pixels, outData);
+#else
+        return 0;
+#endif
+    }
+
+    ssize_t convertRGBA8888ToA8SIMD(const unsigned char* data, ssize_t pixels, unsigned char* outData)
+    {
+        ssize_t i = 0;
+#if CC_TEXTURE2D_CONVERT_SSE2
+        for (; i + 16 <= pixels; i += 16)
+        {
+            const __m128i* in = (const __m128i*)(data + i * 4);
+            __m128i lo = _mm_packs_epi32(_mm_srli_epi32(_mm_loadu_si128(in), 24), _mm_srli_epi32(_mm_loadu_si128(in + 1), 24));
+            __m128i hi = _mm_packs_epi32(_mm_srli_epi32(_mm_loadu_si128(in + 2), 24), _mm_srli_epi32(_mm_loadu_si128(in + 3), 24));
+            _mm_storeu_si128((__m128i*)(outData + i), _mm_packus_epi16(lo, hi));
+        }
+#elif CC_TEXTURE2D_CONVERT_NEON
+        for (; i + 16 <= pixels; i += 16)
+        {
+            vst1q_u8(outData + i, vld4q_u8(data + i * 4).val[3]);
+        }
+#endif
+        return i;
+    }
+
+#if CC_TEXTURE2D_CONVERT_NEON
+    // SSE2 has no byte shuffle, these two are NEON only
+    ssize_t convertRGBA8888ToRGB888SIMD(const unsigned char* data, ssize_t pixels, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 16 <= pixels; i += 16)
+        {
+            uint8x16x4_t p = vld4q_u8(data + i * 4);
+            uint8x16x3_t rgb = {{ p.val[0], p.val[1], p.val[2] }};
+            vst3q_u8(outData + i * 3, rgb);
+        }
+        return i;
+    }
+
+    ssize_t convertRGB888ToRGBA8888SIMD(const unsigned char* data, ssize_t pixels, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 16 <= pixels; i += 16)
+        {
+            uint8x16x3_t rgb = vld3q_u8(data + i * 3);
+            uint8x16x4_t p = {{ rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(0xFF) }};
+            vst4q_u8(outData + i * 4, p);
+        }
+        return i;
+    }
+#endif
+
+    ssize_t convertI8ToRGBA8888SIMD(const unsigned char* data, ssize_t pixels, unsigned char* outData)
+    {
+        ssize_t i = 0;
+#if CC_TEXTURE2D_CONVERT_SSE2
+        const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+        for (; i + 16 <= pixels; i += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+            __m128i lo = _mm_unpacklo_epi8(v, v);
+            __m128i hi = _mm_unpackhi_epi8(v, v);
+            __m128i* out = (__m128i*)(outData + i * 4);
+            _mm_storeu_si128(out,     _mm_or_si128(_mm_unpacklo_epi16(lo, lo), alpha));
+            _mm_storeu_si128(out + 1, _mm_or_si128(_mm_unpackhi_epi16(lo, lo), alpha));
+            _mm_storeu_si128(out + 2, _mm_or_si128(_mm_unpacklo_epi16(hi, hi), alpha));
+            _mm_storeu_si128(out + 3, _mm_or_si128(_mm_unpackhi_epi16(hi, hi), alpha));
+        }
+#elif CC_TEXTURE2D_CONVERT_NEON
+        for (; i + 16 <= pixels; i += 16)
+        {
+            uint8x16_t v = vld1q_u8(data + i);
+            uint8x16x4_t p = {{ v, v, v, vdupq_n_u8(0xFF) }};
+            vst4q_u8(outData + i * 4, p);
+        }
+#endif
+        return i;
+    }
+
+    ssize_t convertAI88ToRGBA8888SIMD(const unsigned char* data, ssize_t pixels, unsigned char* outData)
+    {
+        ssize_t i = 0;
+#if CC_TEXTURE2D_CONVERT_SSE2
+        const __m128i keep = _mm_set1_epi32((int)0xFFFF00FF);
+        const __m128i intensity = _mm_set1_epi32(0xFF);
+        for (; i + 8 <= pixels; i += 8)
+        {
+            // IA pairs unpacked to IAIA, then the first A replaced by I
+            __m128i v = _mm_loadu_si128((const __m128i*)(data + i * 2));
+            __m128i lo = _mm_unpacklo_epi16(v, v);
+            __m128i hi = _mm_unpackhi_epi16(v, v);
+            lo = _mm_or_si128(_mm_and_si128(lo, keep), _mm_slli_epi32(_mm_and_si128(lo, intensity), 8));
+            hi = _mm_or_si128(_mm_and_si128(hi, keep), _mm_slli_epi32(_mm_and_si128(hi, intensity), 8));
+            __m128i* out = (__m128i*)(outData + i * 4);
+            _mm_storeu_si128(out, lo);
+            _mm_storeu_si128(out + 1, hi);
+        }
+#elif CC_TEXTURE2D_CONVERT_NEON
+        for (; i + 16 <= pixels; i += 16)
+        {
+            uint8x16x2_t v = vld2q_u8(data + i * 2);
+            uint8x16x4_t p = {{ v.val[0], v.val[0], v.val[0], v.val[1] }};
+            vst4q_u8(outData + i * 4, p);
+        }
+#endif
+        return i;
+    }
+}
+
+// vectorized converters end
+//////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////
 //conventer function
 
@@ -150,7 +387,9 @@ void Texture2D::convertAI88ToRGB888(const unsigned char* data, ssize_t dataLen,
 // IIIIIIII -> RRRRRRRRGGGGGGGGGBBBBBBBBAAAAAAAA
 void Texture2D::convertI8ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    for (ssize_t i = 0; i < dataLen; ++i)
+    ssize_t i = convertI8ToRGBA8888SIMD(data, dataLen, outData);
+    outData += i * 4;
+    for (; i < dataLen; ++i)
     {
         *outData++ = data[i];     //R
         *outData++ = data[i];     //G
@@ -162,7 +401,9 @@ void Texture2D::convertI8ToRGBA8888(const unsigned char* data, ssize_t dataLen,
 // IIIIIIIIAAAAAAAA -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
 void Texture2D::convertAI88ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    for (ssize_t i = 0, l = dataLen - 1; i < l; i += 2)
+    ssize_t pixels = convertAI88ToRGBA8888SIMD(data, dataLen / 2, outData);
+    outData += pixels * 4;
+    for (ssize_t i = pixels * 2, l = dataLen - 1; i < l; i += 2)
     {
         *outData++ = data[i];     //R
         *outData++ = data[i];     //G
@@ -279,7 +520,12 @@ void Texture2D::convertAI88ToI8(const unsigned char* data, ssize_t dataLen, unsi
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
 void Texture2D::convertRGB888ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
+    ssize_t pixels = 0;
+#if CC_TEXTURE2D_CONVERT_NEON
+    pixels = convertRGB888ToRGBA8888SIMD(data, dataLen / 3, outData);
+    outData += pixels * 4;
+#endif
+    for (ssize_t i = pixels * 3, l = dataLen - 2; i < l; i += 3)
     {
         *outData++ = data[i];         //R
         *outData++ = data[i + 1];     //G
@@ -291,7 +537,12 @@ void Texture2D::convertRGB888ToRGBA8888(const unsigned char* data, ssize_t dataL
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRRRRGGGGGGGGBBBBBBBB
 void Texture2D::convertRGBA8888ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
+    ssize_t pixels = 0;
+#if CC_TEXTURE2D_CONVERT_NEON
+    pixels = convertRGBA8888ToRGB888SIMD(data, dataLen / 4, outData);
+    outData += pixels * 3;
+#endif
+    for (ssize_t i = pixels * 4, l = dataLen - 3; i < l; i += 4)
     {
         *outData++ = data[i];         //R
         *outData++ = data[i + 1];     //G
@@ -314,8 +565,9 @@ void Texture2D::convertRGB888ToRGB565(const unsigned char* data, ssize_t dataLen
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGGBBBBB
 void Texture2D::convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
+    ssize_t pixels = convertRGBA8888ToRGB565SIMD(data, dataLen / 4, outData);
+    unsigned short* out16 = (unsigned short*)outData + pixels;
+    for (ssize_t i = pixels * 4, l = dataLen - 3; i < l; i += 4)
     {
         *out16++ = (data[i] & 0x00F8) << 8    //R
             | (data[i + 1] & 0x00FC) << 3     //G
@@ -344,7 +596,9 @@ void Texture2D::convertRGBA8888ToI8(const unsigned char* data, ssize_t dataLen,
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> AAAAAAAA
 void Texture2D::convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    for (ssize_t i = 0, l = dataLen -3; i < l; i += 4)
+    ssize_t pixels = convertRGBA8888ToA8SIMD(data, dataLen / 4, outData);
+    outData += pixels;
+    for (ssize_t i = pixels * 4, l = dataLen -3; i < l; i += 4)
     {
         *outData++ = data[i + 3]; //A
     }
@@ -387,8 +641,9 @@ void Texture2D::convertRGB888ToRGBA4444(const unsigned char* data, ssize_t dataL
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRGGGGBBBBAAAA
 void Texture2D::convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
+    ssize_t pixels = convertRGBA8888ToRGBA4444SIMD(data, dataLen / 4, outData);
+    unsigned short* out16 = (unsigned short*)outData + pixels;
+    for (ssize_t i = pixels * 4, l = dataLen - 3; i < l; i += 4)
     {
         *out16++ = (data[i] & 0x00F0) << 8    //R
         | (data[i + 1] & 0x00F0) << 4         //G
@@ -413,8 +668,9 @@ void Texture2D::convertRGB888ToRGB5A1(const unsigned char* data, ssize_t dataLen
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGBBBBBA
 void Texture2D::convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 2; i < l; i += 4)
+    ssize_t pixels = convertRGBA8888ToRGB5A1SIMD(data, dataLen / 4, outData);
+    unsigned short* out16 = (unsigned short*)outData + pixels;
+    for (ssize_t i = pixels * 4, l = dataLen - 2; i < l; i += 4)
     {
         *out16++ = (data[i] & 0x00F8) << 8    //R
             | (data[i + 1] & 0x00F8) << 3     //G
@@ -436,6 +692,13 @@ Texture2D::Texture2D()
 , _hasMipmaps(false)
 , _shaderProgram(nullptr)
 , _antialiasEnabled(true)
+, _residencyPriority(0)
+, _evicted(false)
+, _texParams()
+, _lastUsedFrame(0)
+, _baseMipLevel(0)
+, _drawnScale(0)
+, _drawnScaleFrame(0)
 {
 }
 
@@ -471,9 +734,43 @@ int Texture2D::getPixelsHigh() const
 
 GLuint Texture2D::getName() const
 {
+    auto director = Director::getInstance();
+    if (_evicted)
+    {
+        director->getTextureCache()->reloadEvictedTexture(const_cast<Texture2D*>(this));
+    }
+    _lastUsedFrame = director->getTotalFrames();
     return _name;
 }
 
+size_t Texture2D::getMemorySize() const
+{
+    if (_name == 0)
+    {
+        return 0;
+    }
+
+    size_t bytes = (size_t)_pixelsWide * _pixelsHigh * getBitsPerPixelForFormat() / 8;
+    // levels above the base one aren't uploaded, each one is a quarter of the previous
+    bytes >>= 2 * _baseMipLevel;
+    // a full mipmap chain adds a third
+    return _hasMipmaps ? bytes + bytes / 3 : bytes;
+}
+
+void Texture2D::setDrawnScale(float scale)
+{
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    if (_drawnScaleFrame != frame)
+    {
+        _drawnScaleFrame = frame;
+        _drawnScale = scale;
+    }
+    else if (scale > _drawnScale)
+    {
+        _drawnScale = scale;
+    }
+}
+
 Size Texture2D::getContentSize() const
 {
     Size ret;
@@ -541,6 +838,23 @@ bool Texture2D::initWithData(const void *data, ssize_t dataLen, Texture2D::Pixel
     _maxT = contentSize.height / (float)(pixelsHigh);
 }
 
+bool Texture2D::initWithMipmapsFromLevel(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat pixelFormat, int pixelsWide, int pixelsHigh, int baseLevel)
+{
+    CCASSERT(baseLevel >= 0 && baseLevel < mipmapsNum, "Invalid base mipmap level");
+
+    if (! initWithMipmaps(mipmaps + baseLevel, mipmapsNum - baseLevel, pixelFormat, MAX(pixelsWide >> baseLevel, 1), MAX(pixelsHigh >> baseLevel, 1)))
+    {
+        return false;
+    }
+
+    // the smaller levels cover the same texture coordinates as level 0
+    _contentSize = Size((float)pixelsWide, (float)pixelsHigh);
+    _pixelsWide = pixelsWide;
+    _pixelsHigh = pixelsHigh;
+    _baseMipLevel = baseLevel;
+    return true;
+}
+
 bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat pixelFormat, int pixelsWide, int pixelsHigh)
 {
     // cocos2d-x is currently calling this multiple times on the same Texture2D
@@ -613,15 +927,19 @@ bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat
 
     if (mipmapsNum == 1)
     {
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _antialiasEnabled ? GL_LINEAR : GL_NEAREST);
+        _texParams.minFilter = _antialiasEnabled ? GL_LINEAR : GL_NEAREST;
     }else
     {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _antialiasEnabled ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST);
+        _texParams.minFilter = _antialiasEnabled ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST;
     }
-    
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _antialiasEnabled ? GL_LINEAR : GL_NEAREST );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+    _texParams.magFilter = _antialiasEnabled ? GL_LINEAR : GL_NEAREST;
+    _texParams.wrapS = GL_CLAMP_TO_EDGE;
+    _texParams.wrapT = GL_CLAMP_TO_EDGE;
+
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _texParams.minFilter );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _texParams.magFilter );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _texParams.wrapS );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _texParams.wrapT );
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     if (_antialiasEnabled)
@@ -681,6 +999,10 @@ bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat
 
     _hasPremultipliedAlpha = false;
     _hasMipmaps = mipmapsNum > 1;
+    _evicted = false;
+    _baseMipLevel = 0;
+    // a texture that was just created is about to be used, don't evict it right away
+    _lastUsedFrame = Director::getInstance()->getTotalFrames();
 
     // shader
     setGLProgram(GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE));
@@ -1040,13 +1362,72 @@ Texture2D::PixelFormat Texture2D::convertDataToFormat(const unsigned char* data,
     case PixelFormat::RGBA8888:
         return convertRGBA8888ToFormat(data, dataLen, format, outData, outDataLen);
     default:
-        CCLOG("unsupport convert for format %d to format %d", originFormat, format);
+        if (format != originFormat)
+        {
+            CCLOG("unsupport convert for format %d to format %d", originFormat, format);
+        }
         *outData = (unsigned char*)data;
         *outDataLen = dataLen;
         return originFormat;
     }
 }
 
+Texture2D::ConvertFunction Texture2D::getConvertFunction(PixelFormat originFormat, PixelFormat format)
+{
+    // must match the conversions of convert*ToFormat()
+    switch (originFormat)
+    {
+    case PixelFormat::I8:
+        switch (format)
+        {
+        case PixelFormat::RGBA8888: return convertI8ToRGBA8888;
+        case PixelFormat::RGB888:   return convertI8ToRGB888;
+        case PixelFormat::RGB565:   return convertI8ToRGB565;
+        case PixelFormat::AI88:     return convertI8ToAI88;
+        case PixelFormat::RGBA4444: return convertI8ToRGBA4444;
+        case PixelFormat::RGB5A1:   return convertI8ToRGB5A1;
+        default:                    return nullptr;
+        }
+    case PixelFormat::AI88:
+        switch (format)
+        {
+        case PixelFormat::RGBA8888: return convertAI88ToRGBA8888;
+        case PixelFormat::RGB888:   return convertAI88ToRGB888;
+        case PixelFormat::RGB565:   return convertAI88ToRGB565;
+        case PixelFormat::A8:       return convertAI88ToA8;
+        case PixelFormat::I8:       return convertAI88ToI8;
+        case PixelFormat::RGBA4444: return convertAI88ToRGBA4444;
+        case PixelFormat::RGB5A1:   return convertAI88ToRGB5A1;
+        default:                    return nullptr;
+        }
+    case PixelFormat::RGB888:
+        switch (format)
+        {
+        case PixelFormat::RGBA8888: return convertRGB888ToRGBA8888;
+        case PixelFormat::RGB565:   return convertRGB888ToRGB565;
+        case PixelFormat::I8:       return convertRGB888ToI8;
+        case PixelFormat::AI88:     return convertRGB888ToAI88;
+        case PixelFormat::RGBA4444: return convertRGB888ToRGBA4444;
+        case PixelFormat::RGB5A1:   return convertRGB888ToRGB5A1;
+        default:                    return nullptr;
+        }
+    case PixelFormat::RGBA8888:
+        switch (format)
+        {
+        case PixelFormat::RGB888:   return convertRGBA8888ToRGB888;
+        case PixelFormat::RGB565:   return convertRGBA8888ToRGB565;
+        case PixelFormat::A8:       return convertRGBA8888ToA8;
+        case PixelFormat::I8:       return convertRGBA8888ToI8;
+        case PixelFormat::AI88:     return convertRGBA8888ToAI88;
+        case PixelFormat::RGBA4444: return convertRGBA8888ToRGBA4444;
+        case PixelFormat::RGB5A1:   return convertRGBA8888ToRGB5A1;
+        default:                    return nullptr;
+        }
+    default:
+        return nullptr;
+    }
+}
+
 // implementation Texture2D (Text)
 bool Texture2D::initWithString(const char *text, const std::string& fontName, float fontSize, const Size& dimensions/* = Size(0, 0)*/, TextHAlignment hAlignment/* =  TextHAlignment::CENTER */, TextVAlignment vAlignment/* =  TextVAlignment::TOP */)
 {
@@ -1250,6 +1631,7 @@ void Texture2D::setTexParameters(const TexParams &texParams)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texParams.magFilter );
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texParams.wrapS );
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texParams.wrapT );
+    _texParams = texParams;
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     VolatileTextureMgr::setTexParameters(this, texParams);
@@ -1264,6 +1646,9 @@ void Texture2D::setAliasTexParameters()
     }
 
     _antialiasEnabled = false;
+    // an evicted texture gets them when it's reloaded
+    _texParams.minFilter = _hasMipmaps ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST;
+    _texParams.magFilter = GL_NEAREST;
 
     if (_name == 0)
     {
@@ -1296,6 +1681,9 @@ void Texture2D::setAntiAliasTexParameters()
     }
 
     _antialiasEnabled = true;
+    // an evicted texture gets them when it's reloaded
+    _texParams.minFilter = _hasMipmaps ? GL_LINEAR_MIPMAP_NEAREST : GL_LINEAR;
+    _texParams.magFilter = GL_LINEAR;
 
     if (_name == 0)
     {
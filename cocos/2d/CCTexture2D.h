@@ -212,6 +212,21 @@ public:
     /** Initializes with mipmaps */
     bool initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, Texture2D::PixelFormat pixelFormat, int pixelsWide, int pixelsHigh);
 
+    /** Initializes with the mipmaps from baseLevel down. The texture keeps the size of level 0, so texture
+     coordinates don't change, but is sampled from the smaller levels until it's initialized again with a lower baseLevel.
+     @since v3.1
+     */
+    bool initWithMipmapsFromLevel(MipmapInfo* mipmaps, int mipmapsNum, Texture2D::PixelFormat pixelFormat, int pixelsWide, int pixelsHigh, int baseLevel);
+
+    /** Gets the first mipmap level uploaded by initWithMipmapsFromLevel. 0 when the texture has its full resolution */
+    int getBaseMipLevel() const { return _baseMipLevel; }
+
+    /** Called by the nodes drawing the texture, with the ratio between its size on screen and its size in pixels.
+     The TextureCache doesn't stream in mipmap levels larger than the biggest ratio asks for.
+     @since v3.1
+     */
+    void setDrawnScale(float scale);
+
     /** Update with texture data*/
     bool updateWithData(const void *data,int offsetX,int offsetY,int width,int height);
     /**
@@ -341,6 +356,22 @@ public:
     
     void setGLProgram(GLProgram* program);
     GLProgram* getGLProgram() const;
+
+    /** Gets the number of bytes the texture uses in video memory, mipmaps included. 0 if it has no GL texture */
+    size_t getMemorySize() const;
+
+    /** Sets the residency priority used by the TextureCache memory budget.
+     Textures with a lower priority are evicted first. Default is 0.
+     @since v3.1
+     */
+    void setResidencyPriority(int priority) { _residencyPriority = priority; }
+    int getResidencyPriority() const { return _residencyPriority; }
+
+    /** Whether the GL texture was evicted by the TextureCache to stay under its memory budget.
+     An evicted texture is loaded again the next time its name is used.
+     @since v3.1
+     */
+    bool isEvicted() const { return _evicted; }
     
 public:
     static const PixelFormatInfoMap& getPixelFormatInfoMap();
@@ -360,6 +391,13 @@ private:
     static PixelFormat convertRGB888ToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat format, unsigned char** outData, ssize_t* outDataLen);
     static PixelFormat convertRGBA8888ToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat format, unsigned char** outData, ssize_t* outDataLen);
 
+    typedef void (*ConvertFunction)(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    /**
+    Returns the function convertDataToFormat uses to convert originFormat into format, or nullptr if the data is used as is.
+    It can be called on any slice of whole pixels, which lets Image pack rows while they are decoded.
+    */
+    static ConvertFunction getConvertFunction(PixelFormat originFormat, PixelFormat format);
+
     //I8 to XXX
     static void convertI8ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
     static void convertI8ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
@@ -395,6 +433,10 @@ private:
     static void convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
 
 protected:
+    friend class TextureCache;
+    friend class Image;
+    friend class DynamicAtlas;
+
     /** pixel format of the texture */
     Texture2D::PixelFormat _pixelFormat;
 
@@ -427,6 +469,21 @@ protected:
     static const PixelFormatInfoMap _pixelFormatInfoTables;
 
     bool _antialiasEnabled;
+
+    /** file the TextureCache loads the texture from again after evicting it, empty if it can't be evicted */
+    std::string _residencyFile;
+    int _residencyPriority;
+    bool _evicted;
+    /** filters and wrap modes of the GL texture, applied again when an evicted texture is reloaded */
+    TexParams _texParams;
+    /** frame in which the texture name was last used */
+    mutable unsigned int _lastUsedFrame;
+
+    /** first mipmap level in the GL texture, see initWithMipmapsFromLevel */
+    int _baseMipLevel;
+    /** largest scale the texture was drawn at in _drawnScaleFrame */
+    float _drawnScale;
+    unsigned int _drawnScaleFrame;
 };
 
 
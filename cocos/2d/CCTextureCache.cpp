@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include <stack>
 #include <cctype>
 #include <list>
+#include <algorithm>
 
 #include "2d/CCTextureCache.h"
 #include "2d/CCTexture2D.h"
@@ -37,6 +38,8 @@ THE SOFTWARE.
 #include "2d/platform/CCFileUtils.h"
 #include "2d/ccUtils.h"
 #include "base/CCScheduler.h"
+#include "base/CCProfiling.h"
+#include "renderer/ccGLStateCache.h"
 #include "deprecated/CCString.h"
 
 
@@ -57,11 +60,14 @@ TextureCache * TextureCache::getInstance()
 }
 
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
-, _asyncStructQueue(nullptr)
-, _imageInfoQueue(nullptr)
-, _needQuit(false)
+: _imageInfoQueue(nullptr)
+, _loadingImageCount(0)
 , _asyncRefCount(0)
+, _memoryBudget(0)
+, _evictionCount(0)
+, _reloadCount(0)
+, _progressiveMipmapLoading(false)
+, _mipmapUploadBudget(1024 * 1024)
 {
 }
 
@@ -72,7 +78,31 @@ TextureCache::~TextureCache()
     for( auto it=_textures.begin(); it!=_textures.end(); ++it)
         (it->second)->release();
 
-    CC_SAFE_DELETE(_loadingThread);
+    if (_imageInfoQueue)
+    {
+        for (auto imageInfo : *_imageInfoQueue)
+        {
+            CC_SAFE_RELEASE(imageInfo->image);
+            delete imageInfo->asyncStruct;
+            delete imageInfo;
+        }
+        delete _imageInfoQueue;
+    }
+
+    if (_memoryBudget > 0)
+    {
+        Director::getInstance()->getScheduler()->unschedule(schedule_selector(TextureCache::updateResidency), this);
+    }
+
+    if (!_streamingTextures.empty())
+    {
+        Director::getInstance()->getScheduler()->unschedule(schedule_selector(TextureCache::updateMipmapStreaming), this);
+        for (auto& streaming : _streamingTextures)
+        {
+            CC_SAFE_RELEASE(streaming.image);
+            streaming.texture->release();
+        }
+    }
 }
 
 void TextureCache::destroyInstance()
@@ -110,15 +140,9 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
     }
 
     // lazy init
-    if (_asyncStructQueue == nullptr)
-    {             
-        _asyncStructQueue = new queue<AsyncStruct*>();
-        _imageInfoQueue   = new deque<ImageInfo*>();        
-
-        // create a new thread to load images
-        _loadingThread = new std::thread(&TextureCache::loadImage, this);
-
-        _needQuit = false;
+    if (_imageInfoQueue == nullptr)
+    {
+        _imageInfoQueue = new deque<ImageInfo*>();
     }
 
     if (0 == _asyncRefCount)
@@ -131,93 +155,49 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
     // generate async struct
     AsyncStruct *data = new AsyncStruct(fullpath, callback);
 
-    // add async struct into queue
-    _asyncStructQueueMutex.lock();
-    _asyncStructQueue->push(data);
-    _asyncStructQueueMutex.unlock();
-
-    _sleepCondition.notify_one();
+    // decoded on the I/O threads shared with the other loaders
+    {
+        std::lock_guard<std::mutex> lock(_loadingImageMutex);
+        ++_loadingImageCount;
+    }
+    FileUtils::getInstance()->addIOTask([this, data]() {
+        loadImage(data);
+    });
 }
 
-void TextureCache::loadImage()
+void TextureCache::loadImage(AsyncStruct* asyncStruct)
 {
-    AsyncStruct *asyncStruct = nullptr;
-
-    while (true)
+    Image *image = nullptr;
     {
-        std::queue<AsyncStruct*> *pQueue = _asyncStructQueue;
-        _asyncStructQueueMutex.lock();
-        if (pQueue->empty())
-        {
-            _asyncStructQueueMutex.unlock();
-            if (_needQuit) {
-                break;
-            }
-            else {
-                std::unique_lock<std::mutex> lk(_sleepMutex);
-                _sleepCondition.wait(lk);
-                continue;
-            }
-        }
-        else
-        {
-            asyncStruct = pQueue->front();
-            pQueue->pop();
-            _asyncStructQueueMutex.unlock();
-        }        
-
-        Image *image = nullptr;
-        bool generateImage = false;
-
-        auto it = _textures.find(asyncStruct->filename);
-        if( it == _textures.end() )
+        CC_PROFILE_SCOPE("TextureCache::loadImage", "loaders");
+        const std::string& filename = asyncStruct->filename;
+        // generate image. A file requested twice before its texture is added is decoded twice,
+        // addImageAsyncCallBack keeps the first texture
+        image = new Image();
+        image->setTargetPixelFormat(asyncStruct->pixelFormat);
+        if (image && !image->initWithImageFileThreadSafe(filename))
         {
-           _imageInfoMutex.lock();
-           ImageInfo *imageInfo;
-           size_t pos = 0;
-           size_t infoSize = _imageInfoQueue->size();
-           for (; pos < infoSize; pos++)
-           {
-               imageInfo = (*_imageInfoQueue)[pos];
-               if(imageInfo->asyncStruct->filename.compare(asyncStruct->filename))
-                   break;
-           }
-           _imageInfoMutex.unlock();
-           if(infoSize == 0 || pos < infoSize)
-               generateImage = true;
+            // still queued without an image, so the callback is called with nullptr
+            CC_SAFE_RELEASE_NULL(image);
+            CCLOG("can not load %s", filename.c_str());
         }
+    }
 
-        if (generateImage)
-        {
-            const std::string& filename = asyncStruct->filename;
-            // generate image      
-            image = new Image();
-            if (image && !image->initWithImageFileThreadSafe(filename))
-            {
-                CC_SAFE_RELEASE(image);
-                CCLOG("can not load %s", filename.c_str());
-                continue;
-            }
-        }    
+    // generate image info
+    ImageInfo *imageInfo = new ImageInfo();
+    imageInfo->asyncStruct = asyncStruct;
+    imageInfo->image = image;
 
-        // generate image info
-        ImageInfo *imageInfo = new ImageInfo();
-        imageInfo->asyncStruct = asyncStruct;
-        imageInfo->image = image;
+    // put the image info into the queue
+    _imageInfoMutex.lock();
+    _imageInfoQueue->push_back(imageInfo);
+    _imageInfoMutex.unlock();
 
-        // put the image info into the queue
-        _imageInfoMutex.lock();
-        _imageInfoQueue->push_back(imageInfo);
-        _imageInfoMutex.unlock();
-    }
-    
-	if(_asyncStructQueue != nullptr)
     {
-        delete _asyncStructQueue;
-	    _asyncStructQueue = nullptr;
-        delete _imageInfoQueue;
-	    _imageInfoQueue = nullptr;
+        std::lock_guard<std::mutex> lock(_loadingImageMutex);
+        --_loadingImageCount;
     }
+    _loadingImageCondition.notify_all();
 }
 
 void TextureCache::addImageAsyncCallBack(float dt)
@@ -242,29 +222,34 @@ void TextureCache::addImageAsyncCallBack(float dt)
         const std::string& filename = asyncStruct->filename;
 
         Texture2D *texture = nullptr;
-        if (image)
+        auto it = _textures.find(filename);
+        if (it != _textures.end())
         {
+            // added since it was requested, by addImage or an earlier request
+            texture = it->second;
+        }
+        else if (image)
+        {
+            CC_PROFILE_SCOPE("TextureCache::uploadTexture", "loaders");
             // generate texture in render thread
             texture = new Texture2D();
 
-            texture->initWithImage(image);
+            if (! initWithImageProgressively(texture, image))
+            {
+                texture->initWithImage(image, asyncStruct->pixelFormat);
+            }
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
             // cache the texture file name
             VolatileTextureMgr::addImageTexture(texture, filename);
 #endif
             // cache the texture. retain it, since it is added in the map
+            texture->_residencyFile = filename;
             _textures.insert( std::make_pair(filename, texture) );
             texture->retain();
 
             texture->autorelease();
         }
-        else
-        {
-            auto it = _textures.find(asyncStruct->filename);
-            if(it != _textures.end())
-                texture = it->second;
-        }
         
         asyncStruct->callback(texture);
         if(image)
@@ -307,18 +292,20 @@ Texture2D * TextureCache::addImage(const std::string &path)
             image = new Image();
             CC_BREAK_IF(nullptr == image);
 
+            image->setTargetPixelFormat(Texture2D::getDefaultAlphaPixelFormat());
             bool bRet = image->initWithImageFile(fullpath);
             CC_BREAK_IF(!bRet);
 
             texture = new Texture2D();
 
-            if( texture && texture->initWithImage(image) )
+            if( texture && (initWithImageProgressively(texture, image) || texture->initWithImage(image)) )
             {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
                 // cache the texture file name
                 VolatileTextureMgr::addImageTexture(texture, fullpath);
 #endif
                 // texture already retained, no need to re-retain it
+                texture->_residencyFile = fullpath;
                 _textures.insert( std::make_pair(fullpath, texture) );
             }
             else
@@ -398,6 +385,7 @@ bool TextureCache::reloadTexture(const std::string& fileName)
             Image* image = new Image();
             CC_BREAK_IF(nullptr == image);
 
+            image->setTargetPixelFormat(Texture2D::getDefaultAlphaPixelFormat());
             bool bRet = image->initWithImageFile(fullpath);
             CC_BREAK_IF(!bRet);
             
@@ -492,10 +480,323 @@ void TextureCache::reloadAllTextures()
 
 void TextureCache::waitForQuit()
 {
-    // notify sub thread to quick
-    _needQuit = true;
-    _sleepCondition.notify_one();
-    if (_loadingThread) _loadingThread->join();
+    // the images being decoded use this cache, the ones decoded are released by the destructor
+    std::unique_lock<std::mutex> lock(_loadingImageMutex);
+    _loadingImageCondition.wait(lock, [this]{ return _loadingImageCount == 0; });
+}
+
+// TextureCache - Residency
+
+void TextureCache::setMemoryBudget(size_t bytes)
+{
+    auto scheduler = Director::getInstance()->getScheduler();
+    if (bytes > 0 && _memoryBudget == 0)
+    {
+        scheduler->schedule(schedule_selector(TextureCache::updateResidency), this, 0, false);
+    }
+    else if (bytes == 0 && _memoryBudget > 0)
+    {
+        scheduler->unschedule(schedule_selector(TextureCache::updateResidency), this);
+    }
+    _memoryBudget = bytes;
+}
+
+size_t TextureCache::getResidentMemorySize() const
+{
+    size_t bytes = 0;
+    for (auto it = _textures.begin(); it != _textures.end(); ++it)
+    {
+        bytes += it->second->getMemorySize();
+    }
+    return bytes;
+}
+
+void TextureCache::updateResidency(float dt)
+{
+    evictTextures(_memoryBudget);
+}
+
+size_t TextureCache::evictTextures(size_t targetBytes)
+{
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    size_t residentBytes = 0;
+    std::vector<Texture2D*> candidates;
+
+    for (auto it = _textures.begin(); it != _textures.end(); ++it)
+    {
+        Texture2D* texture = it->second;
+        residentBytes += texture->getMemorySize();
+
+        // a texture drawn in the last frame will most likely be drawn in this one too
+        if (texture->_name != 0 && !texture->_residencyFile.empty() && texture->_lastUsedFrame + 1 < frame)
+        {
+            candidates.push_back(texture);
+        }
+    }
+
+    if (residentBytes <= targetBytes)
+    {
+        return 0;
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Texture2D* a, const Texture2D* b) {
+        if (a->_residencyPriority != b->_residencyPriority)
+        {
+            return a->_residencyPriority < b->_residencyPriority;
+        }
+        return a->_lastUsedFrame < b->_lastUsedFrame;
+    });
+
+    size_t releasedBytes = 0;
+    for (auto texture : candidates)
+    {
+        if (residentBytes - releasedBytes <= targetBytes)
+        {
+            break;
+        }
+
+        CCLOG("cocos2d: TextureCache: evicting texture: %s", texture->_residencyFile.c_str());
+        releasedBytes += texture->getMemorySize();
+
+        // keep the Texture2D, the nodes using it don't know it was evicted
+        GL::deleteTexture(texture->_name);
+        texture->_name = 0;
+        texture->_evicted = true;
+        ++_evictionCount;
+    }
+
+    return releasedBytes;
+}
+
+void TextureCache::applyTexParameters(Texture2D* texture, const Texture2D::TexParams& texParams)
+{
+    // initializing a texture resets them to the default filters and GL_CLAMP_TO_EDGE
+    const Texture2D::TexParams& current = texture->_texParams;
+    if (texParams.minFilter != current.minFilter || texParams.magFilter != current.magFilter
+        || texParams.wrapS != current.wrapS || texParams.wrapT != current.wrapT)
+    {
+        GL::bindTexture2D(texture->_name);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texParams.minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texParams.magFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texParams.wrapS);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texParams.wrapT);
+        texture->_texParams = texParams;
+    }
+}
+
+void TextureCache::reloadEvictedTexture(Texture2D* texture)
+{
+    CCASSERT(texture && texture->_evicted, "TextureCache: the texture wasn't evicted");
+
+    bool hasMipmaps = texture->_hasMipmaps;
+    Texture2D::TexParams texParams = texture->_texParams;
+
+    Image* image = new Image();
+    image->setTargetPixelFormat(texture->_pixelFormat);
+    if (image->initWithImageFile(texture->_residencyFile))
+    {
+        // use the pixel format it was converted to the first time
+        if (image->isCompressed() || image->getNumberOfMipmaps() > 1)
+        {
+            texture->initWithImage(image);
+        }
+        else
+        {
+            texture->initWithImage(image, texture->_pixelFormat);
+        }
+
+        if (hasMipmaps && !texture->_hasMipmaps)
+        {
+            texture->generateMipmap();
+        }
+
+        applyTexParameters(texture, texParams);
+
+        ++_reloadCount;
+    }
+    else
+    {
+        // don't try again every time the texture is used
+        CCLOG("cocos2d: TextureCache: can't reload evicted texture: %s", texture->_residencyFile.c_str());
+        texture->_evicted = false;
+    }
+    image->release();
+}
+
+// TextureCache - Mipmap streaming
+
+// the first level uploaded by the progressive loading is the largest one that fits in this size
+static const int MIPMAP_STREAMING_FIRST_LEVEL_SIZE = 128;
+// seconds the decoded levels of a texture are kept once it has the levels it's drawn with
+static const float MIPMAP_STREAMING_KEEP_IMAGE_TIME = 2.0f;
+
+bool TextureCache::initWithImageProgressively(Texture2D* texture, Image* image)
+{
+    int levels = image->getNumberOfMipmaps();
+    if (! _progressiveMipmapLoading || levels <= 1)
+    {
+        return false;
+    }
+
+    int width = image->getWidth();
+    int height = image->getHeight();
+    int baseLevel = 0;
+    while (baseLevel < levels - 1 && MAX(width >> baseLevel, height >> baseLevel) > MIPMAP_STREAMING_FIRST_LEVEL_SIZE)
+    {
+        ++baseLevel;
+    }
+
+    if (! texture->initWithMipmapsFromLevel(image->getMipmaps(), levels, image->getRenderFormat(), width, height, baseLevel))
+    {
+        return false;
+    }
+
+    if (baseLevel > 0)
+    {
+        // keep the decoded levels until all of them are uploaded
+        if (_streamingTextures.empty())
+        {
+            Director::getInstance()->getScheduler()->schedule(schedule_selector(TextureCache::updateMipmapStreaming), this, 0, false);
+        }
+        image->retain();
+        texture->retain();
+        _streamingTextures.push_back({texture, image, 0.0f});
+    }
+    return true;
+}
+
+void TextureCache::updateMipmapStreaming(float dt)
+{
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    size_t uploadedBytes = 0;
+
+    // uploads the levels from level down, returns false if the texture can't be initialized with them
+    auto uploadLevels = [&uploadedBytes](Texture2D* texture, Image* image, int level) {
+        int levels = image->getNumberOfMipmaps();
+        MipmapInfo* mipmaps = image->getMipmaps();
+
+        Texture2D::TexParams texParams = texture->_texParams;
+        if (! texture->initWithMipmapsFromLevel(mipmaps, levels, image->getRenderFormat(), image->getWidth(), image->getHeight(), level))
+        {
+            return false;
+        }
+        applyTexParameters(texture, texParams);
+        for (int i = level; i < levels; ++i)
+        {
+            uploadedBytes += mipmaps[i].len;
+        }
+        return true;
+    };
+
+    for (auto it = _streamingTextures.begin(); it != _streamingTextures.end(); /* nothing */)
+    {
+        Texture2D* texture = it->texture;
+
+        // nobody else uses it, or it was evicted or initialized again
+        bool done = texture->getReferenceCount() == 1 || texture->_evicted || texture->_baseMipLevel == 0;
+
+        if (! done)
+        {
+            // Levels larger than the size it was drawn at in the last frame are not needed.
+            // Textures not drawn by a Sprite get all their levels.
+            int neededLevel = 0;
+            if (texture->_drawnScaleFrame + 1 >= frame && texture->_drawnScale > 0)
+            {
+                neededLevel = MAX((int)floorf(-log2f(texture->_drawnScale)), 0);
+            }
+
+            if (texture->_baseMipLevel > neededLevel)
+            {
+                if (uploadedBytes < _mipmapUploadBudget)
+                {
+                    if (! it->image)
+                    {
+                        // the decoded levels were released, it's drawn larger now
+                        Image* image = new Image();
+                        image->setTargetPixelFormat(texture->_pixelFormat);
+                        if (image->initWithImageFile(texture->_residencyFile) && image->getNumberOfMipmaps() > texture->_baseMipLevel)
+                        {
+                            it->image = image;
+                        }
+                        else
+                        {
+                            image->release();
+                        }
+                    }
+
+                    done = ! it->image || ! uploadLevels(texture, it->image, texture->_baseMipLevel - 1);
+                    it->idleTime = 0;
+                }
+            }
+            else if (it->image)
+            {
+                // It has the levels it's drawn with. Keep the decoded ones for a while in case it's drawn
+                // larger, then release them. The file is decoded again if it's needed.
+                it->idleTime += dt;
+                if (it->idleTime >= MIPMAP_STREAMING_KEEP_IMAGE_TIME)
+                {
+                    if (texture->_residencyFile.empty())
+                    {
+                        // it can't be decoded again, give it all its levels like a texture that isn't streamed
+                        uploadLevels(texture, it->image, 0);
+                        done = true;
+                    }
+                    else
+                    {
+                        it->image->release();
+                        it->image = nullptr;
+                    }
+                }
+            }
+
+            done = done || texture->_baseMipLevel == 0;
+        }
+
+        if (done)
+        {
+            CC_SAFE_RELEASE(it->image);
+            texture->release();
+            it = _streamingTextures.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (_streamingTextures.empty())
+    {
+        Director::getInstance()->getScheduler()->unschedule(schedule_selector(TextureCache::updateMipmapStreaming), this);
+    }
+}
+
+std::string TextureCache::getResidencyInfo() const
+{
+    unsigned int residentCount = 0;
+    unsigned int evictedCount = 0;
+    size_t residentBytes = 0;
+
+    for (auto it = _textures.begin(); it != _textures.end(); ++it)
+    {
+        Texture2D* texture = it->second;
+        if (texture->_evicted)
+        {
+            evictedCount++;
+        }
+        else
+        {
+            residentCount++;
+            residentBytes += texture->getMemorySize();
+        }
+    }
+
+    return StringUtils::format("TextureCache residency: budget %lu KB, %u resident textures for %lu KB, %u evicted textures, %u evictions, %u reloads\n",
+                               (unsigned long)_memoryBudget / 1024,
+                               residentCount,
+                               (unsigned long)residentBytes / 1024,
+                               evictedCount,
+                               _evictionCount,
+                               _reloadCount);
 }
 
 std::string TextureCache::getCachedTextureInfo() const
@@ -504,7 +805,7 @@ std::string TextureCache::getCachedTextureInfo() const
     char buftmp[4096];
 
     unsigned int count = 0;
-    unsigned int totalBytes = 0;
+    size_t totalBytes = 0;
 
     for( auto it = _textures.begin(); it != _textures.end(); ++it ) {
 
@@ -513,24 +814,26 @@ std::string TextureCache::getCachedTextureInfo() const
 
         Texture2D* tex = it->second;
         unsigned int bpp = tex->getBitsPerPixelForFormat();
-        // Each texture takes up width * height * bytesPerPixel bytes.
-        auto bytes = tex->getPixelsWide() * tex->getPixelsHigh() * bpp / 8;
+        // Evicted textures don't use any video memory
+        auto bytes = tex->getMemorySize();
         totalBytes += bytes;
         count++;
-        snprintf(buftmp,sizeof(buftmp)-1,"\"%s\" rc=%lu id=%lu %lu x %lu @ %ld bpp => %lu KB\n",
+        snprintf(buftmp,sizeof(buftmp)-1,"\"%s\" rc=%lu id=%lu %lu x %lu @ %ld bpp => %lu KB%s\n",
                it->first.c_str(),
                (long)tex->getReferenceCount(),
-               (long)tex->getName(),
+               (long)tex->_name,
                (long)tex->getPixelsWide(),
                (long)tex->getPixelsHigh(),
                (long)bpp,
-               (long)bytes / 1024);
+               (long)bytes / 1024,
+               tex->_evicted ? " (evicted)" : "");
         
         buffer += buftmp;
     }
 
     snprintf(buftmp, sizeof(buftmp)-1, "TextureCache dumpDebugInfo: %ld textures, for %lu KB (%.2f MB)\n", (long)count, (long)totalBytes / 1024, totalBytes / (1024.0f*1024.0f));
     buffer += buftmp;
+    buffer += getResidencyInfo();
 
     return buffer;
 }
@@ -687,6 +990,7 @@ void VolatileTextureMgr::reloadAllTextures()
         case VolatileTexture::kImageFile:
             {
                 Image* image = new Image();
+                image->setTargetPixelFormat(vt->_pixelFormat);
                 
                 Data data = FileUtils::getInstance()->getDataFromFile(vt->_fileName);
                 
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include <queue>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <functional>
 
 #include "base/CCRef.h"
@@ -112,8 +113,9 @@ public:
 
     /* Returns a Texture2D object given a file image
     * If the file image was not previously loaded, it will create a new Texture2D object and it will return it.
-    * Otherwise it will load a texture in a new thread, and when the image is loaded, the callback will be called with the Texture2D as a parameter.
+    * Otherwise it will load a texture on an I/O thread of FileUtils (see FileUtils::addIOTask), and when the image is loaded, the callback will be called with the Texture2D as a parameter.
     * The callback will be called from the main thread, so it is safe to create any cocos2d object from the callback.
+    * If the image can't be loaded, the callback is called with nullptr.
     * Supported image extensions: .png, .jpg
     * @since v0.8
     */
@@ -173,47 +175,117 @@ public:
     */
     std::string getCachedTextureInfo() const;
 
+    /** Sets the video memory budget of the cached textures, in bytes. 0 means no budget, which is the default.
+    * Once per frame, if the textures use more memory than the budget, the GL textures of the least recently
+    * used ones are deleted until they fit. Lower residency priorities are evicted first.
+    * Evicted textures stay in the cache and are loaded again from their file the next time they are drawn.
+    * Only textures loaded from a file can be evicted, and the ones drawn in the last frame are kept.
+    * @since v3.1
+    */
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const { return _memoryBudget; }
+
+    /** Returns the number of bytes of video memory used by the cached textures
+    * @since v3.1
+    */
+    size_t getResidentMemorySize() const;
+
+    /** Evicts the least recently used textures until the cached textures use at most targetBytes.
+    * Returns the number of bytes released.
+    * @since v3.1
+    */
+    size_t evictTextures(size_t targetBytes);
+
+    /** Loads an evicted texture again. Called by Texture2D when the name of an evicted texture is used.
+    * @js NA
+    * @lua NA
+    */
+    void reloadEvictedTexture(Texture2D* texture);
+
+    /** Enables or disables progressive loading of images with mipmaps, like PVR files with a mipmap chain.
+    * When it's enabled addImage and addImageAsync only upload a small mipmap level, so the texture can be drawn
+    * right away. Larger levels are uploaded in the following frames, within the mipmap upload budget.
+    * Levels larger than the size Sprites draw the texture at are not uploaded. The decoded levels are released
+    * a couple of seconds after the texture has the ones it's drawn with, the file is decoded again if it's drawn larger.
+    * Disabled by default.
+    * @since v3.1
+    */
+    void setProgressiveMipmapLoading(bool enabled) { _progressiveMipmapLoading = enabled; }
+    bool isProgressiveMipmapLoading() const { return _progressiveMipmapLoading; }
+
+    /** Sets the number of bytes of mipmap levels uploaded per frame by the progressive loading. Defaults to 1 MB.
+    * At least one level is uploaded every frame.
+    * @since v3.1
+    */
+    void setMipmapUploadBudget(size_t bytesPerFrame) { _mipmapUploadBudget = bytesPerFrame; }
+    size_t getMipmapUploadBudget() const { return _mipmapUploadBudget; }
+
+    /** Returns the memory budget, the resident and evicted textures, and the number of evictions and reloads
+    * @since v3.1
+    */
+    std::string getResidencyInfo() const;
+
     //wait for texture cahe to quit befor destroy instance
     //called by director, please do not called outside
     void waitForQuit();
 
 private:
     void addImageAsyncCallBack(float dt);
-    void loadImage();
+    void updateResidency(float dt);
+    bool initWithImageProgressively(Texture2D* texture, Image* image);
+    void updateMipmapStreaming(float dt);
+    static void applyTexParameters(Texture2D* texture, const Texture2D::TexParams& texParams);
 
 public:
     struct AsyncStruct
     {
     public:
-        AsyncStruct(const std::string& fn, std::function<void(Texture2D*)> f) : filename(fn), callback(f) {}
+        AsyncStruct(const std::string& fn, std::function<void(Texture2D*)> f) : filename(fn), callback(f), pixelFormat(Texture2D::getDefaultAlphaPixelFormat()) {}
 
         std::string filename;
         std::function<void(Texture2D*)> callback;
+        // the default alpha pixel format when the image was requested
+        Texture2D::PixelFormat pixelFormat;
     };
 
 protected:
+    // decodes an image on an I/O thread
+    void loadImage(AsyncStruct* asyncStruct);
+
     typedef struct _ImageInfo
     {
         AsyncStruct *asyncStruct;
         Image        *image;
     } ImageInfo;
     
-    std::thread* _loadingThread;
-
-    std::queue<AsyncStruct*>* _asyncStructQueue;
     std::deque<ImageInfo*>* _imageInfoQueue;
 
-    std::mutex _asyncStructQueueMutex;
     std::mutex _imageInfoMutex;
 
-    std::mutex _sleepMutex;
-    std::condition_variable _sleepCondition;
-
-    bool _needQuit;
+    // the images being loaded by the I/O threads of FileUtils, waited for by waitForQuit()
+    int _loadingImageCount;
+    std::mutex _loadingImageMutex;
+    std::condition_variable _loadingImageCondition;
 
     int _asyncRefCount;
 
     std::unordered_map<std::string, Texture2D*> _textures;
+
+    size_t _memoryBudget;
+    unsigned int _evictionCount;
+    unsigned int _reloadCount;
+
+    struct StreamingTexture
+    {
+        Texture2D* texture;
+        // the decoded levels, nullptr once they were kept long enough without being needed
+        Image* image;
+        // seconds since a level was last uploaded
+        float idleTime;
+    };
+    std::vector<StreamingTexture> _streamingTextures;
+    bool _progressiveMipmapLoading;
+    size_t _mipmapUploadBudget;
 };
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
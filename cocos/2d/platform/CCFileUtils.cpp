@@ -27,10 +27,25 @@ THE SOFTWARE.
 #include "base/CCData.h"
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
+#include "base/CCScheduler.h"
 #include "CCSAXParser.h"
 #include "tinyxml2.h"
+#include "base/ZipUtils.h"
 #include "unzip.h"
 #include <stack>
+#include <queue>
+#include <algorithm>
+#include <thread>
+#include <condition_variable>
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
+#define CC_FILEUTILS_USE_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 using namespace std;
 
@@ -93,7 +108,7 @@ public:
         parser.setDelegator(this);
 
         parser.parse(fileName);
-		return _rootDict;
+		return std::move(_rootDict);
     }
 
     ValueVector arrayWithContentsOfFile(const std::string& fileName)
@@ -105,7 +120,7 @@ public:
         parser.setDelegator(this);
 
         parser.parse(fileName);
-		return _rootArray;
+		return std::move(_rootArray);
     }
 
     void startElement(void *ctx, const char *name, const char **atts)
@@ -280,12 +295,11 @@ public:
         }
 
         SAXState curState = _stateStack.empty() ? SAX_DICT : _stateStack.top();
-        const std::string text = std::string((char*)ch,0,len);
 
         switch(_state)
         {
         case SAX_KEY:
-            _curKey = text;
+            _curKey.assign(ch, len);
             break;
         case SAX_INT:
         case SAX_REAL:
@@ -296,7 +310,7 @@ public:
                     CCASSERT(!_curKey.empty(), "key not found : <integer/real>");
                 }
                 
-                _curValue.append(text);
+                _curValue.append(ch, len);
             }
             break;
         default:
@@ -469,20 +483,143 @@ bool FileUtils::writeToFile(ValueMap& dict, const std::string &fullPath) {return
 #endif /* (CC_TARGET_PLATFORM != CC_PLATFORM_IOS) && (CC_TARGET_PLATFORM != CC_PLATFORM_MAC) */
 
 
+class FileUtils::IOThreadPool
+{
+public:
+    // tasks waiting beyond this run on the thread adding them
+    static const size_t MAX_PENDING_TASKS = 256;
+
+    explicit IOThreadPool(int threadCount)
+    : _sequence(0)
+    , _quit(false)
+    {
+        for (int i = 0; i < threadCount; ++i)
+        {
+            _threads.push_back(std::thread(&IOThreadPool::loop, this));
+        }
+    }
+
+    ~IOThreadPool()
+    {
+        quit();
+    }
+
+    // push() fails from now on, the tasks still waiting are run first, so their callbacks are
+    // queued and their futures are set
+    void quit()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _quit = true;
+        }
+        _condition.notify_all();
+
+        for (auto& thread : _threads)
+        {
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+    }
+
+    bool push(const std::function<void()>& function, int priority)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_quit || _tasks.size() >= MAX_PENDING_TASKS)
+            {
+                return false;
+            }
+
+            Task task;
+            task.priority = priority;
+            task.sequence = _sequence++;
+            task.function = function;
+            _tasks.push(task);
+        }
+        _condition.notify_one();
+        return true;
+    }
+
+private:
+    struct Task
+    {
+        int priority;
+        unsigned long long sequence;
+        std::function<void()> function;
+
+        // the top of the queue is the highest priority, then the oldest task
+        bool operator<(const Task& other) const
+        {
+            return priority != other.priority ? priority < other.priority : sequence > other.sequence;
+        }
+    };
+
+    void loop()
+    {
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _condition.wait(lock, [this]{ return _quit || !_tasks.empty(); });
+                if (_tasks.empty())
+                {
+                    // quitting and drained
+                    return;
+                }
+                task = _tasks.top();
+                _tasks.pop();
+            }
+            task.function();
+        }
+    }
+
+    std::vector<std::thread> _threads;
+    std::priority_queue<Task> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    unsigned long long _sequence;
+    bool _quit;
+};
+
 FileUtils* FileUtils::s_sharedFileUtils = nullptr;
 
 
 void FileUtils::destroyInstance()
 {
+    if (s_sharedFileUtils)
+    {
+        // the pool is drained before the platform subclass is destroyed, since its tasks read files through it.
+        // Tasks added meanwhile run on the thread adding them, so the lock isn't held while it is drained.
+        IOThreadPool* ioThreadPool = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(s_sharedFileUtils->_ioThreadPoolMutex);
+            ioThreadPool = s_sharedFileUtils->_ioThreadPool;
+        }
+        if (ioThreadPool)
+        {
+            ioThreadPool->quit();
+        }
+        {
+            std::lock_guard<std::mutex> lock(s_sharedFileUtils->_ioThreadPoolMutex);
+            s_sharedFileUtils->_ioThreadPool = nullptr;
+        }
+        delete ioThreadPool;
+    }
     CC_SAFE_DELETE(s_sharedFileUtils);
 }
 
 FileUtils::FileUtils()
+: _ioThreadPool(nullptr)
+, _ioThreadCount(2)
 {
 }
 
 FileUtils::~FileUtils()
 {
+    CC_SAFE_DELETE(_ioThreadPool);
 }
 
 
@@ -495,7 +632,14 @@ bool FileUtils::init()
 
 void FileUtils::purgeCachedEntries()
 {
+    clearLookupCaches();
+}
+
+void FileUtils::clearLookupCaches()
+{
+    std::lock_guard<std::mutex> lock(_cacheMutex);
     _fullPathCache.clear();
+    _notFoundFileCache.clear();
 }
 
 static Data getData(const std::string& filename, bool forString)
@@ -518,6 +662,11 @@ static Data getData(const std::string& filename, bool forString)
     {
         // Read the file from hardware
         std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
+        if (FileUtils::getInstance()->getFileDataFromArchive(fullPath, forString, &buffer, &size))
+        {
+            break;
+        }
+
         FILE *fp = fopen(fullPath.c_str(), mode);
         CC_BREAK_IF(!fp);
         fseek(fp,0,SEEK_END);
@@ -567,6 +716,142 @@ Data FileUtils::getDataFromFile(const std::string& filename)
     return getData(filename, false);
 }
 
+void FileUtils::setIOThreadCount(int count)
+{
+    std::lock_guard<std::mutex> lock(_ioThreadPoolMutex);
+    CCASSERT(_ioThreadPool == nullptr, "setIOThreadCount must be called before the first I/O task");
+    _ioThreadCount = std::max(count, 1);
+}
+
+void FileUtils::addIOTask(const std::function<void()>& task, int priority)
+{
+    {
+        std::lock_guard<std::mutex> lock(_ioThreadPoolMutex);
+        if (_ioThreadPool == nullptr)
+        {
+            _ioThreadPool = new IOThreadPool(_ioThreadCount);
+        }
+        if (_ioThreadPool->push(task, priority))
+        {
+            return;
+        }
+    }
+
+    // the queue is full, the caller waits for its own read
+    task();
+}
+
+void FileUtils::getDataFromFileAsync(const std::string& filename, const std::function<void(Data)>& callback, int priority)
+{
+    addIOTask([this, filename, callback](){
+        auto data = std::make_shared<Data>(getDataFromFile(filename));
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([data, callback](){
+            callback(std::move(*data));
+        });
+    }, priority);
+}
+
+std::future<Data> FileUtils::getDataFromFileFuture(const std::string& filename, int priority)
+{
+    auto promise = std::make_shared<std::promise<Data>>();
+    addIOTask([this, filename, promise](){
+        promise->set_value(getDataFromFile(filename));
+    }, priority);
+    return promise->get_future();
+}
+
+void FileUtils::getStringFromFileAsync(const std::string& filename, const std::function<void(std::string)>& callback, int priority)
+{
+    addIOTask([this, filename, callback](){
+        auto content = std::make_shared<std::string>(getStringFromFile(filename));
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([content, callback](){
+            callback(std::move(*content));
+        });
+    }, priority);
+}
+
+void FileUtils::getValueMapFromFileAsync(const std::string& filename, const std::function<void(ValueMap)>& callback, int priority)
+{
+    addIOTask([this, filename, callback](){
+        auto dict = std::make_shared<ValueMap>(getValueMapFromFile(filename));
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([dict, callback](){
+            callback(std::move(*dict));
+        });
+    }, priority);
+}
+
+#if CC_FILEUTILS_USE_MMAP
+// maps size bytes at offset of the file, the whole file if size is -1
+static bool mapFile(const std::string& path, off_t offset, ssize_t size, Data* data)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    if (size < 0)
+    {
+        struct stat st;
+        size = fstat(fd, &st) == 0 ? st.st_size : 0;
+    }
+
+    // mmap wants the offset page aligned
+    static const off_t pageSize = sysconf(_SC_PAGESIZE);
+    off_t alignedOffset = offset - offset % pageSize;
+    size_t mappedSize = size + (offset - alignedOffset);
+
+    // private and writable, a decoder working in place only touches its own copy of the pages
+    void* mapped = MAP_FAILED;
+    if (size > 0)
+    {
+        mapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, alignedOffset);
+    }
+    close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        return false;
+    }
+
+    data->fastSet((unsigned char*)mapped + (offset - alignedOffset), size, [mapped, mappedSize](unsigned char*, ssize_t){
+        munmap(mapped, mappedSize);
+    });
+    return true;
+}
+#endif
+
+Data FileUtils::getMappedDataFromFile(const std::string& filename)
+{
+#if CC_FILEUTILS_USE_MMAP
+    if (filename.empty())
+    {
+        return Data::Null;
+    }
+
+    Data ret;
+    const std::string fullPath = fullPathForFilename(filename);
+
+    std::string entryName;
+    if (const SearchArchive* archive = findSearchArchive(fullPath, &entryName))
+    {
+        ssize_t offset = 0;
+        ssize_t size = 0;
+        if (archive->zipFile->getStoredFileRange(entryName, &offset, &size)
+            && mapFile(archive->searchPath.substr(0, archive->searchPath.length() - 1), offset, size, &ret))
+        {
+            return ret;
+        }
+    }
+    else if (isAbsolutePath(fullPath) && mapFile(fullPath, 0, -1, &ret))
+    {
+        return ret;
+    }
+#endif
+
+    return getDataFromFile(filename);
+}
+
 unsigned char* FileUtils::getFileData(const std::string& filename, const char* mode, ssize_t *size)
 {
     unsigned char * buffer = nullptr;
@@ -576,6 +861,11 @@ unsigned char* FileUtils::getFileData(const std::string& filename, const char* m
     {
         // read the file from hardware
         const std::string fullPath = fullPathForFilename(filename);
+        if (getFileDataFromArchive(fullPath, false, &buffer, size))
+        {
+            break;
+        }
+
         FILE *fp = fopen(fullPath.c_str(), mode);
         CC_BREAK_IF(!fp);
         
@@ -603,6 +893,15 @@ unsigned char* FileUtils::getFileDataFromZip(const std::string& zipFilePath, con
     unzFile file = nullptr;
     *size = 0;
 
+    // a package added by addSearchArchive is already open and indexed
+    for (const auto& archive : _searchArchives)
+    {
+        if (archive.searchPath.compare(0, archive.searchPath.length() - 1, zipFilePath) == 0)
+        {
+            return archive.zipFile->getFileData(filename, size);
+        }
+    }
+
     do 
     {
         CC_BREAK_IF(zipFilePath.empty());
@@ -665,6 +964,38 @@ std::string FileUtils::getPathForFilename(const std::string& filename, const std
         file_path = filename.substr(0, pos+1);
         file = filename.substr(pos+1);
     }
+
+    // the search path of a package, look the file up in its index instead of the file system
+    for (const auto& archive : _searchArchives)
+    {
+        if (archive.searchPath == searchPath)
+        {
+            std::string entry = file_path + resolutionDirectory;
+            if (!entry.empty() && entry[entry.length()-1] != '/')
+            {
+                entry += '/';
+            }
+            entry += file;
+
+            return archive.zipFile->fileExists(archive.entryPrefix + entry) ? searchPath + entry : "";
+        }
+    }
+
+    // the file index answers for the folders it covers without touching the file system
+    if (!_fileIndexRoots.empty())
+    {
+        std::string candidate = searchPath + file_path + resolutionDirectory;
+        if (!candidate.empty() && candidate[candidate.length()-1] != '/')
+        {
+            candidate += '/';
+        }
+        candidate += file;
+
+        if (isPathInFileIndex(candidate))
+        {
+            return _fileIndex.find(candidate) != _fileIndex.end() ? candidate : "";
+        }
+    }
     
     // searchPath + file_path + resourceDirectory
     std::string path = searchPath;
@@ -690,11 +1021,21 @@ std::string FileUtils::fullPathForFilename(const std::string &filename)
         return filename;
     }
 
-    // Already Cached ?
-    auto cacheIter = _fullPathCache.find(filename);
-    if( cacheIter != _fullPathCache.end() )
     {
-        return cacheIter->second;
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+
+        // Already Cached ?
+        auto cacheIter = _fullPathCache.find(filename);
+        if( cacheIter != _fullPathCache.end() )
+        {
+            return cacheIter->second;
+        }
+
+        // Already missed ?
+        if (_notFoundFileCache.find(filename) != _notFoundFileCache.end())
+        {
+            return filename;
+        }
     }
     
     // Get the new file name.
@@ -711,6 +1052,7 @@ std::string FileUtils::fullPathForFilename(const std::string &filename)
             if (fullpath.length() > 0)
             {
                 // Using the filename passed in as key.
+                std::lock_guard<std::mutex> lock(_cacheMutex);
                 _fullPathCache.insert(std::make_pair(filename, fullpath));
                 return fullpath;
             }
@@ -718,6 +1060,12 @@ std::string FileUtils::fullPathForFilename(const std::string &filename)
     }
     
     CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
+    // without an index the file may be written or downloaded later, so the miss isn't remembered
+    if (!_fileIndexRoots.empty())
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        _notFoundFileCache.insert(filename);
+    }
 
     // XXX: Should it return nullptr ? or an empty string ?
     // The file wasn't found, return the file name passed in.
@@ -732,7 +1080,7 @@ std::string FileUtils::fullPathFromRelativeFile(const std::string &filename, con
 void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& searchResolutionsOrder)
 {
     bool existDefault = false;
-    _fullPathCache.clear();
+    clearLookupCaches();
     _searchResolutionsOrderArray.clear();
     for(auto iter = searchResolutionsOrder.cbegin(); iter != searchResolutionsOrder.cend(); ++iter)
     {
@@ -762,6 +1110,10 @@ void FileUtils::addSearchResolutionsOrder(const std::string &order)
         resOrder.append("/");
         
     _searchResolutionsOrderArray.push_back(resOrder);
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        _notFoundFileCache.clear();
+    }
 }
 
 const std::vector<std::string>& FileUtils::getSearchResolutionsOrder()
@@ -778,7 +1130,7 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
 {
     bool existDefaultRootPath = false;
     
-    _fullPathCache.clear();
+    clearLookupCaches();
     _searchPathArray.clear();
     for (auto iter = searchPaths.cbegin(); iter != searchPaths.cend(); ++iter)
     {
@@ -820,11 +1172,305 @@ void FileUtils::addSearchPath(const std::string &searchpath)
         path += "/";
     }
     _searchPathArray.push_back(path);
+
+    // a file missed before may be in the new path
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        _notFoundFileCache.clear();
+    }
+}
+
+bool FileUtils::addSearchArchive(const std::string& archivePath, const std::string& entryPrefix, bool front)
+{
+    std::string fullPath = fullPathForFilename(archivePath);
+
+    std::shared_ptr<ZipFile> zipFile = std::make_shared<ZipFile>(fullPath, entryPrefix);
+    if (!zipFile->isOpen())
+    {
+        CCLOG("cocos2d: addSearchArchive: can't open %s", fullPath.c_str());
+        return false;
+    }
+
+    removeSearchArchive(fullPath);
+
+    SearchArchive archive;
+    archive.searchPath = fullPath + "/";
+    archive.entryPrefix = entryPrefix;
+    archive.zipFile = zipFile;
+    _searchArchives.push_back(archive);
+
+    if (front)
+    {
+        _searchPathArray.insert(_searchPathArray.begin(), archive.searchPath);
+    }
+    else
+    {
+        _searchPathArray.push_back(archive.searchPath);
+    }
+
+    // files found before may be shadowed by the package now
+    clearLookupCaches();
+    return true;
+}
+
+void FileUtils::removeSearchArchive(const std::string& archivePath)
+{
+    std::string searchPath = fullPathForFilename(archivePath) + "/";
+
+    for (auto iter = _searchArchives.begin(); iter != _searchArchives.end(); ++iter)
+    {
+        if (iter->searchPath == searchPath)
+        {
+            // Data mapped from the package by getMappedDataFromFile maps the archive file itself, it stays valid
+            _searchArchives.erase(iter);
+
+            auto pathIter = std::find(_searchPathArray.begin(), _searchPathArray.end(), searchPath);
+            if (pathIter != _searchPathArray.end())
+            {
+                _searchPathArray.erase(pathIter);
+            }
+            clearLookupCaches();
+            break;
+        }
+    }
+}
+
+const FileUtils::SearchArchive* FileUtils::findSearchArchive(const std::string& fullPath, std::string* entryName) const
+{
+    for (const auto& archive : _searchArchives)
+    {
+        if (fullPath.compare(0, archive.searchPath.length(), archive.searchPath) == 0)
+        {
+            if (entryName)
+            {
+                *entryName = archive.entryPrefix + fullPath.substr(archive.searchPath.length());
+            }
+            return &archive;
+        }
+    }
+    return nullptr;
+}
+
+bool FileUtils::getFileDataFromArchive(const std::string& fullPath, bool forString, unsigned char** buffer, ssize_t* size) const
+{
+    if (_searchArchives.empty())
+    {
+        return false;
+    }
+
+    std::string entryName;
+    const SearchArchive* archive = findSearchArchive(fullPath, &entryName);
+    if (archive == nullptr)
+    {
+        return false;
+    }
+
+    *buffer = nullptr;
+    *size = 0;
+
+    ssize_t storedSize = 0;
+    const unsigned char* stored = archive->zipFile->getStoredFileData(entryName, &storedSize);
+    if (stored)
+    {
+        *buffer = (unsigned char*)malloc(storedSize + (forString ? 1 : 0));
+        memcpy(*buffer, stored, storedSize);
+        *size = storedSize;
+    }
+    else
+    {
+        *buffer = archive->zipFile->getFileData(entryName, size);
+        if (*buffer && forString)
+        {
+            *buffer = (unsigned char*)realloc(*buffer, *size + 1);
+        }
+    }
+
+    if (*buffer && forString)
+    {
+        (*buffer)[*size] = '\0';
+    }
+    return true;
+}
+
+ssize_t FileUtils::buildFileIndex()
+{
+    clearFileIndex();
+
+    for (const auto& searchPath : _searchPathArray)
+    {
+        // packages have their own index, and a folder inside an indexed one is listed already
+        if (searchPath.empty() || !isAbsolutePath(searchPath)
+            || findSearchArchive(searchPath, nullptr) || isPathInFileIndex(searchPath))
+        {
+            continue;
+        }
+
+        if (addDirectoryToFileIndex(searchPath))
+        {
+            _fileIndexRoots.push_back(searchPath);
+        }
+    }
+
+    return _fileIndex.size();
+}
+
+bool FileUtils::loadFileIndex(const std::string& manifestFile)
+{
+    if (_defaultResRootPath.empty())
+    {
+        CCLOG("cocos2d: loadFileIndex: no default resource root path on this platform");
+        return false;
+    }
+
+    std::string content = getStringFromFile(manifestFile);
+    if (content.empty())
+    {
+        CCLOG("cocos2d: loadFileIndex: can't read %s", manifestFile.c_str());
+        return false;
+    }
+
+    std::string root = _defaultResRootPath;
+    if (root[root.length()-1] != '/')
+    {
+        root += '/';
+    }
+
+    size_t start = 0;
+    while (start < content.length())
+    {
+        size_t end = content.find('\n', start);
+        if (end == std::string::npos)
+        {
+            end = content.length();
+        }
+
+        std::string line = content.substr(start, end - start);
+        if (!line.empty() && line[line.length()-1] == '\r')
+        {
+            line.erase(line.length()-1);
+        }
+        if (line.compare(0, 2, "./") == 0)
+        {
+            line.erase(0, 2);
+        }
+        if (!line.empty())
+        {
+            _fileIndex.insert(root + line);
+        }
+
+        start = end + 1;
+    }
+
+    if (std::find(_fileIndexRoots.begin(), _fileIndexRoots.end(), root) == _fileIndexRoots.end())
+    {
+        _fileIndexRoots.push_back(root);
+    }
+
+    clearLookupCaches();
+    return true;
+}
+
+void FileUtils::clearFileIndex()
+{
+    _fileIndex.clear();
+    _fileIndexRoots.clear();
+
+    clearLookupCaches();
+}
+
+bool FileUtils::isPathInFileIndex(const std::string& fullPath) const
+{
+    for (const auto& root : _fileIndexRoots)
+    {
+        if (fullPath.compare(0, root.length(), root) == 0)
+        {
+            // the index only has plain paths, let the file system resolve the others
+            size_t from = root.length() - 1;
+            return fullPath.find("/./", from) == std::string::npos
+                && fullPath.find("/../", from) == std::string::npos
+                && fullPath.find("//", from) == std::string::npos;
+        }
+    }
+    return false;
+}
+
+bool FileUtils::addDirectoryToFileIndex(const std::string& directory)
+{
+#if CC_FILEUTILS_USE_MMAP
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        return false;
+    }
+
+    while (struct dirent* entry = readdir(dir))
+    {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+        {
+            continue;
+        }
+
+        std::string path = directory + entry->d_name;
+        bool isDirectory = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK)
+        {
+            struct stat st;
+            isDirectory = stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+        }
+
+        if (isDirectory)
+        {
+            addDirectoryToFileIndex(path + "/");
+        }
+        else
+        {
+            _fileIndex.insert(path);
+        }
+    }
+    closedir(dir);
+    return true;
+#elif CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+    WCHAR pattern[MAX_PATH] = {0};
+    MultiByteToWideChar(CP_UTF8, 0, (directory + "*").c_str(), -1, pattern, sizeof(pattern)/sizeof(pattern[0]));
+
+    WIN32_FIND_DATAW findData;
+    HANDLE handle = FindFirstFileW(pattern, &findData);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    do
+    {
+        if (wcscmp(findData.cFileName, L".") == 0 || wcscmp(findData.cFileName, L"..") == 0)
+        {
+            continue;
+        }
+
+        char name[MAX_PATH] = {0};
+        WideCharToMultiByte(CP_UTF8, 0, findData.cFileName, -1, name, sizeof(name), nullptr, nullptr);
+
+        std::string path = directory + name;
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            addDirectoryToFileIndex(path + "/");
+        }
+        else
+        {
+            _fileIndex.insert(path);
+        }
+    } while (FindNextFileW(handle, &findData));
+
+    FindClose(handle);
+    return true;
+#else
+    return false;
+#endif
 }
 
 void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
 {
-    _fullPathCache.clear();    
+    clearLookupCaches();
     _filenameLookupDict = filenameLookupDict;
 }
 
@@ -869,14 +1515,28 @@ bool FileUtils::isFileExist(const std::string& filename) const
     // If filename is absolute path, we don't need to consider 'search paths' and 'resolution orders'.
     if (isAbsolutePath(filename))
     {
+        std::string entryName;
+        if (const SearchArchive* archive = findSearchArchive(filename, &entryName))
+        {
+            return archive->zipFile->fileExists(entryName);
+        }
         return isFileExistInternal(filename);
     }
     
-    // Already Cached ?
-    auto cacheIter = _fullPathCache.find(filename);
-    if( cacheIter != _fullPathCache.end() )
     {
-        return true;
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+
+        // Already Cached ?
+        auto cacheIter = _fullPathCache.find(filename);
+        if( cacheIter != _fullPathCache.end() )
+        {
+            return true;
+        }
+
+        if (_notFoundFileCache.find(filename) != _notFoundFileCache.end())
+        {
+            return false;
+        }
     }
     
     // Get the new file name.
@@ -893,11 +1553,18 @@ bool FileUtils::isFileExist(const std::string& filename) const
             if (!fullpath.empty())
             {
                 // Using the filename passed in as key.
+                std::lock_guard<std::mutex> lock(_cacheMutex);
                 const_cast<FileUtils*>(this)->_fullPathCache.insert(std::make_pair(filename, fullpath));
                 return true;
             }
         }
     }
+
+    if (!_fileIndexRoots.empty())
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        const_cast<FileUtils*>(this)->_notFoundFileCache.insert(filename);
+    }
     return false;
 }
 
@@ -33,9 +33,16 @@ THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <functional>
+#include <future>
+#include <mutex>
 
 NS_CC_BEGIN
 
+class ZipFile;
+
 /**
  * @addtogroup platform
  * @{
@@ -77,6 +84,29 @@ public:
      *        this method should be invoked to clean the file search cache.
      */
     virtual void purgeCachedEntries();
+
+    /**
+     *  Lists the files under the absolute search paths once and keeps them in an index.
+     *  File lookups in the indexed folders then check the index instead of the file system.
+     *  Search paths added later, and folders that can't be listed (e.g. Android assets), are still
+     *  checked on the file system; use loadFileIndex for those.
+     *
+     *  @note The index isn't updated when files are added or removed, build it again after the resources were updated.
+     *  @return The number of files in the index.
+     */
+    virtual ssize_t buildFileIndex();
+
+    /**
+     *  Loads the file index from a manifest instead of listing the folders.
+     *  The manifest has one file path per line, relative to the default resource root path,
+     *  it covers the search paths inside that root.
+     *
+     *  @return false if the manifest can't be read.
+     */
+    virtual bool loadFileIndex(const std::string& manifestFile);
+
+    /** Removes the file index, lookups check the file system again. */
+    virtual void clearFileIndex();
     
     /**
      *  Gets string from a file.
@@ -88,6 +118,46 @@ public:
      *  @return A data object.
      */
     virtual Data getDataFromFile(const std::string& filename);
+
+    /**
+     *  Like getDataFromFile, but the returned Data maps the file into memory instead of reading it into
+     *  a heap buffer, it is unmapped when the Data is released. The mapping is private, writing to the
+     *  bytes doesn't change the file. Files stored without compression in a package added by
+     *  addSearchArchive are returned without copying too.
+     *  Where the file can't be mapped (e.g. Android assets, Windows) it falls back to getDataFromFile.
+     */
+    virtual Data getMappedDataFromFile(const std::string& filename);
+
+    /**
+     *  Runs task on one of the I/O threads shared by the resource loaders. Tasks with a higher
+     *  priority run first, tasks with the same priority run in the order they were added.
+     *  When too many tasks are waiting, task runs right away on the calling thread instead.
+     *  The tasks still waiting when destroyInstance() is called are run before it returns.
+     *  @note Search paths, resolution orders and the file index must not be changed while tasks
+     *        that look up files are running.
+     */
+    void addIOTask(const std::function<void()>& task, int priority = 0);
+
+    /**
+     *  Sets the number of I/O threads, 2 by default. It only takes effect before the first task is added.
+     */
+    void setIOThreadCount(int count);
+
+    /**
+     *  Reads a file on an I/O thread, then calls callback with its contents on the cocos thread.
+     *  @param priority See addIOTask.
+     */
+    virtual void getDataFromFileAsync(const std::string& filename, const std::function<void(Data)>& callback, int priority = 0);
+
+    /**
+     *  Reads a file on an I/O thread. The future can be waited on from any thread.
+     */
+    std::future<Data> getDataFromFileFuture(const std::string& filename, int priority = 0);
+
+    /**
+     *  Like getDataFromFileAsync, but passes the contents of the file as a string.
+     */
+    virtual void getStringFromFileAsync(const std::string& filename, const std::function<void(std::string)>& callback, int priority = 0);
     
     /**
      *  Gets resource file data
@@ -267,6 +337,35 @@ public:
       * @since v2.1
       */
     void addSearchPath(const std::string & path);
+
+    /**
+     *  Adds a zip package, e.g. an Android OBB file, as a search path.
+     *  The package is opened once and its file list is indexed. The files inside it are then found
+     *  like the files of a search path folder, their full path is "archivePath/entryName".
+     *  Files stored without compression are read from the package mapped into memory.
+     *
+     *  @param archivePath The path of the package.
+     *  @param entryPrefix Only the entries beginning with it are searched, and it isn't part of their names, e.g. "assets/".
+     *  @param front Whether to search the package before the other search paths.
+     *  @return false if the package can't be opened.
+     */
+    virtual bool addSearchArchive(const std::string& archivePath, const std::string& entryPrefix = "", bool front = false);
+
+    /**
+     *  Removes a package added by addSearchArchive, and its search path.
+     */
+    virtual void removeSearchArchive(const std::string& archivePath);
+
+    /**
+     *  Reads a file that lives in a package added by addSearchArchive.
+     *
+     *  @param[in]  fullPath The full path of the file, as returned by fullPathForFilename.
+     *  @param[in]  forString Whether to append a '\0' to the data.
+     *  @param[out] buffer The file data, or nullptr if it can't be read. You are responsible for calling free() on it.
+     *  @param[out] size The data size, without the '\0'.
+     *  @return false if fullPath isn't inside such a package, buffer and size are not touched then.
+     */
+    bool getFileDataFromArchive(const std::string& fullPath, bool forString, unsigned char** buffer, ssize_t* size) const;
     
     /**
      *  Gets the array of search paths.
@@ -315,6 +414,12 @@ public:
      *  @note This method is used internally.
      */
     virtual ValueMap getValueMapFromFile(const std::string& filename);
+
+    /**
+     *  Parses a plist file on an I/O thread, then calls callback with the result on the cocos thread.
+     *  @param priority See addIOTask.
+     */
+    virtual void getValueMapFromFileAsync(const std::string& filename, const std::function<void(ValueMap)>& callback, int priority = 0);
     
     /**
      *  Write a ValueMap to a plist file.
@@ -382,6 +487,35 @@ protected:
      *  @return The full path of the file, if the file can't be found, it will return an empty string.
      */
     virtual std::string getFullPathForDirectoryAndFilename(const std::string& directory, const std::string& filename);
+
+    /** A package added by addSearchArchive */
+    struct SearchArchive
+    {
+        std::string searchPath;     // the full path of the package with a trailing '/'
+        std::string entryPrefix;
+        std::shared_ptr<ZipFile> zipFile;
+    };
+
+    /**
+     *  Finds the package that fullPath is inside of.
+     *  @param[out] entryName The name of the entry in the package, with the entry prefix.
+     *  @return nullptr if fullPath isn't inside any package added by addSearchArchive.
+     */
+    const SearchArchive* findSearchArchive(const std::string& fullPath, std::string* entryName) const;
+
+    /**
+     *  Checks whether the file index knows about the folder of fullPath.
+     *  If so the file exists if and only if the index contains fullPath.
+     */
+    bool isPathInFileIndex(const std::string& fullPath) const;
+
+    /** Adds the files under directory, which ends with a '/', to the file index. Returns false if it can't be listed. */
+    bool addDirectoryToFileIndex(const std::string& directory);
+
+    /** Clears _fullPathCache and _notFoundFileCache. */
+    void clearLookupCaches();
+
+    class IOThreadPool;
     
     
     /** Dictionary used to lookup filenames based on a key.
@@ -419,6 +553,37 @@ protected:
      *  This variable is used for improving the performance of file search.
      */
     std::unordered_map<std::string, std::string> _fullPathCache;
+
+    /**
+     *  The files that weren't found, so looking for them again doesn't search every path.
+     *  Misses are only kept while a file index is used: like the index, they are forgotten
+     *  when the index is built again, so files written or downloaded later are still found.
+     *  It is cleared with _fullPathCache, and when search paths or resolution orders are added.
+     */
+    std::unordered_set<std::string> _notFoundFileCache;
+
+    /**
+     *  Guards _fullPathCache and _notFoundFileCache, files are looked up from the I/O threads too.
+     */
+    mutable std::mutex _cacheMutex;
+
+    /**
+     *  The full paths of all files under _fileIndexRoots, see buildFileIndex and loadFileIndex.
+     */
+    std::unordered_set<std::string> _fileIndex;
+    std::vector<std::string> _fileIndexRoots;
+
+    /**
+     *  The packages added by addSearchArchive.
+     */
+    std::vector<SearchArchive> _searchArchives;
+
+    /**
+     *  The threads running addIOTask, created with the first task.
+     */
+    IOThreadPool* _ioThreadPool;
+    int _ioThreadCount;
+    std::mutex _ioThreadPoolMutex;
     
     /**
      *  The singleton pointer of FileUtils.
@@ -29,6 +29,8 @@ THE SOFTWARE.
 
 #include <string>
 #include <ctype.h>
+#include <atomic>
+#include <functional>
 
 #ifdef EMSCRIPTEN
 #include <SDL/SDL.h>
@@ -55,6 +57,7 @@ extern "C"
 #include "CCStdC.h"
 #include "CCFileUtils.h"
 #include "base/CCConfiguration.h"
+#include "base/CCJobSystem.h"
 #include "2d/ccUtils.h"
 #include "base/ZipUtils.h"
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
@@ -348,6 +351,34 @@ namespace
 
 //////////////////////////////////////////////////////////////////////////
 
+//software decoders of compressed textures
+namespace
+{
+    // each job decodes at least this many rows of 4x4 blocks
+    static const int DECODE_MIN_BLOCK_ROWS_PER_THREAD = 16;
+
+    // set by Director, images are also loaded by the TextureCache thread
+    static std::atomic<JobSystem*> s_decodeJobSystem(nullptr);
+
+    // Calls decodeRows(firstBlockRow, blockRowCount) over all the rows of 4x4 blocks of an image, split across
+    // the workers of the job system. The blocks of a row are stored together, so each call can decode its rows independently.
+    void decodeBlockRowsInParallel(int blockRows, const std::function<void(int, int)>& decodeRows)
+    {
+        JobSystem* jobSystem = s_decodeJobSystem.load(std::memory_order_acquire);
+        if (jobSystem == nullptr)
+        {
+            decodeRows(0, blockRows);
+            return;
+        }
+
+        jobSystem->parallelFor(0, blockRows, DECODE_MIN_BLOCK_ROWS_PER_THREAD, [&decodeRows](int first, int last) {
+            decodeRows(first, last - first);
+        });
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 namespace
 {
     typedef struct 
@@ -377,6 +408,11 @@ namespace
 // Implement Image
 //////////////////////////////////////////////////////////////////////////
 
+void Image::setDecodeJobSystem(JobSystem* jobSystem)
+{
+    s_decodeJobSystem.store(jobSystem, std::memory_order_release);
+}
+
 Image::Image()
 : _data(nullptr)
 , _dataLen(0)
@@ -384,6 +420,7 @@ Image::Image()
 , _height(0)
 , _fileType(Format::UNKOWN)
 , _renderFormat(Texture2D::PixelFormat::NONE)
+, _targetPixelFormat(Texture2D::PixelFormat::AUTO)
 , _preMulti(false)
 , _numberOfMipmaps(0)
 , _hasPremultipliedAlpha(true)
@@ -421,7 +458,7 @@ bool Image::initWithImageFile(const std::string& path)
 
     SDL_FreeSurface(iSurf);
 #else
-    Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
+    Data data = FileUtils::getInstance()->getMappedDataFromFile(_filePath);
 
     if (!data.isNull())
     {
@@ -437,7 +474,7 @@ bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
     bool ret = false;
     _filePath = fullpath;
 
-    Data data = FileUtils::getInstance()->getDataFromFile(fullpath);
+    Data data = FileUtils::getInstance()->getMappedDataFromFile(fullpath);
 
     if (!data.isNull())
     {
@@ -738,6 +775,15 @@ namespace
     }
 }
 
+namespace
+{
+    // bytes of one row of pixels in the given uncompressed format
+    ssize_t getRowBytes(Texture2D::PixelFormat format, int width)
+    {
+        return (ssize_t)width * Texture2D::getPixelFormatInfoMap().at(format).bpp / 8;
+    }
+}
+
 bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
 {
     /* these are standard libjpeg structures for reading(decompression) */
@@ -749,8 +795,6 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
 	struct MyErrorMgr jerr;
     /* libjpeg data structure for storing one row, that is, scanline of an image */
     JSAMPROW row_pointer[1] = {0};
-    unsigned long location = 0;
-    unsigned int i = 0;
 
     bool bRet = false;
     do 
@@ -799,21 +843,40 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
         _width  = cinfo.output_width;
         _height = cinfo.output_height;
         _preMulti = false;
-        row_pointer[0] = static_cast<unsigned char*>(malloc(cinfo.output_width*cinfo.output_components * sizeof(unsigned char)));
-        CC_BREAK_IF(! row_pointer[0]);
 
-        _dataLen = cinfo.output_width*cinfo.output_height*cinfo.output_components;
-        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
-        CC_BREAK_IF(! _data);
+        ssize_t rowBytes = cinfo.output_width*cinfo.output_components;
+        Texture2D::ConvertFunction convert = Texture2D::getConvertFunction(_renderFormat, _targetPixelFormat);
+        if (convert)
+        {
+            /* decode one scan line at a time and pack it into the texture format */
+            row_pointer[0] = static_cast<unsigned char*>(malloc(rowBytes * sizeof(unsigned char)));
+            CC_BREAK_IF(! row_pointer[0]);
 
-        /* now actually read the jpeg into the raw buffer */
-        /* read one scan line at a time */
-        while( cinfo.output_scanline < cinfo.output_height )
+            ssize_t outRowBytes = getRowBytes(_targetPixelFormat, cinfo.output_width);
+            _dataLen = outRowBytes*cinfo.output_height;
+            _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+            CC_BREAK_IF(! _data);
+
+            while( cinfo.output_scanline < cinfo.output_height )
+            {
+                unsigned char* outRow = _data + cinfo.output_scanline*outRowBytes;
+                jpeg_read_scanlines( &cinfo, row_pointer, 1 );
+                convert(row_pointer[0], rowBytes, outRow);
+            }
+            _renderFormat = _targetPixelFormat;
+        }
+        else
         {
-            jpeg_read_scanlines( &cinfo, row_pointer, 1 );
-            for( i=0; i<cinfo.output_width*cinfo.output_components;i++) 
+            _dataLen = rowBytes*cinfo.output_height;
+            _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+            CC_BREAK_IF(! _data);
+
+            /* now actually read the jpeg into the raw buffer */
+            /* read one scan line at a time */
+            while( cinfo.output_scanline < cinfo.output_height )
             {
-                _data[location++] = row_pointer[0][i];
+                JSAMPROW row = _data + cinfo.output_scanline*rowBytes;
+                jpeg_read_scanlines( &cinfo, &row, 1 );
             }
         }
 
@@ -843,6 +906,8 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
     png_byte        header[PNGSIGSIZE]   = {0}; 
     png_structp     png_ptr     =   0;
     png_infop       info_ptr    = 0;
+    // volatile: it's set after setjmp() and freed after a libpng error
+    png_bytep volatile row_buffer = nullptr;
 
     do 
     {
@@ -935,10 +1000,39 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
         }
 
         // read png data
-        png_size_t rowbytes;
-        png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
+        png_size_t rowbytes = png_get_rowbytes(png_ptr, info_ptr);
+
+        // pack the rows into the texture format while they are decoded. Interlaced images
+        // are only complete after the last pass, so they are converted by Texture2D instead.
+        Texture2D::ConvertFunction convert = nullptr;
+        if (png_get_interlace_type(png_ptr, info_ptr) == PNG_INTERLACE_NONE)
+        {
+            convert = Texture2D::getConvertFunction(_renderFormat, _targetPixelFormat);
+        }
+        if (convert)
+        {
+            row_buffer = static_cast<png_bytep>(malloc(rowbytes));
+            CC_BREAK_IF(! row_buffer);
+
+            ssize_t outRowBytes = getRowBytes(_targetPixelFormat, _width);
+            _dataLen = outRowBytes * _height;
+            _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+            CC_BREAK_IF(! _data);
+
+            for (int i = 0; i < _height; ++i)
+            {
+                png_read_row(png_ptr, row_buffer, nullptr);
+                convert(row_buffer, rowbytes, _data + i * outRowBytes);
+            }
+            png_read_end(png_ptr, nullptr);
+
+            _renderFormat = _targetPixelFormat;
+            _preMulti = false;
+            bRet = true;
+            break;
+        }
 
-        rowbytes = png_get_rowbytes(png_ptr, info_ptr);
+        png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
 
         _dataLen = rowbytes * _height;
         _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
@@ -969,6 +1063,10 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
         bRet = true;
     } while (0);
 
+    if (row_buffer != nullptr)
+    {
+        free(row_buffer);
+    }
     if (png_ptr)
     {
         png_destroy_read_struct(&png_ptr, (info_ptr) ? &info_ptr : 0, 0);
@@ -1467,14 +1565,34 @@ bool Image::initWithETCData(const unsigned char * data, ssize_t dataLen)
         CCLOG("cocos2d: Hardware ETC1 decoder not present. Using software decoder");
 
          //if it is not gles or device do not support ETC, decode texture by software
+        //ETC1 has no alpha, decode to RGB565 directly only when this image was asked for it,
+        //Texture2D converts RGB888 to whatever format the texture is created with
         int bytePerPixel = 3;
-        unsigned int stride = _width * bytePerPixel;
         _renderFormat = Texture2D::PixelFormat::RGB888;
+        if (_targetPixelFormat == Texture2D::PixelFormat::RGB565)
+        {
+            bytePerPixel = 2;
+            _renderFormat = Texture2D::PixelFormat::RGB565;
+        }
+        unsigned int stride = _width * bytePerPixel;
         
         _dataLen =  _width * _height * bytePerPixel;
         _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
         
-        if (etc1_decode_image(static_cast<const unsigned char*>(data) + ETC_PKM_HEADER_SIZE, static_cast<etc1_byte*>(_data), _width, _height, bytePerPixel, stride) != 0)
+        const etc1_byte* encodeData = static_cast<const unsigned char*>(data) + ETC_PKM_HEADER_SIZE;
+        int blocksPerRow = (_width + 3) / 4;
+        std::atomic<int> errors(0);
+        decodeBlockRowsInParallel((_height + 3) / 4, [&](int firstRow, int rowCount) {
+            int y = firstRow * 4;
+            if (etc1_decode_image(encodeData + firstRow * blocksPerRow * ETC1_ENCODED_BLOCK_SIZE,
+                                  static_cast<etc1_byte*>(_data) + y * stride,
+                                  _width, std::min(rowCount * 4, _height - y), bytePerPixel, stride) != 0)
+            {
+                ++errors;
+            }
+        });
+
+        if (errors != 0)
         {
             _dataLen = 0;
             if (_data != nullptr)
@@ -1669,23 +1787,30 @@ bool Image::initWithS3TCData(const unsigned char * data, ssize_t dataLen)
             int bytePerPixel = 4;
             unsigned int stride = width * bytePerPixel;
 
-            std::vector<unsigned char> decodeImageData(stride * height);
-            if (FOURCC_DXT1 == header->ddsd.DUMMYUNIONNAMEN4.ddpfPixelFormat.fourCC)
-            {
-                s3tc_decode(pixelData + encodeOffset, &decodeImageData[0], width, height, S3TCDecodeFlag::DXT1);
-            }
-            else if (FOURCC_DXT3 == header->ddsd.DUMMYUNIONNAMEN4.ddpfPixelFormat.fourCC)
+            S3TCDecodeFlag decodeFlag = S3TCDecodeFlag::DXT1;
+            if (FOURCC_DXT3 == header->ddsd.DUMMYUNIONNAMEN4.ddpfPixelFormat.fourCC)
             {
-                s3tc_decode(pixelData + encodeOffset, &decodeImageData[0], width, height, S3TCDecodeFlag::DXT3);
+                decodeFlag = S3TCDecodeFlag::DXT3;
             }
             else if (FOURCC_DXT5 == header->ddsd.DUMMYUNIONNAMEN4.ddpfPixelFormat.fourCC)
             {
-                s3tc_decode(pixelData + encodeOffset, &decodeImageData[0], width, height, S3TCDecodeFlag::DXT5);
+                decodeFlag = S3TCDecodeFlag::DXT5;
             }
-            
+
+            // decode straight into the mipmap, the decoder skips levels smaller than a block
             _mipmaps[i].address = (unsigned char *)_data + decodeOffset;
             _mipmaps[i].len = (stride * height);
-            memcpy((void *)_mipmaps[i].address, (void *)&decodeImageData[0], _mipmaps[i].len);
+            if (width < 4 || height < 4)
+            {
+                memset(_mipmaps[i].address, 0, _mipmaps[i].len);
+            }
+
+            unsigned char* decodeData = _mipmaps[i].address;
+            int blocksPerRow = (width + 3) / 4;
+            decodeBlockRowsInParallel(height / 4, [=](int firstRow, int rowCount) {
+                s3tc_decode(pixelData + encodeOffset + firstRow * blocksPerRow * blockSize, decodeData + firstRow * 4 * stride,
+                            width, rowCount * 4, decodeFlag);
+            });
             decodeOffset += stride * height;
         }
         
@@ -1803,25 +1928,42 @@ bool Image::initWithATITCData(const unsigned char *data, ssize_t dataLen)
             unsigned int stride = width * bytePerPixel;
             _renderFormat = Texture2D::PixelFormat::RGBA8888;
             
-            std::vector<unsigned char> decodeImageData(stride * height);
+            // decode straight into the mipmap, the decoder skips levels smaller than a block
+            _mipmaps[i].address = (unsigned char *)_data + decodeOffset;
+            _mipmaps[i].len = (stride * height);
+            if (width < 4 || height < 4)
+            {
+                memset(_mipmaps[i].address, 0, _mipmaps[i].len);
+            }
+
+            bool supported = true;
+            ATITCDecodeFlag decodeFlag = ATITCDecodeFlag::ATC_RGB;
             switch (header->glInternalFormat)
             {
                 case CC_GL_ATC_RGB_AMD:
-                    atitc_decode(pixelData + encodeOffset, &decodeImageData[0], width, height, ATITCDecodeFlag::ATC_RGB);
+                    decodeFlag = ATITCDecodeFlag::ATC_RGB;
                     break;
                 case CC_GL_ATC_RGBA_EXPLICIT_ALPHA_AMD:
-                    atitc_decode(pixelData + encodeOffset, &decodeImageData[0], width, height, ATITCDecodeFlag::ATC_EXPLICIT_ALPHA);
+                    decodeFlag = ATITCDecodeFlag::ATC_EXPLICIT_ALPHA;
                     break;
                 case CC_GL_ATC_RGBA_INTERPOLATED_ALPHA_AMD:
-                    atitc_decode(pixelData + encodeOffset, &decodeImageData[0], width, height, ATITCDecodeFlag::ATC_INTERPOLATED_ALPHA);
+                    decodeFlag = ATITCDecodeFlag::ATC_INTERPOLATED_ALPHA;
                     break;
                 default:
+                    supported = false;
+                    memset(_mipmaps[i].address, 0, _mipmaps[i].len);
                     break;
             }
 
-            _mipmaps[i].address = (unsigned char *)_data + decodeOffset;
-            _mipmaps[i].len = (stride * height);
-            memcpy((void *)_mipmaps[i].address, (void *)&decodeImageData[0], _mipmaps[i].len);
+            if (supported)
+            {
+                unsigned char* decodeData = _mipmaps[i].address;
+                int blocksPerRow = (width + 3) / 4;
+                decodeBlockRowsInParallel(height / 4, [=](int firstRow, int rowCount) {
+                    atitc_decode(pixelData + encodeOffset + firstRow * blocksPerRow * blockSize, decodeData + firstRow * 4 * stride,
+                                 width, rowCount * 4, decodeFlag);
+                });
+            }
             decodeOffset += stride * height;
         }
 
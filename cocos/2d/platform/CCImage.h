@@ -53,6 +53,8 @@ typedef struct _MipmapInfo
     int len;
 }MipmapInfo;
 
+class JobSystem;
+
 class CC_DLL Image : public Ref
 {
 public:
@@ -114,6 +116,19 @@ public:
     // @warning kFmtRawData only support RGBA8888
     bool initWithRawData(const unsigned char * data, ssize_t dataLen, int width, int height, int bitsPerComponent, bool preMulti = false);
 
+    /**
+    @brief Set the texture format that PNG and JPEG data, and ETC data decoded by software, is packed into while it is decoded.
+    The texture created from the image can then use the data without converting it.
+    The default, PixelFormat::AUTO, keeps the decoded format. Call it before the image is initialized.
+    */
+    inline void              setTargetPixelFormat(Texture2D::PixelFormat format) { _targetPixelFormat = format; }
+
+    /**
+    @brief Set the JobSystem that software decoders of compressed textures split their work on.
+    Director sets its own. Without one, as in tools that don't create a Director, images are decoded on the calling thread.
+    */
+    static void              setDecodeJobSystem(JobSystem* jobSystem);
+
     // Getters
     inline unsigned char *   getData()               { return _data; }
     inline ssize_t           getDataLen()            { return _dataLen; }
@@ -167,6 +182,7 @@ protected:
     int _height;
     Format _fileType;
     Texture2D::PixelFormat _renderFormat;
+    Texture2D::PixelFormat _targetPixelFormat;
     bool _preMulti;
     MipmapInfo _mipmaps[MIPMAP_MAX];   // pointer to mipmap images
     int _numberOfMipmaps;
@@ -194,6 +194,11 @@ Data FileUtilsAndroid::getData(const std::string& filename, bool forString)
     {
         do
         {
+            if (getFileDataFromArchive(fullPath, forString, &data, &size))
+            {
+                break;
+            }
+
             // read rrom other path than user set it
             //CCLOG("GETTING FILE ABSOLUTE DATA: %s", filename);
             const char* mode = nullptr;
@@ -310,6 +315,16 @@ unsigned char* FileUtilsAndroid::getFileData(const std::string& filename, const
     {
         do
         {
+            ssize_t archiveSize = 0;
+            if (getFileDataFromArchive(fullPath, false, &data, &archiveSize))
+            {
+                if (size)
+                {
+                    *size = archiveSize;
+                }
+                break;
+            }
+
             // read rrom other path than user set it
             //CCLOG("GETTING FILE ABSOLUTE DATA: %s", filename);
             FILE *fp = fopen(fullPath.c_str(), mode);
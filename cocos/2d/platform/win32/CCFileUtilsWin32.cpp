@@ -144,6 +144,13 @@ static Data getData(const std::string& filename, bool forString)
         // read the file from hardware
         std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
 
+        ssize_t archiveSize = 0;
+        if (FileUtils::getInstance()->getFileDataFromArchive(fullPath, forString, &buffer, &archiveSize))
+        {
+            size = archiveSize;
+            break;
+        }
+
         WCHAR wszBuf[CC_MAX_PATH] = {0};
         MultiByteToWideChar(CP_UTF8, 0, fullPath.c_str(), -1, wszBuf, sizeof(wszBuf)/sizeof(wszBuf[0]));
 
@@ -218,6 +225,10 @@ unsigned char* FileUtilsWin32::getFileData(const std::string& filename, const ch
     {
         // read the file from hardware
         std::string fullPath = fullPathForFilename(filename);
+        if (getFileDataFromArchive(fullPath, false, &pBuffer, size))
+        {
+            break;
+        }
 
         WCHAR wszBuf[CC_MAX_PATH] = {0};
         MultiByteToWideChar(CP_UTF8, 0, fullPath.c_str(), -1, wszBuf, sizeof(wszBuf)/sizeof(wszBuf[0]));
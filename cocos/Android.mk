@@ -30,6 +30,7 @@ cocos2d.cpp \
 2d/CCComponent.cpp \
 2d/CCDrawingPrimitives.cpp \
 2d/CCDrawNode.cpp \
+2d/CCDynamicAtlas.cpp \
 2d/CCFontAtlasCache.cpp \
 2d/CCFontAtlas.cpp \
 2d/CCFontCharMap.cpp \
@@ -51,6 +52,7 @@ cocos2d.cpp \
 2d/CCMotionStreak.cpp \
 2d/CCNode.cpp \
 2d/CCNodeGrid.cpp \
+2d/CCNodePool.cpp \
 2d/CCParallaxNode.cpp \
 2d/CCParticleBatchNode.cpp \
 2d/CCParticleExamples.cpp \
@@ -123,6 +125,8 @@ base/CCNS.cpp \
 base/CCProfiling.cpp \
 base/CCRef.cpp \
 base/CCScheduler.cpp \
+base/CCFunctionQueue.cpp \
+base/CCJobSystem.cpp \
 base/CCTouch.cpp \
 base/CCValue.cpp \
 base/ZipUtils.cpp \
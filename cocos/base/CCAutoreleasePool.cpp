@@ -25,10 +25,15 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/ccMacros.h"
 
+#include <algorithm>
+#include <new>
+
 NS_CC_BEGIN
 
 AutoreleasePool::AutoreleasePool()
 : _name("")
+, _lastClearedObjectCount(0)
+, _peakObjectCount(0)
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
 , _isClearing(false)
 #endif
@@ -39,6 +44,8 @@ AutoreleasePool::AutoreleasePool()
 
 AutoreleasePool::AutoreleasePool(const std::string &name)
 : _name(name)
+, _lastClearedObjectCount(0)
+, _peakObjectCount(0)
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
 , _isClearing(false)
 #endif
@@ -65,16 +72,31 @@ void AutoreleasePool::clear()
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = true;
 #endif
-    for (const auto &obj : _managedObjectArray)
+    ssize_t count = 0;
+    // objects autoreleased by the destructors are released too
+    while (!_managedObjectArray.empty())
     {
-        obj->release();
+        _releasingObjectArray.swap(_managedObjectArray);
+        count += _releasingObjectArray.size();
+        for (const auto &obj : _releasingObjectArray)
+        {
+            obj->release();
+        }
+        _releasingObjectArray.clear();
     }
-    _managedObjectArray.clear();
+    _lastClearedObjectCount = count;
+    _peakObjectCount = std::max(_peakObjectCount, count);
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = false;
 #endif
 }
 
+void AutoreleasePool::resetStatistics()
+{
+    _lastClearedObjectCount = 0;
+    _peakObjectCount = 0;
+}
+
 bool AutoreleasePool::contains(Ref* object) const
 {
     for (const auto& obj : _managedObjectArray)
@@ -82,12 +104,18 @@ bool AutoreleasePool::contains(Ref* object) const
         if (obj == object)
             return true;
     }
+    for (const auto& obj : _releasingObjectArray)
+    {
+        if (obj == object)
+            return true;
+    }
     return false;
 }
 
 void AutoreleasePool::dump()
 {
     CCLOG("autorelease pool: %s, number of managed object %d\n", _name.c_str(), static_cast<int>(_managedObjectArray.size()));
+    CCLOG("objects released by the last clear: %d, peak: %d\n", static_cast<int>(_lastClearedObjectCount), static_cast<int>(_peakObjectCount));
     CCLOG("%20s%20s%20s", "Object pointer", "Object id", "reference count");
     for (const auto &obj : _managedObjectArray)
     {
@@ -176,4 +204,193 @@ void PoolManager::pop()
     }
 }
 
+//--------------------------------------------------------------------
+//
+// FrameArena
+//
+//--------------------------------------------------------------------
+
+namespace
+{
+    // keeps the objects aligned like operator new does
+    const size_t ALIGNMENT = 16;
+    // every object is preceded by the chunk it belongs to, or nullptr if it came from operator new
+    const size_t OBJECT_HEADER_SIZE = ALIGNMENT;
+    const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+    // empty chunks kept for the next frames, the others are freed
+    const ssize_t MAX_FREE_CHUNKS = 4;
+
+    inline size_t alignSize(size_t size)
+    {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+}
+
+FrameArena* FrameArena::s_sharedFrameArena = nullptr;
+
+FrameArena* FrameArena::getInstance()
+{
+    if (s_sharedFrameArena == nullptr)
+    {
+        s_sharedFrameArena = new FrameArena(DEFAULT_CHUNK_SIZE);
+    }
+    return s_sharedFrameArena;
+}
+
+void FrameArena::destroyInstance()
+{
+    // objects that are still alive would be deleted into a freed arena
+    if (s_sharedFrameArena && s_sharedFrameArena->_objectCount == 0)
+    {
+        delete s_sharedFrameArena;
+        s_sharedFrameArena = nullptr;
+    }
+}
+
+FrameArena::FrameArena(size_t chunkSize)
+: _chunkSize(chunkSize)
+, _currentChunk(nullptr)
+, _freeChunks(nullptr)
+, _freeChunkCount(0)
+, _chunkCount(0)
+, _objectCount(0)
+, _peakObjectCount(0)
+, _allocationCount(0)
+, _frameAllocationCount(0)
+, _lastFrameAllocationCount(0)
+, _fallbackCount(0)
+, _threadId(std::this_thread::get_id())
+{
+}
+
+FrameArena::~FrameArena()
+{
+    CCLOGINFO("deallocing FrameArena: %p", this);
+
+    if (_currentChunk)
+    {
+        ::operator delete(_currentChunk);
+    }
+    while (_freeChunks)
+    {
+        Chunk* next = _freeChunks->next;
+        ::operator delete(_freeChunks);
+        _freeChunks = next;
+    }
+}
+
+FrameArena::Chunk* FrameArena::newChunk()
+{
+    Chunk* chunk = _freeChunks;
+    if (chunk)
+    {
+        _freeChunks = chunk->next;
+        --_freeChunkCount;
+    }
+    else
+    {
+        chunk = static_cast<Chunk*>(::operator new(_chunkSize));
+        ++_chunkCount;
+    }
+    chunk->next = nullptr;
+    chunk->used = alignSize(sizeof(Chunk));
+    chunk->liveObjects = 0;
+    return chunk;
+}
+
+void* FrameArena::allocate(size_t size)
+{
+    size = alignSize(size) + OBJECT_HEADER_SIZE;
+
+    Chunk* chunk = nullptr;
+    if (std::this_thread::get_id() == _threadId && size <= _chunkSize - alignSize(sizeof(Chunk)))
+    {
+        if (_currentChunk == nullptr || _currentChunk->used + size > _chunkSize)
+        {
+            // the old chunk is given back by deallocate() when its last object is deleted
+            if (_currentChunk && _currentChunk->liveObjects == 0)
+            {
+                _currentChunk->used = alignSize(sizeof(Chunk));
+            }
+            else
+            {
+                _currentChunk = newChunk();
+            }
+        }
+        chunk = _currentChunk;
+    }
+
+    char* memory;
+    if (chunk)
+    {
+        memory = reinterpret_cast<char*>(chunk) + chunk->used;
+        chunk->used += size;
+        ++chunk->liveObjects;
+        ++_objectCount;
+        _peakObjectCount = std::max(_peakObjectCount, _objectCount);
+        ++_allocationCount;
+        ++_frameAllocationCount;
+    }
+    else
+    {
+        // too large for a chunk, or created in another thread
+        memory = static_cast<char*>(::operator new(size));
+        _fallbackCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    *reinterpret_cast<Chunk**>(memory) = chunk;
+    return memory + OBJECT_HEADER_SIZE;
+}
+
+void FrameArena::endFrame()
+{
+    _lastFrameAllocationCount = _frameAllocationCount;
+    _frameAllocationCount = 0;
+}
+
+void FrameArena::resetStatistics()
+{
+    _allocationCount = 0;
+    _fallbackCount.store(0, std::memory_order_relaxed);
+    _peakObjectCount = _objectCount;
+}
+
+void FrameArena::deallocate(void* ptr)
+{
+    if (ptr == nullptr)
+        return;
+
+    char* memory = static_cast<char*>(ptr) - OBJECT_HEADER_SIZE;
+    Chunk* chunk = *reinterpret_cast<Chunk**>(memory);
+    if (chunk == nullptr)
+    {
+        ::operator delete(memory);
+        return;
+    }
+
+    CCASSERT(std::this_thread::get_id() == _threadId, "FrameArena: an object of the arena MUST be deleted in the thread that created it");
+    CCASSERT(chunk->liveObjects > 0, "FrameArena: the object was already deleted");
+
+    --_objectCount;
+    if (--chunk->liveObjects > 0)
+        return;
+
+    if (chunk == _currentChunk)
+    {
+        // nothing alive in it, start over from the beginning
+        chunk->used = alignSize(sizeof(Chunk));
+    }
+    else if (_freeChunkCount < MAX_FREE_CHUNKS)
+    {
+        chunk->next = _freeChunks;
+        _freeChunks = chunk;
+        ++_freeChunkCount;
+    }
+    else
+    {
+        ::operator delete(chunk);
+        --_chunkCount;
+    }
+}
+
 NS_CC_END
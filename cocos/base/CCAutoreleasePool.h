@@ -28,6 +28,8 @@ THE SOFTWARE.
 #include <stack>
 #include <vector>
 #include <string>
+#include <thread>
+#include <atomic>
 #include "base/CCRef.h"
 
 NS_CC_BEGIN
@@ -93,6 +95,21 @@ public:
      */
     bool contains(Ref* object) const;
 
+    /** Number of objects that are in the pool now */
+    ssize_t getObjectCount() const { return _managedObjectArray.size(); }
+
+    /**
+     * Number of objects released by the last `clear`. For the pool of the engine,
+     * it is the number of objects autoreleased in the last frame.
+     */
+    ssize_t getLastClearedObjectCount() const { return _lastClearedObjectCount; }
+
+    /** Largest number of objects released by one `clear` since the statistics were reset */
+    ssize_t getPeakObjectCount() const { return _peakObjectCount; }
+
+    /** Resets the last cleared and peak object counts */
+    void resetStatistics();
+
     /**
      * Dump the objects that are put into autorelease pool. It is used for debugging.
      *
@@ -113,7 +130,15 @@ private:
      * is in the pool.
      */
     std::vector<Ref*> _managedObjectArray;
+    /**
+     * The objects being released by `clear`. The array is swapped with _managedObjectArray,
+     * so objects autoreleased while the pool is cleared don't invalidate the iteration,
+     * and both arrays keep their capacity from frame to frame.
+     */
+    std::vector<Ref*> _releasingObjectArray;
     std::string _name;
+    ssize_t _lastClearedObjectCount;
+    ssize_t _peakObjectCount;
     
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     /**
@@ -167,6 +192,104 @@ private:
     AutoreleasePool *_curReleasePool;
 };
 
+/**
+ * @brief FrameArena allocates short lived objects from large chunks.
+
+ Objects created and autoreleased in a frame, like one shot actions, event objects or
+ temporary containers, are usually all deleted when the autorelease pool is cleared at the
+ end of the frame. FrameArena places them one after another in the current chunk, and a
+ chunk is reused as soon as all the objects in it are deleted, so they cost no call to the
+ system allocator.
+
+ An object that lives longer keeps its whole chunk in use, so only classes whose instances
+ rarely outlive the frame should use it, with CC_FRAME_ARENA_ALLOCATED. The instant actions
+ (ActionInstant and its subclasses, like CallFunc, Show or RemoveSelf) use it.
+
+ @code
+ class DamageEvent : public Ref
+ {
+     CC_FRAME_ARENA_ALLOCATED;
+ public:
+     ...
+ };
+ @endcode
+
+ Objects created in another thread than the one the arena was created in get their memory
+ from operator new.
+ @since v3.1
+ */
+class CC_DLL FrameArena
+{
+public:
+    static FrameArena* getInstance();
+    /** Destroys the arena if no object allocated from it is alive */
+    static void destroyInstance();
+
+    /** Returns memory for an object of `size` bytes */
+    void* allocate(size_t size);
+    /** Gives back memory returned by allocate() */
+    void deallocate(void* ptr);
+
+    /** Number of objects allocated from the arena that are alive */
+    ssize_t getObjectCount() const { return _objectCount; }
+    /** Largest number of objects alive at once */
+    ssize_t getPeakObjectCount() const { return _peakObjectCount; }
+    /** Number of chunks, including the ones kept for reuse */
+    ssize_t getChunkCount() const { return _chunkCount; }
+    /** Number of objects allocated from the chunks since the statistics were reset */
+    ssize_t getAllocationCount() const { return _allocationCount; }
+    /** Number of objects that got their memory from operator new instead, because they were
+     too large or created in another thread, since the statistics were reset */
+    ssize_t getFallbackCount() const { return _fallbackCount.load(std::memory_order_relaxed); }
+    /** Number of objects allocated from the chunks in the last frame */
+    ssize_t getLastFrameAllocationCount() const { return _lastFrameAllocationCount; }
+
+    /** Called by Director once the autorelease pool was cleared */
+    void endFrame();
+    /** Resets the allocation, fallback and peak counts */
+    void resetStatistics();
+
+protected:
+    struct Chunk
+    {
+        Chunk* next;
+        size_t used;
+        size_t liveObjects;
+    };
+
+    FrameArena(size_t chunkSize);
+    ~FrameArena();
+
+    Chunk* newChunk();
+
+    static FrameArena* s_sharedFrameArena;
+
+    size_t _chunkSize;
+    Chunk* _currentChunk;
+    // empty chunks kept for reuse
+    Chunk* _freeChunks;
+    ssize_t _freeChunkCount;
+    ssize_t _chunkCount;
+    ssize_t _objectCount;
+    ssize_t _peakObjectCount;
+    ssize_t _allocationCount;
+    ssize_t _frameAllocationCount;
+    ssize_t _lastFrameAllocationCount;
+    std::atomic<ssize_t> _fallbackCount;
+    std::thread::id _threadId;
+};
+
+/** Allocates the instances of a Ref subclass and of its subclasses from FrameArena.
+ Put it in the class declaration.
+ */
+#define CC_FRAME_ARENA_ALLOCATED \
+public: \
+    static void* operator new(size_t size) { return cocos2d::FrameArena::getInstance()->allocate(size); } \
+    static void operator delete(void* ptr) { cocos2d::FrameArena::getInstance()->deallocate(ptr); } \
+    static void* operator new(size_t, void* where) { return where; } \
+    static void operator delete(void*, void*) {} \
+private:
+
 // end of base_nodes group
 /// @}
 
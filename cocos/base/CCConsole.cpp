@@ -58,6 +58,8 @@
 #include "base/CCScheduler.h"
 #include "base/CCPlatformConfig.h"
 #include "base/CCConfiguration.h"
+#include "base/CCProfiling.h"
+#include "base/CCAutoreleasePool.h"
 #include "2d/CCScene.h"
 #include "2d/platform/CCFileUtils.h"
 #include "2d/CCTextureCache.h"
@@ -267,6 +269,7 @@ Console::Console()
 {
     // VS2012 doesn't support initializer list, so we create a new array and assign its elements to '_command'.
 	Command commands[] = {     
+        { "autorelease", "Print or reset the autorelease pool and FrameArena statistics. Args: [reset | ]", std::bind(&Console::commandAutorelease, this, std::placeholders::_1, std::placeholders::_2) },
         { "config", "Print the Configuration object", std::bind(&Console::commandConfig, this, std::placeholders::_1, std::placeholders::_2) },
         { "debugmsg", "Whether or not to forward the debug messages on the console. Args: [on | off]", [&](int fd, const std::string& args) {
             if( args.compare("on")==0 || args.compare("off")==0) {
@@ -288,10 +291,11 @@ Console::Console()
             }
         } },
         { "help", "Print this message", std::bind(&Console::commandHelp, this, std::placeholders::_1, std::placeholders::_2) },
+        { "profile", "Record a timeline of the frames and export it as a Chrome trace. Args: [start | stop | clear | dump | save filename | ]", std::bind(&Console::commandProfile, this, std::placeholders::_1, std::placeholders::_2) },
         { "projection", "Change or print the current projection. Args: [2d | 3d]", std::bind(&Console::commandProjection, this, std::placeholders::_1, std::placeholders::_2) },
         { "resolution", "Change or print the window resolution. Args: [width height resolution_policy | ]", std::bind(&Console::commandResolution, this, std::placeholders::_1, std::placeholders::_2) },
         { "scenegraph", "Print the scene graph", std::bind(&Console::commandSceneGraph, this, std::placeholders::_1, std::placeholders::_2) },
-        { "texture", "Flush or print the TextureCache info. Args: [flush | ] ", std::bind(&Console::commandTextures, this, std::placeholders::_1, std::placeholders::_2) },
+        { "texture", "Flush, print the TextureCache info or its residency stats, or set its memory budget. Args: [flush | stats | budget size_in_MB | ] ", std::bind(&Console::commandTextures, this, std::placeholders::_1, std::placeholders::_2) },
         { "director", "director commands, type -h or [director help] to list supported directives", std::bind(&Console::commandDirector, this, std::placeholders::_1, std::placeholders::_2) },
         { "touch", "simulate touch event via console, type -h or [touch help] to list supported directives", std::bind(&Console::commandTouch, this, std::placeholders::_1, std::placeholders::_2) },
         { "upload", "upload file. Args: [filename base64_encoded_data]", std::bind(&Console::commandUpload, this, std::placeholders::_1) },
@@ -573,6 +577,27 @@ void Console::commandTextures(int fd, const std::string& args)
         }
                                             );
     }
+    else if( args.compare("stats")== 0)
+    {
+        sched->performFunctionInCocosThread( [=](){
+            mydprintf(fd, "%s", Director::getInstance()->getTextureCache()->getResidencyInfo().c_str());
+            sendPrompt(fd);
+        }
+                                            );
+    }
+    else if( args.compare(0, 6, "budget")== 0)
+    {
+        int megabytes = atoi(args.c_str() + 6);
+        if (megabytes < 0)
+        {
+            mydprintf(fd, "Invalid budget: '%s'. Use 0 to disable it\n", args.c_str());
+            return;
+        }
+        sched->performFunctionInCocosThread( [=](){
+            Director::getInstance()->getTextureCache()->setMemoryBudget((size_t)megabytes * 1024 * 1024);
+        }
+                                            );
+    }
     else if(args.length()==0)
     {
         sched->performFunctionInCocosThread( [=](){
@@ -583,10 +608,111 @@ void Console::commandTextures(int fd, const std::string& args)
     }
     else
     {
-        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'flush' or nothing", args.c_str());
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'flush', 'stats', 'budget size_in_MB' or nothing", args.c_str());
+    }
+}
+
+
+void Console::commandAutorelease(int fd, const std::string& args)
+{
+    Scheduler *sched = Director::getInstance()->getScheduler();
+
+    // the pool and the arena belong to the cocos thread
+    if( args.compare("reset")== 0)
+    {
+        sched->performFunctionInCocosThread( [](){
+            PoolManager::getInstance()->getCurrentPool()->resetStatistics();
+            FrameArena::getInstance()->resetStatistics();
+        }
+                                            );
+    }
+    else if(args.length()==0)
+    {
+        sched->performFunctionInCocosThread( [=](){
+            auto pool = PoolManager::getInstance()->getCurrentPool();
+            auto arena = FrameArena::getInstance();
+            mydprintf(fd, "Autorelease pool: %d objects released by the last clear, peak %d\n",
+                      static_cast<int>(pool->getLastClearedObjectCount()), static_cast<int>(pool->getPeakObjectCount()));
+            mydprintf(fd, "FrameArena: %d objects allocated in the last frame, %d allocated, %d from operator new\n",
+                      static_cast<int>(arena->getLastFrameAllocationCount()), static_cast<int>(arena->getAllocationCount()),
+                      static_cast<int>(arena->getFallbackCount()));
+            mydprintf(fd, "FrameArena: %d objects alive, peak %d, %d chunks\n",
+                      static_cast<int>(arena->getObjectCount()), static_cast<int>(arena->getPeakObjectCount()),
+                      static_cast<int>(arena->getChunkCount()));
+            sendPrompt(fd);
+        }
+                                            );
+    }
+    else
+    {
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'reset' or nothing\n", args.c_str());
     }
 }
 
+void Console::commandProfile(int fd, const std::string& args)
+{
+    // FrameProfiler is thread safe, it's used from the console thread so a large trace doesn't stall a frame
+    auto profiler = FrameProfiler::getInstance();
+
+    if( args.compare("start")== 0)
+    {
+        profiler->setEnabled(true);
+    }
+    else if( args.compare("stop")== 0)
+    {
+        profiler->setEnabled(false);
+    }
+    else if( args.compare("clear")== 0)
+    {
+        profiler->clear();
+    }
+    else if( args.compare("dump")== 0)
+    {
+        // the trace is larger than what mydprintf can send
+        std::string trace = profiler->getChromeTrace();
+        size_t sent = 0;
+        while (sent < trace.size())
+        {
+            ssize_t result = send(fd, trace.c_str() + sent, trace.size() - sent, 0);
+            if (result <= 0)
+            {
+                break;
+            }
+            sent += result;
+        }
+        send(fd, "\n", 1, 0);
+    }
+    else if( args.compare(0, 4, "save")== 0)
+    {
+        std::string filename = args.substr(4);
+        trim(filename);
+        if (filename.empty())
+        {
+            filename = "trace.json";
+        }
+        if (!FileUtils::getInstance()->isAbsolutePath(filename))
+        {
+            filename = FileUtils::getInstance()->getWritablePath() + filename;
+        }
+
+        if (profiler->writeChromeTrace(filename))
+        {
+            mydprintf(fd, "Trace saved to %s\n", filename.c_str());
+        }
+        else
+        {
+            mydprintf(fd, "Can't write the trace to %s\n", filename.c_str());
+        }
+    }
+    else if(args.length()==0)
+    {
+        mydprintf(fd, "Profiler is: %s\n", FrameProfiler::isEnabled() ? "on" : "off");
+    }
+    else
+    {
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'start', 'stop', 'clear', 'dump', 'save filename' or nothing\n", args.c_str());
+    }
+}
 
 void Console::commandDirector(int fd, const std::string& args)
 {
@@ -120,6 +120,8 @@ protected:
     void commandProjection(int fd, const std::string &args);
     void commandDirector(int fd, const std::string &args);
     void commandTouch(int fd, const std::string &args);
+    void commandProfile(int fd, const std::string &args);
+    void commandAutorelease(int fd, const std::string &args);
     void commandUpload(int fd);
     // file descriptor: socket, console, etc.
     int _listenfd;
@@ -78,11 +78,20 @@ Data& Data::operator= (Data&& other)
 
 void Data::move(Data& other)
 {
+    if (this == &other)
+    {
+        return;
+    }
+
+    clear();
+
     _bytes = other._bytes;
     _size = other._size;
+    _releaser = std::move(other._releaser);
     
     other._bytes = nullptr;
     other._size = 0;
+    other._releaser = nullptr;
 }
 
 bool Data::isNull() const
@@ -116,11 +125,30 @@ void Data::fastSet(unsigned char* bytes, const ssize_t size)
 {
     _bytes = bytes;
     _size = size;
+    _releaser = nullptr;
+}
+
+void Data::fastSet(unsigned char* bytes, const ssize_t size, const Releaser& releaser)
+{
+    _bytes = bytes;
+    _size = size;
+    _releaser = releaser;
 }
 
 void Data::clear()
 {
-    free(_bytes);
+    if (_releaser)
+    {
+        if (_bytes)
+        {
+            _releaser(_bytes, _size);
+        }
+        _releaser = nullptr;
+    }
+    else
+    {
+        free(_bytes);
+    }
     _bytes = nullptr;
     _size = 0;
 }
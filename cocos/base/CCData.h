@@ -30,6 +30,7 @@
 #include <stdint.h> // for ssize_t on android
 #include <string>   // for ssize_t on linux
 #include "CCStdC.h" // for ssize_t on window
+#include <functional>
 
 NS_CC_BEGIN
 
@@ -37,6 +38,9 @@ class CC_DLL Data
 {
 public:
     static const Data Null;
+
+    /** Releases a buffer set by fastSet(bytes, size, releaser) */
+    typedef std::function<void(unsigned char* bytes, ssize_t size)> Releaser;
     
     Data();
     Data(const Data& other);
@@ -73,6 +77,13 @@ public:
      *  @see Data::copy
      */
     void fastSet(unsigned char* bytes, const ssize_t size);
+
+    /** Fast set a buffer that wasn't allocated by 'malloc', e.g. a memory mapped file.
+     *  @param releaser It is called with the buffer instead of 'free' when Data releases the buffer.
+     *         It may capture what keeps the buffer alive.
+     *  @note Copying the Data copies the buffer into a 'malloc' one, moving it moves the releaser too.
+     */
+    void fastSet(unsigned char* bytes, const ssize_t size, const Releaser& releaser);
     
     /** Clears data, free buffer and reset data size */
     void clear();
@@ -86,6 +97,7 @@ private:
 private:
     unsigned char* _bytes;
     ssize_t _size;
+    Releaser _releaser;
 };
 
 NS_CC_END
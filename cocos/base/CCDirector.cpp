@@ -49,6 +49,7 @@ THE SOFTWARE.
 #include "2d/CCTextureCache.h"
 #include "2d/CCFontFreeType.h"
 #include "base/CCScheduler.h"
+#include "base/CCJobSystem.h"
 #include "base/ccMacros.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventCustom.h"
@@ -134,12 +135,22 @@ bool Director::init(void)
 
     _contentScaleFactor = 1.0f;
 
+    // the arena belongs to the thread that runs the main loop
+    FrameArena::getInstance();
+#if CC_ENABLE_FRAME_PROFILER
+    FrameProfiler::getInstance()->setThreadName("cocos");
+#endif
+
     // scheduler
     _scheduler = new Scheduler();
     // action manager
     _actionManager = new ActionManager();
     _scheduler->scheduleUpdate(_actionManager, Scheduler::PRIORITY_SYSTEM, false);
 
+    // job system, its workers start with the first job
+    _jobSystem = new JobSystem();
+    Image::setDecodeJobSystem(_jobSystem);
+
     _eventDispatcher = new EventDispatcher();
     _eventAfterDraw = new EventCustom(EVENT_AFTER_DRAW);
     _eventAfterDraw->setUserData(this);
@@ -167,6 +178,10 @@ Director::~Director(void)
 {
     CCLOGINFO("deallocing Director: %p", this);
 
+    // the jobs left finish first, their continuations may still be posted to the scheduler
+    Image::setDecodeJobSystem(nullptr);
+    CC_SAFE_DELETE(_jobSystem);
+
     CC_SAFE_RELEASE(_FPSLabel);
     CC_SAFE_RELEASE(_drawnVerticesLabel);
     CC_SAFE_RELEASE(_drawnBatchesLabel);
@@ -192,6 +207,7 @@ Director::~Director(void)
     
     // clean auto release pool
     PoolManager::destroyInstance();
+    FrameArena::destroyInstance();
 
     // delete _lastUpdate
     CC_SAFE_DELETE(_lastUpdate);
@@ -253,6 +269,8 @@ void Director::setGLDefaultValues()
 // Draw the Scene
 void Director::drawScene()
 {
+    CC_PROFILE_SCOPE("Director::drawScene", "director");
+
     // calculate "global" dt
     calculateDeltaTime();
     
@@ -287,17 +305,21 @@ void Director::drawScene()
 
     Matrix identity = Matrix::identity();
 
-    // draw the scene
-    if (_runningScene)
     {
-        _runningScene->visit(_renderer, identity, false);
-        _eventDispatcher->dispatchEvent(_eventAfterVisit);
-    }
+        CC_PROFILE_SCOPE("Director::visit", "director");
 
-    // draw the notifications node
-    if (_notificationNode)
-    {
-        _notificationNode->visit(_renderer, identity, false);
+        // draw the scene
+        if (_runningScene)
+        {
+            _runningScene->visit(_renderer, identity, false);
+            _eventDispatcher->dispatchEvent(_eventAfterVisit);
+        }
+
+        // draw the notifications node
+        if (_notificationNode)
+        {
+            _notificationNode->visit(_renderer, identity, false);
+        }
     }
 
     if (_displayStats)
@@ -315,6 +337,7 @@ void Director::drawScene()
     // swap buffers
     if (_openGLView)
     {
+        CC_PROFILE_SCOPE("Director::swapBuffers", "director");
         _openGLView->swapBuffers();
     }
 
@@ -1253,6 +1276,7 @@ void DisplayLinkDirector::mainLoop()
      
         // release the objects
         PoolManager::getInstance()->getCurrentPool()->clear();
+        FrameArena::getInstance()->endFrame();
     }
 }
 
@@ -61,6 +61,7 @@ class EventCustom;
 class EventListenerCustom;
 class TextureCache;
 class Renderer;
+class JobSystem;
 
 #if  (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
 class Console;
@@ -376,6 +377,11 @@ public:
      */
     void setActionManager(ActionManager* actionManager);
     
+    /** Gets the JobSystem that runs the jobs of the engine and of the game on worker threads
+     @since v3.1
+     */
+    JobSystem* getJobSystem() const { return _jobSystem; }
+
     /** Gets the EventDispatcher associated with this director 
      @since v3.0
      */
@@ -433,6 +439,11 @@ protected:
      @since v2.0
      */
     ActionManager *_actionManager;
+
+    /** JobSystem associated with this director
+     @since v3.1
+     */
+    JobSystem *_jobSystem;
     
     /** EventDispatcher associated with this director
      @since v3.0
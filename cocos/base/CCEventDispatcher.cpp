@@ -376,6 +376,60 @@ void EventDispatcher::removeEventListenersForTarget(Node* target, bool recursive
     }
 }
 
+void EventDispatcher::removeAddedEventListenersForTarget(Node* target)
+{
+    auto listenerIter = _nodeListenersMap.find(target);
+    if (listenerIter != _nodeListenersMap.end())
+    {
+        auto listenersCopy = *listenerIter->second;
+        for (auto& l : listenersCopy)
+        {
+            if (!l->_isBuiltWithNode)
+            {
+                removeEventListener(l);
+            }
+        }
+    }
+    
+    for (auto iter = _toAddedListeners.begin(); iter != _toAddedListeners.end(); )
+    {
+        EventListener * listener = *iter;
+        
+        if (listener->getAssociatedNode() == target && !listener->_isBuiltWithNode)
+        {
+            listener->setAssociatedNode(nullptr);
+            listener->setRegistered(false);
+            listener->release();
+            iter = _toAddedListeners.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+void EventDispatcher::markEventListenersBuiltWithTarget(Node* target)
+{
+    auto listenerIter = _nodeListenersMap.find(target);
+    if (listenerIter != _nodeListenersMap.end())
+    {
+        for (auto& l : *listenerIter->second)
+        {
+            l->_isBuiltWithNode = true;
+        }
+    }
+    
+    // listeners registered while an event is dispatched aren't associated yet
+    for (auto& l : _toAddedListeners)
+    {
+        if (l->getAssociatedNode() == target)
+        {
+            l->_isBuiltWithNode = true;
+        }
+    }
+}
+
 void EventDispatcher::associateNodeAndEventListener(Node* node, EventListener* listener)
 {
     std::vector<EventListener*>* listeners = nullptr;
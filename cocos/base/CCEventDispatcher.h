@@ -95,6 +95,18 @@ public:
     /** Removes all listeners which are associated with the specified target. */
     void removeEventListenersForTarget(Node* target, bool recursive = false);
     
+    /** Removes the listeners associated with the target, except the ones marked by markEventListenersBuiltWithTarget().
+     *  Node::resetForReuse() calls it, so the listeners that engine nodes register for themselves are kept.
+     *  @since v3.1
+     */
+    void removeAddedEventListenersForTarget(Node* target);
+
+    /** Marks the listeners associated with the target as part of what the target was built with.
+     *  NodePool calls it on the nodes it creates.
+     *  @since v3.1
+     */
+    void markEventListenersBuiltWithTarget(Node* target);
+    
     /** Removes all custom listeners with the same event name */
     void removeCustomEventListeners(const std::string& customEventName);
 
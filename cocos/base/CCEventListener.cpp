@@ -43,6 +43,7 @@ bool EventListener::init(Type t, const ListenerID& listenerID, const std::functi
     _isRegistered = false;
     _paused = true;
     _isEnabled = true;
+    _isBuiltWithNode = false;
     
     return true;
 }
@@ -150,6 +150,7 @@ protected:
     Node* _node;            // scene graph based priority
     bool _paused;           // Whether the listener is paused
     bool _isEnabled;        // Whether the listener is enabled
+    bool _isBuiltWithNode;  // Whether the listener was registered when its node was created, Node::resetForReuse() keeps it
     friend class EventDispatcher;
 };
 
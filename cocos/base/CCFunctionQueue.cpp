@@ -0,0 +1,208 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCFunctionQueue.h"
+#include "base/ccMacros.h"
+
+#include <algorithm>
+#include <chrono>
+
+NS_CC_BEGIN
+
+FunctionQueue::FunctionQueue(size_t capacity)
+: _enqueuePosition(0)
+, _dequeuePosition(0)
+, _overflowing(false)
+, _overflowSize(0)
+, _overflowCount(0)
+, _peakDepth(0)
+, _lastPerformedCount(0)
+{
+    size_t size = 2;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    _mask = size - 1;
+
+    _slots = new Slot[size];
+    for (size_t i = 0; i < size; ++i)
+    {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+FunctionQueue::~FunctionQueue()
+{
+    size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+    size_t end = _enqueuePosition.load(std::memory_order_relaxed);
+    for (; position != end; ++position)
+    {
+        Slot& slot = _slots[position & _mask];
+        if (slot.sequence.load(std::memory_order_acquire) == position + 1)
+        {
+            slot.destroy(&slot.storage);
+        }
+    }
+    delete [] _slots;
+
+    for (const auto& entry : _overflow)
+    {
+        entry.destroy(entry.function);
+    }
+}
+
+FunctionQueue::Slot* FunctionQueue::claimSlot(size_t& position)
+{
+    position = _enqueuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Slot* slot = &_slots[position & _mask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0)
+        {
+            // the slot is free for this position, try to take it
+            if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                return slot;
+            }
+        }
+        else if (difference < 0)
+        {
+            // the slot still holds the function of the previous round, the ring is full
+            return nullptr;
+        }
+        else
+        {
+            // another thread took the position
+            position = _enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void FunctionQueue::pushOverflow(const OverflowEntry& entry)
+{
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    _overflow.push_back(entry);
+    _overflowSize.store(_overflow.size(), std::memory_order_relaxed);
+    _overflowCount.fetch_add(1, std::memory_order_relaxed);
+    _overflowing.store(true, std::memory_order_release);
+}
+
+ssize_t FunctionQueue::getDepth() const
+{
+    size_t end = _enqueuePosition.load(std::memory_order_relaxed);
+    size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+    return (ssize_t)(end - position) + _overflowSize.load(std::memory_order_relaxed);
+}
+
+ssize_t FunctionQueue::perform(float timeBudget)
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(timeBudget));
+
+    ssize_t depth = getDepth();
+    _peakDepth = std::max(_peakDepth, depth);
+
+    // functions pushed while these are called, even by them, wait for the next call
+    const size_t end = _enqueuePosition.load(std::memory_order_acquire);
+    size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+    ssize_t performed = 0;
+    bool outOfTime = false;
+
+    while (position != end)
+    {
+        Slot& slot = _slots[position & _mask];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+        {
+            // taken by a producer that hasn't stored its function yet
+            break;
+        }
+
+        slot.invoke(&slot.storage);
+        // the slot is free for the position of the next round
+        slot.sequence.store(position + _mask + 1, std::memory_order_release);
+        ++position;
+        _dequeuePosition.store(position, std::memory_order_release);
+        ++performed;
+
+        if (timeBudget > 0 && Clock::now() >= deadline)
+        {
+            outOfTime = true;
+            break;
+        }
+    }
+
+    // The overflow functions must wait for the ones taking a ring slot before them. While it is
+    // overflowing new functions don't go to the ring, so it is empty by the next call at the latest.
+    if (position == end && ! outOfTime && _overflowing.load(std::memory_order_acquire))
+    {
+        std::vector<OverflowEntry> entries;
+        {
+            std::lock_guard<std::mutex> lock(_overflowMutex);
+            if (_enqueuePosition.load(std::memory_order_acquire) == position)
+            {
+                entries.swap(_overflow);
+                _overflowSize.store(0, std::memory_order_relaxed);
+            }
+        }
+        if (entries.empty())
+        {
+            _lastPerformedCount = performed;
+            return performed;
+        }
+
+        size_t i = 0;
+        while (i < entries.size())
+        {
+            entries[i].invoke(entries[i].function);
+            ++i;
+            ++performed;
+
+            if (timeBudget > 0 && Clock::now() >= deadline)
+            {
+                break;
+            }
+        }
+
+        // new functions go to the overflow list until it is empty, so they can't pass the ones left there
+        std::lock_guard<std::mutex> lock(_overflowMutex);
+        if (i < entries.size())
+        {
+            // out of time, put the others back in front of the ones pushed meanwhile
+            _overflow.insert(_overflow.begin(), entries.begin() + i, entries.end());
+            _overflowSize.store(_overflow.size(), std::memory_order_relaxed);
+        }
+        else if (_overflow.empty())
+        {
+            _overflowing.store(false, std::memory_order_release);
+        }
+    }
+
+    _lastPerformedCount = performed;
+    return performed;
+}
+
+NS_CC_END
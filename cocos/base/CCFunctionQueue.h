@@ -0,0 +1,214 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCFUNCTION_QUEUE_H__
+#define __CCFUNCTION_QUEUE_H__
+
+#include "base/CCPlatformMacros.h"
+#include <stdint.h> // for ssize_t on android
+#include <string>   // for ssize_t on linux
+#include "CCStdC.h" // for ssize_t on window
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief FunctionQueue passes functions from any number of threads to the thread that calls perform().
+
+ The functions are stored in a bounded ring without locks. A function of up to INLINE_STORAGE_SIZE
+ bytes, like a lambda capturing a few values, is stored in the ring itself, larger ones are
+ allocated. When the ring is full the functions go to a list protected by a mutex, and they still
+ run in the order each thread pushed them.
+
+ Scheduler uses it for performFunctionInCocosThread().
+ @since v3.1
+ */
+class CC_DLL FunctionQueue
+{
+public:
+    /** size of the functions that don't need an allocation */
+    static const size_t INLINE_STORAGE_SIZE = 48;
+
+    /** capacity is the number of functions the ring holds, rounded up to a power of 2 */
+    explicit FunctionQueue(size_t capacity = 1024);
+    /** destroys the functions that weren't performed */
+    ~FunctionQueue();
+
+    /** Adds a function, it can be called from any thread */
+    template <typename Function>
+    void push(Function&& function)
+    {
+        typedef typename std::decay<Function>::type Type;
+        if (! _overflowing.load(std::memory_order_acquire))
+        {
+            size_t position;
+            Slot* slot = claimSlot(position);
+            if (slot)
+            {
+                Callable<Type>::construct(slot->storage, std::forward<Function>(function), slot->invoke, slot->destroy);
+                slot->sequence.store(position + 1, std::memory_order_release);
+                return;
+            }
+        }
+
+        OverflowEntry entry;
+        entry.function = new Type(std::forward<Function>(function));
+        entry.invoke = &Callable<Type>::invokeAllocated;
+        entry.destroy = &Callable<Type>::destroyAllocated;
+        pushOverflow(entry);
+    }
+
+    /** Calls the functions pushed before this call, in order, and returns how many were called.
+     Stops once timeBudget seconds passed, the others are called by the next perform().
+     0 means no limit. It must always be called from the same thread.
+     */
+    ssize_t perform(float timeBudget = 0);
+
+    /** Number of functions waiting, it can be called from any thread */
+    ssize_t getDepth() const;
+    /** Largest number of functions found waiting by perform() */
+    ssize_t getPeakDepth() const { return _peakDepth; }
+    /** Number of functions that were pushed while the ring was full */
+    ssize_t getOverflowCount() const { return _overflowCount.load(std::memory_order_relaxed); }
+    /** Number of functions called by the last perform() */
+    ssize_t getLastPerformedCount() const { return _lastPerformedCount; }
+
+protected:
+    typedef std::aligned_storage<INLINE_STORAGE_SIZE>::type Storage;
+    typedef void (*InvokeFunction)(void* storage);
+
+    /** a ring slot, its sequence tells whether it is free for the position or holds its function */
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        /** calls and destroys the function */
+        InvokeFunction invoke;
+        /** destroys the function without calling it */
+        InvokeFunction destroy;
+        Storage storage;
+    };
+
+    struct OverflowEntry
+    {
+        void* function;
+        InvokeFunction invoke;
+        InvokeFunction destroy;
+    };
+
+    template <typename Type, bool Inline = (sizeof(Type) <= sizeof(Storage) && std::alignment_of<Type>::value <= std::alignment_of<Storage>::value)>
+    struct Callable
+    {
+        template <typename Function>
+        static void construct(Storage& storage, Function&& function, InvokeFunction& invoke, InvokeFunction& destroy)
+        {
+            new (&storage) Type(std::forward<Function>(function));
+            invoke = &invokeInline;
+            destroy = &destroyInline;
+        }
+        static void invokeInline(void* storage)
+        {
+            Type* function = static_cast<Type*>(storage);
+            (*function)();
+            function->~Type();
+        }
+        static void destroyInline(void* storage)
+        {
+            static_cast<Type*>(storage)->~Type();
+        }
+        static void invokeAllocated(void* function)
+        {
+            (*static_cast<Type*>(function))();
+            delete static_cast<Type*>(function);
+        }
+        static void destroyAllocated(void* function)
+        {
+            delete static_cast<Type*>(function);
+        }
+    };
+
+    template <typename Type>
+    struct Callable<Type, false> : public Callable<Type, true>
+    {
+        // too large for the slot, the slot stores a pointer to it
+        template <typename Function>
+        static void construct(Storage& storage, Function&& function, InvokeFunction& invoke, InvokeFunction& destroy)
+        {
+            *reinterpret_cast<Type**>(&storage) = new Type(std::forward<Function>(function));
+            invoke = &invokePointer;
+            destroy = &destroyPointer;
+        }
+        static void invokePointer(void* storage)
+        {
+            Callable<Type, true>::invokeAllocated(*static_cast<Type**>(storage));
+        }
+        static void destroyPointer(void* storage)
+        {
+            Callable<Type, true>::destroyAllocated(*static_cast<Type**>(storage));
+        }
+    };
+
+    /** reserves the slot of the next position, or returns nullptr if the ring is full */
+    Slot* claimSlot(size_t& position);
+    void pushOverflow(const OverflowEntry& entry);
+
+    Slot* _slots;
+    size_t _mask;
+
+    // the producers and the consumer positions are on different cache lines
+    char _padding0[64];
+    std::atomic<size_t> _enqueuePosition;
+    char _padding1[64];
+    std::atomic<size_t> _dequeuePosition;
+    char _padding2[64];
+
+    /** true while functions are in the overflow list, new functions go there too to keep their order */
+    std::atomic<bool> _overflowing;
+    std::atomic<ssize_t> _overflowSize;
+    std::atomic<ssize_t> _overflowCount;
+    std::mutex _overflowMutex;
+    std::vector<OverflowEntry> _overflow;
+
+    ssize_t _peakDepth;
+    ssize_t _lastPerformedCount;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(FunctionQueue);
+};
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __CCFUNCTION_QUEUE_H__
@@ -0,0 +1,379 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCJobSystem.h"
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "base/CCProfiling.h"
+#include "base/ccMacros.h"
+
+#include <algorithm>
+
+NS_CC_BEGIN
+
+JobSystem::Job::Job()
+: _pendingDependencies(1)
+, _finished(false)
+{
+}
+
+JobSystem::JobSystem()
+: _started(false)
+, _queuedJobCount(0)
+, _quit(false)
+{
+    // the cocos thread takes one core
+    _workerCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+}
+
+JobSystem::~JobSystem()
+{
+    CCLOGINFO("deallocing JobSystem: %p", this);
+
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _quit = true;
+    }
+    _sleepCondition.notify_all();
+
+    // the workers that are still running may steal from the queues of the others
+    for (auto& worker : _workers)
+    {
+        worker->thread.join();
+    }
+    for (auto& worker : _workers)
+    {
+        delete worker;
+    }
+}
+
+void JobSystem::setWorkerCount(int count)
+{
+    CCASSERT(! _started, "setWorkerCount must be called before the first job is added");
+    _workerCount = std::max(count, 1);
+}
+
+void JobSystem::start()
+{
+    std::lock_guard<std::mutex> lock(_startMutex);
+    if (_started)
+    {
+        return;
+    }
+
+    // all the workers exist before any of them looks for jobs to steal
+    for (int i = 0; i < _workerCount; ++i)
+    {
+        _workers.push_back(new Worker());
+    }
+    for (int i = 0; i < _workerCount; ++i)
+    {
+        _workers[i]->thread = std::thread(&JobSystem::loop, this, i);
+        _workers[i]->threadId = _workers[i]->thread.get_id();
+    }
+    _started.store(true, std::memory_order_release);
+}
+
+int JobSystem::getCurrentWorkerIndex() const
+{
+    if (! _started.load(std::memory_order_acquire))
+    {
+        return -1;
+    }
+
+    auto threadId = std::this_thread::get_id();
+    for (int i = 0; i < (int)_workers.size(); ++i)
+    {
+        if (_workers[i]->threadId == threadId)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+JobSystem::JobPtr JobSystem::addJob(const std::function<void()>& function, const std::vector<JobPtr>& dependencies, const std::function<void()>& continuation)
+{
+    CCASSERT(function, "JobSystem: function MUST not be nil");
+
+    if (! _started.load(std::memory_order_acquire))
+    {
+        start();
+    }
+
+    JobPtr job(new Job());
+    job->_function = function;
+    job->_continuation = continuation;
+
+    for (const auto& dependency : dependencies)
+    {
+        if (! dependency)
+        {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(dependency->_mutex);
+        if (! dependency->_finished.load(std::memory_order_relaxed))
+        {
+            job->_pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+            dependency->_dependents.push_back(job);
+        }
+    }
+
+    // drop the count held while adding, the last dependency to finish schedules the job otherwise
+    if (job->_pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        schedule(job);
+    }
+    return job;
+}
+
+void JobSystem::schedule(const JobPtr& job)
+{
+    int workerIndex = getCurrentWorkerIndex();
+    if (workerIndex >= 0)
+    {
+        Worker* worker = _workers[workerIndex];
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->jobs.push_back(job);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        _queue.push_back(job);
+    }
+    _queuedJobCount.fetch_add(1, std::memory_order_release);
+
+    // a worker checking the count under the mutex can't miss the notification
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _sleepCondition.notify_one();
+}
+
+JobSystem::JobPtr JobSystem::takeJob(int workerIndex)
+{
+    JobPtr job;
+
+    // the newest job of the worker first, its data is likely still in the cache
+    if (workerIndex >= 0)
+    {
+        Worker* worker = _workers[workerIndex];
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (! worker->jobs.empty())
+        {
+            job = worker->jobs.back();
+            worker->jobs.pop_back();
+        }
+    }
+
+    if (! job)
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        if (! _queue.empty())
+        {
+            job = _queue.front();
+            _queue.pop_front();
+        }
+    }
+
+    // steal the oldest job of another worker
+    for (int i = 1; ! job && i <= (int)_workers.size(); ++i)
+    {
+        Worker* victim = _workers[(workerIndex + i + (int)_workers.size()) % _workers.size()];
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if (! victim->jobs.empty())
+        {
+            job = victim->jobs.front();
+            victim->jobs.pop_front();
+        }
+    }
+
+    if (job)
+    {
+        _queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+void JobSystem::run(const JobPtr& job)
+{
+    {
+        CC_PROFILE_SCOPE("JobSystem::run", "jobs");
+        job->_function();
+    }
+    // release what the function captured
+    job->_function = nullptr;
+
+    std::vector<JobPtr> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->_mutex);
+        job->_finished.store(true, std::memory_order_release);
+        dependents.swap(job->_dependents);
+    }
+    job->_finishedCondition.notify_all();
+
+    for (const auto& dependent : dependents)
+    {
+        if (dependent->_pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            schedule(dependent);
+        }
+    }
+
+    if (job->_continuation)
+    {
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread(job->_continuation);
+        job->_continuation = nullptr;
+    }
+}
+
+void JobSystem::loop(int workerIndex)
+{
+#if CC_ENABLE_FRAME_PROFILER
+    char name[32];
+    snprintf(name, sizeof(name), "JobSystem worker %d", workerIndex);
+    FrameProfiler::getInstance()->setThreadName(name);
+#endif
+
+    while (true)
+    {
+        JobPtr job = takeJob(workerIndex);
+        if (job)
+        {
+            run(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        // the jobs that were added are run before quitting
+        _sleepCondition.wait(lock, [this]{ return _quit || _queuedJobCount.load(std::memory_order_acquire) > 0; });
+        if (_quit && _queuedJobCount.load(std::memory_order_acquire) == 0)
+        {
+            return;
+        }
+    }
+}
+
+void JobSystem::wait(const JobPtr& job)
+{
+    if (! job)
+    {
+        return;
+    }
+
+    int workerIndex = getCurrentWorkerIndex();
+    if (workerIndex < 0)
+    {
+        std::unique_lock<std::mutex> lock(job->_mutex);
+        job->_finishedCondition.wait(lock, [&job]{ return job->_finished.load(std::memory_order_relaxed); });
+        return;
+    }
+
+    // a worker keeps running jobs, the job it waits for may be in its own queue
+    while (! job->isFinished())
+    {
+        JobPtr other = takeJob(workerIndex);
+        if (other)
+        {
+            run(other);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallelFor(int begin, int end, int minRange, const std::function<void(int first, int last)>& function)
+{
+    int count = end - begin;
+    if (count <= 0)
+    {
+        return;
+    }
+
+    // a few ranges per thread, so the threads that start late still get some
+    int rangeCount = std::min((_workerCount + 1) * 4, count / std::max(minRange, 1));
+    if (rangeCount <= 1)
+    {
+        function(begin, end);
+        return;
+    }
+
+    struct Ranges
+    {
+        std::atomic<int> next;
+        int count;
+        int size;
+        // ranges that returned, guarded by mutex
+        int finished;
+        std::mutex mutex;
+        std::condition_variable finishedCondition;
+    };
+
+    auto ranges = std::make_shared<Ranges>();
+    ranges->next = 0;
+    ranges->size = (count + rangeCount - 1) / rangeCount;
+    ranges->count = (count + ranges->size - 1) / ranges->size;
+    ranges->finished = 0;
+
+    // a helper that starts after all the ranges were taken returns without using function,
+    // which may be gone by then
+    const std::function<void(int, int)>* functionPtr = &function;
+    auto runRanges = [ranges, functionPtr, begin, end]() {
+        int finished = 0;
+        int range;
+        while ((range = ranges->next.fetch_add(1, std::memory_order_relaxed)) < ranges->count)
+        {
+            int first = begin + range * ranges->size;
+            (*functionPtr)(first, std::min(first + ranges->size, end));
+            ++finished;
+        }
+
+        if (finished > 0)
+        {
+            std::lock_guard<std::mutex> lock(ranges->mutex);
+            ranges->finished += finished;
+            if (ranges->finished == ranges->count)
+            {
+                ranges->finishedCondition.notify_all();
+            }
+        }
+    };
+
+    int helperCount = std::min(_workerCount, ranges->count - 1);
+    for (int i = 0; i < helperCount; ++i)
+    {
+        addJob(runRanges);
+    }
+
+    runRanges();
+
+    // only the ranges that helpers are running are left
+    std::unique_lock<std::mutex> lock(ranges->mutex);
+    ranges->finishedCondition.wait(lock, [&ranges]{ return ranges->finished == ranges->count; });
+}
+
+NS_CC_END
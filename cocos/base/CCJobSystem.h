@@ -0,0 +1,164 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCJOB_SYSTEM_H__
+#define __CCJOB_SYSTEM_H__
+
+#include "base/CCPlatformMacros.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief JobSystem runs jobs on a pool of worker threads shared by the engine.
+
+ There is one worker per core besides the one of the cocos thread. Each worker has its own queue:
+ jobs added by a job go to the queue of its worker, and a worker without jobs takes the oldest ones
+ of the others. Jobs added by other threads go to a shared queue.
+
+ A job can wait for other jobs to finish before it starts, and it can have a continuation that is
+ called on the cocos thread after it finished:
+
+ @code
+ auto jobs = Director::getInstance()->getJobSystem();
+ auto parse = jobs->addJob([=]() { parseLevel(level); });
+ auto build = jobs->addJob([=]() { buildPaths(level); }, { parse }, [=]() { showLevel(level); });
+ @endcode
+
+ Jobs shouldn't block on I/O or locks for long, they would keep a worker from other jobs.
+ Use Director::getJobSystem() to get the one of the engine.
+ @since v3.1
+ */
+class CC_DLL JobSystem
+{
+public:
+    class CC_DLL Job
+    {
+    public:
+        /** Returns true once the function of the job returned. Its continuation may not have been called yet. */
+        bool isFinished() const { return _finished.load(std::memory_order_acquire); }
+
+    protected:
+        friend class JobSystem;
+
+        Job();
+
+        std::function<void()> _function;
+        std::function<void()> _continuation;
+        // the dependencies not finished yet, plus one while the job is being added
+        std::atomic<int> _pendingDependencies;
+        std::atomic<bool> _finished;
+        // guards _dependents and the change of _finished
+        std::mutex _mutex;
+        // notified when _finished changes, for the threads that wait without being workers
+        std::condition_variable _finishedCondition;
+        std::vector<std::shared_ptr<Job>> _dependents;
+
+    private:
+        CC_DISALLOW_COPY_AND_ASSIGN(Job);
+    };
+
+    typedef std::shared_ptr<Job> JobPtr;
+
+    JobSystem();
+    /** Waits for the jobs that were added to finish, then stops the workers */
+    ~JobSystem();
+
+    /** Sets the number of workers, the number of cores minus one by default.
+     It only takes effect before the first job is added.
+     */
+    void setWorkerCount(int count);
+    int getWorkerCount() const { return _workerCount; }
+
+    /** Runs function on a worker after the dependencies finished, then calls continuation on the cocos thread.
+     It can be called from any thread. The dependencies that are nullptr are ignored.
+     */
+    JobPtr addJob(const std::function<void()>& function, const std::vector<JobPtr>& dependencies = std::vector<JobPtr>(), const std::function<void()>& continuation = nullptr);
+
+    /** Waits for a job to finish. It doesn't wait for the continuation.
+     A worker runs other jobs meanwhile, other threads block: the cocos thread would otherwise run
+     older jobs that have nothing to do with the one it waits for.
+     */
+    void wait(const JobPtr& job);
+
+    /** Calls function(first, last) over ranges of [begin, end) of at least minRange items, on the workers and
+     the calling thread, and returns once all of them returned.
+     The calling thread takes the ranges that no worker took yet, so it only waits for the ranges being run:
+     it doesn't wait for the workers to finish the jobs that were added before.
+     */
+    void parallelFor(int begin, int end, int minRange, const std::function<void(int first, int last)>& function);
+
+protected:
+    struct Worker
+    {
+        std::thread thread;
+        std::thread::id threadId;
+        std::mutex mutex;
+        std::deque<JobPtr> jobs;
+    };
+
+    void start();
+    void loop(int workerIndex);
+    /** index of the worker of the calling thread, or -1 */
+    int getCurrentWorkerIndex() const;
+    void schedule(const JobPtr& job);
+    JobPtr takeJob(int workerIndex);
+    void run(const JobPtr& job);
+
+    int _workerCount;
+    std::vector<Worker*> _workers;
+    std::atomic<bool> _started;
+    std::mutex _startMutex;
+
+    // jobs added by threads that aren't workers
+    std::deque<JobPtr> _queue;
+    std::mutex _queueMutex;
+
+    std::atomic<int> _queuedJobCount;
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCondition;
+    bool _quit;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(JobSystem);
+};
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __CCJOB_SYSTEM_H__
@@ -26,6 +26,14 @@ THE SOFTWARE.
 #include "base/CCProfiling.h"
 
 #include <chrono>
+#include <algorithm>
+#include <stdio.h>
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT) || (CC_TARGET_PLATFORM == CC_PLATFORM_WP8)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
 
 using namespace std;
 
@@ -182,5 +190,327 @@ void ProfilingResetTimingBlock(const char *timerName)
     timer->reset();
 }
 
+// FrameProfiler
+
+struct FrameProfiler::ThreadBuffer
+{
+    std::string name;
+    int tid;
+    // guards the events, the thread records while the trace is read by another one
+    std::mutex mutex;
+    std::vector<Event> events;
+    // where the next event goes, and how many are kept
+    size_t next;
+    size_t count;
+    // depth of the scope being recorded, only used by the thread
+    int depth;
+    // the thread exited, the buffer is only kept for its calls
+    bool exited;
+};
+
+std::atomic<bool> FrameProfiler::s_enabled(false);
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT) || (CC_TARGET_PLATFORM == CC_PLATFORM_WP8)
+// a fiber local slot rather than __declspec(thread), its callback releases the buffer when the thread exits
+static DWORD s_threadBufferIndex = FLS_OUT_OF_INDEXES;
+static INIT_ONCE s_threadBufferIndexOnce = INIT_ONCE_STATIC_INIT;
+
+static VOID WINAPI releaseThreadBuffer(PVOID buffer)
+{
+    FrameProfiler::getInstance()->releaseThreadBuffer(static_cast<FrameProfiler::ThreadBuffer*>(buffer));
+}
+
+static BOOL CALLBACK createThreadBufferIndex(PINIT_ONCE, PVOID, PVOID*)
+{
+    s_threadBufferIndex = FlsAlloc(releaseThreadBuffer);
+    return s_threadBufferIndex != FLS_OUT_OF_INDEXES;
+}
+
+static FrameProfiler::ThreadBuffer* getCurrentThreadBuffer()
+{
+    InitOnceExecuteOnce(&s_threadBufferIndexOnce, createThreadBufferIndex, nullptr, nullptr);
+    return static_cast<FrameProfiler::ThreadBuffer*>(FlsGetValue(s_threadBufferIndex));
+}
+
+static void setCurrentThreadBuffer(FrameProfiler::ThreadBuffer* buffer)
+{
+    InitOnceExecuteOnce(&s_threadBufferIndexOnce, createThreadBufferIndex, nullptr, nullptr);
+    FlsSetValue(s_threadBufferIndex, buffer);
+}
+#else
+static pthread_key_t s_threadBufferKey;
+static pthread_once_t s_threadBufferKeyOnce = PTHREAD_ONCE_INIT;
+
+static void releaseThreadBuffer(void* buffer)
+{
+    FrameProfiler::getInstance()->releaseThreadBuffer(static_cast<FrameProfiler::ThreadBuffer*>(buffer));
+}
+
+static void createThreadBufferKey()
+{
+    pthread_key_create(&s_threadBufferKey, releaseThreadBuffer);
+}
+
+static FrameProfiler::ThreadBuffer* getCurrentThreadBuffer()
+{
+    pthread_once(&s_threadBufferKeyOnce, createThreadBufferKey);
+    return static_cast<FrameProfiler::ThreadBuffer*>(pthread_getspecific(s_threadBufferKey));
+}
+
+static void setCurrentThreadBuffer(FrameProfiler::ThreadBuffer* buffer)
+{
+    pthread_once(&s_threadBufferKeyOnce, createThreadBufferKey);
+    pthread_setspecific(s_threadBufferKey, buffer);
+}
+#endif
+
+FrameProfiler* FrameProfiler::getInstance()
+{
+    // never deleted, scopes may be recorded by threads that outlive the Director
+    static FrameProfiler* s_sharedFrameProfiler = new FrameProfiler();
+    return s_sharedFrameProfiler;
+}
+
+FrameProfiler::FrameProfiler()
+: _epoch(std::chrono::steady_clock::now())
+, _eventCapacity(16384)
+{
+}
+
+int FrameProfiler::registerScope(const char* name, const char* category)
+{
+    std::lock_guard<std::mutex> lock(_scopesMutex);
+
+    auto iter = _scopeIds.find(name);
+    if (iter != _scopeIds.end())
+    {
+        return iter->second;
+    }
+
+    int scopeId = static_cast<int>(_scopes.size());
+    Scope scope = { name, category };
+    _scopes.push_back(scope);
+    _scopeIds[name] = scopeId;
+    return scopeId;
+}
+
+int FrameProfiler::getScopeId(std::atomic<int>& scopeId, const char* name, const char* category)
+{
+    int id = scopeId.load(std::memory_order_acquire);
+    if (id < 0)
+    {
+        // threads racing here get the same id from registerScope
+        id = registerScope(name, category);
+        scopeId.store(id, std::memory_order_release);
+    }
+    return id;
+}
+
+int64_t FrameProfiler::now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch).count();
+}
+
+FrameProfiler::ThreadBuffer* FrameProfiler::getThreadBuffer()
+{
+    ThreadBuffer* buffer = getCurrentThreadBuffer();
+    if (buffer == nullptr)
+    {
+        // the events are allocated by beginScope, threads that are only named don't use memory for them
+        buffer = new ThreadBuffer();
+        buffer->next = 0;
+        buffer->count = 0;
+        buffer->depth = 0;
+        buffer->exited = false;
+
+        std::lock_guard<std::mutex> lock(_buffersMutex);
+        buffer->tid = static_cast<int>(_buffers.size()) + 1;
+        char name[32];
+        snprintf(name, sizeof(name), "thread %d", buffer->tid);
+        buffer->name = name;
+        _buffers.push_back(buffer);
+        setCurrentThreadBuffer(buffer);
+    }
+    return buffer;
+}
+
+void FrameProfiler::setThreadName(const std::string& name)
+{
+    ThreadBuffer* buffer = getThreadBuffer();
+
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+    buffer->name = name;
+}
+
+FrameProfiler::ThreadBuffer* FrameProfiler::beginScope(int64_t& start)
+{
+    ThreadBuffer* buffer = getThreadBuffer();
+    if (buffer->events.empty())
+    {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->events.resize(std::max(_eventCapacity, static_cast<size_t>(1)));
+    }
+    ++buffer->depth;
+    start = now();
+    return buffer;
+}
+
+void FrameProfiler::releaseThreadBuffer(ThreadBuffer* buffer)
+{
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+    if (buffer->count > 0)
+    {
+        // its calls stay in the trace until clear()
+        buffer->exited = true;
+        return;
+    }
+
+    _buffers.erase(std::remove(_buffers.begin(), _buffers.end(), buffer), _buffers.end());
+    delete buffer;
+}
+
+void FrameProfiler::endScope(ThreadBuffer* buffer, int scopeId, int64_t start)
+{
+    int64_t end = now();
+    int depth = --buffer->depth;
+
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    Event& event = buffer->events[buffer->next];
+    event.scopeId = scopeId;
+    event.depth = depth;
+    event.start = start;
+    event.end = end;
+
+    buffer->next = (buffer->next + 1) % buffer->events.size();
+    buffer->count = std::min(buffer->count + 1, buffer->events.size());
+}
+
+void FrameProfiler::clear()
+{
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+    for (auto iter = _buffers.begin(); iter != _buffers.end(); )
+    {
+        ThreadBuffer* buffer = *iter;
+        if (buffer->exited)
+        {
+            iter = _buffers.erase(iter);
+            delete buffer;
+            continue;
+        }
+
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->next = 0;
+        buffer->count = 0;
+        ++iter;
+    }
+}
+
+static void appendJSONString(std::string& out, const char* str)
+{
+    out += '"';
+    for (const char* p = str; *p; ++p)
+    {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += *p;
+        }
+        else if (c < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        }
+        else
+        {
+            out += *p;
+        }
+    }
+    out += '"';
+}
+
+std::string FrameProfiler::getChromeTrace()
+{
+    std::vector<Scope> scopes;
+    {
+        std::lock_guard<std::mutex> lock(_scopesMutex);
+        scopes = _scopes;
+    }
+
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+    char number[96];
+
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+    for (auto buffer : _buffers)
+    {
+        if (!first)
+        {
+            out += ',';
+        }
+        first = false;
+
+        snprintf(number, sizeof(number), "{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":", buffer->tid);
+        out += number;
+        appendJSONString(out, buffer->name.c_str());
+        out += "}}";
+
+        // copies the events, so the thread doesn't wait for the string to be built
+        std::vector<Event> events;
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            events.reserve(buffer->count);
+            size_t size = std::max(buffer->events.size(), static_cast<size_t>(1));
+            size_t begin = (buffer->next + size - buffer->count) % size;
+            for (size_t i = 0; i < buffer->count; ++i)
+            {
+                events.push_back(buffer->events[(begin + i) % size]);
+            }
+        }
+
+        for (const auto& event : events)
+        {
+            if (event.scopeId < 0 || event.scopeId >= static_cast<int>(scopes.size()))
+            {
+                continue;
+            }
+            const Scope& scope = scopes[event.scopeId];
+
+            out += ",{\"ph\":\"X\",\"name\":";
+            appendJSONString(out, scope.name);
+            out += ",\"cat\":";
+            appendJSONString(out, scope.category);
+            // microseconds, with the nanoseconds as decimals
+            snprintf(number, sizeof(number), ",\"pid\":1,\"tid\":%d,\"ts\":%lld.%03d,\"dur\":%lld.%03d,\"args\":{\"depth\":%d}}",
+                     buffer->tid,
+                     static_cast<long long>(event.start / 1000), static_cast<int>(event.start % 1000),
+                     static_cast<long long>((event.end - event.start) / 1000), static_cast<int>((event.end - event.start) % 1000),
+                     event.depth);
+            out += number;
+        }
+    }
+
+    out += "]}";
+    return out;
+}
+
+bool FrameProfiler::writeChromeTrace(const std::string& path)
+{
+    std::string trace = getChromeTrace();
+
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        CCLOG("FrameProfiler: can't open %s", path.c_str());
+        return false;
+    }
+
+    size_t written = fwrite(trace.c_str(), 1, trace.size(), fp);
+    fclose(fp);
+
+    return written == trace.size();
+}
+
 NS_CC_END
 
@@ -28,6 +28,11 @@ THE SOFTWARE.
 
 #include <string>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
 #include "base/ccConfig.h"
 #include "base/CCRef.h"
 #include "base/CCMap.h"
@@ -156,6 +161,143 @@ extern bool kProfilerCategorySprite;
 extern bool kProfilerCategoryBatchSprite;
 extern bool kProfilerCategoryParticles;
 
+/** @brief FrameProfiler records when the scopes marked with CC_PROFILE_SCOPE start and end, on every thread.
+
+ Unlike Profiler, it keeps each call rather than averages: every thread writes to its own ring buffer,
+ which holds its last calls, and the nested scopes make a timeline of each frame.
+ getChromeTrace() exports it in the trace event format, to be opened with chrome://tracing.
+
+ It is compiled in unless CC_ENABLE_FRAME_PROFILER is 0, and records nothing until it is enabled,
+ either with setEnabled() or with the "profile" command of the Console. A disabled scope costs
+ a test of a flag.
+
+ @code
+ void World::step(float dt)
+ {
+     CC_PROFILE_SCOPE("World::step", "game");
+     ...
+ }
+ @endcode
+ @since v3.1
+ */
+class CC_DLL FrameProfiler
+{
+public:
+    static FrameProfiler* getInstance();
+
+    /** Returns the id of the scope with this name, registering it the first time.
+     The name and category must be string literals, they aren't copied.
+     */
+    int registerScope(const char* name, const char* category);
+    /** Returns the id kept in scopeId, registering the scope if it is still -1. Used by CC_PROFILE_SCOPE */
+    int getScopeId(std::atomic<int>& scopeId, const char* name, const char* category);
+
+    /** Starts or stops recording */
+    void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /** Number of scope calls each thread keeps, 16384 by default. The buffer of a thread is allocated
+     when it records its first call, so it applies to the threads that start recording later.
+     */
+    void setEventCapacity(size_t capacity) { _eventCapacity = capacity; }
+    size_t getEventCapacity() const { return _eventCapacity; }
+
+    /** Names the calling thread in the trace. Only the name is kept until the thread records a call. */
+    void setThreadName(const std::string& name);
+
+    /** Forgets the calls recorded so far, and the threads that have exited */
+    void clear();
+
+    /** Returns the calls recorded, as Chrome trace event JSON */
+    std::string getChromeTrace();
+    /** Writes getChromeTrace() to a file, returns false if it can't be written */
+    bool writeChromeTrace(const std::string& path);
+
+    /** used by ProfileScope */
+    struct ThreadBuffer;
+    ThreadBuffer* beginScope(int64_t& start);
+    void endScope(ThreadBuffer* buffer, int scopeId, int64_t start);
+    /** called when a thread exits, its buffer is kept until clear() if it has calls */
+    void releaseThreadBuffer(ThreadBuffer* buffer);
+
+protected:
+    struct Scope
+    {
+        const char* name;
+        const char* category;
+    };
+
+    struct Event
+    {
+        int scopeId;
+        int depth;
+        int64_t start;
+        int64_t end;
+    };
+
+    FrameProfiler();
+    ThreadBuffer* getThreadBuffer();
+    int64_t now() const;
+
+    static std::atomic<bool> s_enabled;
+
+    std::chrono::steady_clock::time_point _epoch;
+    size_t _eventCapacity;
+
+    std::mutex _scopesMutex;
+    std::vector<Scope> _scopes;
+    std::unordered_map<std::string, int> _scopeIds;
+
+    std::mutex _buffersMutex;
+    std::vector<ThreadBuffer*> _buffers;
+};
+
+/** Records the time spent between its construction and its destruction, use CC_PROFILE_SCOPE */
+class CC_DLL ProfileScope
+{
+public:
+    /** the scope is registered the first time it is recorded, scopeId is -1 until then */
+    ProfileScope(std::atomic<int>& scopeId, const char* name, const char* category)
+    : _buffer(nullptr)
+    , _scopeId(-1)
+    {
+        if (FrameProfiler::isEnabled())
+        {
+            FrameProfiler* profiler = FrameProfiler::getInstance();
+            _scopeId = profiler->getScopeId(scopeId, name, category);
+            _buffer = profiler->beginScope(_start);
+        }
+    }
+
+    ~ProfileScope()
+    {
+        if (_buffer)
+        {
+            FrameProfiler::getInstance()->endScope(_buffer, _scopeId, _start);
+        }
+    }
+
+private:
+    FrameProfiler::ThreadBuffer* _buffer;
+    int _scopeId;
+    int64_t _start;
+};
+
+/** @def CC_PROFILE_SCOPE
+ Records the rest of the enclosing block as a scope of FrameProfiler. name and category must be string literals.
+ The id of the scope is kept in a constant initialized atomic rather than a function local static initialized
+ by registerScope(), whose initialization isn't thread safe on every compiler.
+ */
+#if CC_ENABLE_FRAME_PROFILER
+#define CC_PROFILE_SCOPE_CONCAT_(__A__, __B__) __A__##__B__
+#define CC_PROFILE_SCOPE_CONCAT(__A__, __B__) CC_PROFILE_SCOPE_CONCAT_(__A__, __B__)
+#define CC_PROFILE_SCOPE(__NAME__, __CATEGORY__) \
+    static std::atomic<int> CC_PROFILE_SCOPE_CONCAT(__ccProfileScopeId, __LINE__) = ATOMIC_VAR_INIT(-1); \
+    cocos2d::ProfileScope CC_PROFILE_SCOPE_CONCAT(__ccProfileScope, __LINE__)(CC_PROFILE_SCOPE_CONCAT(__ccProfileScopeId, __LINE__), __NAME__, __CATEGORY__)
+#else
+#define CC_PROFILE_SCOPE(__NAME__, __CATEGORY__) do {} while (0)
+#endif
+
 // end of global group
 /// @}
 
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
+#include "base/CCProfiling.h"
 #include "2d/utlist.h"
 #include "2d/ccCArray.h"
 #include "2d/CCScriptSupport.h"
@@ -258,9 +259,8 @@ Scheduler::Scheduler(void)
 #if CC_ENABLE_SCRIPT_BINDING
 , _scriptHandlerEntries(20)
 #endif
+, _performFunctionTimeBudget(0)
 {
-    // I don't expect to have more than 30 functions to all per frame
-    _functionsToPerform.reserve(30);
 }
 
 Scheduler::~Scheduler(void)
@@ -804,16 +804,14 @@ void Scheduler::resumeTargets(const std::set<void*>& targetsToResume)
 
 void Scheduler::performFunctionInCocosThread(const std::function<void ()> &function)
 {
-    _performMutex.lock();
-
-    _functionsToPerform.push_back(function);
-
-    _performMutex.unlock();
+    _functionsToPerform.push(function);
 }
 
 // main loop
 void Scheduler::update(float dt)
 {
+    CC_PROFILE_SCOPE("Scheduler::update", "scheduler");
+
     _updateHashLocked = true;
 
     if (_timeScale != 1.0f)
@@ -951,19 +949,9 @@ void Scheduler::update(float dt)
     // Functions allocated from another thread
     //
 
-    // Testing size is faster than locking / unlocking.
-    // And almost never there will be functions scheduled to be called.
-    if( !_functionsToPerform.empty() ) {
-        _performMutex.lock();
-        // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
-        auto temp = _functionsToPerform;
-        _functionsToPerform.clear();
-        _performMutex.unlock();
-        for( const auto &function : temp ) {
-            function();
-        }
-        
-    }
+    // No lock is taken, and functions added by the callbacks are called in the next frame.
+    CC_PROFILE_SCOPE("Scheduler::performFunctions", "scheduler");
+    _functionsToPerform.perform(_performFunctionTimeBudget);
 }
 
 void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, unsigned int repeat, float delay, bool paused)
@@ -34,6 +34,7 @@ THE SOFTWARE.
 
 #include "base/CCRef.h"
 #include "base/CCVector.h"
+#include "base/CCFunctionQueue.h"
 #include "2d/uthash.h"
 
 NS_CC_BEGIN
@@ -363,6 +364,28 @@ public:
      @since v3.0
      */
     void performFunctionInCocosThread( const std::function<void()> &function);
+
+    /** calls a function object, like a lambda, on the cocos2d thread without wrapping it in a std::function.
+     Small ones are stored without allocation. This function is thread safe.
+     @since v3.1
+     */
+    template <typename Function>
+    void performFunctionInCocosThread(Function&& function)
+    {
+        _functionsToPerform.push(std::forward<Function>(function));
+    }
+
+    /** Sets how long, in seconds, update() may spend calling the functions of performFunctionInCocosThread.
+     The functions left are called in the next frames. 0, the default, means no limit.
+     @since v3.1
+     */
+    void setPerformFunctionTimeBudget(float timeBudget) { _performFunctionTimeBudget = timeBudget; }
+    float getPerformFunctionTimeBudget() const { return _performFunctionTimeBudget; }
+
+    /** The queue of the functions of performFunctionInCocosThread, for its depth and counters
+     @since v3.1
+     */
+    const FunctionQueue& getPerformFunctionQueue() const { return _functionsToPerform; }
     
     /////////////////////////////////////
     
@@ -459,8 +482,8 @@ protected:
 #endif
     
     // Used for "perform Function"
-    std::vector<std::function<void()>> _functionsToPerform;
-    std::mutex _performMutex;
+    FunctionQueue _functionsToPerform;
+    float _performFunctionTimeBudget;
 };
 
 // end of global group
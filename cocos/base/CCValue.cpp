@@ -32,59 +32,68 @@ const Value Value::Null;
 
 Value::Value()
 : _type(Type::NONE)
+, _inlineString(false)
 {
     memset(&_field, 0, sizeof(_field));
 }
 
 Value::Value(unsigned char v)
 : _type(Type::BYTE)
+, _inlineString(false)
 {
     _field.byteVal = v;
 }
 
 Value::Value(int v)
 : _type(Type::INTEGER)
+, _inlineString(false)
 {
     _field.intVal = v;
 }
 
 Value::Value(float v)
 : _type(Type::FLOAT)
+, _inlineString(false)
 {
     _field.floatVal = v;
 }
 
 Value::Value(double v)
 : _type(Type::DOUBLE)
+, _inlineString(false)
 {
     _field.doubleVal = v;
 }
 
 Value::Value(bool v)
 : _type(Type::BOOLEAN)
+, _inlineString(false)
 {
     _field.boolVal = v;
 }
 
 Value::Value(const char* v)
 : _type(Type::STRING)
+, _inlineString(true)
 {
-    _field.strVal = new std::string();
+    _field.inlineStrVal[0] = '\0';
     if (v)
     {
-        *_field.strVal = v;
+        setString(v, strlen(v));
     }
 }
 
 Value::Value(const std::string& v)
 : _type(Type::STRING)
+, _inlineString(true)
 {
-    _field.strVal = new std::string();
-    *_field.strVal = v;
+    _field.inlineStrVal[0] = '\0';
+    setString(v.data(), v.length());
 }
 
 Value::Value(const ValueVector& v)
 : _type(Type::VECTOR)
+, _inlineString(false)
 {
     _field.vectorVal = new ValueVector();
     *_field.vectorVal = v;
@@ -92,6 +101,7 @@ Value::Value(const ValueVector& v)
 
 Value::Value(ValueVector&& v)
 : _type(Type::VECTOR)
+, _inlineString(false)
 {
     _field.vectorVal = new ValueVector();
     *_field.vectorVal = std::move(v);
@@ -99,6 +109,7 @@ Value::Value(ValueVector&& v)
 
 Value::Value(const ValueMap& v)
 : _type(Type::MAP)
+, _inlineString(false)
 {
     _field.mapVal = new ValueMap();
     *_field.mapVal = v;
@@ -106,6 +117,7 @@ Value::Value(const ValueMap& v)
 
 Value::Value(ValueMap&& v)
 : _type(Type::MAP)
+, _inlineString(false)
 {
     _field.mapVal = new ValueMap();
     *_field.mapVal = std::move(v);
@@ -113,6 +125,7 @@ Value::Value(ValueMap&& v)
 
 Value::Value(const ValueMapIntKey& v)
 : _type(Type::INT_KEY_MAP)
+, _inlineString(false)
 {
     _field.intKeyMapVal = new ValueMapIntKey();
     *_field.intKeyMapVal = v;
@@ -120,6 +133,7 @@ Value::Value(const ValueMapIntKey& v)
 
 Value::Value(ValueMapIntKey&& v)
 : _type(Type::INT_KEY_MAP)
+, _inlineString(false)
 {
     _field.intKeyMapVal = new ValueMapIntKey();
     *_field.intKeyMapVal = std::move(v);
@@ -127,12 +141,14 @@ Value::Value(ValueMapIntKey&& v)
 
 Value::Value(const Value& other)
 : _type(Type::NONE)
+, _inlineString(false)
 {
     *this = other;
 }
 
 Value::Value(Value&& other)
 : _type(Type::NONE)
+, _inlineString(false)
 {
     *this = std::move(other);
 }
@@ -164,11 +180,14 @@ Value& Value::operator= (const Value& other)
                 _field.boolVal = other._field.boolVal;
                 break;
             case Type::STRING:
-                if (_field.strVal == nullptr)
+                if (other._inlineString)
                 {
-                    _field.strVal = new std::string();
+                    setString(other._field.inlineStrVal, strlen(other._field.inlineStrVal));
+                }
+                else
+                {
+                    setString(other._field.strVal->data(), other._field.strVal->length());
                 }
-                *_field.strVal = *other._field.strVal;
                 break;
             case Type::VECTOR:
                 if (_field.vectorVal == nullptr)
@@ -221,7 +240,8 @@ Value& Value::operator= (Value&& other)
                 _field.boolVal = other._field.boolVal;
                 break;
             case Type::STRING:
-                _field.strVal = other._field.strVal;
+                _field = other._field;
+                _inlineString = other._inlineString;
                 break;
             case Type::VECTOR:
                 _field.vectorVal = other._field.vectorVal;
@@ -239,6 +259,7 @@ Value& Value::operator= (Value&& other)
 
         memset(&other._field, 0, sizeof(other._field));
         other._type = Type::NONE;
+        other._inlineString = false;
     }
 
     return *this;
@@ -282,14 +303,21 @@ Value& Value::operator= (bool v)
 Value& Value::operator= (const char* v)
 {
     reset(Type::STRING);
-    *_field.strVal = v ? v : "";
+    if (v)
+    {
+        setString(v, strlen(v));
+    }
+    else
+    {
+        setString("", 0);
+    }
     return *this;
 }
 
 Value& Value::operator= (const std::string& v)
 {
     reset(Type::STRING);
-    *_field.strVal = v;
+    setString(v.data(), v.length());
     return *this;
 }
 
@@ -352,7 +380,7 @@ unsigned char Value::asByte() const
 
     if (_type == Type::STRING)
     {
-        return static_cast<unsigned char>(atoi(_field.strVal->c_str()));
+        return static_cast<unsigned char>(atoi(getCString()));
     }
 
     if (_type == Type::FLOAT)
@@ -388,7 +416,7 @@ int Value::asInt() const
 
     if (_type == Type::STRING)
     {
-        return atoi(_field.strVal->c_str());
+        return atoi(getCString());
     }
 
     if (_type == Type::FLOAT)
@@ -424,7 +452,7 @@ float Value::asFloat() const
 
     if (_type == Type::STRING)
     {
-        return atof(_field.strVal->c_str());
+        return atof(getCString());
     }
 
     if (_type == Type::INTEGER)
@@ -460,7 +488,7 @@ double Value::asDouble() const
 
     if (_type == Type::STRING)
     {
-        return static_cast<double>(atof(_field.strVal->c_str()));
+        return static_cast<double>(atof(getCString()));
     }
 
     if (_type == Type::INTEGER)
@@ -496,7 +524,8 @@ bool Value::asBool() const
 
     if (_type == Type::STRING)
     {
-        return (*_field.strVal == "0" || *_field.strVal == "false") ? false : true;
+        const char* str = getCString();
+        return (strcmp(str, "0") == 0 || strcmp(str, "false") == 0) ? false : true;
     }
 
     if (_type == Type::INTEGER)
@@ -523,7 +552,7 @@ std::string Value::asString() const
 
     if (_type == Type::STRING)
     {
-        return *_field.strVal;
+        return _inlineString ? std::string(_field.inlineStrVal) : *_field.strVal;
     }
 
     std::stringstream ret;
@@ -703,7 +732,15 @@ void Value::clear()
             _field.boolVal = false;
             break;
         case Type::STRING:
-            CC_SAFE_DELETE(_field.strVal);
+            if (_inlineString)
+            {
+                _field.strVal = nullptr;
+                _inlineString = false;
+            }
+            else
+            {
+                CC_SAFE_DELETE(_field.strVal);
+            }
             break;
         case Type::VECTOR:
             CC_SAFE_DELETE(_field.vectorVal);
@@ -732,7 +769,8 @@ void Value::reset(Type type)
     switch (type)
     {
         case Type::STRING:
-            _field.strVal = new std::string();
+            _field.inlineStrVal[0] = '\0';
+            _inlineString = true;
             break;
         case Type::VECTOR:
             _field.vectorVal = new ValueVector();
@@ -750,4 +788,33 @@ void Value::reset(Type type)
     _type = type;
 }
 
+void Value::setString(const char* str, size_t length)
+{
+    // strings with '\0' in them stay in a std::string to keep their length
+    if (length <= INLINE_STRING_CAPACITY && memchr(str, '\0', length) == nullptr)
+    {
+        if (!_inlineString)
+        {
+            CC_SAFE_DELETE(_field.strVal);
+            _inlineString = true;
+        }
+        memcpy(_field.inlineStrVal, str, length);
+        _field.inlineStrVal[length] = '\0';
+    }
+    else if (_inlineString)
+    {
+        _field.strVal = new std::string(str, length);
+        _inlineString = false;
+    }
+    else
+    {
+        _field.strVal->assign(str, length);
+    }
+}
+
+const char* Value::getCString() const
+{
+    return _inlineString ? _field.inlineStrVal : _field.strVal->c_str();
+}
+
 NS_CC_END
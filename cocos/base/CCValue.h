@@ -124,9 +124,16 @@ public:
     std::string getDescription();
 
 private:
+    /** Strings up to this length are stored in the Value itself instead of a heap allocated std::string. */
+    static const size_t INLINE_STRING_CAPACITY = 15;
+
     void clear();
     void reset(Type type);
 
+    /** Sets the string of a Type::STRING value. */
+    void setString(const char* str, size_t length);
+    const char* getCString() const;
+
     union
     {
         unsigned char byteVal;
@@ -136,12 +143,14 @@ private:
         bool boolVal;
 
         std::string* strVal;
+        char inlineStrVal[INLINE_STRING_CAPACITY + 1];
         ValueVector* vectorVal;
         ValueMap* mapVal;
         ValueMapIntKey* intKeyMapVal;
     }_field;
 
     Type _type;
+    bool _inlineString;     // a Type::STRING value stores its string in _field.inlineStrVal
 };
 
 NS_CC_END
@@ -32,6 +32,15 @@
 #include "2d/platform/CCFileUtils.h"
 #include "unzip.h"
 #include <map>
+#include <mutex>
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
+#define CC_ZIPFILE_USE_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 NS_CC_BEGIN
 
@@ -484,27 +493,81 @@ void ZipUtils::setPvrEncryptionKey(unsigned int keyPart1, unsigned int keyPart2,
 // from unzip.cpp
 #define UNZ_MAXFILENAMEINZIP 256
 
+// signatures and fixed sizes of the zip records, see the zip APPNOTE
+#define ZIP_CENTRAL_HEADER_SIGNATURE 0x02014b50
+#define ZIP_LOCAL_HEADER_SIGNATURE   0x04034b50
+#define ZIP_CENTRAL_HEADER_SIZE      46
+#define ZIP_LOCAL_HEADER_SIZE        30
+
 struct ZipEntryInfo
 {
     unz_file_pos pos;
     uLong uncompressed_size;
+    uLong compressed_size;
+    uLong compression_method;
 };
 
 class ZipFilePrivate
 {
 public:
+    ZipFilePrivate()
+    : zipFile(nullptr)
+    , mapped(nullptr)
+    , mappedSize(0)
+    {
+    }
+
     unzFile zipFile;
     
     // std::unordered_map is faster if available on the platform
     typedef std::unordered_map<std::string, struct ZipEntryInfo> FileListContainer;
     FileListContainer fileList;
+
+    // unzFile has a single read position, compressed files are read one at a time
+    std::mutex zipFileMutex;
+
+    // the whole zip file mapped read only, stored files are read from it directly
+    const unsigned char *mapped;
+    size_t mappedSize;
 };
 
+static inline unsigned int readZipShort(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline unsigned int readZipInt(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
 ZipFile::ZipFile(const std::string &zipFile, const std::string &filter)
 : _data(new ZipFilePrivate)
 {
     _data->zipFile = unzOpen(zipFile.c_str());
     setFilter(filter);
+
+#if CC_ZIPFILE_USE_MMAP
+    if (_data->zipFile)
+    {
+        int fd = open(zipFile.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+                if (mapped != MAP_FAILED)
+                {
+                    _data->mapped = (const unsigned char *)mapped;
+                    _data->mappedSize = st.st_size;
+                }
+            }
+            // the mapping keeps the file open
+            close(fd);
+        }
+    }
+#endif
 }
 
 ZipFile::~ZipFile()
@@ -514,9 +577,21 @@ ZipFile::~ZipFile()
         unzClose(_data->zipFile);
     }
 
+#if CC_ZIPFILE_USE_MMAP
+    if (_data && _data->mapped)
+    {
+        munmap((void *)_data->mapped, _data->mappedSize);
+    }
+#endif
+
     CC_SAFE_DELETE(_data);
 }
 
+bool ZipFile::isOpen() const
+{
+    return _data && _data->zipFile;
+}
+
 bool ZipFile::setFilter(const std::string &filter)
 {
     bool ret = false;
@@ -549,6 +624,8 @@ bool ZipFile::setFilter(const std::string &filter)
                     ZipEntryInfo entry;
                     entry.pos = posInfo;
                     entry.uncompressed_size = (uLong)fileInfo.uncompressed_size;
+                    entry.compressed_size = (uLong)fileInfo.compressed_size;
+                    entry.compression_method = fileInfo.compression_method;
                     _data->fileList[currentFileName] = entry;
                 }
             }
@@ -591,6 +668,21 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, ssize_t *size)
         CC_BREAK_IF(it ==  _data->fileList.end());
         
         ZipEntryInfo fileInfo = it->second;
+
+        ssize_t storedSize = 0;
+        const unsigned char *stored = getStoredFileData(fileName, &storedSize);
+        if (stored)
+        {
+            buffer = (unsigned char*)malloc(storedSize);
+            memcpy(buffer, stored, storedSize);
+            if (size)
+            {
+                *size = storedSize;
+            }
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(_data->zipFileMutex);
         
         int nRet = unzGoToFilePos(_data->zipFile, &fileInfo.pos);
         CC_BREAK_IF(UNZ_OK != nRet);
@@ -612,4 +704,59 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, ssize_t *size)
     return buffer;
 }
 
+const unsigned char *ZipFile::getStoredFileData(const std::string &fileName, ssize_t *size) const
+{
+    ssize_t offset = 0;
+    ssize_t storedSize = 0;
+
+    if (size)
+        *size = 0;
+
+    if (!getStoredFileRange(fileName, &offset, &storedSize))
+    {
+        return nullptr;
+    }
+
+    if (size)
+    {
+        *size = storedSize;
+    }
+    return _data->mapped + offset;
+}
+
+bool ZipFile::getStoredFileRange(const std::string &fileName, ssize_t *offset, ssize_t *size) const
+{
+    do
+    {
+        CC_BREAK_IF(!_data->mapped);
+
+        ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
+        CC_BREAK_IF(it == _data->fileList.end());
+
+        const ZipEntryInfo &fileInfo = it->second;
+        CC_BREAK_IF(fileInfo.compression_method != 0 || fileInfo.compressed_size != fileInfo.uncompressed_size);
+
+        // the central directory record tells where the local header is,
+        // the data follows the local header and its variable length fields
+        size_t central = fileInfo.pos.pos_in_zip_directory;
+        CC_BREAK_IF(central + ZIP_CENTRAL_HEADER_SIZE > _data->mappedSize);
+        CC_BREAK_IF(readZipInt(_data->mapped + central) != ZIP_CENTRAL_HEADER_SIGNATURE);
+
+        size_t local = readZipInt(_data->mapped + central + 42);
+        CC_BREAK_IF(local + ZIP_LOCAL_HEADER_SIZE > _data->mappedSize);
+        CC_BREAK_IF(readZipInt(_data->mapped + local) != ZIP_LOCAL_HEADER_SIGNATURE);
+
+        size_t dataOffset = local + ZIP_LOCAL_HEADER_SIZE
+            + readZipShort(_data->mapped + local + 26)
+            + readZipShort(_data->mapped + local + 28);
+        CC_BREAK_IF(dataOffset + fileInfo.uncompressed_size > _data->mappedSize);
+
+        *offset = dataOffset;
+        *size = fileInfo.uncompressed_size;
+        return true;
+    } while (0);
+
+    return false;
+}
+
 NS_CC_END
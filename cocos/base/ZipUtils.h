@@ -259,6 +259,11 @@ namespace cocos2d
         */
         bool fileExists(const std::string &fileName) const;
 
+        /**
+        * Check whether the zip file was opened successfully.
+        */
+        bool isOpen() const;
+
         /**
         * Get resource file data from a zip file.
         * @param fileName File name
@@ -270,6 +275,24 @@ namespace cocos2d
         */
         unsigned char *getFileData(const std::string &fileName, ssize_t *size);
 
+        /**
+        * Get the data of a file stored without compression, without copying it.
+        * The zip file is mapped into memory, so it can be called from any thread.
+        * @param fileName File name
+        * @param[out] size If the file is found, it will be the data size, otherwise 0.
+        * @return A pointer into the mapped zip file, it is valid as long as the ZipFile lives.
+        *         nullptr if the file is compressed, or the zip file can't be mapped on this platform.
+        */
+        const unsigned char *getStoredFileData(const std::string &fileName, ssize_t *size) const;
+
+        /**
+        * Get where the data of a file stored without compression is in the zip file.
+        * @param[out] offset The offset of the data from the beginning of the zip file.
+        * @param[out] size The data size.
+        * @return false if the file is compressed, or the zip file can't be mapped on this platform.
+        */
+        bool getStoredFileRange(const std::string &fileName, ssize_t *offset, ssize_t *size) const;
+
     private:
         /** Internal data like zip file pointer / file list array and so on */
         ZipFilePrivate *_data;
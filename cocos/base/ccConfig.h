@@ -262,6 +262,17 @@ To enable set it to a value different than 0. Disabled by default.
 #define CC_ENABLE_PROFILERS 0
 #endif
 
+/** @def CC_ENABLE_FRAME_PROFILER
+ If enabled, CC_PROFILE_SCOPE marks are compiled in, so that FrameProfiler can record a timeline of the frames
+ of the engine and the game. They record nothing until FrameProfiler is enabled at runtime, for instance with
+ the "profile" command of the Console.
+ 
+ To disable set it to 0. Enabled by default.
+ */
+#ifndef CC_ENABLE_FRAME_PROFILER
+#define CC_ENABLE_FRAME_PROFILER 1
+#endif
+
 /** Enable Lua engine debug log */
 #ifndef CC_LUA_ENGINE_DEBUG
 #define CC_LUA_ENGINE_DEBUG 0
@@ -11,6 +11,7 @@ CCActionManagerEx.cpp \
 CCActionNode.cpp \
 CCActionObject.cpp \
 CCArmature.cpp \
+CCArmatureSkinning.cpp \
 CCBone.cpp \
 CCArmatureAnimation.cpp \
 CCProcessBase.cpp \
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "cocostudio/CCDataReaderHelper.h"
 #include "cocostudio/CCDatas.h"
 #include "cocostudio/CCSkin.h"
+#include "cocostudio/CCArmatureSkinning.h"
 
 #include "renderer/CCRenderer.h"
 #include "renderer/CCGroupCommand.h"
@@ -35,6 +36,8 @@ THE SOFTWARE.
 #include "2d/CCDrawingPrimitives.h"
 #include "base/CCDirector.h"
 
+#include <typeinfo>
+
 #if ENABLE_PHYSICS_BOX2D_DETECT
 #include "Box2D/Box2D.h"
 #elif ENABLE_PHYSICS_CHIPMUNK_DETECT
@@ -88,6 +91,8 @@ Armature::Armature()
     , _batchNode(nullptr)
     , _parentBone(nullptr)
     , _armatureTransformDirty(true)
+    , _boneListDirty(true)
+    , _skinning(nullptr)
     , _animation(nullptr)
 {
 }
@@ -97,7 +102,15 @@ Armature::~Armature(void)
 {
     _boneDic.clear();
     _topBoneList.clear();
+    _boneList.clear();
+
+    for (auto& command : _quadCommands)
+    {
+        delete command;
+    }
+    _quadCommands.clear();
 
+    CC_SAFE_DELETE(_skinning);
     CC_SAFE_DELETE(_animation);
 }
 
@@ -257,6 +270,8 @@ void Armature::addBone(Bone *bone, const std::string& parentName)
 
     _boneDic.insert(bone->getName(), bone);
     addChild(bone);
+
+    _boneListDirty = true;
 }
 
 
@@ -273,6 +288,8 @@ void Armature::removeBone(Bone *bone, bool recursion)
     }
     _boneDic.erase(bone->getName());
     removeChild(bone, true);
+
+    _boneListDirty = true;
 }
 
 
@@ -309,6 +326,8 @@ void Armature::changeBoneParent(Bone *bone, const std::string& parentName)
             _topBoneList.pushBack(bone);
         }
     }
+
+    _boneListDirty = true;
 }
 
 const cocos2d::Map<std::string, Bone*>& Armature::getBoneDic() const
@@ -371,13 +390,78 @@ void Armature::update(float dt)
 {
     _animation->update(dt);
 
-    for(const auto &bone : _topBoneList) {
-        bone->update(dt);
+    if (_boneListDirty)
+    {
+        updateBoneList();
+    }
+
+    // parents come first, so a bone always sees the dirty flag of its parent from this frame
+    for (const auto &bone : _boneList)
+    {
+        bone->updateBoneTransform(dt);
+    }
+
+    for (const auto &bone : _boneList)
+    {
+        bone->setTransformDirty(false);
     }
 
     _armatureTransformDirty = false;
 }
 
+void Armature::setGPUSkinningEnabled(bool enabled)
+{
+    if (enabled && _skinning == nullptr)
+    {
+        _skinning = new ArmatureSkinning();
+    }
+    else if (!enabled)
+    {
+        CC_SAFE_DELETE(_skinning);
+    }
+}
+
+void Armature::updateBoneList()
+{
+    _boneList.clear();
+    _boneList.reserve(_boneDic.size());
+
+    for (const auto &bone : _topBoneList)
+    {
+        _boneList.push_back(bone);
+    }
+
+    for (size_t i = 0; i < _boneList.size(); i++)
+    {
+        for (const auto &child : _boneList[i]->getChildren())
+        {
+            _boneList.push_back(static_cast<Bone *>(child));
+        }
+    }
+
+    _boneListDirty = false;
+}
+
+void Armature::flushQuads(cocos2d::Renderer *renderer, const Matrix &mv, Skin *batchSkin, ssize_t &batchStart, ssize_t quadCount, int &commandIndex)
+{
+    if (quadCount == batchStart)
+    {
+        return;
+    }
+
+    if (commandIndex == (int)_quadCommands.size())
+    {
+        _quadCommands.push_back(new QuadCommand());
+    }
+
+    // all skins of the run share texture, shader, blend function and global z order with batchSkin
+    QuadCommand *command = _quadCommands[commandIndex++];
+    command->init(batchSkin->getGlobalZOrder(), batchSkin->getTexture()->getName(), batchSkin->getGLProgramState(), batchSkin->getBlendFunc(), &_quads[batchStart], quadCount - batchStart, mv);
+    renderer->addCommand(command);
+
+    batchStart = quadCount;
+}
+
 void Armature::draw(cocos2d::Renderer *renderer, const Matrix &transform, bool transformUpdated)
 {
     if (_parentBone == nullptr && _batchNode == nullptr)
@@ -386,6 +470,24 @@ void Armature::draw(cocos2d::Renderer *renderer, const Matrix &transform, bool t
     }
 
 
+    Matrix mv = Director::getInstance()->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+
+    if (_skinning && _skinning->draw(renderer, this, mv))
+    {
+        return;
+    }
+
+    // every child has at most one skin, so _quads never grows while commands point into it
+    if ((ssize_t)_quads.size() < _children.size())
+    {
+        _quads.resize(_children.size());
+    }
+
+    Skin *batchSkin = nullptr;
+    ssize_t batchStart = 0;
+    ssize_t quadCount = 0;
+    int commandIndex = 0;
+
     for (auto& object : _children)
     {
         if (Bone *bone = dynamic_cast<Bone *>(object))
@@ -408,16 +510,39 @@ void Armature::draw(cocos2d::Renderer *renderer, const Matrix &transform, bool t
                 {
                     skin->setBlendFunc(bone->getBlendFunc());
                 }
-                skin->draw(renderer, transform, transformUpdated);
+
+                // a subclass may draw differently, only the quads of plain skins are batched
+                if (typeid(*skin) != typeid(Skin))
+                {
+                    flushQuads(renderer, mv, batchSkin, batchStart, quadCount, commandIndex);
+                    batchSkin = nullptr;
+                    skin->draw(renderer, transform, transformUpdated);
+                    break;
+                }
+
+                if (batchSkin == nullptr
+                    || batchSkin->getTexture() != skin->getTexture()
+                    || batchSkin->getGLProgramState() != skin->getGLProgramState()
+                    || batchSkin->getGlobalZOrder() != skin->getGlobalZOrder()
+                    || !(batchSkin->getBlendFunc() == skin->getBlendFunc())
+                    || quadCount - batchStart >= Renderer::VBO_SIZE - 1)
+                {
+                    flushQuads(renderer, mv, batchSkin, batchStart, quadCount, commandIndex);
+                    batchSkin = skin;
+                }
+
+                _quads[quadCount++] = skin->getQuad();
             }
             break;
             case CS_DISPLAY_ARMATURE:
             {
+                flushQuads(renderer, mv, batchSkin, batchStart, quadCount, commandIndex);
                 node->draw(renderer, transform, transformUpdated);
             }
             break;
             default:
             {
+                flushQuads(renderer, mv, batchSkin, batchStart, quadCount, commandIndex);
                 node->visit(renderer, transform, transformUpdated);
 //                CC_NODE_DRAW_SETUP();
             }
@@ -426,10 +551,13 @@ void Armature::draw(cocos2d::Renderer *renderer, const Matrix &transform, bool t
         }
         else if(Node *node = dynamic_cast<Node *>(object))
         {
+            flushQuads(renderer, mv, batchSkin, batchStart, quadCount, commandIndex);
             node->visit(renderer, transform, transformUpdated);
 //            CC_NODE_DRAW_SETUP();
         }
     }
+
+    flushQuads(renderer, mv, batchSkin, batchStart, quadCount, commandIndex);
 }
 
 void Armature::onEnter()
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "cocostudio/CCSpriteFrameCacheHelper.h"
 #include "cocostudio/CCArmatureDataManager.h"
 #include "math/CCMath.h"
+#include "renderer/CCQuadCommand.h"
 
 class b2Body;
 struct cpBody;
@@ -40,6 +41,9 @@ namespace cocostudio {
 
 USING_NS_CC_MATH;
 
+class Skin;
+class ArmatureSkinning;
+
 CC_DEPRECATED_ATTRIBUTE typedef ProcessBase CCProcessBase;
 CC_DEPRECATED_ATTRIBUTE typedef BaseData CCBaseData;
 CC_DEPRECATED_ATTRIBUTE typedef DisplayData CCDisplayData;
@@ -160,6 +164,10 @@ public:
      * @lua NA
      */
     virtual void visit(cocos2d::Renderer *renderer, const Matrix &parentTransform, bool parentTransformUpdated) override;
+    /**
+     * Consecutive Skins that share texture, shader, blend function and global z order are drawn with one command.
+     * Instances of Skin subclasses aren't batched, their own draw() is called.
+     */
     virtual void draw(cocos2d::Renderer *renderer, const Matrix &transform, bool transformUpdated) override;
     virtual void update(float dt) override;
 
@@ -191,6 +199,20 @@ public:
     
     virtual bool getArmatureTransformDirty() const;
 
+    /**
+     * Mark the ordered bone list to be rebuilt, called when the bone hierarchy changed.
+     */
+    virtual void setBoneListDirty() { _boneListDirty = true; }
+
+    /**
+     * Draw the skins from one static vertex buffer and let the vertex shader apply the bone transforms,
+     * only the transforms and colors are uploaded each frame. It needs all skins to share one texture,
+     * blend function and the default shader, and at most ArmatureSkinning::MAX_BONES skins; when they
+     * don't, the armature draws them as quads.
+     */
+    virtual void setGPUSkinningEnabled(bool enabled);
+    virtual bool isGPUSkinningEnabled() const { return _skinning != nullptr; }
+
 
 #if ENABLE_PHYSICS_BOX2D_DETECT || ENABLE_PHYSICS_CHIPMUNK_DETECT
     virtual void setColliderFilter(ColliderFilter *filter);
@@ -254,6 +276,12 @@ protected:
      */
     Bone *createBone(const std::string& boneName );
 
+    //! Rebuild _boneList, parents are always placed before their children
+    void updateBoneList();
+
+    //! Submit the skin quads gathered in _quads since the last flush as one command
+    void flushQuads(cocos2d::Renderer *renderer, const Matrix &mv, Skin *batchSkin, ssize_t &batchStart, ssize_t quadCount, int &commandIndex);
+
 protected:
     ArmatureData *_armatureData;
 
@@ -269,6 +297,14 @@ protected:
 
     cocos2d::Vector<Bone*> _topBoneList;
 
+    std::vector<Bone*> _boneList;                     //! All bones in update order, rebuilt when _boneListDirty is set
+    bool _boneListDirty;
+
+    std::vector<cocos2d::V3F_C4B_T2F_Quad> _quads;    //! Skin quads of this frame, one command is submitted for each run of skins sharing a material
+    std::vector<cocos2d::QuadCommand*> _quadCommands;
+
+    ArmatureSkinning *_skinning;
+
     cocos2d::BlendFunc _blendFunc;                    //! It's required for CCTextureProtocol inheritance
 
     cocos2d::Vector2 _offsetPoint;
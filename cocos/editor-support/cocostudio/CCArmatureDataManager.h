@@ -172,9 +172,13 @@ public:
     const cocos2d::Map<std::string, AnimationData*>&    getAnimationDatas() const;
     const cocos2d::Map<std::string, TextureData*>&      getTextureDatas() const;
 
+    /**
+     *	@brief	Get the names of the datas and sprite files added from a config file
+     */
+    RelativeData *getRelativeData(const std::string& configFilePath);
+
 protected:
     void addRelativeData(const std::string& configFilePath);
-    RelativeData *getRelativeData(const std::string& configFilePath);
 private:
     /**
      *	@brief	save amature datas
@@ -0,0 +1,363 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cocostudio/CCArmatureSkinning.h"
+#include "cocostudio/CCArmature.h"
+#include "cocostudio/CCSkin.h"
+
+#include "renderer/CCRenderer.h"
+#include "renderer/CCGLProgramCache.h"
+#include "renderer/ccGLStateCache.h"
+#include "2d/CCTexture2D.h"
+#include "base/CCConfiguration.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCEventType.h"
+
+using namespace cocos2d;
+
+namespace cocostudio {
+
+#define STRINGIFY(A)  #A
+
+static const char *SKINNING_PROGRAM_KEY = "ShaderArmatureSkinning";
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+// reloads the program when the context is recreated, replaced when the program is created again
+static EventListenerCustom *s_programToForegroundListener = nullptr;
+#endif
+
+// u_bones holds two rows for each bone: (m0, m4, m12, 0) and (m1, m5, m13, z)
+static const char *s_skinningVert = "#define MAX_BONES 32\n" STRINGIFY(
+attribute vec4 a_position;
+attribute vec2 a_texCoord;
+
+uniform vec4 u_bones[MAX_BONES * 2];
+uniform vec4 u_colors[MAX_BONES];
+
+\n#ifdef GL_ES\n
+varying lowp vec4 v_fragmentColor;
+varying mediump vec2 v_texCoord;
+\n#else\n
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+\n#endif\n
+
+void main()
+{
+    int index = int(a_position.z);
+    vec4 row0 = u_bones[index * 2];
+    vec4 row1 = u_bones[index * 2 + 1];
+    vec3 position = vec3(a_position.xy, 1.0);
+
+    gl_Position = CC_MVPMatrix * vec4(dot(row0.xyz, position), dot(row1.xyz, position), row1.w, 1.0);
+    v_fragmentColor = u_colors[index];
+    v_texCoord = a_texCoord;
+}
+);
+
+static const char *s_skinningFrag = STRINGIFY(
+\n#ifdef GL_ES\n
+precision lowp float;
+\n#endif\n
+
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+uniform sampler2D CC_Texture0;
+
+void main()
+{
+    gl_FragColor = v_fragmentColor * texture2D(CC_Texture0, v_texCoord);
+}
+);
+
+GLProgram *ArmatureSkinning::getSkinningProgram()
+{
+    GLProgram *program = GLProgramCache::getInstance()->getGLProgram(SKINNING_PROGRAM_KEY);
+    if (program)
+    {
+        return program;
+    }
+
+    program = GLProgram::createWithByteArrays(s_skinningVert, s_skinningFrag);
+    GLProgramCache::getInstance()->addGLProgram(program, SKINNING_PROGRAM_KEY);
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // The program is created again after GLProgramCache was purged. Remove the listener of the old one,
+    // it may still be registered, or be gone with the dispatcher of a purged Director.
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    if (s_programToForegroundListener)
+    {
+        dispatcher->removeEventListener(s_programToForegroundListener);
+        s_programToForegroundListener->release();
+    }
+
+    // reload the program once when the context is recreated
+    s_programToForegroundListener = EventListenerCustom::create(EVENT_COME_TO_FOREGROUND, [](EventCustom* event){
+        GLProgram *program = GLProgramCache::getInstance()->getGLProgram(SKINNING_PROGRAM_KEY);
+        if (program)
+        {
+            program->reset();
+            program->initWithByteArrays(s_skinningVert, s_skinningFrag);
+            program->link();
+            program->updateUniforms();
+        }
+    });
+    s_programToForegroundListener->retain();
+    dispatcher->addEventListenerWithFixedPriority(s_programToForegroundListener, -1);
+#endif
+
+    return program;
+}
+
+ArmatureSkinning::ArmatureSkinning()
+    : _boneCount(0)
+    , _dirty(true)
+    , _glProgram(nullptr)
+    , _bonesLocation(-1)
+    , _colorsLocation(-1)
+    , _texture(nullptr)
+    , _blendFunc(BlendFunc::ALPHA_PREMULTIPLIED)
+    , _toForegroundListener(nullptr)
+{
+    _buffersVBO[0] = _buffersVBO[1] = 0;
+
+    _bones.resize(MAX_BONES * 2);
+    _colors.resize(MAX_BONES);
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    _toForegroundListener = EventListenerCustom::create(EVENT_COME_TO_FOREGROUND, CC_CALLBACK_1(ArmatureSkinning::listenToForeground, this));
+    Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_toForegroundListener, 1);
+#endif
+}
+
+ArmatureSkinning::~ArmatureSkinning()
+{
+    if (_buffersVBO[0])
+    {
+        glDeleteBuffers(2, &_buffersVBO[0]);
+    }
+
+    if (_toForegroundListener)
+    {
+        Director::getInstance()->getEventDispatcher()->removeEventListener(_toForegroundListener);
+    }
+}
+
+void ArmatureSkinning::listenToForeground(EventCustom *event)
+{
+    // the old buffers are gone with the context
+    _buffersVBO[0] = _buffersVBO[1] = 0;
+    _vertices.clear();
+    _dirty = true;
+}
+
+bool ArmatureSkinning::draw(Renderer *renderer, Armature *armature, const Matrix &modelView)
+{
+    GLProgram *defaultProgram = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP);
+
+    Skin *firstSkin = nullptr;
+    int boneCount = 0;
+    _frameVertices.clear();
+
+    for (auto& object : armature->getChildren())
+    {
+        Bone *bone = dynamic_cast<Bone *>(object);
+        if (bone == nullptr)
+        {
+            return false;
+        }
+
+        Node *node = bone->getDisplayRenderNode();
+        if (nullptr == node)
+        {
+            continue;
+        }
+
+        if (bone->getDisplayRenderNodeType() != CS_DISPLAY_SPRITE || boneCount == MAX_BONES)
+        {
+            return false;
+        }
+
+        Skin *skin = static_cast<Skin *>(node);
+        if (bone->isBlendDirty())
+        {
+            skin->setBlendFunc(bone->getBlendFunc());
+        }
+
+        if (firstSkin == nullptr)
+        {
+            firstSkin = skin;
+        }
+        else if (firstSkin->getTexture() != skin->getTexture()
+                 || firstSkin->getGlobalZOrder() != skin->getGlobalZOrder()
+                 || !(firstSkin->getBlendFunc() == skin->getBlendFunc()))
+        {
+            return false;
+        }
+
+        if (skin->getGLProgram() != defaultProgram || skin->getTexture() == nullptr)
+        {
+            return false;
+        }
+
+        // the untransformed quad, it only changes when the displays or their frames change
+        const V3F_C4B_T2F_Quad quad = skin->getQuad();
+        const Vector2 &offset = skin->getOffsetPosition();
+        const Size &size = skin->getTextureRect().size;
+        float index = (float)boneCount;
+
+        SkinVertex vertex;
+        vertex.vertices = Vector3(offset.x, offset.y, index);
+        vertex.texCoords = quad.bl.texCoords;
+        _frameVertices.push_back(vertex);
+        vertex.vertices = Vector3(offset.x + size.width, offset.y, index);
+        vertex.texCoords = quad.br.texCoords;
+        _frameVertices.push_back(vertex);
+        vertex.vertices = Vector3(offset.x, offset.y + size.height, index);
+        vertex.texCoords = quad.tl.texCoords;
+        _frameVertices.push_back(vertex);
+        vertex.vertices = Vector3(offset.x + size.width, offset.y + size.height, index);
+        vertex.texCoords = quad.tr.texCoords;
+        _frameVertices.push_back(vertex);
+
+        // the per frame part
+        Vector4 *bones = &_bones[boneCount * 2];
+        Vector4 &color = _colors[boneCount];
+        if (skin->isVisible())
+        {
+            const Matrix &transform = skin->getArmatureTransform();
+            bones[0].set(transform.m[0], transform.m[4], transform.m[12], 0);
+            bones[1].set(transform.m[1], transform.m[5], transform.m[13], skin->getPositionZ());
+            color.set(quad.bl.colors.r / 255.0f, quad.bl.colors.g / 255.0f, quad.bl.colors.b / 255.0f, quad.bl.colors.a / 255.0f);
+        }
+        else
+        {
+            bones[0].set(0, 0, 0, 0);
+            bones[1].set(0, 0, 0, 0);
+            color.set(0, 0, 0, 0);
+        }
+
+        boneCount++;
+    }
+
+    if (boneCount == 0)
+    {
+        return true;
+    }
+
+    if (_frameVertices.size() != _vertices.size()
+        || memcmp(&_frameVertices[0], &_vertices[0], sizeof(SkinVertex) * _vertices.size()) != 0)
+    {
+        _vertices.swap(_frameVertices);
+        _dirty = true;
+    }
+
+    if (_glProgram == nullptr)
+    {
+        _glProgram = getSkinningProgram();
+    }
+
+    _boneCount = boneCount;
+    _texture = firstSkin->getTexture();
+    _blendFunc = firstSkin->getBlendFunc();
+
+    _customCommand.init(firstSkin->getGlobalZOrder());
+    _customCommand.func = CC_CALLBACK_0(ArmatureSkinning::onDraw, this, modelView);
+    renderer->addCommand(&_customCommand);
+
+    return true;
+}
+
+void ArmatureSkinning::setupBuffers()
+{
+    if (_buffersVBO[0] == 0)
+    {
+        glGenBuffers(2, &_buffersVBO[0]);
+    }
+
+    std::vector<GLushort> indices(_boneCount * 6);
+    for (int i = 0; i < _boneCount; i++)
+    {
+        indices[i * 6 + 0] = (GLushort) (i * 4 + 0);
+        indices[i * 6 + 1] = (GLushort) (i * 4 + 1);
+        indices[i * 6 + 2] = (GLushort) (i * 4 + 2);
+        indices[i * 6 + 3] = (GLushort) (i * 4 + 3);
+        indices[i * 6 + 4] = (GLushort) (i * 4 + 2);
+        indices[i * 6 + 5] = (GLushort) (i * 4 + 1);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(SkinVertex) * _vertices.size(), &_vertices[0], GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * indices.size(), &indices[0], GL_STATIC_DRAW);
+
+    _dirty = false;
+}
+
+void ArmatureSkinning::onDraw(const Matrix &modelView)
+{
+    if (_bonesLocation == -1)
+    {
+        _bonesLocation = _glProgram->getUniformLocation("u_bones");
+        _colorsLocation = _glProgram->getUniformLocation("u_colors");
+    }
+
+    _glProgram->use();
+    _glProgram->setUniformsForBuiltins(modelView);
+    _glProgram->setUniformLocationWith4fv(_bonesLocation, (const GLfloat *)&_bones[0], _boneCount * 2);
+    _glProgram->setUniformLocationWith4fv(_colorsLocation, (const GLfloat *)&_colors[0], _boneCount);
+
+    GL::bindTexture2D(_texture->getName());
+    GL::blendFunc(_blendFunc.src, _blendFunc.dst);
+
+    if (Configuration::getInstance()->supportsShareableVAO())
+    {
+        GL::bindVAO(0);
+    }
+
+    if (_dirty || _buffersVBO[0] == 0)
+    {
+        setupBuffers();
+    }
+
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POSITION | GL::VERTEX_ATTRIB_FLAG_TEX_COORD);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(SkinVertex), (GLvoid *)offsetof(SkinVertex, vertices));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(SkinVertex), (GLvoid *)offsetof(SkinVertex, texCoords));
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glDrawElements(GL_TRIANGLES, (GLsizei)(_boneCount * 6), GL_UNSIGNED_SHORT, (GLvoid *)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _boneCount * 4);
+    CHECK_GL_ERROR_DEBUG();
+}
+
+}
@@ -0,0 +1,108 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCARMATURESKINNING_H__
+#define __CCARMATURESKINNING_H__
+
+#include "cocostudio/CCArmatureDefine.h"
+#include "renderer/CCCustomCommand.h"
+#include "renderer/CCGLProgram.h"
+#include "math/CCMath.h"
+
+#include <vector>
+
+namespace cocos2d {
+    class Renderer;
+    class Texture2D;
+    class EventCustom;
+    class EventListenerCustom;
+}
+
+namespace cocostudio {
+
+USING_NS_CC_MATH;
+
+class Armature;
+
+/*
+ * Draws all skins of an armature from one static vertex buffer. The buffer holds the untransformed
+ * skin quads, every frame only the skin to armature transforms and skin colors are uploaded as
+ * uniforms, and the vertex shader applies them.
+ *
+ * It is used when all displays of the armature are skins sharing one texture, blend function,
+ * global z order and the default shader, and there are at most MAX_BONES of them. Otherwise draw()
+ * returns false and the armature draws its skins as quads.
+ *
+ * @js NA
+ * @lua NA
+ */
+class ArmatureSkinning
+{
+public:
+    static const int MAX_BONES = 32;
+
+    ArmatureSkinning();
+    ~ArmatureSkinning();
+
+    /*
+     * Submit the draw command of the armature.
+     * @return false if the armature can't be drawn this way, nothing is submitted then.
+     */
+    bool draw(cocos2d::Renderer *renderer, Armature *armature, const Matrix &modelView);
+
+protected:
+    struct SkinVertex
+    {
+        cocos2d::Vector3 vertices;     // x, y in skin space, z is the bone index
+        cocos2d::Tex2F texCoords;
+    };
+
+    static cocos2d::GLProgram *getSkinningProgram();
+
+    void onDraw(const Matrix &modelView);
+    void setupBuffers();
+    void listenToForeground(cocos2d::EventCustom *event);
+
+    std::vector<SkinVertex> _vertices;           // uploaded vertices
+    std::vector<SkinVertex> _frameVertices;      // vertices of the skins drawn this frame
+    std::vector<cocos2d::Vector4> _bones;        // two rows of a 2D affine transform for each bone
+    std::vector<cocos2d::Vector4> _colors;
+    int _boneCount;
+    bool _dirty;
+
+    GLuint _buffersVBO[2];                       // 0: vertex, 1: indices
+
+    cocos2d::GLProgram *_glProgram;
+    GLint _bonesLocation;
+    GLint _colorsLocation;
+    cocos2d::Texture2D *_texture;
+    cocos2d::BlendFunc _blendFunc;
+
+    cocos2d::CustomCommand _customCommand;
+    cocos2d::EventListenerCustom *_toForegroundListener;
+};
+
+}
+
+#endif /*__CCARMATURESKINNING_H__*/
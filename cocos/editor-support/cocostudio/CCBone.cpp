@@ -177,6 +177,18 @@ Armature *Bone::getArmature() const
 }
 
 void Bone::update(float delta)
+{
+    updateBoneTransform(delta);
+
+    for(const auto &obj: _children) {
+        Bone *childBone = static_cast<Bone*>(obj);
+        childBone->update(delta);
+    }
+
+    _boneTransformDirty = false;
+}
+
+void Bone::updateBoneTransform(float delta)
 {
     if (_parentBone)
         _boneTransformDirty = _boneTransformDirty || _parentBone->isTransformDirty();
@@ -220,18 +232,11 @@ void Bone::update(float delta)
 
         if (_armatureParentBone)
         {
-            _worldTransform = TransformConcat(_worldTransform, _armature->getNodeToParentTransform());
+            TransformHelp::affineConcat(_worldTransform, _armature->getNodeToParentTransform(), _worldTransform);
         }
     }
 
     DisplayFactory::updateDisplay(this, delta, _boneTransformDirty || _armature->getArmatureTransformDirty());
-
-    for(const auto &obj: _children) {
-        Bone *childBone = static_cast<Bone*>(obj);
-        childBone->update(delta);
-    }
-
-    _boneTransformDirty = false;
 }
 
 void Bone::applyParentTransform(Bone *parent) 
@@ -342,6 +347,11 @@ void Bone::removeFromParent(bool recursion)
 void Bone::setParentBone(Bone *parent)
 {
     _parentBone = parent;
+
+    if (_armature)
+    {
+        _armature->setBoneListDirty();
+    }
 }
 
 Bone *Bone::getParentBone()
@@ -137,6 +137,13 @@ public:
 
     void update(float delta) override;
 
+    /**
+     * Update the world transform and display of this bone only, the child bones are not visited
+     * and the transform dirty flag is kept, so the children can still see it.
+     * Armature calls it on its bones in parent first order.
+     */
+    void updateBoneTransform(float delta);
+
     void updateDisplayedColor(const cocos2d::Color3B &parentColor) override;
     void updateDisplayedOpacity(GLubyte parentOpacity) override;
 
@@ -25,9 +25,16 @@ THE SOFTWARE.
 #include "2d/platform/CCFileUtils.h"
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
+#include "base/CCProfiling.h"
+#include "2d/CCSpriteFrameCache.h"
 
 #include "tinyxml2.h"
 
+#include <stdio.h>
+#include <string.h>
+#include <unordered_map>
+#include <algorithm>
+
 #include "cocostudio/CCDataReaderHelper.h"
 #include "cocostudio/CCArmatureDataManager.h"
 #include "cocostudio/CCTransformHelp.h"
@@ -136,6 +143,10 @@ static const char *COLOR_INFO = "color";
 static const char *CONFIG_FILE_PATH = "config_file_path";
 static const char *CONTENT_SCALE = "content_scale";
 
+static const char *BINARY_EXTENSION = ".csab";
+static const char BINARY_MAGIC[4] = {'C', 'S', 'A', 'B'};
+static const unsigned int BINARY_VERSION = 1;
+
 namespace cocostudio {
 
 
@@ -148,64 +159,38 @@ DataReaderHelper *DataReaderHelper::_dataReaderHelper = nullptr;
 
 
 
-//! Async load
-void DataReaderHelper::loadData()
+//! Async load, runs in a job of the job system
+void DataReaderHelper::loadData(AsyncStruct *pAsyncStruct)
 {
-    AsyncStruct *pAsyncStruct = nullptr;
+    CC_PROFILE_SCOPE("DataReaderHelper::loadData", "loaders");
 
-    while (true)
-    {
-        std::queue<AsyncStruct *> *pQueue = _asyncStructQueue;
-        _asyncStructQueueMutex.lock(); // get async struct from queue
-        if (pQueue->empty())
-        {
-            _asyncStructQueueMutex.unlock();
-            if (need_quit)
-            {
-                break;
-            }
-            else
-            {
-				std::unique_lock<std::mutex> lk(_sleepMutex);
-				_sleepCondition.wait(lk);
-                continue;
-            }
-        }
-        else
-        {
-            pAsyncStruct = pQueue->front();
-            pQueue->pop();
-            _asyncStructQueueMutex.unlock();
-        }
-
-        // generate data info
-        DataInfo *pDataInfo = new DataInfo();
-        pDataInfo->asyncStruct = pAsyncStruct;
-        pDataInfo->filename = pAsyncStruct->filename;
-        pDataInfo->baseFilePath = pAsyncStruct->baseFilePath;
-
-        if (pAsyncStruct->configType == DragonBone_XML)
-        {
-            DataReaderHelper::addDataFromCache(pAsyncStruct->fileContent.c_str(), pDataInfo);
-        }
-        else if(pAsyncStruct->configType == CocoStudio_JSON)
-        {
-            DataReaderHelper::addDataFromJsonCache(pAsyncStruct->fileContent.c_str(), pDataInfo);
-        }
+    // generate data info
+    DataInfo *pDataInfo = new DataInfo();
+    pDataInfo->asyncStruct = pAsyncStruct;
+    pDataInfo->filename = pAsyncStruct->filename;
+    pDataInfo->baseFilePath = pAsyncStruct->baseFilePath;
 
-        // put the image info into the queue
-        _dataInfoMutex.lock();
-        _dataQueue->push(pDataInfo);
-        _dataInfoMutex.unlock();
+    // read the file in the job too, so several files are read and parsed at the same time.
+    // XML and binary files are decoded from the mapped file, rapidjson needs a '\0' terminated copy
+    if (pAsyncStruct->configType == DragonBone_XML)
+    {
+        Data data = FileUtils::getInstance()->getMappedDataFromFile(pAsyncStruct->fullPath);
+        DataReaderHelper::addDataFromCache((const char *)data.getBytes(), data.getSize(), pDataInfo);
     }
-
-    if( _asyncStructQueue != nullptr )
+    else if(pAsyncStruct->configType == CocoStudio_JSON)
+    {
+        DataReaderHelper::addDataFromJsonCache(FileUtils::getInstance()->getStringFromFile(pAsyncStruct->fullPath), pDataInfo);
+    }
+    else if(pAsyncStruct->configType == CocoStudio_Binary)
     {
-        delete _asyncStructQueue;
-        _asyncStructQueue = nullptr;
-        delete _dataQueue;
-        _dataQueue = nullptr;
+        Data data = FileUtils::getInstance()->getMappedDataFromFile(pAsyncStruct->fullPath);
+        DataReaderHelper::addDataFromBinaryCache(data.getBytes(), data.getSize(), pDataInfo);
     }
+
+    // put the data info into the queue
+    _dataInfoMutex.lock();
+    _dataQueue->push(pDataInfo);
+    _dataInfoMutex.unlock();
 }
 
 
@@ -238,25 +223,34 @@ void DataReaderHelper::purge()
 
 
 DataReaderHelper::DataReaderHelper()
-	: _loadingThread(nullptr)
-	, _asyncRefCount(0)
+	: _asyncRefCount(0)
 	, _asyncRefTotalCount(0)
-	, need_quit(false)
-	, _asyncStructQueue(nullptr)
 	, _dataQueue(nullptr)
+	, _jobSystem(nullptr)
 {
 
 }
 
 DataReaderHelper::~DataReaderHelper()
 {
-    need_quit = true;
+    // the jobs use this helper, wait for the files being loaded.
+    // The director finishes all jobs before deleting its job system, so a job that
+    // is not finished yet means _jobSystem is still alive
+    for (const auto& job : _loadingJobs)
+    {
+        if (!job->isFinished())
+        {
+            _jobSystem->wait(job);
+        }
+    }
+    _loadingJobs.clear();
 
-	_sleepCondition.notify_one();
-	if (_loadingThread) _loadingThread->join();
+    CC_SAFE_DELETE(_dataQueue);
 
-	CC_SAFE_DELETE(_loadingThread);
-	_dataReaderHelper = nullptr;
+    if (_dataReaderHelper == this)
+    {
+        _dataReaderHelper = nullptr;
+    }
 }
 
 void DataReaderHelper::addDataFromFile(const std::string& filePath)
@@ -292,9 +286,7 @@ void DataReaderHelper::addDataFromFile(const std::string& filePath)
     size_t startPos = filePathStr.find_last_of(".");
     std::string str = &filePathStr[startPos];
 
-    // Read content from file
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
-    std::string contentStr = FileUtils::getInstance()->getStringFromFile(fullPath);
 
     DataInfo dataInfo;
     dataInfo.filename = filePathStr;
@@ -302,11 +294,17 @@ void DataReaderHelper::addDataFromFile(const std::string& filePath)
     dataInfo.baseFilePath = basefilePath;
     if (str == ".xml")
     {
-        DataReaderHelper::addDataFromCache(contentStr, &dataInfo);
+        Data data = FileUtils::getInstance()->getMappedDataFromFile(fullPath);
+        DataReaderHelper::addDataFromCache((const char *)data.getBytes(), data.getSize(), &dataInfo);
     }
     else if(str == ".json" || str == ".ExportJson")
     {
-        DataReaderHelper::addDataFromJsonCache(contentStr, &dataInfo);
+        DataReaderHelper::addDataFromJsonCache(FileUtils::getInstance()->getStringFromFile(fullPath), &dataInfo);
+    }
+    else if(str == BINARY_EXTENSION)
+    {
+        Data data = FileUtils::getInstance()->getMappedDataFromFile(fullPath);
+        DataReaderHelper::addDataFromBinaryCache(data.getBytes(), data.getSize(), &dataInfo);
     }
 }
 
@@ -350,15 +348,9 @@ void DataReaderHelper::addDataFromFileAsync(const std::string& imagePath, const
 
 
     // lazy init
-    if (_asyncStructQueue == nullptr)
+    if (_dataQueue == nullptr)
     {
-        _asyncStructQueue = new std::queue<AsyncStruct *>();
         _dataQueue = new std::queue<DataInfo *>();
-
-		// create a new thread to load images
-		_loadingThread = new std::thread(&DataReaderHelper::loadData, this);
-
-        need_quit = false;
     }
 
     if (0 == _asyncRefCount)
@@ -389,10 +381,8 @@ void DataReaderHelper::addDataFromFileAsync(const std::string& imagePath, const
     size_t startPos = filePathStr.find_last_of(".");
     std::string str = &filePathStr[startPos];
 
-    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
-
-    // XXX fileContent is being leaked
-    data->fileContent = FileUtils::getInstance()->getStringFromFile(fullPath);
+    // the file is read in a job, resolve the path here since the path cache is not thread safe
+    data->fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
 
     if (str == ".xml")
     {
@@ -402,72 +392,107 @@ void DataReaderHelper::addDataFromFileAsync(const std::string& imagePath, const
     {
         data->configType = CocoStudio_JSON;
     }
+    else if(str == BINARY_EXTENSION)
+    {
+        data->configType = CocoStudio_Binary;
+    }
 
 
-    // add async struct into queue
-    _asyncStructQueueMutex.lock();
-    _asyncStructQueue->push(data);
-    _asyncStructQueueMutex.unlock();
-
-    _sleepCondition.notify_one();
+    // read and parse the file in a job, several files are loaded at the same time
+    _jobSystem = Director::getInstance()->getJobSystem();
+    _loadingJobs.push_back(_jobSystem->addJob([this, data]() {
+        loadData(data);
+    }));
 }
 
 void DataReaderHelper::addDataAsyncCallBack(float dt)
 {
-    // the data is generated in loading thread
-    std::queue<DataInfo *> *dataQueue = _dataQueue;
-
+    // the datas are generated in the jobs, take all of them that are ready
+    std::queue<DataInfo *> dataQueue;
     _dataInfoMutex.lock();
-    if (dataQueue->empty())
-    {
-        _dataInfoMutex.unlock();
-    }
-    else
+    std::swap(dataQueue, *_dataQueue);
+    _dataInfoMutex.unlock();
+
+    _loadingJobs.erase(std::remove_if(_loadingJobs.begin(), _loadingJobs.end(), [](const JobSystem::JobPtr& job) {
+        return job->isFinished();
+    }), _loadingJobs.end());
+
+    while (!dataQueue.empty())
     {
-        DataInfo *pDataInfo = dataQueue->front();
-        dataQueue->pop();
-        _dataInfoMutex.unlock();
+        DataInfo *pDataInfo = dataQueue.front();
+        dataQueue.pop();
 
         AsyncStruct *pAsyncStruct = pDataInfo->asyncStruct;
 
+        // hold one count until all sprite files are requested, a cached texture calls back at once
+        pDataInfo->pendingSpriteFileCount = 1;
 
         if (pAsyncStruct->imagePath != "" && pAsyncStruct->plistPath != "")
         {
-            _getFileMutex.lock();
-            ArmatureDataManager::getInstance()->addSpriteFrameFromFile(pAsyncStruct->plistPath.c_str(), pAsyncStruct->imagePath.c_str());
-            _getFileMutex.unlock();
+            addSpriteFileAsync(pDataInfo, pAsyncStruct->plistPath, pAsyncStruct->imagePath, "");
         }
 
         while (!pDataInfo->configFileQueue.empty())
         {
             std::string configPath = pDataInfo->configFileQueue.front();
-            _getFileMutex.lock();
-            ArmatureDataManager::getInstance()->addSpriteFrameFromFile((pAsyncStruct->baseFilePath + configPath + ".plist").c_str(), (pAsyncStruct->baseFilePath + configPath + ".png").c_str());
-            _getFileMutex.unlock();
+            addSpriteFileAsync(pDataInfo, pAsyncStruct->baseFilePath + configPath + ".plist", pAsyncStruct->baseFilePath + configPath + ".png", pAsyncStruct->filename);
             pDataInfo->configFileQueue.pop();
         }
 
+        spriteFileLoaded(pDataInfo);
+    }
+}
 
-        Ref* target = pAsyncStruct->target;
-        SEL_SCHEDULE selector = pAsyncStruct->selector;
-
-        --_asyncRefCount;
+void DataReaderHelper::addSpriteFileAsync(DataInfo *dataInfo, const std::string& plistPath, const std::string& imagePath, const std::string& configFilePath)
+{
+    ++dataInfo->pendingSpriteFileCount;
 
-        if (target && selector)
+    retain();
+    // the plist is parsed and the image decoded on the I/O threads of FileUtils
+    SpriteFrameCache::getInstance()->addSpriteFramesWithFileAsync(plistPath, imagePath, [=](bool loaded){
+        if (loaded)
         {
-            (target->*selector)((_asyncRefTotalCount - _asyncRefCount) / (float)_asyncRefTotalCount);
-            target->release();
+            if (RelativeData *data = ArmatureDataManager::getInstance()->getRelativeData(configFilePath))
+            {
+                data->plistFiles.push_back(plistPath);
+            }
         }
+        else
+        {
+            CCLOG("DataReaderHelper: can not load %s, the frames of %s are skipped", imagePath.c_str(), plistPath.c_str());
+        }
+        // counted even when it failed, so the loading finishes
+        spriteFileLoaded(dataInfo);
+        release();
+    });
+}
+
+void DataReaderHelper::spriteFileLoaded(DataInfo *dataInfo)
+{
+    if (--dataInfo->pendingSpriteFileCount > 0)
+    {
+        return;
+    }
 
+    AsyncStruct *pAsyncStruct = dataInfo->asyncStruct;
+    Ref* target = pAsyncStruct->target;
+    SEL_SCHEDULE selector = pAsyncStruct->selector;
 
-        delete pAsyncStruct;
-        delete pDataInfo;
+    --_asyncRefCount;
 
-        if (0 == _asyncRefCount)
-        {
-            _asyncRefTotalCount = 0;
-            Director::getInstance()->getScheduler()->unschedule(schedule_selector(DataReaderHelper::addDataAsyncCallBack), this);
-        }
+    if (target && selector)
+    {
+        (target->*selector)((_asyncRefTotalCount - _asyncRefCount) / (float)_asyncRefTotalCount);
+    }
+    CC_SAFE_RELEASE(target);
+
+    delete pAsyncStruct;
+    delete dataInfo;
+
+    if (0 == _asyncRefCount)
+    {
+        _asyncRefTotalCount = 0;
+        Director::getInstance()->getScheduler()->unschedule(schedule_selector(DataReaderHelper::addDataAsyncCallBack), this);
     }
 }
 
@@ -492,9 +517,14 @@ void DataReaderHelper::removeConfigFile(const std::string& configFile)
 
 
 void DataReaderHelper::addDataFromCache(const std::string& pFileContent, DataInfo *dataInfo)
+{
+    addDataFromCache(pFileContent.c_str(), pFileContent.length(), dataInfo);
+}
+
+void DataReaderHelper::addDataFromCache(const char *fileContent, size_t size, DataInfo *dataInfo)
 {
     tinyxml2::XMLDocument document;
-    document.Parse(pFileContent.c_str());
+    document.Parse(fileContent, size);
 
     tinyxml2::XMLElement *root = document.RootElement();
     CCASSERT(root, "XML error  or  XML is empty.");
@@ -689,7 +719,15 @@ AnimationData *DataReaderHelper::decodeAnimation(tinyxml2::XMLElement *animation
 
     const char	*name = animationXML->Attribute(A_NAME);
 
+    if (dataInfo->asyncStruct)
+    {
+        _dataReaderHelper->_addDataMutex.lock();
+    }
     ArmatureData *armatureData = ArmatureDataManager::getInstance()->getArmatureData(name);
+    if (dataInfo->asyncStruct)
+    {
+        _dataReaderHelper->_addDataMutex.unlock();
+    }
 
     aniData->name = name;
 
@@ -1204,7 +1242,7 @@ void DataReaderHelper::addDataFromJsonCache(const std::string& fileContent, Data
         {
             _dataReaderHelper->_addDataMutex.lock();
         }
-        ArmatureDataManager::getInstance()->addArmatureData(armatureData->name.c_str(), armatureData);
+        ArmatureDataManager::getInstance()->addArmatureData(armatureData->name.c_str(), armatureData, dataInfo->filename.c_str());
         armatureData->release();
         if (dataInfo->asyncStruct)
         {
@@ -1223,7 +1261,7 @@ void DataReaderHelper::addDataFromJsonCache(const std::string& fileContent, Data
         {
             _dataReaderHelper->_addDataMutex.lock();
         }
-        ArmatureDataManager::getInstance()->addAnimationData(animationData->name.c_str(), animationData);
+        ArmatureDataManager::getInstance()->addAnimationData(animationData->name.c_str(), animationData, dataInfo->filename.c_str());
         animationData->release();
         if (dataInfo->asyncStruct)
         {
@@ -1242,7 +1280,7 @@ void DataReaderHelper::addDataFromJsonCache(const std::string& fileContent, Data
         {
             _dataReaderHelper->_addDataMutex.lock();
         }
-        ArmatureDataManager::getInstance()->addTextureData(textureData->name.c_str(), textureData);
+        ArmatureDataManager::getInstance()->addTextureData(textureData->name.c_str(), textureData, dataInfo->filename.c_str());
         textureData->release();
         if (dataInfo->asyncStruct)
         {
@@ -1276,7 +1314,7 @@ void DataReaderHelper::addDataFromJsonCache(const std::string& fileContent, Data
                 std::string plistPath = filePath + ".plist";
                 std::string pngPath =  filePath + ".png";
 
-                ArmatureDataManager::getInstance()->addSpriteFrameFromFile((dataInfo->baseFilePath + plistPath).c_str(), (dataInfo->baseFilePath + pngPath).c_str());
+                ArmatureDataManager::getInstance()->addSpriteFrameFromFile((dataInfo->baseFilePath + plistPath).c_str(), (dataInfo->baseFilePath + pngPath).c_str(), dataInfo->filename.c_str());
             }
         }
     }
@@ -1582,6 +1620,7 @@ FrameData *DataReaderHelper::decodeFrame(const rapidjson::Value& json, DataInfo
     int length = DICTOOL->getArrayCount_json(json, A_EASING_PARAM);
     if (length != 0)
     {
+        frameData->easingParamNumber = length;
         frameData->easingParams = new float[length];
         
         for (int i = 0; i < length; i++)
@@ -1687,4 +1726,655 @@ void DataReaderHelper::decodeNode(BaseData *node, const rapidjson::Value& json,
 
 }
 
+
+
+/*
+* Binary format, all values are 32 bit little endian, whatever the byte order of the host:
+*
+* magic "CSAB", version
+* string table    : count, then per string its length and the characters with a '\0', padded to 4 bytes
+* sprite files    : count, plist path (relative to the config file)
+* armature datas  : count, then name, version, bones
+* animation datas : count, then name, movements, each movement bone keeps its frames in one flat array
+* texture datas   : count, then name, size, pivot, contours
+*
+* Every string is stored once in the string table and referenced by its index.
+*/
+
+namespace {
+
+class BinaryWriter
+{
+public:
+    void writeU32(unsigned int value)
+    {
+        unsigned char bytes[4] = {
+            (unsigned char)value, (unsigned char)(value >> 8), (unsigned char)(value >> 16), (unsigned char)(value >> 24)
+        };
+        write(bytes, sizeof(bytes));
+    }
+    void writeI32(int value) { writeU32((unsigned int)value); }
+    void writeFloat(float value)
+    {
+        unsigned int bits;
+        memcpy(&bits, &value, sizeof(bits));
+        writeU32(bits);
+    }
+    void writeBool(bool value) { writeU32(value ? 1 : 0); }
+
+    void writeString(const std::string& str)
+    {
+        auto iter = _stringIndices.find(str);
+        if (iter == _stringIndices.end())
+        {
+            iter = _stringIndices.insert(std::make_pair(str, (unsigned int)_strings.size())).first;
+            _strings.push_back(str);
+        }
+        writeU32(iter->second);
+    }
+
+    void writeBaseData(const BaseData *node)
+    {
+        writeFloat(node->x / s_PositionReadScale);
+        writeFloat(node->y / s_PositionReadScale);
+        writeI32(node->zOrder);
+        writeFloat(node->skewX);
+        writeFloat(node->skewY);
+        writeFloat(node->scaleX);
+        writeFloat(node->scaleY);
+        writeFloat(node->tweenRotate);
+        writeBool(node->isUseColorInfo);
+        writeI32(node->a);
+        writeI32(node->r);
+        writeI32(node->g);
+        writeI32(node->b);
+    }
+
+    bool saveToFile(const std::string& path) const
+    {
+        BinaryWriter head;
+        head.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        head.writeU32(BINARY_VERSION);
+        head.writeU32((unsigned int)_strings.size());
+        for (const auto& str : _strings)
+        {
+            head.writeU32((unsigned int)str.length());
+            head.write(str.c_str(), str.length() + 1);
+            while (head._buffer.size() % 4 != 0)
+            {
+                head._buffer.push_back(0);
+            }
+        }
+
+        FILE *fp = fopen(path.c_str(), "wb");
+        if (!fp)
+        {
+            CCLOG("can not open %s for writing", path.c_str());
+            return false;
+        }
+        bool ret = fwrite(head._buffer.data(), 1, head._buffer.size(), fp) == head._buffer.size()
+                && fwrite(_buffer.data(), 1, _buffer.size(), fp) == _buffer.size();
+        fclose(fp);
+        return ret;
+    }
+
+private:
+    void write(const void *data, size_t size)
+    {
+        const unsigned char *bytes = (const unsigned char *)data;
+        _buffer.insert(_buffer.end(), bytes, bytes + size);
+    }
+
+    std::vector<unsigned char> _buffer;
+    std::vector<std::string> _strings;
+    std::unordered_map<std::string, unsigned int> _stringIndices;
+};
+
+class BinaryReader
+{
+public:
+    BinaryReader(const unsigned char *bytes, ssize_t size)
+        : _cursor(bytes)
+        , _end(bytes + size)
+        , _valid(bytes != nullptr)
+    {
+    }
+
+    bool isValid() const { return _valid; }
+
+    /** Reads the number of items that follow, each taking at least minItemSize bytes.
+     A count the rest of the buffer can't hold makes the reader invalid, so corrupted files
+     don't reserve huge amounts of memory.
+     */
+    unsigned int readCount(size_t minItemSize)
+    {
+        unsigned int count = readU32();
+        if (_valid && count > (size_t)(_end - _cursor) / minItemSize)
+        {
+            _valid = false;
+        }
+        return _valid ? count : 0;
+    }
+
+    unsigned int readU32()
+    {
+        unsigned char bytes[4] = {0, 0, 0, 0};
+        read(bytes, sizeof(bytes));
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+    }
+    int readI32() { return (int)readU32(); }
+    float readFloat()
+    {
+        unsigned int bits = readU32();
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    bool readBool() { return readU32() != 0; }
+
+    /** The returned string points into the buffer */
+    const char *readString()
+    {
+        unsigned int index = readU32();
+        if (index >= _strings.size())
+        {
+            _valid = false;
+            return "";
+        }
+        return _strings[index];
+    }
+
+    bool readHeader()
+    {
+        char magic[sizeof(BINARY_MAGIC)];
+        read(magic, sizeof(magic));
+        if (!_valid || memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0 || readU32() != BINARY_VERSION)
+        {
+            _valid = false;
+            return false;
+        }
+
+        // a length and at least 4 bytes of characters
+        unsigned int count = readCount(sizeof(unsigned int) * 2);
+        _strings.reserve(count);
+        for (unsigned int i = 0; i < count && _valid; i++)
+        {
+            unsigned int length = readU32();
+            size_t padded = ((size_t)length + 1 + 3) & ~(size_t)3;
+            if (!_valid || (size_t)(_end - _cursor) < padded || _cursor[length] != '\0')
+            {
+                _valid = false;
+                break;
+            }
+            _strings.push_back((const char *)_cursor);
+            _cursor += padded;
+        }
+        return _valid;
+    }
+
+    void readBaseData(BaseData *node)
+    {
+        node->x = readFloat() * s_PositionReadScale;
+        node->y = readFloat() * s_PositionReadScale;
+        node->zOrder = readI32();
+        node->skewX = readFloat();
+        node->skewY = readFloat();
+        node->scaleX = readFloat();
+        node->scaleY = readFloat();
+        node->tweenRotate = readFloat();
+        node->isUseColorInfo = readBool();
+        node->a = readI32();
+        node->r = readI32();
+        node->g = readI32();
+        node->b = readI32();
+    }
+
+private:
+    void read(void *data, size_t size)
+    {
+        if (!_valid || (size_t)(_end - _cursor) < size)
+        {
+            _valid = false;
+            return;
+        }
+        memcpy(data, _cursor, size);
+        _cursor += size;
+    }
+
+    const unsigned char *_cursor;
+    const unsigned char *_end;
+    bool _valid;
+    std::vector<const char *> _strings;
+};
+
+// the smallest size of the records, to check the counts read
+static const size_t BINARY_BASE_DATA_SIZE = 13 * 4;
+static const size_t BINARY_BONE_MIN_SIZE = BINARY_BASE_DATA_SIZE + 3 * 4;
+static const size_t BINARY_DISPLAY_MIN_SIZE = 2 * 4;
+static const size_t BINARY_MOVEMENT_MIN_SIZE = 8 * 4;
+static const size_t BINARY_MOVEMENT_BONE_MIN_SIZE = 5 * 4;
+static const size_t BINARY_FRAME_MIN_SIZE = BINARY_BASE_DATA_SIZE + 12 * 4;
+static const size_t BINARY_ARMATURE_MIN_SIZE = 3 * 4;
+static const size_t BINARY_ANIMATION_MIN_SIZE = 2 * 4;
+static const size_t BINARY_TEXTURE_MIN_SIZE = 6 * 4;
+
+std::string relativePath(const std::string& path, const std::string& basePath)
+{
+    if (!basePath.empty() && path.compare(0, basePath.length(), basePath) == 0)
+    {
+        return path.substr(basePath.length());
+    }
+    return path;
+}
+
+void writeArmatureData(BinaryWriter& writer, ArmatureData *armatureData, const std::string& basePath)
+{
+    writer.writeString(armatureData->name);
+    writer.writeFloat(armatureData->dataVersion);
+    writer.writeU32((unsigned int)armatureData->boneDataDic.size());
+    for (auto& element : armatureData->boneDataDic)
+    {
+        BoneData *boneData = element.second;
+        writer.writeBaseData(boneData);
+        writer.writeString(boneData->name);
+        writer.writeString(boneData->parentName);
+        writer.writeU32((unsigned int)boneData->displayDataList.size());
+        for (auto& displayData : boneData->displayDataList)
+        {
+            writer.writeI32(displayData->displayType);
+            if (displayData->displayType == CS_DISPLAY_PARTICLE)
+            {
+                writer.writeString(relativePath(displayData->displayName, basePath));
+            }
+            else
+            {
+                writer.writeString(displayData->displayName);
+            }
+            // unknown display types are read as sprites, like the json decoder does
+            if (displayData->displayType != CS_DISPLAY_ARMATURE && displayData->displayType != CS_DISPLAY_PARTICLE)
+            {
+                writer.writeBaseData(&static_cast<SpriteDisplayData *>(displayData)->skinData);
+            }
+        }
+    }
+}
+
+void writeAnimationData(BinaryWriter& writer, AnimationData *animationData)
+{
+    writer.writeString(animationData->name);
+    writer.writeU32((unsigned int)animationData->movementNames.size());
+    for (const auto& movementName : animationData->movementNames)
+    {
+        MovementData *movementData = animationData->getMovement(movementName);
+        writer.writeString(movementData->name);
+        writer.writeI32(movementData->duration);
+        writer.writeFloat(movementData->scale);
+        writer.writeI32(movementData->durationTo);
+        writer.writeI32(movementData->durationTween);
+        writer.writeBool(movementData->loop);
+        writer.writeI32(movementData->tweenEasing);
+
+        writer.writeU32((unsigned int)movementData->movBoneDataDic.size());
+        for (auto& element : movementData->movBoneDataDic)
+        {
+            MovementBoneData *movBoneData = element.second;
+            writer.writeString(movBoneData->name);
+            writer.writeFloat(movBoneData->delay);
+            writer.writeFloat(movBoneData->scale);
+            writer.writeFloat(movBoneData->duration);
+
+            writer.writeU32((unsigned int)movBoneData->frameList.size());
+            for (auto& frameData : movBoneData->frameList)
+            {
+                writer.writeBaseData(frameData);
+                writer.writeI32(frameData->frameID);
+                writer.writeI32(frameData->duration);
+                writer.writeI32(frameData->tweenEasing);
+                writer.writeBool(frameData->isTween);
+                writer.writeI32(frameData->displayIndex);
+                writer.writeU32(frameData->blendFunc.src);
+                writer.writeU32(frameData->blendFunc.dst);
+                writer.writeString(frameData->strEvent);
+                writer.writeString(frameData->strMovement);
+                writer.writeString(frameData->strSound);
+                writer.writeString(frameData->strSoundEffect);
+                writer.writeI32(frameData->easingParams ? frameData->easingParamNumber : 0);
+            }
+            // easing params of all frames, in frame order
+            for (auto& frameData : movBoneData->frameList)
+            {
+                for (int i = 0; frameData->easingParams && i < frameData->easingParamNumber; i++)
+                {
+                    writer.writeFloat(frameData->easingParams[i]);
+                }
+            }
+        }
+    }
+}
+
+void writeTextureData(BinaryWriter& writer, TextureData *textureData)
+{
+    writer.writeString(textureData->name);
+    writer.writeFloat(textureData->width);
+    writer.writeFloat(textureData->height);
+    writer.writeFloat(textureData->pivotX);
+    writer.writeFloat(textureData->pivotY);
+    writer.writeU32((unsigned int)textureData->contourDataList.size());
+    for (auto& contourData : textureData->contourDataList)
+    {
+        writer.writeU32((unsigned int)contourData->vertexList.size());
+        for (const auto& vertex : contourData->vertexList)
+        {
+            writer.writeFloat(vertex.x);
+            writer.writeFloat(vertex.y);
+        }
+    }
+}
+
+ArmatureData *readArmatureData(BinaryReader& reader, const std::string& basePath)
+{
+    ArmatureData *armatureData = new ArmatureData();
+    armatureData->init();
+
+    armatureData->name = reader.readString();
+    armatureData->dataVersion = reader.readFloat();
+
+    unsigned int boneCount = reader.readCount(BINARY_BONE_MIN_SIZE);
+    for (unsigned int i = 0; i < boneCount && reader.isValid(); i++)
+    {
+        BoneData *boneData = new BoneData();
+        boneData->init();
+        reader.readBaseData(boneData);
+        boneData->name = reader.readString();
+        boneData->parentName = reader.readString();
+
+        unsigned int displayCount = reader.readCount(BINARY_DISPLAY_MIN_SIZE);
+        for (unsigned int j = 0; j < displayCount && reader.isValid(); j++)
+        {
+            DisplayType displayType = (DisplayType)reader.readI32();
+            DisplayData *displayData = nullptr;
+            switch (displayType)
+            {
+            case CS_DISPLAY_ARMATURE:
+                displayData = new ArmatureDisplayData();
+                displayData->displayName = reader.readString();
+                break;
+            case CS_DISPLAY_PARTICLE:
+                displayData = new ParticleDisplayData();
+                displayData->displayName = basePath + reader.readString();
+                break;
+            default:
+                displayData = new SpriteDisplayData();
+                displayData->displayName = reader.readString();
+                reader.readBaseData(&static_cast<SpriteDisplayData *>(displayData)->skinData);
+                break;
+            }
+            displayData->displayType = displayType;
+            boneData->addDisplayData(displayData);
+            displayData->release();
+        }
+
+        armatureData->addBoneData(boneData);
+        boneData->release();
+    }
+
+    return armatureData;
+}
+
+AnimationData *readAnimationData(BinaryReader& reader)
+{
+    AnimationData *aniData = new AnimationData();
+    aniData->name = reader.readString();
+
+    unsigned int movementCount = reader.readCount(BINARY_MOVEMENT_MIN_SIZE);
+    for (unsigned int i = 0; i < movementCount && reader.isValid(); i++)
+    {
+        MovementData *movementData = new MovementData();
+        movementData->name = reader.readString();
+        movementData->duration = reader.readI32();
+        movementData->scale = reader.readFloat();
+        movementData->durationTo = reader.readI32();
+        movementData->durationTween = reader.readI32();
+        movementData->loop = reader.readBool();
+        movementData->tweenEasing = (TweenType)reader.readI32();
+
+        unsigned int movBoneCount = reader.readCount(BINARY_MOVEMENT_BONE_MIN_SIZE);
+        for (unsigned int j = 0; j < movBoneCount && reader.isValid(); j++)
+        {
+            MovementBoneData *movBoneData = new MovementBoneData();
+            movBoneData->init();
+            movBoneData->name = reader.readString();
+            movBoneData->delay = reader.readFloat();
+            movBoneData->scale = reader.readFloat();
+            movBoneData->duration = reader.readFloat();
+
+            unsigned int frameCount = reader.readCount(BINARY_FRAME_MIN_SIZE);
+            movBoneData->frameList.reserve(frameCount);
+            for (unsigned int k = 0; k < frameCount && reader.isValid(); k++)
+            {
+                FrameData *frameData = new FrameData();
+                reader.readBaseData(frameData);
+                frameData->frameID = reader.readI32();
+                frameData->duration = reader.readI32();
+                frameData->tweenEasing = (TweenType)reader.readI32();
+                frameData->isTween = reader.readBool();
+                frameData->displayIndex = reader.readI32();
+                frameData->blendFunc.src = reader.readU32();
+                frameData->blendFunc.dst = reader.readU32();
+                frameData->strEvent = reader.readString();
+                frameData->strMovement = reader.readString();
+                frameData->strSound = reader.readString();
+                frameData->strSoundEffect = reader.readString();
+                frameData->easingParamNumber = (int)reader.readCount(sizeof(float));
+
+                movBoneData->addFrameData(frameData);
+                frameData->release();
+            }
+
+            for (auto& frameData : movBoneData->frameList)
+            {
+                if (frameData->easingParamNumber <= 0 || !reader.isValid())
+                {
+                    continue;
+                }
+                frameData->easingParams = new float[frameData->easingParamNumber];
+                for (int k = 0; k < frameData->easingParamNumber; k++)
+                {
+                    frameData->easingParams[k] = reader.readFloat();
+                }
+            }
+
+            movementData->addMovementBoneData(movBoneData);
+            movBoneData->release();
+        }
+
+        aniData->addMovement(movementData);
+        movementData->release();
+    }
+
+    return aniData;
+}
+
+TextureData *readTextureData(BinaryReader& reader)
+{
+    TextureData *textureData = new TextureData();
+    textureData->init();
+
+    textureData->name = reader.readString();
+    textureData->width = reader.readFloat();
+    textureData->height = reader.readFloat();
+    textureData->pivotX = reader.readFloat();
+    textureData->pivotY = reader.readFloat();
+
+    unsigned int contourCount = reader.readCount(sizeof(unsigned int));
+    for (unsigned int i = 0; i < contourCount && reader.isValid(); i++)
+    {
+        ContourData *contourData = new ContourData();
+        contourData->init();
+
+        unsigned int vertexCount = reader.readCount(sizeof(float) * 2);
+        for (unsigned int j = 0; j < vertexCount && reader.isValid(); j++)
+        {
+            Vector2 vertex;
+            vertex.x = reader.readFloat();
+            vertex.y = reader.readFloat();
+            contourData->vertexList.push_back(vertex);
+        }
+
+        textureData->contourDataList.pushBack(contourData);
+        contourData->release();
+    }
+
+    return textureData;
+}
+
+}
+
+void DataReaderHelper::addDataFromBinaryCache(const unsigned char *bytes, ssize_t size, DataInfo *dataInfo)
+{
+    BinaryReader reader(bytes, size);
+    if (!reader.readHeader())
+    {
+        CCLOG("%s is not a valid armature binary file", dataInfo->filename.c_str());
+        return;
+    }
+
+    std::string basePath = dataInfo->asyncStruct ? dataInfo->asyncStruct->baseFilePath : dataInfo->baseFilePath;
+
+    std::vector<std::string> spriteFiles;
+    unsigned int count = reader.readCount(sizeof(unsigned int));
+    for (unsigned int i = 0; i < count && reader.isValid(); i++)
+    {
+        spriteFiles.push_back(reader.readString());
+    }
+
+    // the whole file is decoded before any data is added, a corrupted file adds nothing
+    std::vector<ArmatureData *> armatureDatas;
+    count = reader.readCount(BINARY_ARMATURE_MIN_SIZE);
+    for (unsigned int i = 0; i < count && reader.isValid(); i++)
+    {
+        armatureDatas.push_back(readArmatureData(reader, basePath));
+    }
+
+    std::vector<AnimationData *> animationDatas;
+    count = reader.readCount(BINARY_ANIMATION_MIN_SIZE);
+    for (unsigned int i = 0; i < count && reader.isValid(); i++)
+    {
+        animationDatas.push_back(readAnimationData(reader));
+    }
+
+    std::vector<TextureData *> textureDatas;
+    count = reader.readCount(BINARY_TEXTURE_MIN_SIZE);
+    for (unsigned int i = 0; i < count && reader.isValid(); i++)
+    {
+        textureDatas.push_back(readTextureData(reader));
+    }
+
+    bool valid = reader.isValid();
+    if (valid)
+    {
+        if (dataInfo->asyncStruct)
+        {
+            _dataReaderHelper->_addDataMutex.lock();
+        }
+        for (auto armatureData : armatureDatas)
+        {
+            ArmatureDataManager::getInstance()->addArmatureData(armatureData->name, armatureData, dataInfo->filename);
+        }
+        for (auto animationData : animationDatas)
+        {
+            ArmatureDataManager::getInstance()->addAnimationData(animationData->name, animationData, dataInfo->filename);
+        }
+        for (auto textureData : textureDatas)
+        {
+            ArmatureDataManager::getInstance()->addTextureData(textureData->name, textureData, dataInfo->filename);
+        }
+        if (dataInfo->asyncStruct)
+        {
+            _dataReaderHelper->_addDataMutex.unlock();
+        }
+    }
+
+    for (auto armatureData : armatureDatas)
+    {
+        armatureData->release();
+    }
+    for (auto animationData : animationDatas)
+    {
+        animationData->release();
+    }
+    for (auto textureData : textureDatas)
+    {
+        textureData->release();
+    }
+
+    if (!valid)
+    {
+        CCLOG("%s is truncated or corrupted", dataInfo->filename.c_str());
+        return;
+    }
+
+    // Auto load sprite file
+    bool autoLoad = dataInfo->asyncStruct == nullptr ? ArmatureDataManager::getInstance()->isAutoLoadSpriteFile() : dataInfo->asyncStruct->autoLoadSpriteFile;
+    if (autoLoad)
+    {
+        for (const auto& spriteFile : spriteFiles)
+        {
+            std::string filePath = spriteFile.substr(0, spriteFile.find_last_of("."));
+
+            if (dataInfo->asyncStruct)
+            {
+                dataInfo->configFileQueue.push(filePath);
+            }
+            else
+            {
+                ArmatureDataManager::getInstance()->addSpriteFrameFromFile(basePath + filePath + ".plist", basePath + filePath + ".png", dataInfo->filename);
+            }
+        }
+    }
+}
+
+bool DataReaderHelper::saveBinaryFile(const std::string& configFilePath, const std::string& outputPath)
+{
+    ArmatureDataManager *manager = ArmatureDataManager::getInstance();
+    RelativeData *relativeData = manager->getRelativeData(configFilePath);
+    if (relativeData->armatures.empty() && relativeData->animations.empty() && relativeData->textures.empty())
+    {
+        CCLOG("no armature data was loaded from %s", configFilePath.c_str());
+        return false;
+    }
+
+    std::string basePath = configFilePath;
+    size_t pos = basePath.find_last_of("/");
+    basePath = pos != std::string::npos ? basePath.substr(0, pos + 1) : "";
+
+    BinaryWriter writer;
+
+    writer.writeU32((unsigned int)relativeData->plistFiles.size());
+    for (const auto& plistFile : relativeData->plistFiles)
+    {
+        writer.writeString(relativePath(plistFile, basePath));
+    }
+
+    writer.writeU32((unsigned int)relativeData->armatures.size());
+    for (const auto& name : relativeData->armatures)
+    {
+        writeArmatureData(writer, manager->getArmatureData(name), basePath);
+    }
+
+    writer.writeU32((unsigned int)relativeData->animations.size());
+    for (const auto& name : relativeData->animations)
+    {
+        writeAnimationData(writer, manager->getAnimationData(name));
+    }
+
+    writer.writeU32((unsigned int)relativeData->textures.size());
+    for (const auto& name : relativeData->textures)
+    {
+        writeTextureData(writer, manager->getTextureData(name));
+    }
+
+    return writer.saveToFile(outputPath);
+}
+
 }
@@ -33,9 +33,9 @@ THE SOFTWARE.
 #include <string>
 #include <queue>
 #include <list>
+#include <vector>
 #include <mutex>
-#include <thread>
-#include <condition_variable>
+#include "base/CCJobSystem.h"
 
 namespace tinyxml2
 {
@@ -55,13 +55,14 @@ protected:
 	enum ConfigType
 	{
 		DragonBone_XML,
-		CocoStudio_JSON
+		CocoStudio_JSON,
+		CocoStudio_Binary
 	};
 
 	typedef struct _AsyncStruct
 	{
 		std::string    filename;
-		std::string    fileContent;
+		std::string    fullPath;
 		ConfigType     configType;
 		std::string    baseFilePath;
 		cocos2d::Ref       *target;
@@ -81,6 +82,7 @@ protected:
         std::string    baseFilePath;
         float flashToolVersion;
         float cocoStudioVersion;
+        int pendingSpriteFileCount;
 	} DataInfo;
 
 public:
@@ -123,7 +125,9 @@ public:
      *
      * @param xmlPath The cache of the xml
      */
-    static void addDataFromCache(const std::string& pFileContent, DataInfo *dataInfo = nullptr);
+    static void addDataFromCache(const std::string& pFileContent, DataInfo *dataInfo);
+    /** The content doesn't need to be '\0' terminated, so a mapped file can be passed as it is */
+    static void addDataFromCache(const char *fileContent, size_t size, DataInfo *dataInfo);
 
 
 
@@ -155,7 +159,7 @@ public:
     static ContourData *decodeContour(tinyxml2::XMLElement *contourXML, DataInfo *dataInfo);
 
 public:
-    static void addDataFromJsonCache(const std::string& fileContent, DataInfo *dataInfo = nullptr);
+    static void addDataFromJsonCache(const std::string& fileContent, DataInfo *dataInfo);
 
     static ArmatureData *decodeArmature(const rapidjson::Value& json, DataInfo *dataInfo);
     static BoneData *decodeBone(const rapidjson::Value& json, DataInfo *dataInfo);
@@ -172,19 +176,39 @@ public:
 
     static void decodeNode(BaseData *node, const rapidjson::Value& json, DataInfo *dataInfo);
 
-protected:
-	void loadData();
+public:
+    /**
+     * Decode the binary format written by tools/armature/armature_to_binary.py or saveBinaryFile.
+     * Strings are read in place from the buffer, which only has to stay valid during the call.
+     * Nothing is added if the file is truncated or corrupted.
+     */
+    static void addDataFromBinaryCache(const unsigned char *bytes, ssize_t size, DataInfo *dataInfo);
 
+    /**
+     * Write the armature, animation and texture datas loaded from configFilePath in the binary format.
+     * The config file must have been added with ArmatureDataManager::addArmatureFileInfo before.
+     * Files with the .csab extension are loaded as binary by addDataFromFile and addDataFromFileAsync.
+     * Shipped files are better converted offline with tools/armature/armature_to_binary.py,
+     * this writes the datas as the engine decoded them, to check the tool against the engine.
+     *
+     * @param configFilePath The xml or json file the datas were loaded from
+     * @param outputPath The full path of the binary file to write
+     * @return true if the file was written
+     */
+    static bool saveBinaryFile(const std::string& configFilePath, const std::string& outputPath);
+
+protected:
+	void loadData(AsyncStruct *asyncStruct);
 
+    void addSpriteFileAsync(DataInfo *dataInfo, const std::string& plistPath, const std::string& imagePath, const std::string& configFilePath);
+    void spriteFileLoaded(DataInfo *dataInfo);
 
 
-	std::condition_variable		_sleepCondition;
 
-	std::thread     *_loadingThread;
 
-	std::mutex      _sleepMutex;
+	// the jobs reading and parsing config files, each of them loads one file
+	std::vector<cocos2d::JobSystem::JobPtr> _loadingJobs;
 
-	std::mutex      _asyncStructQueueMutex;
 	std::mutex      _dataInfoMutex;
 
 	std::mutex      _addDataMutex;
@@ -195,11 +219,11 @@ protected:
 	unsigned long _asyncRefCount;
 	unsigned long _asyncRefTotalCount;
 
-	bool need_quit;
-
-	std::queue<AsyncStruct *> *_asyncStructQueue;
 	std::queue<DataInfo *>   *_dataQueue;
 
+	// the job system of the director the jobs were added to
+	cocos2d::JobSystem *_jobSystem;
+
     static std::vector<std::string> _configFileList;
 
     static DataReaderHelper *_dataReaderHelper;
@@ -25,6 +25,9 @@ THE SOFTWARE.
 #include "cocostudio/CCDatas.h"
 #include "cocostudio/CCUtilMath.h"
 #include "cocostudio/CCTransformHelp.h"
+#include "2d/CCNodePool.h"
+
+#include <mutex>
 
 using namespace cocos2d;
 
@@ -268,6 +271,30 @@ FrameData::~FrameData(void)
     CC_SAFE_DELETE(easingParams);
 }
 
+static std::mutex& getFrameDataMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+static SlabAllocator& getFrameDataAllocator()
+{
+    static SlabAllocator allocator(sizeof(FrameData), 256);
+    return allocator;
+}
+
+void *FrameData::operator new(size_t size)
+{
+    std::lock_guard<std::mutex> lock(getFrameDataMutex());
+    return getFrameDataAllocator().allocate(size);
+}
+
+void FrameData::operator delete(void *ptr, size_t size)
+{
+    std::lock_guard<std::mutex> lock(getFrameDataMutex());
+    getFrameDataAllocator().deallocate(ptr, size);
+}
+
 void FrameData::copy(const BaseData *baseData)
 {
     BaseData::copy(baseData);
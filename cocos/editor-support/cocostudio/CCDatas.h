@@ -329,6 +329,16 @@ public:
      */
     ~FrameData();
 
+    /**
+     * Key frames come from a SlabAllocator shared by all armatures, so the thousands of frames
+     * of a file don't get scattered over the heap. It is locked, frames are created on the
+     * loading threads too.
+     * @js NA
+     * @lua NA
+     */
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr, size_t size);
+
     virtual void copy(const BaseData *baseData);
 public:
     int frameID;
@@ -141,7 +141,7 @@ const BaseData &Skin::getSkinData() const
 
 void Skin::updateArmatureTransform()
 {
-    _transform = TransformConcat(_bone->getNodeToArmatureTransform(), _skinTransform);
+    TransformHelp::affineConcat(_bone->getNodeToArmatureTransform(), _skinTransform, _transform);
 //    if(_armature && _armature->getBatchNode())
 //    {
 //        _transform = TransformConcat(_transform, _armature->getNodeToParentTransform());
@@ -51,6 +51,9 @@ public:
     void updateArmatureTransform();
     void updateTransform() override;
 
+    //! The transform from skin to armature, computed in updateArmatureTransform
+    const Matrix &getArmatureTransform() const { return _transform; }
+
     Matrix getNodeToWorldTransform() const override;
     Matrix getNodeToWorldTransformAR() const;
     
@@ -25,6 +25,15 @@ THE SOFTWARE.
 #include "cocostudio/CCTransformHelp.h"
 #include "cocostudio/CCUtilMath.h"
 
+// affineConcat uses SSE2 or NEON when the target always has them, like the Texture2D pixel format converters
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CC_TRANSFORM_HELP_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    #define CC_TRANSFORM_HELP_NEON 1
+    #include <arm_neon.h>
+#endif
+
 using namespace cocos2d;
 
 namespace cocostudio {
@@ -198,6 +207,64 @@ void TransformHelp::matrixToNode(const Matrix &matrix, BaseData &node)
 }
 
 
+static inline bool isAffine2D(const Matrix &m)
+{
+    return m.m[2] == 0 && m.m[3] == 0 && m.m[6] == 0 && m.m[7] == 0
+        && m.m[8] == 0 && m.m[9] == 0 && m.m[10] == 1 && m.m[11] == 0 && m.m[15] == 1;
+}
+
+void TransformHelp::affineConcat(const Matrix &t1, const Matrix &t2, Matrix &out)
+{
+    if (!isAffine2D(t1) || !isAffine2D(t2))
+    {
+        out = t1 * t2;
+        return;
+    }
+
+    // (a, b, c, d) = (col0, col0) * (t2.m[0], t2.m[0], t2.m[4], t2.m[4]) + (col1, col1) * (t2.m[1], t2.m[1], t2.m[5], t2.m[5])
+    // (tx, ty) = col0 * t2.m[12] + col1 * t2.m[13] + col3, where colN are the 2D columns of t1
+    float abcd[4];
+    float txty[4];
+#if CC_TRANSFORM_HELP_SSE2
+    __m128 col0 = _mm_setr_ps(t1.m[0], t1.m[1], t1.m[0], t1.m[1]);
+    __m128 col1 = _mm_setr_ps(t1.m[4], t1.m[5], t1.m[4], t1.m[5]);
+    __m128 linear = _mm_add_ps(_mm_mul_ps(col0, _mm_setr_ps(t2.m[0], t2.m[0], t2.m[4], t2.m[4])),
+                               _mm_mul_ps(col1, _mm_setr_ps(t2.m[1], t2.m[1], t2.m[5], t2.m[5])));
+    __m128 translation = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, _mm_set1_ps(t2.m[12])), _mm_mul_ps(col1, _mm_set1_ps(t2.m[13]))),
+                                    _mm_setr_ps(t1.m[12], t1.m[13], 0, 0));
+    _mm_storeu_ps(abcd, linear);
+    _mm_storeu_ps(txty, translation);
+#elif CC_TRANSFORM_HELP_NEON
+    float32x2_t col0 = vld1_f32(&t1.m[0]);
+    float32x2_t col1 = vld1_f32(&t1.m[4]);
+    float32x4_t col00 = vcombine_f32(col0, col0);
+    float32x4_t col11 = vcombine_f32(col1, col1);
+    float32x4_t linear = vmulq_f32(col00, vcombine_f32(vdup_n_f32(t2.m[0]), vdup_n_f32(t2.m[4])));
+    linear = vmlaq_f32(linear, col11, vcombine_f32(vdup_n_f32(t2.m[1]), vdup_n_f32(t2.m[5])));
+    float32x2_t translation = vmla_n_f32(vmla_n_f32(vld1_f32(&t1.m[12]), col0, t2.m[12]), col1, t2.m[13]);
+    vst1q_f32(abcd, linear);
+    vst1_f32(txty, translation);
+#else
+    abcd[0] = t1.m[0] * t2.m[0] + t1.m[4] * t2.m[1];
+    abcd[1] = t1.m[1] * t2.m[0] + t1.m[5] * t2.m[1];
+    abcd[2] = t1.m[0] * t2.m[4] + t1.m[4] * t2.m[5];
+    abcd[3] = t1.m[1] * t2.m[4] + t1.m[5] * t2.m[5];
+    txty[0] = t1.m[0] * t2.m[12] + t1.m[4] * t2.m[13] + t1.m[12];
+    txty[1] = t1.m[1] * t2.m[12] + t1.m[5] * t2.m[13] + t1.m[13];
+#endif
+    float tz = t1.m[14] + t2.m[14];
+
+    // out may be t1 or t2, it's written after both were read
+    out = Matrix::identity();
+    out.m[0] = abcd[0];
+    out.m[1] = abcd[1];
+    out.m[4] = abcd[2];
+    out.m[5] = abcd[3];
+    out.m[12] = txty[0];
+    out.m[13] = txty[1];
+    out.m[14] = tz;
+}
+
 void TransformHelp::nodeConcat(BaseData &target, BaseData &source)
 {
     target.x += source.x;
@@ -53,6 +53,13 @@ public:
     static void matrixToNode(const cocos2d::AffineTransform &_matrix, BaseData &_node);
     static void matrixToNode(const Matrix &_matrix, BaseData &_node);
 
+    /*
+     * out = t1 * t2, same as TransformConcat. Matrices built by nodeToMatrix only use the 2D
+     * affine part, for those only the six affine terms are computed, with SSE2 or NEON when the target
+     * has them; others fall back to a full multiply.
+     */
+    static void affineConcat(const Matrix &t1, const Matrix &t2, Matrix &out);
+
     static void nodeConcat(BaseData &target, BaseData &source);
     static void nodeSub(BaseData &target, BaseData &source);
 public:
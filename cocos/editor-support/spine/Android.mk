@@ -16,11 +16,13 @@ Bone.cpp \
 BoneData.cpp \
 CCSkeleton.cpp \
 CCSkeletonAnimation.cpp \
+CCSkeletonAnimationCache.cpp \
 Json.cpp \
 RegionAttachment.cpp \
 Skeleton.cpp \
 SkeletonData.cpp \
 SkeletonJson.cpp \
+SkeletonBinary.cpp \
 Skin.cpp \
 Slot.cpp \
 SlotData.cpp \
@@ -40,6 +40,27 @@ using std::max;
 
 namespace spine {
 
+/* Files converted by tools/spine/skeleton_to_binary.py are decoded straight from the mapped file. */
+static spSkeletonData* readSkeletonDataFile (const char* skeletonDataFile, spAtlas* atlas, float scale) {
+	spSkeletonData* skeletonData;
+	size_t length = strlen(skeletonDataFile);
+	if (length > 5 && strcmp(skeletonDataFile + length - 5, ".cssb") == 0) {
+		Data data = FileUtils::getInstance()->getMappedDataFromFile(skeletonDataFile);
+		spSkeletonBinary* binary = spSkeletonBinary_create(atlas);
+		binary->scale = scale == 0 ? (1 / Director::getInstance()->getContentScaleFactor()) : scale;
+		skeletonData = spSkeletonBinary_readSkeletonData(binary, data.getBytes(), (int)data.getSize());
+		CCAssert(skeletonData, binary->error ? binary->error : "Error reading skeleton data file.");
+		spSkeletonBinary_dispose(binary);
+	} else {
+		spSkeletonJson* json = spSkeletonJson_create(atlas);
+		json->scale = scale == 0 ? (1 / Director::getInstance()->getContentScaleFactor()) : scale;
+		skeletonData = spSkeletonJson_readSkeletonDataFile(json, skeletonDataFile);
+		CCAssert(skeletonData, json->error ? json->error : "Error reading skeleton data file.");
+		spSkeletonJson_dispose(json);
+	}
+	return skeletonData;
+}
+
 Skeleton* Skeleton::createWithData (spSkeletonData* skeletonData, bool isOwnsSkeletonData) {
 	Skeleton* node = new Skeleton(skeletonData, isOwnsSkeletonData);
 	node->autorelease();
@@ -91,13 +112,7 @@ Skeleton::Skeleton (spSkeletonData *skeletonData, bool isOwnsSkeletonData) {
 Skeleton::Skeleton (const char* skeletonDataFile, spAtlas* aAtlas, float scale) {
 	initialize();
 
-	spSkeletonJson* json = spSkeletonJson_create(aAtlas);
-	json->scale = scale == 0 ? (1 / Director::getInstance()->getContentScaleFactor()) : scale;
-	spSkeletonData* skeletonData = spSkeletonJson_readSkeletonDataFile(json, skeletonDataFile);
-	CCAssert(skeletonData, json->error ? json->error : "Error reading skeleton data.");
-	spSkeletonJson_dispose(json);
-
-	setSkeletonData(skeletonData, true);
+	setSkeletonData(readSkeletonDataFile(skeletonDataFile, aAtlas, scale), true);
 }
 
 Skeleton::Skeleton (const char* skeletonDataFile, const char* atlasFile, float scale) {
@@ -106,13 +121,7 @@ Skeleton::Skeleton (const char* skeletonDataFile, const char* atlasFile, float s
 	atlas = spAtlas_readAtlasFile(atlasFile);
 	CCAssert(atlas, "Error reading atlas file.");
 
-	spSkeletonJson* json = spSkeletonJson_create(atlas);
-	json->scale = scale == 0 ? (1 / Director::getInstance()->getContentScaleFactor()) : scale;
-	spSkeletonData* skeletonData = spSkeletonJson_readSkeletonDataFile(json, skeletonDataFile);
-	CCAssert(skeletonData, json->error ? json->error : "Error reading skeleton data file.");
-	spSkeletonJson_dispose(json);
-
-	setSkeletonData(skeletonData, true);
+	setSkeletonData(readSkeletonDataFile(skeletonDataFile, atlas, scale), true);
 }
 
 Skeleton::~Skeleton () {
@@ -59,6 +59,7 @@ public:
     cocos2d::BlendFunc blendFunc;
 
 	static Skeleton* createWithData (spSkeletonData* skeletonData, bool ownsSkeletonData = false);
+	/* skeletonDataFile is the JSON export, or a .cssb file made from it by tools/spine/skeleton_to_binary.py */
 	static Skeleton* createWithFile (const char* skeletonDataFile, spAtlas* atlas, float scale = 0);
 	static Skeleton* createWithFile (const char* skeletonDataFile, const char* atlasFile, float scale = 0);
 
@@ -67,6 +67,7 @@ SkeletonAnimation* SkeletonAnimation::createWithFile (const char* skeletonDataFi
 void SkeletonAnimation::initialize () {
 	listenerInstance = 0;
 	listenerMethod = 0;
+	animationCache = 0;
 
 	ownsAnimationStateData = true;
 	state = spAnimationState_create(spAnimationStateData_create(skeleton->data));
@@ -90,6 +91,7 @@ SkeletonAnimation::SkeletonAnimation (const char* skeletonDataFile, const char*
 }
 
 SkeletonAnimation::~SkeletonAnimation () {
+	CC_SAFE_RELEASE(animationCache);
 	if (ownsAnimationStateData) spAnimationStateData_dispose(state->data);
 	spAnimationState_dispose(state);
 }
@@ -99,10 +101,74 @@ void SkeletonAnimation::update (float deltaTime) {
 
 	deltaTime *= timeScale;
 	spAnimationState_update(state, deltaTime);
-	spAnimationState_apply(state, skeleton);
+	if (!animationCache || !applyCachedAnimation()) spAnimationState_apply(state, skeleton);
 	spSkeleton_updateWorldTransform(skeleton);
 }
 
+/* Mirrors spAnimationState_apply for a single unmixed track, posing the skeleton from the cache instead of the
+ * timelines. Returns false without touching the state when the cache cannot be used this frame. */
+bool SkeletonAnimation::applyCachedAnimation () {
+	int i, ii;
+	int trackIndex = -1;
+	for (i = 0; i < state->trackCount; i++) {
+		if (!state->tracks[i]) continue;
+		if (trackIndex != -1) return false;
+		trackIndex = i;
+	}
+	if (trackIndex == -1) return true;
+
+	spTrackEntry* current = state->tracks[trackIndex];
+	if (current->previous) return false;
+	const BakedAnimation* baked = animationCache->getBakedAnimation(current->animation);
+	if (!baked) return false;
+
+	const spAnimation* animation = current->animation;
+	float time = current->time;
+	if (!current->loop && time > current->endTime) time = current->endTime;
+	float lastTime = current->lastTime;
+	float animationTime = time;
+	if (current->loop && animation->duration) {
+		animationTime = FMOD(time, animation->duration);
+		lastTime = FMOD(lastTime, animation->duration);
+	}
+	animationCache->apply(baked, skeleton, animationTime);
+
+	/* An event timeline fires each of its frames at most once per update. */
+	if ((int)firedEvents.size() < baked->maxFiredEvents) firedEvents.resize(baked->maxFiredEvents);
+	spEvent** events = firedEvents.empty() ? 0 : &firedEvents[0];
+	int eventCount = 0;
+	for (i = 0; events && i < animation->timelineCount; i++) {
+		if (animation->timelines[i]->type != TIMELINE_EVENT) continue;
+		spTimeline_apply(animation->timelines[i], skeleton, lastTime, animationTime, events, &eventCount, 1);
+	}
+	for (ii = 0; ii < eventCount; ii++) {
+		if (current->listener) current->listener(state, trackIndex, ANIMATION_EVENT, events[ii], 0);
+		if (state->listener) state->listener(state, trackIndex, ANIMATION_EVENT, events[ii], 0);
+	}
+
+	/* Check if completed the animation or a loop iteration. */
+	if (current->loop ? (FMOD(current->lastTime, current->endTime) > FMOD(time, current->endTime)) //
+			: (current->lastTime < current->endTime && time >= current->endTime)) {
+		int count = (int)(time / current->endTime);
+		if (current->listener) current->listener(state, trackIndex, ANIMATION_COMPLETE, 0, count);
+		if (state->listener) state->listener(state, trackIndex, ANIMATION_COMPLETE, 0, count);
+	}
+
+	if (trackIndex < state->trackCount && state->tracks[trackIndex] == current) current->lastTime = current->time;
+	return true;
+}
+
+void SkeletonAnimation::setAnimationCache (SkeletonAnimationCache* cache) {
+	CCAssert(!cache || cache->getSkeletonData() == skeleton->data, "Animation cache was created for other skeleton data.");
+	CC_SAFE_RETAIN(cache);
+	CC_SAFE_RELEASE(animationCache);
+	animationCache = cache;
+}
+
+SkeletonAnimationCache* SkeletonAnimation::getAnimationCache () const {
+	return animationCache;
+}
+
 void SkeletonAnimation::setAnimationStateData (spAnimationStateData* stateData) {
 	CCAssert(stateData, "stateData cannot be null.");
 
@@ -36,6 +36,7 @@
 
 #include <spine/spine.h>
 #include <spine/CCSkeleton.h>
+#include <spine/CCSkeletonAnimationCache.h>
 
 namespace spine {
 
@@ -73,6 +74,12 @@ public:
 
 	virtual void onAnimationStateEvent (int trackIndex, spEventType type, spEvent* event, int loopCount);
 
+	/* Shares pre-sampled poses with other instances of the same skeleton data. The cache is used while a single track
+	 * plays without mixing, otherwise the timelines are evaluated as usual.
+	 * @param cache May be 0 to always evaluate the timelines. */
+	void setAnimationCache (SkeletonAnimationCache* cache);
+	SkeletonAnimationCache* getAnimationCache () const;
+
 protected:
 	SkeletonAnimation ();
 
@@ -81,8 +88,11 @@ private:
     cocos2d::Ref* listenerInstance;
 	SEL_AnimationStateEvent listenerMethod;
 	bool ownsAnimationStateData;
+	SkeletonAnimationCache* animationCache;
+	std::vector<spEvent*> firedEvents;
 
 	void initialize ();
+	bool applyCachedAnimation ();
 };
 
 }
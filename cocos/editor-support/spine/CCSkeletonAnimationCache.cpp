@@ -0,0 +1,320 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <spine/CCSkeletonAnimationCache.h>
+#include <spine/extension.h>
+#include <string.h>
+#include <float.h>
+#include <algorithm>
+
+#include "base/ccMacros.h"
+
+namespace spine {
+
+SkeletonAnimationCache* SkeletonAnimationCache::create (spSkeletonData* skeletonData, float sampleRate) {
+	SkeletonAnimationCache* cache = new SkeletonAnimationCache(skeletonData, sampleRate);
+	cache->autorelease();
+	return cache;
+}
+
+SkeletonAnimationCache::SkeletonAnimationCache (spSkeletonData* skeletonData, float sampleRate)
+		: skeletonData(skeletonData)
+		, sampler(0)
+		, sampleRate(sampleRate) {
+	CCAssert(skeletonData, "skeletonData cannot be null.");
+	CCAssert(sampleRate > 0, "sampleRate must be positive.");
+	sampler = spSkeleton_create(skeletonData);
+}
+
+SkeletonAnimationCache::~SkeletonAnimationCache () {
+	removeAllBakedAnimations();
+	spSkeleton_dispose(sampler);
+}
+
+const BakedAnimation* SkeletonAnimationCache::bakeAnimation (const char* animationName) {
+	spAnimation* animation = spSkeletonData_findAnimation(skeletonData, animationName);
+	if (!animation) {
+		cocos2d::log("Spine: Animation not found: %s", animationName);
+		return 0;
+	}
+	return getBakedAnimation(animation);
+}
+
+const BakedAnimation* SkeletonAnimationCache::getBakedAnimation (const spAnimation* animation) {
+	auto iter = bakedAnimations.find(animation);
+	if (iter != bakedAnimations.end()) return iter->second;
+
+	/* Animations that cannot be baked are remembered as 0 so they are not inspected again. */
+	BakedAnimation* baked = bake(animation);
+	bakedAnimations[animation] = baked;
+	return baked;
+}
+
+BakedAnimation* SkeletonAnimationCache::bake (const spAnimation* animation) {
+	int i, frame;
+	for (i = 0; i < animation->timelineCount; ++i)
+		if (animation->timelines[i]->type == TIMELINE_DRAWORDER) return 0;
+
+	BakedAnimation* baked = new BakedAnimation();
+	baked->animation = animation;
+	baked->maxFiredEvents = 0;
+
+	/* Find what the timelines key, in skeleton order, and when their first key is. */
+	std::vector<int> boneKeys(sampler->boneCount, 0);
+	std::vector<float> boneKeyStarts(sampler->boneCount * 3, FLT_MAX);
+	std::vector<float> colorStarts(sampler->slotCount, FLT_MAX);
+	std::vector<float> attachmentStarts(sampler->slotCount, FLT_MAX);
+	for (i = 0; i < animation->timelineCount; ++i) {
+		const spTimeline* timeline = animation->timelines[i];
+		switch (timeline->type) {
+		case TIMELINE_TRANLATE:
+		case TIMELINE_ROTATE:
+		case TIMELINE_SCALE: {
+			/* The three are spBaseTimeline. */
+			const spTranslateTimeline* boneTimeline = (const spTranslateTimeline*)timeline;
+			int key = timeline->type == TIMELINE_TRANLATE ? 0 : timeline->type == TIMELINE_ROTATE ? 1 : 2;
+			boneKeys[boneTimeline->boneIndex] |= 1 << key;
+			float* start = &boneKeyStarts[boneTimeline->boneIndex * 3 + key];
+			*start = MIN(*start, boneTimeline->frames[0]);
+			break;
+		}
+		case TIMELINE_COLOR: {
+			const spColorTimeline* colorTimeline = (const spColorTimeline*)timeline;
+			colorStarts[colorTimeline->slotIndex] = MIN(colorStarts[colorTimeline->slotIndex], colorTimeline->frames[0]);
+			break;
+		}
+		case TIMELINE_ATTACHMENT: {
+			const spAttachmentTimeline* attachmentTimeline = (const spAttachmentTimeline*)timeline;
+			attachmentStarts[attachmentTimeline->slotIndex] = MIN(attachmentStarts[attachmentTimeline->slotIndex],
+					attachmentTimeline->frames[0]);
+			break;
+		}
+		case TIMELINE_EVENT:
+			baked->maxFiredEvents += ((const spEventTimeline*)timeline)->framesLength;
+			break;
+		default:
+			break;
+		}
+	}
+	for (i = 0; i < sampler->boneCount; ++i) {
+		if (!boneKeys[i]) continue;
+		baked->boneIndices.push_back(i);
+		baked->boneKeys.push_back(boneKeys[i]);
+		baked->boneKeyStarts.insert(baked->boneKeyStarts.end(), &boneKeyStarts[i * 3], &boneKeyStarts[i * 3] + 3);
+	}
+	for (i = 0; i < sampler->slotCount; ++i) {
+		if (colorStarts[i] != FLT_MAX) {
+			baked->colorSlotIndices.push_back(i);
+			baked->colorKeyStarts.push_back(colorStarts[i]);
+		}
+		if (attachmentStarts[i] != FLT_MAX) {
+			baked->attachmentSlotIndices.push_back(i);
+			baked->attachmentKeyStarts.push_back(attachmentStarts[i]);
+		}
+	}
+
+	const int boneCount = (int)baked->boneIndices.size();
+	const int colorCount = (int)baked->colorSlotIndices.size();
+	const int attachmentCount = (int)baked->attachmentSlotIndices.size();
+	baked->frameCount = (int)ceilf(animation->duration * sampleRate) + 1;
+	baked->bones.resize(baked->frameCount * boneCount * BONE_STRIDE);
+	baked->slotColors.resize(baked->frameCount * colorCount * COLOR_STRIDE);
+	baked->slotAttachments.resize(baked->frameCount * attachmentCount);
+
+	for (frame = 0; frame < baked->frameCount; ++frame) {
+		float time = frame / sampleRate;
+		if (time > animation->duration) time = animation->duration;
+
+		spSkeleton_setToSetupPose(sampler);
+		spAnimation_apply(animation, sampler, time, time, 0, 0, 0);
+
+		float* bones = baked->bones.empty() ? 0 : &baked->bones[frame * boneCount * BONE_STRIDE];
+		for (i = 0; i < boneCount; ++i, bones += BONE_STRIDE) {
+			const spBone* bone = sampler->bones[baked->boneIndices[i]];
+			bones[0] = bone->x;
+			bones[1] = bone->y;
+			bones[2] = bone->rotation;
+			bones[3] = bone->scaleX;
+			bones[4] = bone->scaleY;
+		}
+
+		float* colors = baked->slotColors.empty() ? 0 : &baked->slotColors[frame * colorCount * COLOR_STRIDE];
+		for (i = 0; i < colorCount; ++i, colors += COLOR_STRIDE) {
+			const spSlot* slot = sampler->slots[baked->colorSlotIndices[i]];
+			colors[0] = slot->r;
+			colors[1] = slot->g;
+			colors[2] = slot->b;
+			colors[3] = slot->a;
+		}
+
+		/* Attachments are recorded by name, the sampler has no skin to resolve them against. */
+		if (!attachmentCount) continue;
+		const char** attachments = &baked->slotAttachments[frame * attachmentCount];
+		for (i = 0; i < attachmentCount; ++i)
+			attachments[i] = sampler->slots[baked->attachmentSlotIndices[i]]->data->attachmentName;
+		for (i = 0; i < animation->timelineCount; ++i) {
+			if (animation->timelines[i]->type != TIMELINE_ATTACHMENT) continue;
+			const spAttachmentTimeline* timeline = (const spAttachmentTimeline*)animation->timelines[i];
+			if (time < timeline->frames[0]) continue;
+			int frameIndex = timeline->framesLength - 1;
+			while (timeline->frames[frameIndex] > time)
+				--frameIndex;
+			int index = (int)(std::find(baked->attachmentSlotIndices.begin(), baked->attachmentSlotIndices.end(),
+					timeline->slotIndex) - baked->attachmentSlotIndices.begin());
+			attachments[index] = timeline->attachmentNames[frameIndex];
+		}
+	}
+
+	/* Samples before a first key hold the setup pose, which apply() never writes. Give them the value at the first key
+	 * so the interpolation into it starts from there. */
+	for (i = 0; i < boneCount; ++i) {
+		for (int key = 0; key < 3; ++key) {
+			float start = baked->boneKeyStarts[i * 3 + key];
+			if (!(baked->boneKeys[i] & (1 << key)) || start <= 0) continue;
+			spSkeleton_setToSetupPose(sampler);
+			spAnimation_apply(animation, sampler, start, start, 0, 0, 0);
+			const spBone* bone = sampler->bones[baked->boneIndices[i]];
+			for (frame = 0; frame < baked->frameCount && frame / sampleRate < start; ++frame) {
+				float* bones = &baked->bones[(frame * boneCount + i) * BONE_STRIDE];
+				if (key == 0) {
+					bones[0] = bone->x;
+					bones[1] = bone->y;
+				} else if (key == 1) {
+					bones[2] = bone->rotation;
+				} else {
+					bones[3] = bone->scaleX;
+					bones[4] = bone->scaleY;
+				}
+			}
+		}
+	}
+	for (i = 0; i < colorCount; ++i) {
+		float start = baked->colorKeyStarts[i];
+		if (start <= 0) continue;
+		spSkeleton_setToSetupPose(sampler);
+		spAnimation_apply(animation, sampler, start, start, 0, 0, 0);
+		const spSlot* slot = sampler->slots[baked->colorSlotIndices[i]];
+		for (frame = 0; frame < baked->frameCount && frame / sampleRate < start; ++frame) {
+			float* colors = &baked->slotColors[(frame * colorCount + i) * COLOR_STRIDE];
+			colors[0] = slot->r;
+			colors[1] = slot->g;
+			colors[2] = slot->b;
+			colors[3] = slot->a;
+		}
+	}
+	return baked;
+}
+
+void SkeletonAnimationCache::apply (const BakedAnimation* baked, spSkeleton* skeleton, float time) const {
+	int i;
+	const int boneCount = (int)baked->boneIndices.size();
+	const int colorCount = (int)baked->colorSlotIndices.size();
+	const int attachmentCount = (int)baked->attachmentSlotIndices.size();
+	CCAssert(skeleton->data == skeletonData, "Skeleton does not use the cached skeleton data.");
+
+	/* Samples are 1 / sampleRate apart, except the last one which is at the end of the animation. */
+	int frame = (int)(time * sampleRate);
+	if (frame < 0) frame = 0;
+	int nextFrame = frame + 1;
+	float alpha = 0;
+	if (nextFrame >= baked->frameCount) {
+		frame = nextFrame = baked->frameCount - 1;
+	} else {
+		float frameTime = frame / sampleRate;
+		float nextFrameTime = nextFrame / sampleRate;
+		if (nextFrameTime > baked->animation->duration) nextFrameTime = baked->animation->duration;
+		if (nextFrameTime > frameTime) alpha = (time - frameTime) / (nextFrameTime - frameTime);
+		if (alpha < 0) alpha = 0;
+		if (alpha > 1) alpha = 1;
+	}
+
+	if (boneCount) {
+		const float* bones = &baked->bones[frame * boneCount * BONE_STRIDE];
+		const float* nextBones = &baked->bones[nextFrame * boneCount * BONE_STRIDE];
+		for (i = 0; i < boneCount; ++i, bones += BONE_STRIDE, nextBones += BONE_STRIDE) {
+			spBone* bone = skeleton->bones[baked->boneIndices[i]];
+			int keys = baked->boneKeys[i];
+			const float* starts = &baked->boneKeyStarts[i * 3];
+			/* Before its first key a timeline leaves the bone alone. */
+			if (time < starts[0]) keys &= ~BakedAnimation::KEYED_TRANSLATE;
+			if (time < starts[1]) keys &= ~BakedAnimation::KEYED_ROTATE;
+			if (time < starts[2]) keys &= ~BakedAnimation::KEYED_SCALE;
+			if (keys & BakedAnimation::KEYED_TRANSLATE) {
+				bone->x = bones[0] + (nextBones[0] - bones[0]) * alpha;
+				bone->y = bones[1] + (nextBones[1] - bones[1]) * alpha;
+			}
+			if (keys & BakedAnimation::KEYED_ROTATE) {
+				float amount = nextBones[2] - bones[2];
+				while (amount > 180)
+					amount -= 360;
+				while (amount < -180)
+					amount += 360;
+				bone->rotation = bones[2] + amount * alpha;
+			}
+			if (keys & BakedAnimation::KEYED_SCALE) {
+				bone->scaleX = bones[3] + (nextBones[3] - bones[3]) * alpha;
+				bone->scaleY = bones[4] + (nextBones[4] - bones[4]) * alpha;
+			}
+		}
+	}
+
+	if (colorCount) {
+		const float* colors = &baked->slotColors[frame * colorCount * COLOR_STRIDE];
+		const float* nextColors = &baked->slotColors[nextFrame * colorCount * COLOR_STRIDE];
+		for (i = 0; i < colorCount; ++i, colors += COLOR_STRIDE, nextColors += COLOR_STRIDE) {
+			if (time < baked->colorKeyStarts[i]) continue;
+			spSlot* slot = skeleton->slots[baked->colorSlotIndices[i]];
+			slot->r = colors[0] + (nextColors[0] - colors[0]) * alpha;
+			slot->g = colors[1] + (nextColors[1] - colors[1]) * alpha;
+			slot->b = colors[2] + (nextColors[2] - colors[2]) * alpha;
+			slot->a = colors[3] + (nextColors[3] - colors[3]) * alpha;
+		}
+	}
+
+	if (attachmentCount) {
+		const char* const* attachments = &baked->slotAttachments[frame * attachmentCount];
+		for (i = 0; i < attachmentCount; ++i) {
+			if (time < baked->attachmentKeyStarts[i]) continue;
+			int slotIndex = baked->attachmentSlotIndices[i];
+			spSlot* slot = skeleton->slots[slotIndex];
+
+			/* Attachments are stepped, like AttachmentTimeline. Only switch when the name changes so the attachment
+			 * time of region sequences keeps running. */
+			const char* attachmentName = attachments[i];
+			if (!attachmentName) {
+				if (slot->attachment) spSlot_setAttachment(slot, 0);
+			} else if (!slot->attachment || strcmp(slot->attachment->name, attachmentName) != 0) {
+				spSlot_setAttachment(slot, spSkeleton_getAttachmentForSlotIndex(skeleton, slotIndex, attachmentName));
+			}
+		}
+	}
+}
+
+void SkeletonAnimationCache::removeAllBakedAnimations () {
+	for (auto& iter : bakedAnimations)
+		delete iter.second;
+	bakedAnimations.clear();
+}
+
+}
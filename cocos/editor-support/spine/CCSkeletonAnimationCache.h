@@ -0,0 +1,106 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef SPINE_CCSKELETONANIMATIONCACHE_H_
+#define SPINE_CCSKELETONANIMATIONCACHE_H_
+
+#include <spine/spine.h>
+#include <unordered_map>
+#include <vector>
+
+#include "base/CCRef.h"
+
+namespace spine {
+
+/** Pre-sampled values of the bones and slots one animation keys, at a fixed rate. */
+struct BakedAnimation {
+	/* Which values of a bone its timelines key. */
+	enum { KEYED_TRANSLATE = 1, KEYED_ROTATE = 2, KEYED_SCALE = 4 };
+
+	const spAnimation* animation;
+	int frameCount;
+	/* Bones with a timeline, and the values they key. */
+	std::vector<int> boneIndices;
+	std::vector<int> boneKeys;
+	/* Time of the first key of translate, rotate and scale per keyed bone. Before it the value is left alone. */
+	std::vector<float> boneKeyStarts;
+	/* x, y, rotation, scaleX, scaleY per keyed bone, per frame. */
+	std::vector<float> bones;
+	/* Slots with a color timeline. */
+	std::vector<int> colorSlotIndices;
+	/* Time of the first color key per color slot. */
+	std::vector<float> colorKeyStarts;
+	/* r, g, b, a per color slot, per frame. */
+	std::vector<float> slotColors;
+	/* Slots with an attachment timeline. */
+	std::vector<int> attachmentSlotIndices;
+	/* Time of the first attachment key per attachment slot. */
+	std::vector<float> attachmentKeyStarts;
+	/* Attachment name per attachment slot, per frame. Points into the skeleton data, 0 when the slot is empty. */
+	std::vector<const char*> slotAttachments;
+	/* The most events the event timelines can fire in one update. */
+	int maxFiredEvents;
+};
+
+/** Samples animations of one skeleton data at a fixed rate so identical skeletons can share the result.
+  * Applying a baked animation is a table lookup with linear interpolation between two samples instead of evaluating
+  * every timeline. Animations with draw order timelines are not baked and keep using the regular path.
+  * The cache must not outlive the skeleton data it was created with. */
+class SkeletonAnimationCache: public cocos2d::Ref {
+public:
+	static const int BONE_STRIDE = 5;
+	static const int COLOR_STRIDE = 4;
+
+	static SkeletonAnimationCache* create (spSkeletonData* skeletonData, float sampleRate = 30);
+
+	SkeletonAnimationCache (spSkeletonData* skeletonData, float sampleRate);
+	virtual ~SkeletonAnimationCache ();
+
+	/* Samples the animation now instead of on first use. Returns 0 if the animation was not found or cannot be baked. */
+	const BakedAnimation* bakeAnimation (const char* animationName);
+	/* Returns the baked animation, sampling it on first use. Returns 0 if it cannot be baked. */
+	const BakedAnimation* getBakedAnimation (const spAnimation* animation);
+
+	/* Poses the skeleton's bones and slots at the specified time. The time must already be wrapped or clamped to the
+	 * animation's duration. Like the timelines, only the bone values and slots the animation keys are written, and
+	 * only from their first key on. */
+	void apply (const BakedAnimation* baked, spSkeleton* skeleton, float time) const;
+
+	void removeAllBakedAnimations ();
+
+	spSkeletonData* getSkeletonData () const { return skeletonData; }
+	float getSampleRate () const { return sampleRate; }
+
+private:
+	BakedAnimation* bake (const spAnimation* animation);
+
+	spSkeletonData* skeletonData;
+	spSkeleton* sampler;
+	float sampleRate;
+	std::unordered_map<const spAnimation*, BakedAnimation*> bakedAnimations;
+};
+
+}
+
+#endif /* SPINE_CCSKELETONANIMATIONCACHE_H_ */
@@ -0,0 +1,545 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <spine/SkeletonBinary.h>
+#include <spine/extension.h>
+#include <spine/RegionAttachment.h>
+#include <spine/BoundingBoxAttachment.h>
+#include <spine/AtlasAttachmentLoader.h>
+
+/*
+ * magic "CSSB", version
+ * string table : count, then per string its length and the characters with a '\0', padded to 4 bytes
+ * bones        : count, then name, parent index or -1, length, x, y, rotation, scaleX, scaleY, inheritScale, inheritRotation
+ * slots        : count, then name, bone index, r, g, b, a, attachment name, additive
+ * skins        : count, then name, attachment count, per attachment its slot index, name in the skin, name, type
+ *                and x, y, scaleX, scaleY, rotation, width, height for regions or the vertices for bounding boxes
+ * events       : count, then name, int, float, string
+ * animations   : count, then name, timeline count, per timeline its type, bone or slot index, frame count,
+ *                the frames array of the timeline and the curves of all frames but the last one
+ *
+ * Strings are indices in the string table, NO_STRING for a null string. Values are scaled when they are read,
+ * like SkeletonJson does.
+ */
+static const char BINARY_MAGIC[4] = {'C', 'S', 'S', 'B'};
+static const unsigned int BINARY_VERSION = 1;
+static const unsigned int NO_STRING = 0xffffffff;
+
+typedef enum {
+	BINARY_TIMELINE_ROTATE,
+	BINARY_TIMELINE_TRANSLATE,
+	BINARY_TIMELINE_SCALE,
+	BINARY_TIMELINE_COLOR,
+	BINARY_TIMELINE_ATTACHMENT,
+	BINARY_TIMELINE_EVENT,
+	BINARY_TIMELINE_DRAWORDER
+} _spBinaryTimelineType;
+
+typedef enum {
+	BINARY_CURVE_LINEAR, BINARY_CURVE_STEPPED, BINARY_CURVE_BEZIER
+} _spBinaryCurveType;
+
+typedef struct {
+	spSkeletonBinary super;
+	int ownsLoader;
+} _spSkeletonBinary;
+
+/* Reading past the end or a bad index makes the input invalid, the following reads return 0. */
+typedef struct {
+	const unsigned char* cursor;
+	const unsigned char* end;
+	const char** strings;
+	int stringCount;
+	int valid;
+} _spBinaryInput;
+
+spSkeletonBinary* spSkeletonBinary_createWithLoader (spAttachmentLoader* attachmentLoader) {
+	spSkeletonBinary* self = SUPER(NEW(_spSkeletonBinary));
+	self->scale = 1;
+	self->attachmentLoader = attachmentLoader;
+	return self;
+}
+
+spSkeletonBinary* spSkeletonBinary_create (spAtlas* atlas) {
+	spAtlasAttachmentLoader* attachmentLoader = spAtlasAttachmentLoader_create(atlas);
+	spSkeletonBinary* self = spSkeletonBinary_createWithLoader(SUPER(attachmentLoader));
+	SUB_CAST(_spSkeletonBinary, self)->ownsLoader = 1;
+	return self;
+}
+
+void spSkeletonBinary_dispose (spSkeletonBinary* self) {
+	if (SUB_CAST(_spSkeletonBinary, self)->ownsLoader) spAttachmentLoader_dispose(self->attachmentLoader);
+	FREE(self->error);
+	FREE(self);
+}
+
+static void _spSkeletonBinary_setError (spSkeletonBinary* self, const char* value1, const char* value2) {
+	char message[256];
+	size_t length = 0;
+	FREE(self->error);
+	strcpy(message, value1);
+	length = strlen(value1);
+	if (value2) strncat(message + length, value2, 255 - length);
+	MALLOC_STR(self->error, message);
+}
+
+static unsigned int _readU32 (_spBinaryInput* input) {
+	const unsigned char* bytes = input->cursor;
+	if (!input->valid || input->end - bytes < 4) {
+		input->valid = 0;
+		return 0;
+	}
+	input->cursor += 4;
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+static int _readInt (_spBinaryInput* input) {
+	return (int)_readU32(input);
+}
+
+static float _readFloat (_spBinaryInput* input) {
+	unsigned int bits = _readU32(input);
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+/* Reads an array of floats, on little endian hosts it is copied as it is. */
+static void _readFloats (_spBinaryInput* input, float* values, int count) {
+	static const unsigned int one = 1;
+	int i;
+	if (!input->valid || (input->end - input->cursor) / 4 < count) {
+		input->valid = 0;
+		return;
+	}
+	if (*(const unsigned char*)&one == 1) {
+		memcpy(values, input->cursor, count * sizeof(float));
+		input->cursor += count * sizeof(float);
+	} else {
+		for (i = 0; i < count; ++i)
+			values[i] = _readFloat(input);
+	}
+}
+
+/* Reads the number of items that follow, each taking at least minItemSize bytes. A count the rest of the input
+ * can't hold makes the input invalid, so corrupted files don't allocate huge arrays. */
+static int _readCount (_spBinaryInput* input, int minItemSize) {
+	unsigned int count = _readU32(input);
+	if (input->valid && count > (unsigned int)((input->end - input->cursor) / minItemSize)) input->valid = 0;
+	return input->valid ? (int)count : 0;
+}
+
+/* Reads an index in [0, count), or in [-1, count) when allowNone is set. */
+static int _readIndex (_spBinaryInput* input, int count, int allowNone) {
+	int index = _readInt(input);
+	if (index < (allowNone ? -1 : 0) || index >= count) {
+		input->valid = 0;
+		return allowNone ? -1 : 0;
+	}
+	return index;
+}
+
+/* Returns 0 for NO_STRING. */
+static const char* _readString (_spBinaryInput* input) {
+	unsigned int index = _readU32(input);
+	if (!input->valid || index == NO_STRING) return 0;
+	if (index >= (unsigned int)input->stringCount) {
+		input->valid = 0;
+		return 0;
+	}
+	return input->strings[index];
+}
+
+/* A string that can't be null. */
+static const char* _readName (_spBinaryInput* input) {
+	const char* name = _readString(input);
+	if (!name) {
+		input->valid = 0;
+		return "";
+	}
+	return name;
+}
+
+static int _readHeader (_spBinaryInput* input) {
+	int i, count;
+	if (input->end - input->cursor < (int)sizeof(BINARY_MAGIC) || memcmp(input->cursor, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0)
+		return 0;
+	input->cursor += sizeof(BINARY_MAGIC);
+	if (_readU32(input) != BINARY_VERSION) return 0;
+
+	/* A length and at least 4 bytes of characters. */
+	count = _readCount(input, 8);
+	if (!input->valid) return 0;
+	input->strings = MALLOC(const char*, count);
+	for (i = 0; i < count; ++i) {
+		unsigned int length = _readU32(input);
+		size_t padded = ((size_t)length + 1 + 3) & ~(size_t)3;
+		if (!input->valid || (size_t)(input->end - input->cursor) < padded || input->cursor[length] != '\0') {
+			input->valid = 0;
+			return 0;
+		}
+		input->strings[i] = (const char*)input->cursor;
+		input->cursor += padded;
+		++input->stringCount;
+	}
+	return 1;
+}
+
+static void _readCurves (_spBinaryInput* input, spCurveTimeline* timeline, int frameCount) {
+	int i;
+	for (i = 0; i < frameCount - 1 && input->valid; ++i) {
+		switch (_readU32(input)) {
+		case BINARY_CURVE_LINEAR:
+			break;
+		case BINARY_CURVE_STEPPED:
+			spCurveTimeline_setStepped(timeline, i);
+			break;
+		case BINARY_CURVE_BEZIER: {
+			float cx1 = _readFloat(input);
+			float cy1 = _readFloat(input);
+			float cx2 = _readFloat(input);
+			float cy2 = _readFloat(input);
+			if (input->valid) spCurveTimeline_setCurve(timeline, i, cx1, cy1, cx2, cy2);
+			break;
+		}
+		default:
+			input->valid = 0;
+		}
+	}
+}
+
+static spTimeline* _readTimeline (spSkeletonBinary* self, _spBinaryInput* input, spSkeletonData* skeletonData, float* duration) {
+	int i;
+	int type = _readInt(input);
+	int index = _readInt(input);
+	int frameCount = _readCount(input, 4);
+	if (!input->valid || frameCount == 0) {
+		input->valid = 0;
+		return 0;
+	}
+
+	switch (type) {
+	case BINARY_TIMELINE_ROTATE:
+	case BINARY_TIMELINE_TRANSLATE:
+	case BINARY_TIMELINE_SCALE: {
+		struct spBaseTimeline* timeline;
+		int frameSize = type == BINARY_TIMELINE_ROTATE ? 2 : 3;
+		if (index < 0 || index >= skeletonData->boneCount) break;
+		if (type == BINARY_TIMELINE_ROTATE)
+			timeline = spRotateTimeline_create(frameCount);
+		else if (type == BINARY_TIMELINE_TRANSLATE)
+			timeline = spTranslateTimeline_create(frameCount);
+		else
+			timeline = spScaleTimeline_create(frameCount);
+		timeline->boneIndex = index;
+		_readFloats(input, timeline->frames, timeline->framesLength);
+		if (type == BINARY_TIMELINE_TRANSLATE && self->scale != 1) {
+			for (i = 0; i < timeline->framesLength; i += 3) {
+				timeline->frames[i + 1] *= self->scale;
+				timeline->frames[i + 2] *= self->scale;
+			}
+		}
+		_readCurves(input, SUPER(timeline), frameCount);
+		*duration = timeline->frames[timeline->framesLength - frameSize];
+		return (spTimeline*)timeline;
+	}
+	case BINARY_TIMELINE_COLOR: {
+		spColorTimeline* timeline;
+		if (index < 0 || index >= skeletonData->slotCount) break;
+		timeline = spColorTimeline_create(frameCount);
+		timeline->slotIndex = index;
+		_readFloats(input, timeline->frames, timeline->framesLength);
+		_readCurves(input, SUPER(timeline), frameCount);
+		*duration = timeline->frames[timeline->framesLength - 5];
+		return (spTimeline*)timeline;
+	}
+	case BINARY_TIMELINE_ATTACHMENT: {
+		spAttachmentTimeline* timeline;
+		if (index < 0 || index >= skeletonData->slotCount) break;
+		timeline = spAttachmentTimeline_create(frameCount);
+		timeline->slotIndex = index;
+		_readFloats(input, timeline->frames, frameCount);
+		for (i = 0; i < frameCount && input->valid; ++i)
+			spAttachmentTimeline_setFrame(timeline, i, timeline->frames[i], _readString(input));
+		*duration = timeline->frames[frameCount - 1];
+		return (spTimeline*)timeline;
+	}
+	case BINARY_TIMELINE_EVENT: {
+		spEventTimeline* timeline = spEventTimeline_create(frameCount);
+		_readFloats(input, timeline->frames, frameCount);
+		for (i = 0; i < frameCount && input->valid; ++i) {
+			spEvent* event;
+			const char* stringValue;
+			int eventIndex = _readIndex(input, skeletonData->eventCount, 0);
+			int intValue = _readInt(input);
+			float floatValue = _readFloat(input);
+			stringValue = _readString(input);
+			if (!input->valid) {
+				/* only the events read so far are disposed with the timeline */
+				CONST_CAST(int, timeline->framesLength) = i;
+				break;
+			}
+			event = spEvent_create(skeletonData->events[eventIndex]);
+			event->intValue = intValue;
+			event->floatValue = floatValue;
+			if (stringValue) MALLOC_STR(event->stringValue, stringValue);
+			spEventTimeline_setFrame(timeline, i, timeline->frames[i], event);
+		}
+		*duration = timeline->frames[frameCount - 1];
+		return (spTimeline*)timeline;
+	}
+	case BINARY_TIMELINE_DRAWORDER: {
+		spDrawOrderTimeline* timeline = spDrawOrderTimeline_create(frameCount, skeletonData->slotCount);
+		int* drawOrder = MALLOC(int, skeletonData->slotCount);
+		_readFloats(input, timeline->frames, frameCount);
+		for (i = 0; i < frameCount && input->valid; ++i) {
+			int ii;
+			/* 0 keeps the setup pose order */
+			if (!_readU32(input)) continue;
+			for (ii = 0; ii < skeletonData->slotCount; ++ii)
+				drawOrder[ii] = _readIndex(input, skeletonData->slotCount, 0);
+			if (input->valid) spDrawOrderTimeline_setFrame(timeline, i, timeline->frames[i], drawOrder);
+		}
+		FREE(drawOrder);
+		*duration = timeline->frames[frameCount - 1];
+		return (spTimeline*)timeline;
+	}
+	}
+
+	input->valid = 0;
+	return 0;
+}
+
+static spAnimation* _readAnimation (spSkeletonBinary* self, _spBinaryInput* input, spSkeletonData* skeletonData) {
+	int i;
+	spAnimation* animation;
+	const char* name = _readName(input);
+	/* type, index and frame count */
+	int timelineCount = _readCount(input, 12);
+	if (!input->valid) return 0;
+
+	animation = spAnimation_create(name, timelineCount);
+	animation->timelineCount = 0;
+	for (i = 0; i < timelineCount; ++i) {
+		float duration = 0;
+		spTimeline* timeline = _readTimeline(self, input, skeletonData, &duration);
+		if (!timeline) break;
+		animation->timelines[animation->timelineCount++] = timeline;
+		if (!input->valid) break;
+		if (duration > animation->duration) animation->duration = duration;
+	}
+
+	if (!input->valid) {
+		spAnimation_dispose(animation);
+		return 0;
+	}
+	return animation;
+}
+
+static int _readSkins (spSkeletonBinary* self, _spBinaryInput* input, spSkeletonData* skeletonData) {
+	int i, ii, count = _readCount(input, 8);
+	skeletonData->skins = MALLOC(spSkin*, count);
+	for (i = 0; i < count && input->valid; ++i) {
+		spSkin* skin = spSkin_create(_readName(input));
+		int attachmentCount = _readCount(input, 16);
+		skeletonData->skins[skeletonData->skinCount++] = skin;
+		if (strcmp(skin->name, "default") == 0) skeletonData->defaultSkin = skin;
+
+		for (ii = 0; ii < attachmentCount && input->valid; ++ii) {
+			spAttachment* attachment;
+			float values[7];
+			float* vertices = 0;
+			int verticesCount = 0;
+			int slotIndex = _readIndex(input, skeletonData->slotCount, 0);
+			const char* skinAttachmentName = _readName(input);
+			const char* attachmentName = _readName(input);
+			spAttachmentType type = (spAttachmentType)_readInt(input);
+
+			/* read everything first, the loader can skip the attachment */
+			if (type == ATTACHMENT_BOUNDING_BOX) {
+				verticesCount = _readCount(input, 4);
+				if (!input->valid) break;
+				vertices = MALLOC(float, verticesCount);
+				_readFloats(input, vertices, verticesCount);
+			} else if (type == ATTACHMENT_REGION || type == ATTACHMENT_REGION_SEQUENCE) {
+				_readFloats(input, values, 7);
+			} else {
+				input->valid = 0;
+			}
+			if (!input->valid) {
+				FREE(vertices);
+				break;
+			}
+
+			attachment = spAttachmentLoader_newAttachment(self->attachmentLoader, skin, type, attachmentName);
+			if (!attachment) {
+				FREE(vertices);
+				if (self->attachmentLoader->error1) {
+					_spSkeletonBinary_setError(self, self->attachmentLoader->error1, self->attachmentLoader->error2);
+					return 0;
+				}
+				continue;
+			}
+
+			switch (attachment->type) {
+			case ATTACHMENT_REGION:
+			case ATTACHMENT_REGION_SEQUENCE: {
+				spRegionAttachment* regionAttachment = (spRegionAttachment*)attachment;
+				regionAttachment->x = values[0] * self->scale;
+				regionAttachment->y = values[1] * self->scale;
+				regionAttachment->scaleX = values[2];
+				regionAttachment->scaleY = values[3];
+				regionAttachment->rotation = values[4];
+				regionAttachment->width = values[5] * self->scale;
+				regionAttachment->height = values[6] * self->scale;
+				spRegionAttachment_updateOffset(regionAttachment);
+				FREE(vertices);
+				break;
+			}
+			case ATTACHMENT_BOUNDING_BOX: {
+				spBoundingBoxAttachment* box = (spBoundingBoxAttachment*)attachment;
+				int j;
+				for (j = 0; j < verticesCount; ++j)
+					vertices[j] *= self->scale;
+				box->verticesCount = verticesCount;
+				box->vertices = vertices;
+				break;
+			}
+			}
+
+			spSkin_addAttachment(skin, slotIndex, skinAttachmentName, attachment);
+		}
+	}
+	return 1;
+}
+
+spSkeletonData* spSkeletonBinary_readSkeletonDataFile (spSkeletonBinary* self, const char* path) {
+	int length;
+	spSkeletonData* skeletonData;
+	const char* binary = _spUtil_readFile(path, &length);
+	if (!binary) {
+		_spSkeletonBinary_setError(self, "Unable to read skeleton file: ", path);
+		return 0;
+	}
+	skeletonData = spSkeletonBinary_readSkeletonData(self, (const unsigned char*)binary, length);
+	FREE(binary);
+	return skeletonData;
+}
+
+spSkeletonData* spSkeletonBinary_readSkeletonData (spSkeletonBinary* self, const unsigned char* binary, int length) {
+	int i, count;
+	spSkeletonData* skeletonData;
+	_spBinaryInput input;
+
+	FREE(self->error);
+	CONST_CAST(char*, self->error) = 0;
+
+	memset(&input, 0, sizeof(input));
+	input.cursor = binary;
+	input.end = binary + length;
+	input.valid = binary != 0;
+	if (!_readHeader(&input)) {
+		FREE(input.strings);
+		_spSkeletonBinary_setError(self, "Invalid skeleton binary", 0);
+		return 0;
+	}
+
+	skeletonData = spSkeletonData_create();
+
+	/* Bones, a parent is always before its children. */
+	count = _readCount(&input, 40);
+	skeletonData->bones = MALLOC(spBoneData*, count);
+	for (i = 0; i < count && input.valid; ++i) {
+		spBoneData* boneData;
+		const char* name = _readName(&input);
+		int parentIndex = _readIndex(&input, i, 1);
+		if (!input.valid) break;
+
+		boneData = spBoneData_create(name, parentIndex == -1 ? 0 : skeletonData->bones[parentIndex]);
+		boneData->length = _readFloat(&input) * self->scale;
+		boneData->x = _readFloat(&input) * self->scale;
+		boneData->y = _readFloat(&input) * self->scale;
+		boneData->rotation = _readFloat(&input);
+		boneData->scaleX = _readFloat(&input);
+		boneData->scaleY = _readFloat(&input);
+		boneData->inheritScale = _readInt(&input);
+		boneData->inheritRotation = _readInt(&input);
+
+		skeletonData->bones[i] = boneData;
+		++skeletonData->boneCount;
+	}
+
+	count = _readCount(&input, 32);
+	skeletonData->slots = MALLOC(spSlotData*, count);
+	for (i = 0; i < count && input.valid; ++i) {
+		spSlotData* slotData;
+		const char* name = _readName(&input);
+		int boneIndex = _readIndex(&input, skeletonData->boneCount, 0);
+		if (!input.valid) break;
+
+		slotData = spSlotData_create(name, skeletonData->bones[boneIndex]);
+		slotData->r = _readFloat(&input);
+		slotData->g = _readFloat(&input);
+		slotData->b = _readFloat(&input);
+		slotData->a = _readFloat(&input);
+		spSlotData_setAttachmentName(slotData, _readString(&input));
+		slotData->additiveBlending = _readInt(&input);
+
+		skeletonData->slots[i] = slotData;
+		++skeletonData->slotCount;
+	}
+
+	if (input.valid && !_readSkins(self, &input, skeletonData)) {
+		FREE(input.strings);
+		spSkeletonData_dispose(skeletonData);
+		return 0;
+	}
+
+	count = _readCount(&input, 16);
+	skeletonData->events = MALLOC(spEventData*, count);
+	for (i = 0; i < count && input.valid; ++i) {
+		const char* stringValue;
+		spEventData* eventData = spEventData_create(_readName(&input));
+		eventData->intValue = _readInt(&input);
+		eventData->floatValue = _readFloat(&input);
+		stringValue = _readString(&input);
+		if (stringValue) MALLOC_STR(eventData->stringValue, stringValue);
+		skeletonData->events[skeletonData->eventCount++] = eventData;
+	}
+
+	count = _readCount(&input, 8);
+	skeletonData->animations = MALLOC(spAnimation*, count);
+	for (i = 0; i < count && input.valid; ++i) {
+		spAnimation* animation = _readAnimation(self, &input, skeletonData);
+		if (animation) skeletonData->animations[skeletonData->animationCount++] = animation;
+	}
+
+	FREE(input.strings);
+	if (!input.valid) {
+		spSkeletonData_dispose(skeletonData);
+		_spSkeletonBinary_setError(self, "Skeleton binary is truncated or corrupted", 0);
+		return 0;
+	}
+	return skeletonData;
+}
@@ -38,6 +38,7 @@
 #include "cocos2d.h"
 #include <spine/CCSkeleton.h>
 #include <spine/CCSkeletonAnimation.h>
+#include <spine/CCSkeletonAnimationCache.h>
 
 void spRegionAttachment_updateQuad (spRegionAttachment* self, spSlot* slot, cocos2d::V3F_C4B_T2F_Quad* quad, bool premultiplied = false);
 
@@ -35,6 +35,7 @@
 #include "base/CCVector.h"
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
+#include "base/CCProfiling.h"
 
 #include "curl/curl.h"
 
@@ -108,6 +109,10 @@ void HttpClient::networkThread()
     HttpRequest *request = nullptr;
     
     auto scheduler = Director::getInstance()->getScheduler();
+
+#if CC_ENABLE_FRAME_PROFILER
+    FrameProfiler::getInstance()->setThreadName("HttpClient network");
+#endif
     
     while (true) 
     {
@@ -140,6 +145,7 @@ void HttpClient::networkThread()
         }
         
         // step 2: libcurl sync access
+        CC_PROFILE_SCOPE("HttpClient::processRequest", "network");
         
         // Create a HttpResponse object, the default setting is http access failed
         HttpResponse *response = new HttpResponse(request);
@@ -483,6 +489,7 @@ void HttpClient::send(HttpRequest* request)
 void HttpClient::dispatchResponseCallbacks()
 {
     // log("CCHttpClient::dispatchResponseCallbacks is running");
+    CC_PROFILE_SCOPE("HttpClient::dispatchResponseCallbacks", "network");
     //occurs when cocos thread fires but the network thread has already quited
     if (nullptr == s_responseQueue) {
         return;
@@ -47,6 +47,7 @@
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventCustom.h"
+#include "base/CCProfiling.h"
 
 #include <algorithm>
 
@@ -878,6 +879,8 @@ void PhysicsWorld::setGravity(const Vect& gravity)
 
 void PhysicsWorld::update(float delta)
 {
+    CC_PROFILE_SCOPE("PhysicsWorld::update", "physics");
+
     if (_delayDirty)
     {
         // the updateJoints must run before the updateBodies.
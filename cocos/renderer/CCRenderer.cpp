@@ -37,6 +37,7 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
+#include "base/CCProfiling.h"
 
 NS_CC_BEGIN
 
@@ -327,6 +328,8 @@ void Renderer::visitRenderQueue(const RenderQueue& queue)
 
 void Renderer::render()
 {
+    CC_PROFILE_SCOPE("Renderer::render", "renderer");
+
     //Uncomment this once everything is rendered by new renderer
     //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -7,6 +7,7 @@ enum
     kTagNode,
     kTagGrossini,
     kTagSequence,
+    kTagFade,
 }; 
 
 Layer* nextActionManagerAction();
@@ -15,7 +16,7 @@ Layer* restartActionManagerAction();
 
 static int sceneIdx = -1; 
 
-#define MAX_LAYER    5
+#define MAX_LAYER    6
 
 Layer* createActionManagerLayer(int nIndex)
 {
@@ -26,6 +27,7 @@ Layer* createActionManagerLayer(int nIndex)
         case 2: return new PauseTest();
         case 3: return new StopActionTest();
         case 4: return new ResumeTest();
+        case 5: return new BatchedTweenTest();
     }
 
     return NULL;
@@ -307,6 +309,87 @@ void ResumeTest::resumeGrossini(float time)
     director->getActionManager()->resumeTarget(pGrossini);
 }
 
+//------------------------------------------------------------------
+//
+// BatchedTweenTest
+//
+//------------------------------------------------------------------
+std::string BatchedTweenTest::subtitle() const
+{
+    return "Batched tweens, run in the order they were added";
+}
+
+void BatchedTweenTest::onEnter()
+{
+    ActionManagerTest::onEnter();
+
+    // batched actions are stepped in the order they were added, with the other actions of their target:
+    // the scale set last wins, whether it comes from the batch or from the action wrapped in Speed
+    for (int batchedFirst = 0; batchedFirst < 2; ++batchedFirst)
+    {
+        auto manager = new ActionManager();
+        auto node = Node::create();
+        auto batched = ScaleTo::create(1, 2.0f);
+        auto stepped = Speed::create(ScaleTo::create(1, 1.0f), 1);
+        manager->addAction(batchedFirst ? (Action*)batched : stepped, node, false);
+        manager->addAction(batchedFirst ? (Action*)stepped : batched, node, false);
+
+        manager->update(0);
+        manager->update(0.5f);
+        CCASSERT(node->getScaleX() == (batchedFirst ? 1.0f : 1.5f), "the batched action wasn't stepped in the order it was added");
+        manager->release();
+    }
+
+    auto l = Label::createWithTTF("Both grossinis move, scale and rotate the same way\nonly the left one stops fading after 1 second", "fonts/Thonburi.ttf", 16.0f);
+    addChild(l);
+    l->setPosition( Vector2(VisibleRect::center().x, VisibleRect::top().y - 75));
+
+    // the left grossini runs plain actions, which the action manager tweens in a batch.
+    // The right one runs them wrapped in Speed, so they are stepped one by one.
+    for (int i = 0; i < 2; ++i)
+    {
+        auto grossini = Sprite::create(s_pathGrossini);
+        grossini->setPosition(Vector2(VisibleRect::center().x - 100 + i * 200, VisibleRect::center().y - 50));
+
+        ActionInterval* actions[] = {
+            MoveBy::create(3, Vector2(50, 100)),
+            ScaleTo::create(3, 0.5f, 1.5f),
+            RotateTo::create(3, 270),
+            FadeTo::create(3, 0)
+        };
+        actions[3]->setTag(kTagFade);
+        for (auto action : actions)
+        {
+            grossini->runAction(i == 0 ? (Action*)action : Speed::create(action, 1));
+        }
+
+        if (i == 0)
+        {
+            addChild(grossini, 0, kTagGrossini);
+            CCASSERT(grossini->getNumberOfRunningActions() == 4 && grossini->getActionByTag(kTagFade) == actions[3],
+                     "the batched actions can't be queried");
+        }
+        else
+        {
+            addChild(grossini);
+        }
+    }
+
+    this->schedule(schedule_selector(BatchedTweenTest::stopFade), 1.0f);
+}
+
+void BatchedTweenTest::stopFade(float time)
+{
+    this->unschedule(schedule_selector(BatchedTweenTest::stopFade));
+
+    auto grossini = getChildByTag(kTagGrossini);
+    auto fade = static_cast<ActionInterval*>(grossini->getActionByTag(kTagFade));
+    CCASSERT(fade && fade->getElapsed() > 0, "the elapsed time of a batched action wasn't updated");
+    CC_UNUSED_PARAM(fade);
+    grossini->stopActionByTag(kTagFade);
+    CCASSERT(grossini->getNumberOfRunningActions() == 3, "the batched action wasn't removed");
+}
+
 //------------------------------------------------------------------
 //
 // ActionManagerTestScene
@@ -62,6 +62,14 @@ public:
     void resumeGrossini(float time);
 };
 
+class BatchedTweenTest : public ActionManagerTest
+{
+public:
+    virtual std::string subtitle() const override;
+    virtual void onEnter() override;
+    void stopFade(float time);
+};
+
 class ActionManagerTestScene : public TestScene
 {
 public:
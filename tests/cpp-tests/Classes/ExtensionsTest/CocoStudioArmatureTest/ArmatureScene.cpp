@@ -75,6 +75,9 @@ Layer *CreateLayer(int index)
     case TEST_CHANGE_ANIMATION_INTERNAL:
         pLayer = new TestChangeAnimationInternal();
         break;
+    case TEST_GPU_SKINNING:
+        pLayer = new TestGPUSkinning();
+        break;
     default:
         break;
     }
@@ -1487,3 +1490,40 @@ void TestChangeAnimationInternal::onTouchesEnded(const std::vector<Touch*>& touc
         Director::getInstance()->setAnimationInterval(1/30.0f);
     }
 }
+
+void TestGPUSkinning::onEnter()
+{
+    ArmatureTestLayer::onEnter();
+
+    auto listener = EventListenerTouchAllAtOnce::create();
+    listener->onTouchesEnded = CC_CALLBACK_2(TestGPUSkinning::onTouchesEnded, this);
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, this);
+
+    // the left armature draws its skins as quads, the right one is skinned in the vertex shader
+    for (int i = 0; i < 2; ++i)
+    {
+        Armature *cowboy = Armature::create("Cowboy");
+        cowboy->getAnimation()->playWithIndex(0);
+        cowboy->setScale(0.2f);
+        cowboy->setPosition(Vector2(VisibleRect::center().x - 120 + i * 240, VisibleRect::center().y));
+        addChild(cowboy);
+
+        if (i == 1)
+        {
+            armature = cowboy;
+            armature->setGPUSkinningEnabled(true);
+        }
+    }
+}
+std::string TestGPUSkinning::title() const
+{
+    return "Test GPU skinning";
+}
+std::string TestGPUSkinning::subtitle() const
+{
+    return "Both cowboys should look the same\nTouch to toggle GPU skinning of the right one";
+}
+void TestGPUSkinning::onTouchesEnded(const std::vector<Touch*>& touches, Event* event)
+{
+    armature->setGPUSkinningEnabled(!armature->isGPUSkinningEnabled());
+}
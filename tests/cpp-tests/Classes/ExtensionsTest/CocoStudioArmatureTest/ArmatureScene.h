@@ -45,6 +45,7 @@ enum {
     TEST_PLAY_SEVERAL_MOVEMENT,
     TEST_EASING,
     TEST_CHANGE_ANIMATION_INTERNAL,
+    TEST_GPU_SKINNING,
 
 	TEST_LAYER_COUNT
 };
@@ -393,4 +394,16 @@ public:
     void onTouchesEnded(const std::vector<Touch*>& touches, Event* event);
 };
 
+class TestGPUSkinning : public ArmatureTestLayer
+{
+public:
+    virtual void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    void onTouchesEnded(const std::vector<Touch*>& touches, Event* event);
+
+    cocostudio::Armature *armature;
+};
+
 #endif  // __HELLOWORLD_SCENE_H__
@@ -39,6 +39,8 @@ static std::function<PerformceAllocScene*()> createFunctions[] =
     CL(SpriteCreateEmptyTest),
     CL(SpriteCreateTest),
     CL(SpriteDeallocTest),
+    CL(SpritePoolTest),
+    CL(SlabNodeCreateTest),
 };
 
 #define MAX_LAYER    (sizeof(createFunctions) / sizeof(createFunctions[0]))
@@ -470,6 +472,123 @@ const char*  SpriteDeallocTest::testName()
     return "Sprite::~Sprite()";
 }
 
+////////////////////////////////////////////////////////
+//
+// SpritePoolTest
+//
+////////////////////////////////////////////////////////
+SpritePoolTest::SpritePoolTest()
+: _pool([]() { return Sprite::create("Images/grossini.png"); }, kMaxNodes)
+{
+}
+
+void SpritePoolTest::updateQuantityOfNodes()
+{
+    currentQuantityOfNodes = quantityOfNodes;
+}
+
+void SpritePoolTest::initWithQuantityOfNodes(unsigned int nNodes)
+{
+    PerformceAllocScene::initWithQuantityOfNodes(nNodes);
+
+    printf("Size of Sprite: %lu\n", sizeof(Sprite));
+
+    scheduleUpdate();
+}
+
+void SpritePoolTest::update(float dt)
+{
+    // iterate using fast enumeration protocol
+
+    Sprite **sprites = new Sprite*[quantityOfNodes];
+
+    // only the first frame creates sprites
+    _pool.reserve(quantityOfNodes);
+
+    CC_PROFILER_START(this->profilerName());
+    for( int i=0; i<quantityOfNodes; ++i)
+        sprites[i] = _pool.obtain();
+    for( int i=0; i<quantityOfNodes; ++i)
+        _pool.recycle(sprites[i]);
+    CC_PROFILER_STOP(this->profilerName());
+
+    delete [] sprites;
+}
+
+std::string SpritePoolTest::title() const
+{
+    return "Sprite Pool Perf test.";
+}
+
+std::string SpritePoolTest::subtitle() const
+{
+    return "Obtain and recycle pooled sprites. Compare with Create Sprite. See console";
+}
+
+const char*  SpritePoolTest::testName()
+{
+    return "NodePool<Sprite>::obtain()+recycle()";
+}
+
+////////////////////////////////////////////////////////
+//
+// SlabNodeCreateTest
+//
+////////////////////////////////////////////////////////
+class SlabNode : public Node
+{
+    CC_NODE_SLAB_ALLOCATED(SlabNode);
+public:
+    CREATE_FUNC(SlabNode);
+};
+
+void SlabNodeCreateTest::updateQuantityOfNodes()
+{
+    currentQuantityOfNodes = quantityOfNodes;
+}
+
+void SlabNodeCreateTest::initWithQuantityOfNodes(unsigned int nNodes)
+{
+    PerformceAllocScene::initWithQuantityOfNodes(nNodes);
+
+    printf("Size of Node: %lu\n", sizeof(SlabNode));
+
+    scheduleUpdate();
+}
+
+void SlabNodeCreateTest::update(float dt)
+{
+    // iterate using fast enumeration protocol
+
+    Node **nodes = new Node*[quantityOfNodes];
+
+    CC_PROFILER_START(this->profilerName());
+    for( int i=0; i<quantityOfNodes; ++i) {
+        nodes[i] = SlabNode::create();
+        nodes[i]->retain();
+    }
+    for( int i=0; i<quantityOfNodes; ++i)
+        nodes[i]->release();
+    CC_PROFILER_STOP(this->profilerName());
+
+    delete [] nodes;
+}
+
+std::string SlabNodeCreateTest::title() const
+{
+    return "Slab Node Create Perf test.";
+}
+
+std::string SlabNodeCreateTest::subtitle() const
+{
+    return "Create and delete slab allocated nodes. See console";
+}
+
+const char*  SlabNodeCreateTest::testName()
+{
+    return "SlabNode::create()+~SlabNode()";
+}
+
 ///----------------------------------------
 void runAllocPerformanceTest()
 {
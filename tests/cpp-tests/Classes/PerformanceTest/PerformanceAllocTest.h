@@ -116,6 +116,39 @@ public:
 };
 
 
+class SpritePoolTest : public PerformceAllocScene
+{
+public:
+    CREATE_FUNC(SpritePoolTest);
+
+    SpritePoolTest();
+
+    virtual void updateQuantityOfNodes();
+    virtual void initWithQuantityOfNodes(unsigned int nNodes);
+    virtual void update(float dt);
+    virtual const char* testName();
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+protected:
+    NodePool<Sprite> _pool;
+};
+
+class SlabNodeCreateTest : public PerformceAllocScene
+{
+public:
+    CREATE_FUNC(SlabNodeCreateTest);
+
+    virtual void updateQuantityOfNodes();
+    virtual void initWithQuantityOfNodes(unsigned int nNodes);
+    virtual void update(float dt);
+    virtual const char* testName();
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
 void runAllocPerformanceTest();
 
 #endif // __PERFORMANCE_ALLOC_TEST_H__
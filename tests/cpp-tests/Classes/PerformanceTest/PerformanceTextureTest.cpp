@@ -2,7 +2,7 @@
 
 enum
 {
-    TEST_COUNT = 1,
+    TEST_COUNT = 2,
 };
 
 static int s_nTexCurCase = 0;
@@ -32,6 +32,9 @@ void TextureMenuLayer::showCurrentTest()
     case 0:
         scene = TextureTest::scene();
         break;
+    case 1:
+        scene = TextureConvertTest::scene();
+        break;
     }
     s_nTexCurCase = _curCase;
 
@@ -348,7 +351,74 @@ std::string TextureTest::subtitle() const
 Scene* TextureTest::scene()
 {
     auto scene = Scene::create();
-    TextureTest *layer = new TextureTest(false, TEST_COUNT, s_nTexCurCase);
+    TextureTest *layer = new TextureTest(true, TEST_COUNT, s_nTexCurCase);
+    scene->addChild(layer);
+    layer->release();
+
+    return scene;
+}
+
+////////////////////////////////////////////////////////
+//
+// TextureConvertTest
+//
+////////////////////////////////////////////////////////
+void TextureConvertTest::performTestsFormat(Image* image, const char* name, Texture2D::PixelFormat format)
+{
+    struct timeval now;
+    auto texture = new Texture2D();
+
+    log("%s", name);
+    gettimeofday(&now, NULL);
+    if( texture->initWithImage(image, format) )
+        log("  ms:%f", calculateDeltaTime(&now) * 1000);
+    else
+        log(" ERROR");
+
+    texture->release();
+}
+
+void TextureConvertTest::performTests()
+{
+    // a 2048x2048 RGBA8888 image, converted from on the CPU to each format before the upload
+    const int size = 2048;
+    ssize_t dataLen = size * size * 4;
+    unsigned char* data = (unsigned char*)malloc(dataLen);
+    for (ssize_t i = 0; i < dataLen; ++i)
+    {
+        data[i] = (unsigned char)(i * 7 + (i >> 12));
+    }
+
+    auto image = new Image();
+    image->initWithRawData(data, dataLen, size, size, 8, false);
+    free(data);
+
+    log("--------");
+    log("--- RGBA8888 2048x2048 ---");
+    performTestsFormat(image, "RGBA 8888 (no conversion)", Texture2D::PixelFormat::RGBA8888);
+    performTestsFormat(image, "RGBA 4444", Texture2D::PixelFormat::RGBA4444);
+    performTestsFormat(image, "RGBA 5551", Texture2D::PixelFormat::RGB5A1);
+    performTestsFormat(image, "RGB 565", Texture2D::PixelFormat::RGB565);
+    performTestsFormat(image, "RGB 888", Texture2D::PixelFormat::RGB888);
+    performTestsFormat(image, "A 8", Texture2D::PixelFormat::A8);
+
+    image->release();
+}
+
+std::string TextureConvertTest::title() const
+{
+    return "Texture Convert Test";
+}
+
+std::string TextureConvertTest::subtitle() const
+{
+    return "2048x2048 RGBA8888 to other formats. See console for results";
+}
+
+Scene* TextureConvertTest::scene()
+{
+    auto scene = Scene::create();
+    TextureConvertTest *layer = new TextureConvertTest(true, TEST_COUNT, s_nTexCurCase);
     scene->addChild(layer);
     layer->release();
 
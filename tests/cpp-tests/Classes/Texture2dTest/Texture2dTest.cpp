@@ -107,6 +107,8 @@ static std::function<Layer*()> createFunctions[] =
     CL(TextureConvertRGBA8888),
     CL(TextureConvertI8),
     CL(TextureConvertAI88),
+    CL(TextureMipmapStreaming),
+    CL(TextureEvictionReload),
 };
 
 static unsigned int TEST_CASE_COUNT = sizeof(createFunctions) / sizeof(createFunctions[0]);
@@ -2358,3 +2360,133 @@ std::string TextureConvertAI88::subtitle() const
 {
     return "RGBA8888,RGB888,RGB565,A8,I8,AI88,RGBA4444,RGB5A1";
 }
+
+// TextureMipmapStreaming
+
+void TextureMipmapStreaming::onEnter()
+{
+    TextureDemo::onEnter();
+    auto s = Director::getInstance()->getWinSize();
+
+    // load it again, progressively
+    auto textureCache = Director::getInstance()->getTextureCache();
+    textureCache->removeTextureForKey("Images/test_image_rgba4444_mipmap.pvr");
+    textureCache->setProgressiveMipmapLoading(true);
+
+    _sprite = Sprite::create("Images/test_image_rgba4444_mipmap.pvr");
+    _sprite->setPosition(Vector2(s.width/2, s.height/2));
+    _sprite->setScale(0.1f);
+    addChild(_sprite);
+
+    // small for a while, so the decoded levels are released, then drawn at full size
+    _sprite->runAction(Sequence::create(DelayTime::create(4), ScaleTo::create(2, 1.0f), NULL));
+
+    _label = Label::createWithSystemFont("", "", 20);
+    _label->setPosition(Vector2(s.width/2, s.height/4));
+    addChild(_label);
+    schedule(schedule_selector(TextureMipmapStreaming::updateLevel));
+}
+
+void TextureMipmapStreaming::onExit()
+{
+    auto textureCache = Director::getInstance()->getTextureCache();
+    textureCache->setProgressiveMipmapLoading(false);
+    TextureDemo::onExit();
+}
+
+void TextureMipmapStreaming::updateLevel(float dt)
+{
+    _label->setString(StringUtils::format("scale: %.2f, base mipmap level: %d", _sprite->getScale(), _sprite->getTexture()->getBaseMipLevel()));
+}
+
+std::string TextureMipmapStreaming::title() const
+{
+    return "Mipmap streaming";
+}
+
+std::string TextureMipmapStreaming::subtitle() const
+{
+    return "The base level should go to 0 once the image is drawn at full size";
+}
+
+// TextureEvictionReload
+
+static const Texture2D::TexParams s_evictionTexParams = { GL_LINEAR_MIPMAP_LINEAR, GL_NEAREST, GL_REPEAT, GL_REPEAT };
+
+TextureEvictionReload::TextureEvictionReload()
+: _texture(nullptr)
+, _label(nullptr)
+{
+}
+
+TextureEvictionReload::~TextureEvictionReload()
+{
+    CC_SAFE_RELEASE(_texture);
+}
+
+void TextureEvictionReload::onEnter()
+{
+    TextureDemo::onEnter();
+    auto s = Director::getInstance()->getWinSize();
+
+    auto textureCache = Director::getInstance()->getTextureCache();
+    textureCache->removeTextureForKey("Images/pattern1.png");
+    _texture = textureCache->addImage("Images/pattern1.png");
+    _texture->retain();
+
+    // mipmaps, a filter that needs them, another mag filter and repeat, nothing the texture is created with
+    _texture->generateMipmap();
+    _texture->setTexParameters(s_evictionTexParams);
+
+    _label = Label::createWithSystemFont("evicting the texture", "", 20);
+    _label->setPosition(Vector2(s.width/2, s.height/4));
+    addChild(_label);
+
+    // textures drawn in the last frame aren't evicted
+    scheduleOnce(schedule_selector(TextureEvictionReload::evict), 0.2f);
+}
+
+void TextureEvictionReload::evict(float dt)
+{
+    auto textureCache = Director::getInstance()->getTextureCache();
+    textureCache->evictTextures(0);
+    CCASSERT(_texture->isEvicted(), "the texture wasn't evicted");
+    log("%s", textureCache->getResidencyInfo().c_str());
+
+    // drawing it reloads it
+    auto s = Director::getInstance()->getWinSize();
+    auto sprite = Sprite::createWithTexture(_texture, Rect(0, 0, 512, 512));
+    sprite->setPosition(Vector2(s.width/2, s.height/2));
+    sprite->setScale(0.4f);
+    addChild(sprite);
+
+    scheduleOnce(schedule_selector(TextureEvictionReload::checkReload), 0.2f);
+}
+
+void TextureEvictionReload::checkReload(float dt)
+{
+    CCASSERT(!_texture->isEvicted(), "the texture wasn't reloaded");
+    CCASSERT(_texture->hasMipmaps(), "the mipmaps weren't generated again");
+
+    GLint minFilter = 0, magFilter = 0, wrapS = 0, wrapT = 0;
+    GL::bindTexture2D(_texture->getName());
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &minFilter);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, &magFilter);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, &wrapS);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, &wrapT);
+    CCASSERT(minFilter == (GLint)s_evictionTexParams.minFilter && magFilter == (GLint)s_evictionTexParams.magFilter, "the filters weren't restored");
+    CCASSERT(wrapS == (GLint)s_evictionTexParams.wrapS && wrapT == (GLint)s_evictionTexParams.wrapT, "the wrap modes weren't restored");
+
+    _label->setString("reloaded with its filters and wrap modes");
+    log("%s", Director::getInstance()->getTextureCache()->getResidencyInfo().c_str());
+}
+
+std::string TextureEvictionReload::title() const
+{
+    return "Texture eviction";
+}
+
+std::string TextureEvictionReload::subtitle() const
+{
+    return "A repeated pattern with mipmaps, it should look the same after it's reloaded";
+}
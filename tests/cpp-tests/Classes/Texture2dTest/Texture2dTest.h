@@ -650,4 +650,36 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class TextureMipmapStreaming : public TextureDemo
+{
+public:
+    CREATE_FUNC(TextureMipmapStreaming);
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    void updateLevel(float dt);
+
+private:
+    Sprite* _sprite;
+    Label* _label;
+};
+
+class TextureEvictionReload : public TextureDemo
+{
+public:
+    CREATE_FUNC(TextureEvictionReload);
+    TextureEvictionReload();
+    virtual ~TextureEvictionReload();
+    virtual void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    void evict(float dt);
+    void checkReload(float dt);
+
+private:
+    Texture2D* _texture;
+    Label* _label;
+};
+
 #endif // __TEXTURE2D_TEST_H__
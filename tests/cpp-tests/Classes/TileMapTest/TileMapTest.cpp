@@ -25,7 +25,7 @@ enum
 
 static int sceneIdx = -1;
 
-#define MAX_LAYER    29
+#define MAX_LAYER    31
 
 static std::function<Layer*()> createFunctions[] = {
     CLN(TMXIsoZorder),
@@ -57,6 +57,8 @@ static std::function<Layer*()> createFunctions[] = {
     CLN(TMXBug987),
     CLN(TMXBug787),
     CLN(TMXGIDObjectsTest),
+    CLN(TMXIsoTileSpritesTest),
+    CLN(TMXReleaseMapTest),
 
 };
 
@@ -1573,3 +1575,90 @@ std::string TMXGIDObjectsTest::subtitle() const
 {
     return "Tiles are created from an object group";
 }
+
+//------------------------------------------------------------------
+//
+// TMXIsoTileSpritesTest
+//
+//------------------------------------------------------------------
+TMXIsoTileSpritesTest::TMXIsoTileSpritesTest()
+{
+    auto map = TMXTiledMap::create("TileMaps/iso-test-zorder.tmx");
+    addChild(map, 0, kTagTileMap);
+
+    auto s = map->getContentSize();
+    map->setPosition(Vector2(-s.width/2,0));
+
+    // every other tree becomes a Sprite, it has to stay behind the trees in front of it
+    auto layer = map->getLayer("trees2");
+    auto ls = layer->getLayerSize();
+    int count = 0;
+    for (int y = 0; y < (int)ls.height; y++)
+    {
+        for (int x = 0; x < (int)ls.width; x++)
+        {
+            if (layer->getTileGIDAt(Vector2(x, y)) == 0 || count++ % 2)
+            {
+                continue;
+            }
+
+            auto tile = layer->getTileAt(Vector2(x, y));
+            auto scale = ScaleBy::create(1, 1.3f);
+            auto tint = TintTo::create(1, 255, 128, 128);
+            auto untint = TintTo::create(1, 255, 255, 255);
+            tile->runAction(RepeatForever::create(Sequence::create(Spawn::create(scale, tint, NULL), Spawn::create(scale->reverse(), untint, NULL), NULL)));
+        }
+    }
+
+    // the other ones change and move the trees between the chunk quads
+    layer->removeTileAt(Vector2(0, 0));
+    layer->setTileGID(layer->getTileGIDAt(Vector2(1, 0)), Vector2(0, 0));
+
+    map->runAction(RepeatForever::create(Sequence::create(MoveBy::create(5, Vector2(200, 100)), MoveBy::create(5, Vector2(-200, -100)), NULL)));
+}
+
+std::string TMXIsoTileSpritesTest::title() const
+{
+    return "TMX Iso tile sprites";
+}
+
+std::string TMXIsoTileSpritesTest::subtitle() const
+{
+    return "Pulsing trees should hide behind the trees in front of them";
+}
+
+//------------------------------------------------------------------
+//
+// TMXReleaseMapTest
+//
+//------------------------------------------------------------------
+TMXReleaseMapTest::TMXReleaseMapTest()
+{
+    auto color = LayerColor::create( Color4B(64,64,64,255) );
+    addChild(color, -1);
+
+    auto map = TMXTiledMap::create("TileMaps/iso-test2.tmx");
+    addChild(map, 0, kTagTileMap);
+
+    // the chunks out of view aren't built yet, they are built from a copy of their GIDs when they show up
+    for (const auto& child : map->getChildren())
+    {
+        static_cast<TMXLayer*>(child)->releaseMap();
+    }
+
+    auto ms = map->getMapSize();
+    auto ts = map->getTileSize();
+    auto across = MoveTo::create(4.0f, Vector2( -ms.width * ts.width + VisibleRect::getVisibleRect().size.width, -ms.height * ts.height/2 ));
+    auto back = MoveTo::create(4.0f, Vector2::ZERO);
+    map->runAction(RepeatForever::create(Sequence::create(across, back, NULL)));
+}
+
+std::string TMXReleaseMapTest::title() const
+{
+    return "TMX releaseMap";
+}
+
+std::string TMXReleaseMapTest::subtitle() const
+{
+    return "The map is released before it's drawn, no tile should be missing";
+}
@@ -286,6 +286,22 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class TMXIsoTileSpritesTest : public TileDemo
+{
+public:
+    TMXIsoTileSpritesTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
+class TMXReleaseMapTest : public TileDemo
+{
+public:
+    TMXReleaseMapTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
 class TMXGIDObjectsTest : public TileDemo
 {
 public:
@@ -1,5 +1,10 @@
 #include "UnitTest.h"
 #include "RefPtrTest.h"
+#include <spine/spine-cocos2dx.h>
+#include "cocostudio/CocoStudio.h"
+
+#include <atomic>
+#include <thread>
 
 // For ' < o > ' multiply test scene.
 
@@ -8,6 +13,13 @@ static std::function<Layer*()> createFunctions[] = {
     CL(TemplateMapTest),
     CL(ValueTest),
     CL(RefPtrTest),
+    CL(JobSystemTest),
+    CL(FunctionQueueTest),
+    CL(FrameArenaTest),
+    CL(NodePoolTest),
+    CL(DynamicAtlasTest),
+    CL(SpineAnimationCacheTest),
+    CL(ArmatureBinaryTest),
     CL(UTFConversionTest)
 };
 
@@ -816,3 +828,747 @@ std::string UTFConversionTest::subtitle() const
 {
     return "UTF8 <-> UTF16 Conversion Test, no crash";
 }
+
+// JobSystemTest
+
+void JobSystemTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    // dependencies: a job starts after all of its dependencies finished
+    {
+        JobSystem jobs;
+        jobs.setWorkerCount(4);
+
+        std::atomic<int> counter(0);
+        std::vector<JobSystem::JobPtr> dependencies;
+        for (int i = 0; i < 100; ++i)
+        {
+            dependencies.push_back(jobs.addJob([&counter]() { ++counter; }));
+        }
+        dependencies.push_back(nullptr);
+
+        int countSeen = -1;
+        auto job = jobs.addJob([&]() { countSeen = counter.load(); }, dependencies);
+        jobs.wait(job);
+        CCASSERT(job->isFinished(), "wait() returned before the job finished");
+        CCASSERT(countSeen == 100, "a job started before its dependencies finished");
+
+        // a dependency that already finished doesn't hold the job back
+        auto after = jobs.addJob([]() {}, { job });
+        jobs.wait(after);
+        CCASSERT(after->isFinished(), "a finished dependency held the job back");
+    }
+
+    // parallelFor: every item is visited once, from the calling thread and from a job
+    {
+        JobSystem jobs;
+        jobs.setWorkerCount(4);
+
+        std::vector<int> visits(100000, 0);
+        jobs.parallelFor(0, (int)visits.size(), 1000, [&visits](int first, int last) {
+            for (int i = first; i < last; ++i)
+            {
+                ++visits[i];
+            }
+        });
+        CCASSERT(std::count(visits.begin(), visits.end(), 1) == (int)visits.size(), "parallelFor visited an item twice or not at all");
+
+        std::atomic<long long> sum(0);
+        auto job = jobs.addJob([&]() {
+            jobs.parallelFor(0, 10000, 100, [&sum](int first, int last) {
+                long long rangeSum = 0;
+                for (int i = first; i < last; ++i)
+                {
+                    rangeSum += i;
+                }
+                sum += rangeSum;
+            });
+        });
+        jobs.wait(job);
+        CCASSERT(sum == 49995000LL, "parallelFor in a job returned a wrong sum");
+
+        // fewer items than minRange run on the calling thread
+        auto callerId = std::this_thread::get_id();
+        bool onCaller = false;
+        jobs.parallelFor(0, 10, 100, [&](int first, int last) { onCaller = (std::this_thread::get_id() == callerId) && first == 0 && last == 10; });
+        CCASSERT(onCaller, "a small parallelFor wasn't run on the calling thread");
+    }
+
+    // shutdown: the jobs that were added are run before the JobSystem is destroyed
+    {
+        std::atomic<int> counter(0);
+        {
+            JobSystem jobs;
+            jobs.setWorkerCount(2);
+            for (int i = 0; i < 1000; ++i)
+            {
+                jobs.addJob([&counter]() { ++counter; });
+            }
+        }
+        CCASSERT(counter == 1000, "jobs were dropped when the JobSystem was destroyed");
+    }
+
+    // continuations are called on the cocos thread, after the job finished
+    auto label = Label::createWithSystemFont("waiting for the continuation", "", 20);
+    label->setPosition(VisibleRect::center());
+    addChild(label);
+
+    auto cocosThreadId = std::this_thread::get_id();
+    auto finished = std::make_shared<std::atomic<bool>>(false);
+    retain();
+    Director::getInstance()->getJobSystem()->addJob([finished]() {
+        *finished = true;
+    }, std::vector<JobSystem::JobPtr>(), [this, label, finished, cocosThreadId]() {
+        CCASSERT(std::this_thread::get_id() == cocosThreadId, "the continuation wasn't called on the cocos thread");
+        CCASSERT(*finished, "the continuation was called before the job finished");
+        label->setString("continuation called on the cocos thread");
+        release();
+    });
+}
+
+std::string JobSystemTest::subtitle() const
+{
+    return "JobSystem dependencies, parallelFor, shutdown and continuations, should not crash";
+}
+
+// FunctionQueueTest
+
+void FunctionQueueTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    // several producers: the functions of each thread run in the order it pushed them,
+    // across the ring and the overflow list, while perform() stops on its time budget
+    {
+        static const int producerCount = 4;
+        static const int pushCount = 20000;
+        // too large to be stored in a slot, these functions are allocated
+        struct Large
+        {
+            char padding[FunctionQueue::INLINE_STORAGE_SIZE];
+        };
+
+        FunctionQueue queue(64);
+        std::vector<int> lastIndex(producerCount, -1);
+        int outOfOrder = 0;
+        // only called by the thread calling perform()
+        auto check = [&lastIndex, &outOfOrder](int producer, int index) {
+            if (lastIndex[producer] != index - 1)
+            {
+                ++outOfOrder;
+            }
+            lastIndex[producer] = index;
+        };
+
+        std::atomic<int> running(producerCount);
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < producerCount; ++producer)
+        {
+            producers.push_back(std::thread([&queue, &check, &running, producer]() {
+                for (int index = 0; index < pushCount; ++index)
+                {
+                    if (index % 2)
+                    {
+                        queue.push([&check, producer, index]() { check(producer, index); });
+                    }
+                    else
+                    {
+                        Large large;
+                        large.padding[0] = 0;
+                        queue.push([&check, producer, index, large]() { check(producer, index + large.padding[0]); });
+                    }
+                }
+                --running;
+            }));
+        }
+
+        // the ring is full before the first function is called
+        while (queue.getOverflowCount() == 0 && running > 0)
+        {
+            std::this_thread::yield();
+        }
+
+        ssize_t performed = 0;
+        while (running > 0 || queue.getDepth() > 0)
+        {
+            performed += queue.perform(0.0005f);
+        }
+        for (auto& thread : producers)
+        {
+            thread.join();
+        }
+
+        CCASSERT(queue.getOverflowCount() > 0, "the ring never overflowed");
+        CCASSERT(performed == producerCount * pushCount, "a function was lost or called twice");
+        CCASSERT(outOfOrder == 0, "the functions of a thread weren't called in the order it pushed them");
+        CCASSERT(std::count(lastIndex.begin(), lastIndex.end(), pushCount - 1) == producerCount, "the last functions weren't called");
+        CC_UNUSED_PARAM(performed);
+        CC_UNUSED_PARAM(outOfOrder);
+    }
+
+    // time budget: the functions left are called by the next perform(), the ones in the
+    // overflow list stay in front of those pushed meanwhile
+    {
+        FunctionQueue queue(8);
+        std::vector<int> order;
+        for (int index = 0; index < 32; ++index)
+        {
+            queue.push([&order, index]() {
+                order.push_back(index);
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            });
+        }
+        CCASSERT(queue.getOverflowCount() == 24, "the functions beyond the ring capacity weren't kept in the overflow list");
+
+        ssize_t performed = queue.perform(0.005f);
+        CCASSERT(performed > 0 && performed < 32, "perform() didn't stop on its time budget");
+        CCASSERT(queue.getDepth() == 32 - performed, "the functions left weren't kept");
+        CC_UNUSED_PARAM(performed);
+
+        queue.push([&order]() { order.push_back(32); });
+        while (queue.getDepth() > 0)
+        {
+            queue.perform(0.005f);
+            CCASSERT(queue.getLastPerformedCount() > 0, "perform() called no function");
+        }
+
+        bool inOrder = order.size() == 33;
+        for (int index = 0; inOrder && index < 33; ++index)
+        {
+            inOrder = order[index] == index;
+        }
+        CCASSERT(inOrder, "the functions left by a time budget weren't called in order");
+        CC_UNUSED_PARAM(inOrder);
+    }
+}
+
+std::string FunctionQueueTest::subtitle() const
+{
+    return "FunctionQueue order with several threads and a time budget, should not crash";
+}
+
+// FrameArenaTest
+
+void FrameArenaTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    auto arena = FrameArena::getInstance();
+    const ssize_t allocationCount = arena->getAllocationCount();
+    const ssize_t objectCount = arena->getObjectCount();
+
+    // instant actions are allocated from the arena, and give their memory back when they are deleted
+    {
+        static const int actionCount = 1000;
+        std::vector<Action*> actions;
+        for (int i = 0; i < actionCount; ++i)
+        {
+            Action* action = nullptr;
+            switch (i % 3)
+            {
+                case 0: action = CallFunc::create([](){}); break;
+                case 1: action = Show::create(); break;
+                default: action = RemoveSelf::create(); break;
+            }
+            action->retain();
+            actions.push_back(action);
+        }
+        CCASSERT(arena->getAllocationCount() - allocationCount == actionCount, "the instant actions weren't allocated from the arena");
+        CCASSERT(arena->getObjectCount() - objectCount == actionCount, "the arena doesn't count the instant actions alive");
+        CCASSERT(arena->getChunkCount() > 0, "the arena has no chunk");
+
+        // the pool still holds them once
+        for (auto action : actions)
+        {
+            action->release();
+        }
+        CCASSERT(arena->getObjectCount() - objectCount == actionCount, "an autoreleased action was deleted");
+    }
+
+    // interval actions use operator new
+    {
+        auto move = MoveBy::create(1, Vector2(10, 10));
+        CC_UNUSED_PARAM(move);
+        CCASSERT(arena->getAllocationCount() - allocationCount == 1000, "an interval action was allocated from the arena");
+    }
+
+    // actions created in another thread get their memory from operator new, and can be deleted there
+    {
+        // CallFunc can only be created by create(), which autoreleases it
+        struct ThreadAction : public CallFunc
+        {
+        };
+
+        const ssize_t fallbackCount = arena->getFallbackCount();
+        std::thread thread([]() {
+            auto action = new ThreadAction();
+            action->release();
+        });
+        thread.join();
+        CCASSERT(arena->getFallbackCount() - fallbackCount == 1, "an action created in another thread wasn't allocated with operator new");
+        CCASSERT(arena->getAllocationCount() - allocationCount == 1000, "an action created in another thread was allocated from the arena");
+        CC_UNUSED_PARAM(fallbackCount);
+    }
+
+    CC_UNUSED_PARAM(allocationCount);
+    CC_UNUSED_PARAM(objectCount);
+}
+
+std::string FrameArenaTest::subtitle() const
+{
+    return "Instant actions are allocated from FrameArena, should not crash";
+}
+
+// NodePoolTest
+
+void NodePoolTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    static const std::string eventName = "NodePoolTest";
+    int builtCalls = 0;
+    int addedCalls = 0;
+
+    // the listener registered by the factory stands for the ones Label, Menu or ui::Widget register for themselves
+    NodePool<Node> pool([&builtCalls]() {
+        auto node = Node::create();
+        auto listener = EventListenerCustom::create(eventName, [&builtCalls](EventCustom*) { ++builtCalls; });
+        node->getEventDispatcher()->addEventListenerWithSceneGraphPriority(listener, node);
+        return node;
+    }, 4);
+
+    auto node = pool.obtain();
+    auto listener = EventListenerCustom::create(eventName, [&addedCalls](EventCustom*) { ++addedCalls; });
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, node);
+    node->setPosition(Vector2(100, 100));
+    node->setTag(10);
+    node->runAction(RotateBy::create(1.0f, 90.0f));
+    addChild(node);
+
+    _eventDispatcher->dispatchCustomEvent(eventName);
+    CCASSERT(builtCalls == 1 && addedCalls == 1, "the listeners weren't called");
+
+    pool.recycle(node);
+    CCASSERT(pool.size() == 1, "the recycled node wasn't kept");
+    CCASSERT(node->getParent() == nullptr, "the recycled node wasn't removed from its parent");
+
+    auto reused = pool.obtain();
+    CCASSERT(reused == node, "obtain() didn't return the recycled node");
+    CCASSERT(reused->getPosition().equals(Vector2::ZERO) && reused->getTag() == Node::INVALID_TAG, "the node wasn't reset");
+    CCASSERT(reused->getNumberOfRunningActions() == 0, "the actions of the node weren't stopped");
+
+    addChild(reused);
+    _eventDispatcher->dispatchCustomEvent(eventName);
+    CCASSERT(builtCalls == 2, "the listener registered when the node was created was removed");
+    CCASSERT(addedCalls == 1, "the listener added after the node was obtained was kept");
+    reused->removeFromParent();
+}
+
+std::string NodePoolTest::subtitle() const
+{
+    return "NodePool keeps the listeners nodes are built with, should not crash";
+}
+
+// DynamicAtlasTest
+
+void DynamicAtlasTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    // 62 x 62 images take 64 x 64 with their border, four of them fill a 128 x 128 page
+    static const int imageSize = 62;
+    static const Color3B colors[] = {
+        Color3B::RED, Color3B::GREEN, Color3B::BLUE, Color3B::YELLOW, Color3B::MAGENTA,
+        Color3B::ORANGE, Color3B::WHITE, Color3B::GRAY, Color3B(0, 255, 255)
+    };
+
+    auto atlas = DynamicAtlas::create(128, 128);
+    std::vector<unsigned char> data(imageSize * imageSize * 4);
+    auto addImage = [&](int index) {
+        for (size_t i = 0; i < data.size(); i += 4)
+        {
+            data[i] = colors[index].r;
+            data[i + 1] = colors[index].g;
+            data[i + 2] = colors[index].b;
+            data[i + 3] = 255;
+        }
+        auto image = new Image();
+        image->initWithRawData(data.data(), data.size(), imageSize, imageSize, 8);
+        auto frame = atlas->addImage(image, StringUtils::format("%d", index));
+        CCASSERT(frame != nullptr, "the image wasn't packed");
+        CC_UNUSED_PARAM(frame);
+#if ! CC_ENABLE_CACHE_TEXTURE_DATA
+        CCASSERT(image->getReferenceCount() == 1, "the atlas kept the image");
+#endif
+        image->release();
+    };
+
+    for (int i = 0; i < 8; ++i)
+    {
+        addImage(i);
+    }
+    CCASSERT(atlas->getPageCount() == 2 && atlas->getImageCount() == 8, "the images weren't packed in two pages");
+
+    // a page worth of space is given up, but the pages stay until the atlas is repacked
+    atlas->removeImage("1");
+    atlas->removeImage("4");
+    atlas->removeImage("5");
+    atlas->removeImage("6");
+    CCASSERT(atlas->getPageCount() == 2 && atlas->getUnusedArea() == 128 * 128, "the removed images should leave their space unused");
+
+    // the image that doesn't fit goes into a new page, the repack waits for the next frame
+    addImage(8);
+    CCASSERT(atlas->getPageCount() == 3, "the image that didn't fit wasn't put in a new page");
+
+    atlas->repack();
+    CCASSERT(atlas->getImageCount() == 5 && atlas->getUnusedArea() == 0, "the removed images still use space");
+    CCASSERT(atlas->getPageCount() == 2, "the images left weren't packed in two pages");
+
+    const char* keys[] = { "0", "2", "3", "7", "8" };
+    auto s = Director::getInstance()->getWinSize();
+    for (int i = 0; i < 5; ++i)
+    {
+        auto frame = atlas->getSpriteFrame(keys[i]);
+        CCASSERT(frame->getTexture() == atlas->getPageTexture(0) || frame->getTexture() == atlas->getPageTexture(1),
+                 "the frame doesn't point into the new pages");
+
+        // the pixels are copied from the old pages, the squares keep their colors
+        auto sprite = Sprite::createWithSpriteFrame(frame);
+        sprite->setPosition(Vector2(s.width / 2 + (i - 2) * 80, s.height / 2));
+        addChild(sprite);
+
+        auto label = Label::createWithSystemFont(keys[i], "", 16);
+        label->setPosition(Vector2(s.width / 2 + (i - 2) * 80, s.height / 2 - 50));
+        addChild(label);
+    }
+}
+
+std::string DynamicAtlasTest::subtitle() const
+{
+    return "Red, blue, yellow, gray and cyan squares after a repack, should not crash";
+}
+
+// SpineAnimationCacheTest
+
+void SpineAnimationCacheTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    spAtlas* atlas = spAtlas_readAtlasFile("spine/spineboy.atlas");
+    spSkeletonJson* json = spSkeletonJson_create(atlas);
+    spSkeletonData* skeletonData = spSkeletonJson_readSkeletonDataFile(json, "spine/spineboy.json");
+    spSkeletonJson_dispose(json);
+    CCASSERT(skeletonData != nullptr, "can't load spine/spineboy.json");
+
+    // a high rate keeps the interpolation between samples close to the curves
+    auto cache = new spine::SkeletonAnimationCache(skeletonData, 120);
+    spSkeleton* expected = spSkeleton_create(skeletonData);
+    spSkeleton* cached = spSkeleton_create(skeletonData);
+
+    int poses = 0;
+    float maxError = 0;
+    for (int index = 0; index < skeletonData->animationCount; ++index)
+    {
+        spAnimation* animation = skeletonData->animations[index];
+        const spine::BakedAnimation* baked = cache->getBakedAnimation(animation);
+        if (baked == nullptr)
+        {
+            continue;
+        }
+
+        for (float time = 0; time <= animation->duration; time += 1 / 45.0f)
+        {
+            // move every bone off the setup pose: values that aren't keyed yet must be left alone by both paths
+            spSkeleton* skeletons[] = { expected, cached };
+            for (auto skeleton : skeletons)
+            {
+                spSkeleton_setToSetupPose(skeleton);
+                for (int i = 0; i < skeleton->boneCount; ++i)
+                {
+                    skeleton->bones[i]->x += 7;
+                    skeleton->bones[i]->y -= 5;
+                    skeleton->bones[i]->rotation += 33;
+                    skeleton->bones[i]->scaleX *= 1.5f;
+                    skeleton->bones[i]->scaleY *= 0.5f;
+                }
+            }
+
+            spAnimation_apply(animation, expected, time, time, 0, nullptr, nullptr);
+            cache->apply(baked, cached, time);
+            ++poses;
+
+            for (int i = 0; i < expected->boneCount; ++i)
+            {
+                const spBone* a = expected->bones[i];
+                const spBone* b = cached->bones[i];
+                float rotation = fmodf(fabsf(a->rotation - b->rotation), 360);
+                maxError = MAX(maxError, MIN(rotation, 360 - rotation));
+                maxError = MAX(maxError, MAX(fabsf(a->x - b->x), fabsf(a->y - b->y)));
+                maxError = MAX(maxError, MAX(fabsf(a->scaleX - b->scaleX), fabsf(a->scaleY - b->scaleY)));
+            }
+            for (int i = 0; i < expected->slotCount; ++i)
+            {
+                const spSlot* a = expected->slots[i];
+                const spSlot* b = cached->slots[i];
+                maxError = MAX(maxError, MAX(MAX(fabsf(a->r - b->r), fabsf(a->g - b->g)), MAX(fabsf(a->b - b->b), fabsf(a->a - b->a))));
+                CCASSERT(a->attachment == b->attachment, "the cached pose shows another attachment");
+            }
+        }
+    }
+    CCLOG("SpineAnimationCacheTest: %d poses, largest difference %f", poses, maxError);
+    CCASSERT(poses > 0, "no animation was baked");
+    CCASSERT(maxError < 1.0f, "the cached pose differs from the animation");
+    CC_UNUSED_PARAM(poses);
+    CC_UNUSED_PARAM(maxError);
+
+    // the cache must not outlive the skeleton data
+    spSkeleton_dispose(expected);
+    spSkeleton_dispose(cached);
+    cache->release();
+    spSkeletonData_dispose(skeletonData);
+    spAtlas_dispose(atlas);
+}
+
+std::string SpineAnimationCacheTest::subtitle() const
+{
+    return "Cached spine poses match spAnimation_apply, should not crash";
+}
+
+// ArmatureBinaryTest
+
+static bool isSameFloat(float a, float b)
+{
+    return fabsf(a - b) <= 0.0001f * MAX(1.0f, fabsf(a));
+}
+
+static bool isSameBaseData(const cocostudio::BaseData *a, const cocostudio::BaseData *b)
+{
+    return isSameFloat(a->x, b->x) && isSameFloat(a->y, b->y) && a->zOrder == b->zOrder
+        && isSameFloat(a->skewX, b->skewX) && isSameFloat(a->skewY, b->skewY)
+        && isSameFloat(a->scaleX, b->scaleX) && isSameFloat(a->scaleY, b->scaleY)
+        && isSameFloat(a->tweenRotate, b->tweenRotate) && a->isUseColorInfo == b->isUseColorInfo
+        && a->a == b->a && a->r == b->r && a->g == b->g && a->b == b->b;
+}
+
+static bool isSameArmatureData(cocostudio::ArmatureData *a, cocostudio::ArmatureData *b)
+{
+    if (a->name != b->name || a->dataVersion != b->dataVersion || a->boneDataDic.size() != b->boneDataDic.size())
+    {
+        return false;
+    }
+    for (const auto& element : a->boneDataDic)
+    {
+        cocostudio::BoneData *boneA = element.second;
+        cocostudio::BoneData *boneB = b->getBoneData(element.first);
+        if (!boneB || !isSameBaseData(boneA, boneB) || boneA->parentName != boneB->parentName
+            || boneA->displayDataList.size() != boneB->displayDataList.size())
+        {
+            return false;
+        }
+        for (ssize_t i = 0; i < boneA->displayDataList.size(); i++)
+        {
+            cocostudio::DisplayData *displayA = boneA->displayDataList.at(i);
+            cocostudio::DisplayData *displayB = boneB->displayDataList.at(i);
+            if (displayA->displayType != displayB->displayType)
+            {
+                return false;
+            }
+            if (displayA->displayType == cocostudio::CS_DISPLAY_PARTICLE)
+            {
+                // the particle files are found from the directory of the config file, which differs
+                const std::string& name = displayB->displayName;
+                if (displayA->displayName.length() < name.length()
+                    || displayA->displayName.compare(displayA->displayName.length() - name.length(), name.length(), name) != 0)
+                {
+                    return false;
+                }
+            }
+            else if (displayA->displayName != displayB->displayName)
+            {
+                return false;
+            }
+            else if (displayA->displayType != cocostudio::CS_DISPLAY_ARMATURE
+                && !isSameBaseData(&static_cast<cocostudio::SpriteDisplayData *>(displayA)->skinData, &static_cast<cocostudio::SpriteDisplayData *>(displayB)->skinData))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool isSameFrameData(cocostudio::FrameData *a, cocostudio::FrameData *b)
+{
+    if (!isSameBaseData(a, b) || a->frameID != b->frameID || a->duration != b->duration
+        || a->tweenEasing != b->tweenEasing || a->isTween != b->isTween || a->displayIndex != b->displayIndex
+        || a->blendFunc.src != b->blendFunc.src || a->blendFunc.dst != b->blendFunc.dst
+        || a->strEvent != b->strEvent || a->strMovement != b->strMovement
+        || a->strSound != b->strSound || a->strSoundEffect != b->strSoundEffect)
+    {
+        return false;
+    }
+    int paramCount = a->easingParams ? a->easingParamNumber : 0;
+    if (paramCount != (b->easingParams ? b->easingParamNumber : 0))
+    {
+        return false;
+    }
+    for (int i = 0; i < paramCount; i++)
+    {
+        if (!isSameFloat(a->easingParams[i], b->easingParams[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isSameAnimationData(cocostudio::AnimationData *a, cocostudio::AnimationData *b)
+{
+    if (a->name != b->name || a->movementNames != b->movementNames)
+    {
+        return false;
+    }
+    for (const auto& movementName : a->movementNames)
+    {
+        cocostudio::MovementData *movementA = a->getMovement(movementName);
+        cocostudio::MovementData *movementB = b->getMovement(movementName);
+        if (movementA->name != movementB->name || movementA->duration != movementB->duration
+            || !isSameFloat(movementA->scale, movementB->scale) || movementA->durationTo != movementB->durationTo
+            || movementA->durationTween != movementB->durationTween || movementA->loop != movementB->loop
+            || movementA->tweenEasing != movementB->tweenEasing
+            || movementA->movBoneDataDic.size() != movementB->movBoneDataDic.size())
+        {
+            return false;
+        }
+        for (const auto& element : movementA->movBoneDataDic)
+        {
+            cocostudio::MovementBoneData *movBoneA = element.second;
+            cocostudio::MovementBoneData *movBoneB = movementB->getMovementBoneData(element.first);
+            if (!movBoneB || !isSameFloat(movBoneA->delay, movBoneB->delay) || !isSameFloat(movBoneA->scale, movBoneB->scale)
+                || !isSameFloat(movBoneA->duration, movBoneB->duration) || movBoneA->frameList.size() != movBoneB->frameList.size())
+            {
+                return false;
+            }
+            for (ssize_t i = 0; i < movBoneA->frameList.size(); i++)
+            {
+                if (!isSameFrameData(movBoneA->frameList.at(i), movBoneB->frameList.at(i)))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static bool isSameTextureData(cocostudio::TextureData *a, cocostudio::TextureData *b)
+{
+    if (a->name != b->name || !isSameFloat(a->width, b->width) || !isSameFloat(a->height, b->height)
+        || !isSameFloat(a->pivotX, b->pivotX) || !isSameFloat(a->pivotY, b->pivotY)
+        || a->contourDataList.size() != b->contourDataList.size())
+    {
+        return false;
+    }
+    for (ssize_t i = 0; i < a->contourDataList.size(); i++)
+    {
+        const auto& verticesA = a->contourDataList.at(i)->vertexList;
+        const auto& verticesB = b->contourDataList.at(i)->vertexList;
+        if (verticesA.size() != verticesB.size())
+        {
+            return false;
+        }
+        for (size_t j = 0; j < verticesA.size(); j++)
+        {
+            if (!isSameFloat(verticesA[j].x, verticesB[j].x) || !isSameFloat(verticesA[j].y, verticesB[j].y))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void ArmatureBinaryTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    using namespace cocostudio;
+
+    // the binary file is loaded by a relative name, so its sprite and particle files are found in armature/ like the original ones
+    auto fileUtils = FileUtils::getInstance();
+    const std::vector<std::string> searchPaths = fileUtils->getSearchPaths();
+    std::vector<std::string> testSearchPaths = searchPaths;
+    testSearchPaths.insert(testSearchPaths.begin(), "armature/");
+    testSearchPaths.insert(testSearchPaths.begin(), fileUtils->getWritablePath());
+    fileUtils->setSearchPaths(testSearchPaths);
+
+    const std::string binaryFile = "ArmatureBinaryTest.csab";
+    const std::string binaryPath = fileUtils->getWritablePath() + binaryFile;
+
+    // an xml file of the flash tool and a json file of CocoStudio
+    const char *configFiles[] = { "armature/Dragon.xml", "armature/testEasing.ExportJson" };
+    ArmatureDataManager *manager = ArmatureDataManager::getInstance();
+    for (const char *configFile : configFiles)
+    {
+        manager->addArmatureFileInfo(configFile);
+
+        RelativeData loaded = *manager->getRelativeData(configFile);
+        CCASSERT(!loaded.armatures.empty(), "can't load the armature file");
+        Vector<ArmatureData *> armatureDatas;
+        Vector<AnimationData *> animationDatas;
+        Vector<TextureData *> textureDatas;
+        for (const auto& name : loaded.armatures)
+        {
+            armatureDatas.pushBack(manager->getArmatureData(name));
+        }
+        for (const auto& name : loaded.animations)
+        {
+            animationDatas.pushBack(manager->getAnimationData(name));
+        }
+        for (const auto& name : loaded.textures)
+        {
+            textureDatas.pushBack(manager->getTextureData(name));
+        }
+
+        bool saved = DataReaderHelper::saveBinaryFile(configFile, binaryPath);
+        CCASSERT(saved, "can't write the binary file");
+        CC_UNUSED_PARAM(saved);
+        manager->removeArmatureFileInfo(configFile);
+
+        manager->addArmatureFileInfo(binaryFile);
+        RelativeData reloaded = *manager->getRelativeData(binaryFile);
+        bool same = reloaded.armatures == loaded.armatures && reloaded.animations == loaded.animations
+            && reloaded.textures == loaded.textures;
+        CCASSERT(same, "the binary file has other datas");
+
+        for (auto armatureData : armatureDatas)
+        {
+            same = same && isSameArmatureData(armatureData, manager->getArmatureData(armatureData->name));
+        }
+        CCASSERT(same, "the armature data changed");
+        for (auto animationData : animationDatas)
+        {
+            same = same && isSameAnimationData(animationData, manager->getAnimationData(animationData->name));
+        }
+        CCASSERT(same, "the animation data changed");
+        for (auto textureData : textureDatas)
+        {
+            same = same && isSameTextureData(textureData, manager->getTextureData(textureData->name));
+        }
+        CCASSERT(same, "the texture data changed");
+        CC_UNUSED_PARAM(same);
+        CCLOG("ArmatureBinaryTest: %s, %d armatures, %d animations, %d textures", configFile,
+            (int)armatureDatas.size(), (int)animationDatas.size(), (int)textureDatas.size());
+
+        manager->removeArmatureFileInfo(binaryFile);
+        remove(binaryPath.c_str());
+    }
+
+    fileUtils->setSearchPaths(searchPaths);
+}
+
+std::string ArmatureBinaryTest::subtitle() const
+{
+    return "Armature datas reloaded from a binary file are the same, should not crash";
+}
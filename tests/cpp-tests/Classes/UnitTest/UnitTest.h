@@ -53,6 +53,62 @@ public:
     void constFunc(const Value& value) const;
 };
 
+class JobSystemTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(JobSystemTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class FunctionQueueTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(FunctionQueueTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class FrameArenaTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(FrameArenaTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class NodePoolTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(NodePoolTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class DynamicAtlasTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(DynamicAtlasTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class SpineAnimationCacheTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(SpineAnimationCacheTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class ArmatureBinaryTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(ArmatureBinaryTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
 class UTFConversionTest : public UnitTestDemo
 {
 public:
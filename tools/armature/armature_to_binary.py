@@ -0,0 +1,770 @@
+#!/usr/bin/python
+#armature_to_binary.py
+#Converts the armature files exported by CocoStudio (.ExportJson, .json) and the Dragon Bones
+#flash tool (.xml) to the binary format loaded by DataReaderHelper::addDataFromBinaryCache,
+#the output has the same name with the .csab extension unless -o is given.
+#The datas are decoded like DataReaderHelper decodes them, with a position read scale of 1,
+#so the engine loads the same datas from the binary file as from the original one.
+
+import json
+import math
+import os.path
+import re
+import argparse
+import struct
+import xml.etree.ElementTree as ET
+from collections import OrderedDict
+
+MAGIC = b'CSAB'
+VERSION = 1
+
+#DisplayType
+CS_DISPLAY_SPRITE = 0
+CS_DISPLAY_ARMATURE = 1
+CS_DISPLAY_PARTICLE = 2
+
+#cocos2d::tweenfunc::TweenType
+TWEEN_LINEAR = 0
+TWEEN_SINE_EASE_IN_OUT = 3
+
+#BlendType of the flash tool
+BLEND_NORMAL = 0
+BLEND_MULTIPLY = 3
+BLEND_SCREEN = 5
+BLEND_ADD = 8
+
+GL_ONE = 1
+GL_ONE_MINUS_SRC_COLOR = 0x301
+GL_SRC_ALPHA = 0x302
+GL_ONE_MINUS_SRC_ALPHA = 0x303
+GL_DST_COLOR = 0x306
+
+VERSION_2_0 = 2.0
+VERSION_COMBINED = 0.3
+VERSION_CHANGE_ROTATION_RANGE = 1.0
+VERSION_COLOR_READING = 1.1
+
+class ConvertError(Exception):
+    pass
+
+#the datas are floats in the engine, round like it does so the comparisons give the same results
+def f32(value):
+    return struct.unpack('<f', struct.pack('<f', value))[0]
+
+def degreesToRadians(value):
+    return f32(value * f32(0.01745329252))
+
+class BaseData:
+    def __init__(self):
+        self.x = 0.0
+        self.y = 0.0
+        self.zOrder = 0
+        self.skewX = 0.0
+        self.skewY = 0.0
+        self.scaleX = 1.0
+        self.scaleY = 1.0
+        self.tweenRotate = 0.0
+        self.isUseColorInfo = False
+        self.a = 255
+        self.r = 255
+        self.g = 255
+        self.b = 255
+
+    def copyBase(self, other):
+        for name in ('x', 'y', 'zOrder', 'skewX', 'skewY', 'scaleX', 'scaleY', 'tweenRotate', 'isUseColorInfo', 'a', 'r', 'g', 'b'):
+            setattr(self, name, getattr(other, name))
+
+class DisplayData:
+    def __init__(self, displayType):
+        self.displayType = displayType
+        self.displayName = ''
+        self.skinData = BaseData()
+
+class BoneData(BaseData):
+    def __init__(self):
+        BaseData.__init__(self)
+        self.name = ''
+        self.parentName = ''
+        self.displays = []
+
+class ArmatureData:
+    def __init__(self):
+        self.name = ''
+        self.dataVersion = 0.1
+        self.bones = OrderedDict()
+
+class FrameData(BaseData):
+    def __init__(self):
+        BaseData.__init__(self)
+        self.frameID = 0
+        self.duration = 1
+        self.tweenEasing = TWEEN_LINEAR
+        self.easingParams = []
+        self.isTween = True
+        self.displayIndex = 0
+        self.blendSrc = GL_SRC_ALPHA
+        self.blendDst = GL_ONE_MINUS_SRC_ALPHA
+        self.strEvent = ''
+        self.strMovement = ''
+        self.strSound = ''
+        self.strSoundEffect = ''
+
+    #FrameData::copy, the frame id, the tween flag and the strings are not copied
+    def copyFrame(self, other):
+        self.copyBase(other)
+        self.duration = other.duration
+        self.displayIndex = other.displayIndex
+        self.tweenEasing = other.tweenEasing
+        self.easingParams = list(other.easingParams)
+        self.blendSrc = other.blendSrc
+        self.blendDst = other.blendDst
+
+class MovementBoneData:
+    def __init__(self):
+        self.name = ''
+        self.delay = 0.0
+        self.scale = 1.0
+        self.duration = 0.0
+        self.frames = []
+
+class MovementData:
+    def __init__(self):
+        self.name = ''
+        self.duration = 0
+        self.scale = 1.0
+        self.durationTo = 0
+        self.durationTween = 0
+        self.loop = True
+        self.tweenEasing = TWEEN_LINEAR
+        self.movBones = OrderedDict()
+
+class AnimationData:
+    def __init__(self):
+        self.name = ''
+        self.movements = OrderedDict()
+
+class TextureData:
+    def __init__(self):
+        self.name = ''
+        self.width = 0.0
+        self.height = 0.0
+        self.pivotX = 0.5
+        self.pivotY = 0.5
+        self.contours = []
+
+class ConfigData:
+    def __init__(self):
+        self.spriteFiles = []
+        self.armatures = OrderedDict()
+        self.animations = OrderedDict()
+        self.textures = OrderedDict()
+
+#Change rotation range from (-180 -- 180) to (-infinity -- infinity)
+def changeRotationRange(frames):
+    for j in range(len(frames) - 1, 0, -1):
+        difSkewX = f32(frames[j].skewX - frames[j - 1].skewX)
+        difSkewY = f32(frames[j].skewY - frames[j - 1].skewY)
+        if difSkewX < -math.pi or difSkewX > math.pi:
+            frames[j - 1].skewX = f32(frames[j - 1].skewX - 2 * math.pi if difSkewX < 0 else frames[j - 1].skewX + 2 * math.pi)
+        if difSkewY < -math.pi or difSkewY > math.pi:
+            frames[j - 1].skewY = f32(frames[j - 1].skewY - 2 * math.pi if difSkewY < 0 else frames[j - 1].skewY + 2 * math.pi)
+
+#the movement bone ends with a copy of its last frame at its duration
+def addLastFrame(movBoneData):
+    frameData = FrameData()
+    frameData.copyFrame(movBoneData.frames[-1])
+    frameData.frameID = int(movBoneData.duration)
+    movBoneData.frames.append(frameData)
+
+# -------------- TransformHelp --------------
+
+def nodeToMatrix(node):
+    if node.skewX == -node.skewY:
+        sine = math.sin(node.skewX)
+        cosine = math.cos(node.skewX)
+        matrix = [node.scaleX * cosine, node.scaleX * -sine, node.scaleY * sine, node.scaleY * cosine]
+    else:
+        matrix = [node.scaleX * math.cos(node.skewY), node.scaleX * math.sin(node.skewY),
+                  node.scaleY * math.sin(node.skewX), node.scaleY * math.cos(node.skewX)]
+    return [f32(v) for v in matrix + [node.x, node.y]]
+
+def affineInvert(t):
+    a, b, c, d, tx, ty = t
+    determinant = f32(1 / f32(a * d - b * c))
+    return [f32(v) for v in (determinant * d, -determinant * b, -determinant * c, determinant * a,
+                             determinant * f32(c * ty - d * tx), determinant * f32(b * tx - a * ty))]
+
+def affineConcat(t1, t2):
+    return [f32(v) for v in (t1[0] * t2[0] + t1[1] * t2[2], t1[0] * t2[1] + t1[1] * t2[3],
+                             t1[2] * t2[0] + t1[3] * t2[2], t1[2] * t2[1] + t1[3] * t2[3],
+                             t1[4] * t2[0] + t1[5] * t2[2] + t2[4],
+                             t1[4] * t2[1] + t1[5] * t2[3] + t2[5])]
+
+def matrixToNode(matrix, node):
+    a, b, c, d, tx, ty = matrix
+    #deltaTransformPoint of (0, 1) and (1, 0)
+    p1x = f32(f32(c + tx) - tx)
+    p1y = f32(f32(d + ty) - ty)
+    p2x = f32(f32(a + tx) - tx)
+    p2y = f32(f32(b + ty) - ty)
+    node.skewX = f32(-(f32(math.atan2(p1y, p1x)) - f32(1.5707964)))
+    node.skewY = f32(math.atan2(p2y, p2x))
+    node.scaleX = f32(math.sqrt(a * a + b * b))
+    node.scaleY = f32(math.sqrt(c * c + d * d))
+    node.x = tx
+    node.y = ty
+
+def transformFromParent(node, parentNode):
+    matrix = affineConcat(nodeToMatrix(node), affineInvert(nodeToMatrix(parentNode)))
+    matrixToNode(matrix, node)
+
+# -------------- xml --------------
+
+#the attribute queries of tinyxml2, the values are read with sscanf
+INT_PATTERN = re.compile(r'\s*[+-]?\d+')
+FLOAT_PATTERN = re.compile(r'\s*[+-]?((\d+\.?\d*|\.\d+)([eE][+-]?\d+)?|nan|inf(inity)?)', re.IGNORECASE)
+
+def queryInt(element, name):
+    value = element.get(name)
+    match = INT_PATTERN.match(value) if value is not None else None
+    return int(match.group(0)) if match else None
+
+def queryFloat(element, name):
+    value = element.get(name)
+    match = FLOAT_PATTERN.match(value) if value is not None else None
+    return f32(float(match.group(0))) if match else None
+
+def queryBool(element, name):
+    value = queryInt(element, name)
+    if value is not None:
+        return value != 0
+    value = element.get(name)
+    if value == 'true':
+        return True
+    if value == 'false':
+        return False
+    return None
+
+def queryTweenEasing(element, default):
+    easing = element.get('twE')
+    if easing is None:
+        return default
+    if easing == 'NaN':
+        return TWEEN_LINEAR
+    value = queryInt(element, 'twE')
+    if value is None:
+        return default
+    return TWEEN_SINE_EASE_IN_OUT if value == 2 else value
+
+def decodeArmatureXML(armatureXML):
+    armatureData = ArmatureData()
+    armatureData.name = armatureXML.get('name')
+    for boneXML in armatureXML.findall('b'):
+        boneData = BoneData()
+        boneData.name = boneXML.get('name')
+        if boneXML.get('parent') is not None:
+            boneData.parentName = boneXML.get('parent')
+        zOrder = queryInt(boneXML, 'z')
+        if zOrder is not None:
+            boneData.zOrder = zOrder
+        for displayXML in boneXML.findall('d'):
+            isArmature = queryInt(displayXML, 'isArmature') or 0
+            displayData = DisplayData(CS_DISPLAY_ARMATURE if isArmature else CS_DISPLAY_SPRITE)
+            if displayXML.get('name') is not None:
+                displayData.displayName = displayXML.get('name')
+            boneData.displays.append(displayData)
+        armatureData.bones[boneData.name] = boneData
+    return armatureData
+
+def decodeFrameXML(frameXML, parentFrameXML, flashToolVersion):
+    frameData = FrameData()
+    frameData.strMovement = frameXML.get('mov', '')
+    frameData.strEvent = frameXML.get('evt', '')
+    frameData.strSound = frameXML.get('sd', '')
+    frameData.strSoundEffect = frameXML.get('sdE', '')
+
+    tweenFrame = queryBool(frameXML, 'tweenFrame')
+    if tweenFrame is not None:
+        frameData.isTween = tweenFrame
+
+    xName, yName = ('cocos2d_x', 'cocos2d_y') if flashToolVersion >= VERSION_2_0 else ('x', 'y')
+    x = queryFloat(frameXML, xName)
+    if x is not None:
+        frameData.x = x
+    y = queryFloat(frameXML, yName)
+    if y is not None:
+        frameData.y = -y
+
+    for name, attribute in (('scaleX', 'cX'), ('scaleY', 'cY'), ('tweenRotate', 'twR')):
+        value = queryFloat(frameXML, attribute)
+        if value is not None:
+            setattr(frameData, name, value)
+    skewX = queryFloat(frameXML, 'kX')
+    if skewX is not None:
+        frameData.skewX = degreesToRadians(skewX)
+    skewY = queryFloat(frameXML, 'kY')
+    if skewY is not None:
+        frameData.skewY = degreesToRadians(-skewY)
+    for name, attribute in (('duration', 'dr'), ('displayIndex', 'dI'), ('zOrder', 'z')):
+        value = queryInt(frameXML, attribute)
+        if value is not None:
+            setattr(frameData, name, value)
+
+    blendType = queryInt(frameXML, 'bd')
+    if blendType is not None:
+        frameData.blendSrc, frameData.blendDst = {
+            BLEND_NORMAL: (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA),
+            BLEND_ADD: (GL_SRC_ALPHA, GL_ONE),
+            BLEND_MULTIPLY: (GL_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA),
+            BLEND_SCREEN: (GL_ONE, GL_ONE_MINUS_SRC_COLOR),
+        }.get(blendType, (GL_ONE, GL_ONE_MINUS_SRC_ALPHA))
+
+    colorTransformXML = frameXML.find('colorTransform')
+    if colorTransformXML is not None:
+        def color(name, default):
+            value = queryInt(colorTransformXML, name)
+            return default if value is None else value
+        frameData.a = int(2.55 * color('aM', 0) + color('a', 100))
+        frameData.r = int(2.55 * color('rM', 0) + color('r', 100))
+        frameData.g = int(2.55 * color('gM', 0) + color('g', 100))
+        frameData.b = int(2.55 * color('bM', 0) + color('b', 100))
+        frameData.isUseColorInfo = True
+
+    frameData.tweenEasing = queryTweenEasing(frameXML, frameData.tweenEasing)
+
+    if parentFrameXML is not None:
+        #recalculate frame data from parent frame data, use for translate matrix
+        helpNode = BaseData()
+        helpNode.x = queryFloat(parentFrameXML, xName) or 0.0
+        helpNode.y = -(queryFloat(parentFrameXML, yName) or 0.0)
+        helpNode.skewX = degreesToRadians(queryFloat(parentFrameXML, 'kX') or 0.0)
+        helpNode.skewY = degreesToRadians(-(queryFloat(parentFrameXML, 'kY') or 0.0))
+        transformFromParent(frameData, helpNode)
+    return frameData
+
+def decodeMovementBoneXML(movBoneXML, parentXML, flashToolVersion):
+    movBoneData = MovementBoneData()
+    scale = queryFloat(movBoneXML, 'sc')
+    if scale is not None:
+        movBoneData.scale = scale
+    delay = queryFloat(movBoneXML, 'dl')
+    if delay is not None:
+        movBoneData.delay = delay - 1 if delay > 0 else delay
+    movBoneData.name = movBoneXML.get('name')
+
+    parentFrames = parentXML.findall('f') if parentXML is not None else []
+    index = 0
+    parentTotalDuration = 0
+    currentDuration = 0
+    parentFrameXML = None
+    totalDuration = 0
+    for frameXML in movBoneXML.findall('f'):
+        if parentXML is not None:
+            #get the parent frame the frame starts in
+            while index < len(parentFrames) and (parentFrameXML is None or
+                    totalDuration < parentTotalDuration or totalDuration >= parentTotalDuration + currentDuration):
+                parentFrameXML = parentFrames[index]
+                parentTotalDuration += currentDuration
+                duration = queryInt(parentFrameXML, 'dr')
+                if duration is not None:
+                    currentDuration = duration
+                index += 1
+
+        frameData = decodeFrameXML(frameXML, parentFrameXML, flashToolVersion)
+        frameData.frameID = totalDuration
+        totalDuration += frameData.duration
+        movBoneData.duration = float(totalDuration)
+        movBoneData.frames.append(frameData)
+
+    if not movBoneData.frames:
+        raise ConvertError('movement bone ' + movBoneData.name + ' has no frame')
+    changeRotationRange(movBoneData.frames)
+    addLastFrame(movBoneData)
+    return movBoneData
+
+def decodeMovementXML(movementXML, armatureData, flashToolVersion):
+    movementData = MovementData()
+    movementData.name = movementXML.get('name')
+    for name, attribute in (('duration', 'dr'), ('durationTo', 'to'), ('durationTween', 'drTW')):
+        value = queryInt(movementXML, attribute)
+        if value is not None:
+            setattr(movementData, name, value)
+    loop = queryInt(movementXML, 'lp')
+    if loop is not None:
+        movementData.loop = loop != 0
+    movementData.tweenEasing = queryTweenEasing(movementXML, movementData.tweenEasing)
+
+    movBoneXMLs = movementXML.findall('b')
+    for movBoneXML in movBoneXMLs:
+        boneName = movBoneXML.get('name')
+        if boneName in movementData.movBones:
+            continue
+        boneData = armatureData.bones.get(boneName)
+        if boneData is None:
+            raise ConvertError('bone ' + str(boneName) + ' of movement ' + movementData.name + ' is not in armature ' + armatureData.name)
+
+        parentXML = None
+        if boneData.parentName:
+            parentXML = next((element for element in movBoneXMLs if element.get('name') == boneData.parentName), None)
+
+        movementData.movBones[boneName] = decodeMovementBoneXML(movBoneXML, parentXML, flashToolVersion)
+    return movementData
+
+def decodeTextureXML(textureXML, flashToolVersion):
+    textureData = TextureData()
+    if textureXML.get('name') is not None:
+        textureData.name = textureXML.get('name')
+
+    pivotNames = ('cocos2d_pX', 'cocos2d_pY') if flashToolVersion >= VERSION_2_0 else ('pX', 'pY')
+    px = queryFloat(textureXML, pivotNames[0]) or 0.0
+    py = queryFloat(textureXML, pivotNames[1]) or 0.0
+    width = queryFloat(textureXML, 'width') or 0.0
+    height = queryFloat(textureXML, 'height') or 0.0
+    if width == 0 or height == 0:
+        raise ConvertError('texture ' + textureData.name + ' has no size')
+    #the size only gives the anchor point, the xml decoder keeps the size of the texture data 0
+    textureData.pivotX = f32(px / width)
+    textureData.pivotY = f32(f32(height - py) / height)
+
+    for contourXML in textureXML.findall('con'):
+        vertices = []
+        for vertexXML in contourXML.findall('con_vt'):
+            vertices.append((queryFloat(vertexXML, 'x') or 0.0, -(queryFloat(vertexXML, 'y') or 0.0)))
+        textureData.contours.append(vertices)
+    return textureData
+
+def decodeXML(content):
+    root = ET.fromstring(content)
+    flashToolVersion = queryFloat(root, 'version') or 0.0
+    config = ConfigData()
+
+    armaturesXML = root.find('armatures')
+    for armatureXML in (armaturesXML.findall('armature') if armaturesXML is not None else []):
+        armatureData = decodeArmatureXML(armatureXML)
+        config.armatures[armatureData.name] = armatureData
+
+    animationsXML = root.find('animations')
+    for animationXML in (animationsXML.findall('animation') if animationsXML is not None else []):
+        animationData = AnimationData()
+        animationData.name = animationXML.get('name')
+        armatureData = config.armatures.get(animationData.name)
+        if armatureData is None:
+            raise ConvertError('animation ' + str(animationData.name) + ' has no armature in this file')
+        for movementXML in animationXML.findall('mov'):
+            movementData = decodeMovementXML(movementXML, armatureData, flashToolVersion)
+            animationData.movements[movementData.name] = movementData
+        config.animations[animationData.name] = animationData
+
+    texturesXML = root.find('TextureAtlas')
+    for textureXML in (texturesXML.findall('SubTexture') if texturesXML is not None else []):
+        textureData = decodeTextureXML(textureXML, flashToolVersion)
+        config.textures[textureData.name] = textureData
+    return config
+
+# -------------- json --------------
+
+#the DictionaryHelper getters, a null value is the same as a missing one
+def getValue(map, name, default):
+    value = map.get(name) if isinstance(map, dict) else None
+    return default if value is None else value
+
+def getInt(map, name, default=0):
+    return int(getValue(map, name, default))
+
+def getFloat(map, name, default=0.0):
+    return f32(float(getValue(map, name, default)))
+
+def getArray(map, name):
+    return getValue(map, name, [])
+
+def decodeNodeJSON(node, map, contentScale, cocoStudioVersion):
+    node.x = f32(getFloat(map, 'x') * contentScale)
+    node.y = f32(getFloat(map, 'y') * contentScale)
+    node.zOrder = getInt(map, 'z')
+    node.skewX = getFloat(map, 'kX')
+    node.skewY = getFloat(map, 'kY')
+    node.scaleX = getFloat(map, 'cX', 1.0)
+    node.scaleY = getFloat(map, 'cY', 1.0)
+
+    #the colors of files older than 1.1 are in an array the decoder never finds
+    if cocoStudioVersion >= VERSION_COLOR_READING and 'color' in map:
+        color = getValue(map, 'color', {})
+        node.a = getInt(color, 'a', 255)
+        node.r = getInt(color, 'r', 255)
+        node.g = getInt(color, 'g', 255)
+        node.b = getInt(color, 'b', 255)
+        node.isUseColorInfo = True
+
+def decodeDisplayJSON(map, contentScale):
+    displayType = getInt(map, 'displayType', CS_DISPLAY_SPRITE)
+    displayData = DisplayData(displayType)
+    if displayType == CS_DISPLAY_SPRITE:
+        displayData.displayName = getValue(map, 'name', '')
+        skins = getArray(map, 'skin_data')
+        if skins and skins[0] is not None:
+            skin = skins[0]
+            displayData.skinData.x = f32(getFloat(skin, 'x') * contentScale)
+            displayData.skinData.y = f32(getFloat(skin, 'y') * contentScale)
+            displayData.skinData.scaleX = getFloat(skin, 'cX', 1.0)
+            displayData.skinData.scaleY = getFloat(skin, 'cY', 1.0)
+            displayData.skinData.skewX = getFloat(skin, 'kX', 1.0)
+            displayData.skinData.skewY = getFloat(skin, 'kY', 1.0)
+    elif displayType == CS_DISPLAY_ARMATURE:
+        displayData.displayName = getValue(map, 'name', '')
+    elif displayType == CS_DISPLAY_PARTICLE:
+        #relative to the config file, like the binary reader expects it
+        displayData.displayName = getValue(map, 'plist', '')
+    return displayData
+
+def decodeFrameJSON(map, contentScale, cocoStudioVersion):
+    frameData = FrameData()
+    decodeNodeJSON(frameData, map, contentScale, cocoStudioVersion)
+    frameData.tweenEasing = getInt(map, 'twE', TWEEN_LINEAR)
+    frameData.displayIndex = getInt(map, 'dI')
+    frameData.blendSrc = getInt(map, 'bd_src', GL_SRC_ALPHA)
+    frameData.blendDst = getInt(map, 'bd_dst', GL_ONE_MINUS_SRC_ALPHA)
+    frameData.isTween = bool(getValue(map, 'tweenFrame', True))
+    frameData.strEvent = getValue(map, 'evt', '')
+    if cocoStudioVersion < VERSION_COMBINED:
+        frameData.duration = getInt(map, 'dr', 1)
+    else:
+        frameData.frameID = getInt(map, 'fi')
+    frameData.easingParams = [f32(float(param if param is not None else 0)) for param in getArray(map, 'twEP')]
+    return frameData
+
+def decodeMovementBoneJSON(map, contentScale, cocoStudioVersion):
+    movBoneData = MovementBoneData()
+    movBoneData.delay = getFloat(map, 'dl')
+    movBoneData.name = getValue(map, 'name', '')
+    for frameMap in getArray(map, 'frame_data'):
+        frameData = decodeFrameJSON(frameMap, contentScale, cocoStudioVersion)
+        movBoneData.frames.append(frameData)
+        if cocoStudioVersion < VERSION_COMBINED:
+            frameData.frameID = int(movBoneData.duration)
+            movBoneData.duration += frameData.duration
+
+    if cocoStudioVersion < VERSION_CHANGE_ROTATION_RANGE:
+        changeRotationRange(movBoneData.frames)
+    if cocoStudioVersion < VERSION_COMBINED and movBoneData.frames:
+        addLastFrame(movBoneData)
+    return movBoneData
+
+def decodeMovementJSON(map, contentScale, cocoStudioVersion):
+    movementData = MovementData()
+    movementData.loop = bool(getValue(map, 'lp', True))
+    movementData.durationTween = getInt(map, 'drTW')
+    movementData.durationTo = getInt(map, 'to')
+    movementData.duration = getInt(map, 'dr')
+    movementData.scale = getFloat(map, 'sc', 1.0) if 'dr' in map else 1.0
+    movementData.tweenEasing = getInt(map, 'twE', TWEEN_LINEAR)
+    movementData.name = getValue(map, 'name', '')
+    for movBoneMap in getArray(map, 'mov_bone_data'):
+        movBoneData = decodeMovementBoneJSON(movBoneMap, contentScale, cocoStudioVersion)
+        movementData.movBones[movBoneData.name] = movBoneData
+    return movementData
+
+def decodeJSON(content):
+    root = json.loads(content, object_pairs_hook=OrderedDict)
+    config = ConfigData()
+    contentScale = getFloat(root, 'content_scale', 1.0)
+    #the decoder keeps the version of the last armature for the animations
+    cocoStudioVersion = 0.0
+
+    for armatureMap in getArray(root, 'armature_data'):
+        armatureData = ArmatureData()
+        armatureData.name = getValue(armatureMap, 'name', '')
+        cocoStudioVersion = armatureData.dataVersion = getFloat(armatureMap, 'version', 0.1)
+        for boneMap in getArray(armatureMap, 'bone_data'):
+            boneData = BoneData()
+            decodeNodeJSON(boneData, boneMap, contentScale, cocoStudioVersion)
+            boneData.name = getValue(boneMap, 'name', '')
+            boneData.parentName = getValue(boneMap, 'parent', '')
+            boneData.displays = [decodeDisplayJSON(displayMap, contentScale) for displayMap in getArray(boneMap, 'display_data')]
+            armatureData.bones[boneData.name] = boneData
+        config.armatures[armatureData.name] = armatureData
+
+    for animationMap in getArray(root, 'animation_data'):
+        animationData = AnimationData()
+        animationData.name = getValue(animationMap, 'name', '')
+        for movementMap in getArray(animationMap, 'mov_data'):
+            movementData = decodeMovementJSON(movementMap, contentScale, cocoStudioVersion)
+            animationData.movements[movementData.name] = movementData
+        config.animations[animationData.name] = animationData
+
+    for textureMap in getArray(root, 'texture_data'):
+        textureData = TextureData()
+        textureData.name = getValue(textureMap, 'name', '')
+        textureData.width = getFloat(textureMap, 'width')
+        textureData.height = getFloat(textureMap, 'height')
+        textureData.pivotX = getFloat(textureMap, 'pX')
+        textureData.pivotY = getFloat(textureMap, 'pY')
+        for contourMap in getArray(textureMap, 'contour_data'):
+            #the decoder reads the vertices backwards
+            vertices = [(getFloat(vertex, 'x'), getFloat(vertex, 'y')) for vertex in getArray(contourMap, 'vertex')]
+            textureData.contours.append(vertices[::-1])
+        config.textures[textureData.name] = textureData
+
+    for path in getArray(root, 'config_file_path'):
+        if path is None:
+            raise ConvertError('null config_file_path')
+        config.spriteFiles.append(os.path.splitext(path)[0] + '.plist')
+    return config
+
+# -------------- binary --------------
+
+class Writer:
+    def __init__(self):
+        self.data = bytearray()
+        self.strings = []
+        self.indices = dict()
+
+    def u32(self, value):
+        self.data += struct.pack('<I', value & 0xffffffff)
+
+    def i32(self, value):
+        self.data += struct.pack('<i', int(value))
+
+    def float(self, value):
+        self.data += struct.pack('<f', value)
+
+    def bool(self, value):
+        self.u32(1 if value else 0)
+
+    def string(self, text):
+        if text not in self.indices:
+            self.indices[text] = len(self.strings)
+            self.strings.append(text)
+        self.u32(self.indices[text])
+
+    def baseData(self, node):
+        self.float(node.x)
+        self.float(node.y)
+        self.i32(node.zOrder)
+        for value in (node.skewX, node.skewY, node.scaleX, node.scaleY, node.tweenRotate):
+            self.float(value)
+        self.bool(node.isUseColorInfo)
+        for value in (node.a, node.r, node.g, node.b):
+            self.i32(value)
+
+    def getBytes(self):
+        head = bytearray(MAGIC)
+        head += struct.pack('<II', VERSION, len(self.strings))
+        for text in self.strings:
+            encoded = text.encode('utf-8')
+            head += struct.pack('<I', len(encoded)) + encoded + b'\0'
+            while len(head) % 4 != 0:
+                head += b'\0'
+        return bytes(head + self.data)
+
+#the same layout as DataReaderHelper::saveBinaryFile
+def writeConfig(writer, config):
+    writer.u32(len(config.spriteFiles))
+    for spriteFile in config.spriteFiles:
+        writer.string(spriteFile)
+
+    writer.u32(len(config.armatures))
+    for armatureData in config.armatures.values():
+        writer.string(armatureData.name)
+        writer.float(armatureData.dataVersion)
+        writer.u32(len(armatureData.bones))
+        for boneData in armatureData.bones.values():
+            writer.baseData(boneData)
+            writer.string(boneData.name)
+            writer.string(boneData.parentName)
+            writer.u32(len(boneData.displays))
+            for displayData in boneData.displays:
+                writer.i32(displayData.displayType)
+                writer.string(displayData.displayName)
+                if displayData.displayType not in (CS_DISPLAY_ARMATURE, CS_DISPLAY_PARTICLE):
+                    writer.baseData(displayData.skinData)
+
+    writer.u32(len(config.animations))
+    for animationData in config.animations.values():
+        writer.string(animationData.name)
+        writer.u32(len(animationData.movements))
+        for movementData in animationData.movements.values():
+            writer.string(movementData.name)
+            writer.i32(movementData.duration)
+            writer.float(movementData.scale)
+            writer.i32(movementData.durationTo)
+            writer.i32(movementData.durationTween)
+            writer.bool(movementData.loop)
+            writer.i32(movementData.tweenEasing)
+            writer.u32(len(movementData.movBones))
+            for movBoneData in movementData.movBones.values():
+                writer.string(movBoneData.name)
+                writer.float(movBoneData.delay)
+                writer.float(movBoneData.scale)
+                writer.float(movBoneData.duration)
+                writer.u32(len(movBoneData.frames))
+                for frameData in movBoneData.frames:
+                    writer.baseData(frameData)
+                    writer.i32(frameData.frameID)
+                    writer.i32(frameData.duration)
+                    writer.i32(frameData.tweenEasing)
+                    writer.bool(frameData.isTween)
+                    writer.i32(frameData.displayIndex)
+                    writer.u32(frameData.blendSrc)
+                    writer.u32(frameData.blendDst)
+                    writer.string(frameData.strEvent)
+                    writer.string(frameData.strMovement)
+                    writer.string(frameData.strSound)
+                    writer.string(frameData.strSoundEffect)
+                    writer.i32(len(frameData.easingParams))
+                for frameData in movBoneData.frames:
+                    for param in frameData.easingParams:
+                        writer.float(param)
+
+    writer.u32(len(config.textures))
+    for textureData in config.textures.values():
+        writer.string(textureData.name)
+        for value in (textureData.width, textureData.height, textureData.pivotX, textureData.pivotY):
+            writer.float(value)
+        writer.u32(len(textureData.contours))
+        for vertices in textureData.contours:
+            writer.u32(len(vertices))
+            for x, y in vertices:
+                writer.float(x)
+                writer.float(y)
+
+def convertFile(filename, output):
+    print('Converting ' + filename + ' to ' + output)
+    with open(filename, 'rb') as fp:
+        content = fp.read()
+
+    extension = os.path.splitext(filename)[1]
+    try:
+        if extension == '.xml':
+            config = decodeXML(content)
+        else:
+            config = decodeJSON(content.decode('utf-8'))
+    except (ValueError, ET.ParseError) as e:
+        raise ConvertError(str(e))
+
+    writer = Writer()
+    writeConfig(writer, config)
+    with open(output, 'wb') as fp:
+        fp.write(writer.getBytes())
+    return True
+
+# -------------- entrance --------------
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Convert armature xml and json files to binary armature data.')
+    parser.add_argument('files', nargs='+', help='the .xml, .json or .ExportJson files to convert')
+    parser.add_argument('-o', '--output', help='the output file, only when converting a single file')
+    args = parser.parse_args()
+
+    if args.output and len(args.files) > 1:
+        parser.error('-o can only be used with a single file')
+
+    for filename in args.files:
+        if not os.path.isfile(filename):
+            print(filename + ' does not exist!')
+            continue
+        if os.path.splitext(filename)[1] not in ('.xml', '.json', '.ExportJson'):
+            print('Skip ' + filename + ', unknown file type')
+            continue
+        try:
+            convertFile(filename, args.output or os.path.splitext(filename)[0] + '.csab')
+        except ConvertError as e:
+            print('Skip ' + filename + ', ' + str(e))
@@ -0,0 +1,306 @@
+#!/usr/bin/python
+#skeleton_to_binary.py
+#Converts spine skeleton JSON exports to the binary format loaded by spSkeletonBinary,
+#the output has the same name with the .cssb extension unless -o is given.
+#Values are written as spSkeletonJson reads them before scaling, the scale is applied when loading.
+
+import json
+import os.path
+import argparse
+import struct
+from collections import OrderedDict
+
+MAGIC = b'CSSB'
+VERSION = 1
+NO_STRING = 0xffffffff
+
+TIMELINE_ROTATE = 0
+TIMELINE_TRANSLATE = 1
+TIMELINE_SCALE = 2
+TIMELINE_COLOR = 3
+TIMELINE_ATTACHMENT = 4
+TIMELINE_EVENT = 5
+TIMELINE_DRAWORDER = 6
+
+CURVE_LINEAR = 0
+CURVE_STEPPED = 1
+CURVE_BEZIER = 2
+
+#spAttachmentType
+ATTACHMENT_TYPES = {'region': 0, 'regionsequence': 1, 'boundingbox': 2}
+
+class ConvertError(Exception):
+    pass
+
+class Writer:
+    def __init__(self):
+        self.data = bytearray()
+        self.strings = []
+        self.indices = dict()
+
+    def u32(self, value):
+        self.data += struct.pack('<I', value & 0xffffffff)
+
+    def i32(self, value):
+        self.data += struct.pack('<i', int(value))
+
+    def float(self, value):
+        self.data += struct.pack('<f', value)
+
+    def floats(self, values):
+        self.data += struct.pack('<%df' % len(values), *values)
+
+    def string(self, text):
+        if text is None:
+            self.u32(NO_STRING)
+            return
+        if text not in self.indices:
+            self.indices[text] = len(self.strings)
+            self.strings.append(text)
+        self.u32(self.indices[text])
+
+    def getBytes(self):
+        head = bytearray(MAGIC)
+        head += struct.pack('<II', VERSION, len(self.strings))
+        for text in self.strings:
+            encoded = text.encode('utf-8')
+            head += struct.pack('<I', len(encoded)) + encoded + b'\0'
+            while len(head) % 4 != 0:
+                head += b'\0'
+        return bytes(head + self.data)
+
+#Json_getInt of spine's Json.cpp, numbers are truncated and true is 1
+def getInt(map, name, default):
+    value = map.get(name)
+    if value is None:
+        return default
+    return int(value)
+
+def getFloat(map, name, default):
+    value = map.get(name)
+    if value is None or isinstance(value, bool):
+        return default
+    return float(value)
+
+#toColor of SkeletonJson.cpp, -1 for a malformed color
+def toColor(value, index):
+    if value is None:
+        raise ConvertError('missing color')
+    if len(value) != 8:
+        return -1.0
+    try:
+        return int(value[index * 2:index * 2 + 2], 16) / 255.0
+    except ValueError:
+        return -1.0
+
+def findIndex(names, name, what):
+    if name not in names:
+        raise ConvertError(what + ' not found: ' + str(name))
+    return names.index(name)
+
+def writeCurves(writer, frames):
+    for frame in frames[:-1]:
+        curve = frame.get('curve')
+        if curve == 'stepped':
+            writer.u32(CURVE_STEPPED)
+        elif isinstance(curve, list) and len(curve) >= 4:
+            writer.u32(CURVE_BEZIER)
+            writer.floats([float(c) for c in curve[:4]])
+        else:
+            writer.u32(CURVE_LINEAR)
+
+def writeAnimation(writer, name, animation, boneNames, slotNames, events):
+    timelines = []
+    for boneName, timelineMap in animation.get('bones', {}).items():
+        boneIndex = findIndex(boneNames, boneName, 'Bone')
+        for timelineName, frames in timelineMap.items():
+            if timelineName == 'rotate':
+                values = []
+                for frame in frames:
+                    values += [getFloat(frame, 'time', 0), getFloat(frame, 'angle', 0)]
+                timelines.append((TIMELINE_ROTATE, boneIndex, frames, values, None))
+            elif timelineName == 'translate' or timelineName == 'scale':
+                values = []
+                for frame in frames:
+                    values += [getFloat(frame, 'time', 0), getFloat(frame, 'x', 0), getFloat(frame, 'y', 0)]
+                type = TIMELINE_TRANSLATE if timelineName == 'translate' else TIMELINE_SCALE
+                timelines.append((type, boneIndex, frames, values, None))
+            else:
+                raise ConvertError('Invalid timeline type for a bone: ' + timelineName)
+
+    for slotName, timelineMap in animation.get('slots', {}).items():
+        slotIndex = findIndex(slotNames, slotName, 'Slot')
+        for timelineName, frames in timelineMap.items():
+            if timelineName == 'color':
+                values = []
+                for frame in frames:
+                    color = frame.get('color')
+                    values += [getFloat(frame, 'time', 0)] + [toColor(color, i) for i in range(4)]
+                timelines.append((TIMELINE_COLOR, slotIndex, frames, values, None))
+            elif timelineName == 'attachment':
+                values = [getFloat(frame, 'time', 0) for frame in frames]
+                names = [frame.get('name') for frame in frames]
+                timelines.append((TIMELINE_ATTACHMENT, slotIndex, frames, values, names))
+            else:
+                raise ConvertError('Invalid timeline type for a slot: ' + timelineName)
+
+    eventFrames = animation.get('events')
+    if eventFrames is not None:
+        values = [getFloat(frame, 'time', 0) for frame in eventFrames]
+        timelines.append((TIMELINE_EVENT, -1, eventFrames, values, None))
+
+    drawOrderFrames = animation.get('draworder')
+    if drawOrderFrames is not None:
+        values = [getFloat(frame, 'time', 0) for frame in drawOrderFrames]
+        timelines.append((TIMELINE_DRAWORDER, -1, drawOrderFrames, values, None))
+
+    writer.string(name)
+    writer.u32(len(timelines))
+    for type, index, frames, values, names in timelines:
+        if len(frames) == 0:
+            raise ConvertError('Empty timeline in animation ' + name)
+        writer.i32(type)
+        writer.i32(index)
+        writer.u32(len(frames))
+        writer.floats(values)
+        if type in (TIMELINE_ROTATE, TIMELINE_TRANSLATE, TIMELINE_SCALE, TIMELINE_COLOR):
+            writeCurves(writer, frames)
+        elif type == TIMELINE_ATTACHMENT:
+            for attachmentName in names:
+                writer.string(attachmentName)
+        elif type == TIMELINE_EVENT:
+            eventNames = [event[0] for event in events]
+            for frame in frames:
+                eventIndex = findIndex(eventNames, frame.get('name'), 'Event')
+                eventName, intValue, floatValue, stringValue = events[eventIndex]
+                writer.i32(eventIndex)
+                writer.i32(getInt(frame, 'int', intValue))
+                writer.float(getFloat(frame, 'float', floatValue))
+                writer.string(frame.get('string', stringValue))
+        else:
+            for frame in frames:
+                offsets = frame.get('offsets')
+                if offsets is None:
+                    writer.u32(0)
+                    continue
+                writer.u32(1)
+                writer.data += b''.join(struct.pack('<i', i) for i in drawOrder(offsets, slotNames))
+
+#the draw order of a frame as _spSkeletonJson_readAnimation builds it
+def drawOrder(offsets, slotNames):
+    slotCount = len(slotNames)
+    order = [-1] * slotCount
+    unchanged = []
+    originalIndex = 0
+    for offsetMap in offsets:
+        slotIndex = findIndex(slotNames, offsetMap.get('slot'), 'Slot')
+        while originalIndex != slotIndex:
+            unchanged.append(originalIndex)
+            originalIndex += 1
+        order[originalIndex + getInt(offsetMap, 'offset', 0)] = originalIndex
+        originalIndex += 1
+    while originalIndex < slotCount:
+        unchanged.append(originalIndex)
+        originalIndex += 1
+    for i in range(slotCount - 1, -1, -1):
+        if order[i] == -1:
+            order[i] = unchanged.pop()
+    return order
+
+def convertFile(filename, output):
+    print('Converting ' + filename + ' to ' + output)
+    with open(filename, 'rb') as fp:
+        root = json.loads(fp.read().decode('utf-8'), object_pairs_hook=OrderedDict)
+
+    writer = Writer()
+
+    bones = root.get('bones', [])
+    boneNames = []
+    writer.u32(len(bones))
+    for bone in bones:
+        parentName = bone.get('parent')
+        writer.string(bone.get('name'))
+        writer.i32(findIndex(boneNames, parentName, 'Parent bone') if parentName is not None else -1)
+        writer.floats([getFloat(bone, 'length', 0), getFloat(bone, 'x', 0), getFloat(bone, 'y', 0),
+                       getFloat(bone, 'rotation', 0), getFloat(bone, 'scaleX', 1), getFloat(bone, 'scaleY', 1)])
+        writer.i32(getInt(bone, 'inheritScale', 1))
+        writer.i32(getInt(bone, 'inheritRotation', 1))
+        boneNames.append(bone.get('name'))
+
+    slots = root.get('slots', [])
+    slotNames = []
+    writer.u32(len(slots))
+    for slot in slots:
+        writer.string(slot.get('name'))
+        writer.i32(findIndex(boneNames, slot.get('bone'), 'Slot bone'))
+        color = slot.get('color')
+        writer.floats([toColor(color, i) for i in range(4)] if color is not None else [1.0, 1.0, 1.0, 1.0])
+        writer.string(slot.get('attachment'))
+        writer.i32(getInt(slot, 'additive', 0))
+        slotNames.append(slot.get('name'))
+
+    skins = root.get('skins', OrderedDict())
+    writer.u32(len(skins))
+    for skinName, slotMap in skins.items():
+        attachments = []
+        for slotName, attachmentMap in slotMap.items():
+            slotIndex = findIndex(slotNames, slotName, 'Slot')
+            for skinAttachmentName, attachment in attachmentMap.items():
+                attachments.append((slotIndex, skinAttachmentName, attachment))
+        writer.string(skinName)
+        writer.u32(len(attachments))
+        for slotIndex, skinAttachmentName, attachment in attachments:
+            typeName = attachment.get('type', 'region')
+            if typeName not in ATTACHMENT_TYPES:
+                raise ConvertError('Unknown attachment type: ' + typeName)
+            writer.i32(slotIndex)
+            writer.string(skinAttachmentName)
+            writer.string(attachment.get('name', skinAttachmentName))
+            writer.i32(ATTACHMENT_TYPES[typeName])
+            if typeName == 'boundingbox':
+                vertices = [float(v) for v in attachment.get('vertices', [])]
+                writer.u32(len(vertices))
+                writer.floats(vertices)
+            else:
+                writer.floats([getFloat(attachment, 'x', 0), getFloat(attachment, 'y', 0),
+                               getFloat(attachment, 'scaleX', 1), getFloat(attachment, 'scaleY', 1),
+                               getFloat(attachment, 'rotation', 0),
+                               getFloat(attachment, 'width', 32), getFloat(attachment, 'height', 32)])
+
+    events = []
+    for eventName, event in root.get('events', OrderedDict()).items():
+        events.append((eventName, getInt(event, 'int', 0), getFloat(event, 'float', 0), event.get('string')))
+    writer.u32(len(events))
+    for eventName, intValue, floatValue, stringValue in events:
+        writer.string(eventName)
+        writer.i32(intValue)
+        writer.float(floatValue)
+        writer.string(stringValue)
+
+    animations = root.get('animations', OrderedDict())
+    writer.u32(len(animations))
+    for name, animation in animations.items():
+        writeAnimation(writer, name, animation, boneNames, slotNames, events)
+
+    with open(output, 'wb') as fp:
+        fp.write(writer.getBytes())
+    return True
+
+# -------------- entrance --------------
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Convert spine skeleton JSON files to binary skeleton data.')
+    parser.add_argument('files', nargs='+', help='the skeleton JSON files to convert')
+    parser.add_argument('-o', '--output', help='the output file, only when converting a single file')
+    args = parser.parse_args()
+
+    if args.output and len(args.files) > 1:
+        parser.error('-o can only be used with a single file')
+
+    for filename in args.files:
+        if not os.path.isfile(filename):
+            print(filename + ' does not exist!')
+            continue
+        try:
+            convertFile(filename, args.output or os.path.splitext(filename)[0] + '.cssb')
+        except ConvertError as e:
+            print('Skip ' + filename + ', ' + str(e))
@@ -0,0 +1,107 @@
+#!/usr/bin/python
+#plist_to_binary.py
+#Converts sprite sheet plists to the binary format loaded by SpriteFrameCache,
+#the output has the same name with the .ccsf extension unless -o is given.
+
+import plistlib
+import os.path
+import argparse
+import re
+import struct
+
+MAGIC = b'CCSF'
+VERSION = 1
+NO_STRING = 0xffffffff
+
+numberPattern = re.compile(r'[-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?')
+
+#parse strings like "{x,y}" and "{{x,y},{w,h}}" the way PointFromString and RectFromString do
+def parseNumbers(text, count):
+    numbers = [float(n) for n in numberPattern.findall(text or '')]
+    if len(numbers) != count:
+        return [0.0] * count
+    return numbers
+
+class StringTable:
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = dict()
+
+    def add(self, text):
+        if text not in self.offsets:
+            self.offsets[text] = len(self.data)
+            self.data += text.encode('utf-8') + b'\0'
+        return self.offsets[text]
+
+#returns (rect, rotated, offset, sourceSize, aliases) as SpriteFrameCache::addSpriteFramesWithDictionary builds them
+def convertFrame(frameDict, format):
+    if format == 0:
+        rect = [frameDict.get('x', 0), frameDict.get('y', 0), frameDict.get('width', 0), frameDict.get('height', 0)]
+        offset = [frameDict.get('offsetX', 0), frameDict.get('offsetY', 0)]
+        source = [abs(int(frameDict.get('originalWidth', 0))), abs(int(frameDict.get('originalHeight', 0)))]
+        return rect, False, offset, source, []
+    elif format == 1 or format == 2:
+        rect = parseNumbers(frameDict.get('frame'), 4)
+        rotated = format == 2 and bool(frameDict.get('rotated', False))
+        offset = parseNumbers(frameDict.get('offset'), 2)
+        source = parseNumbers(frameDict.get('sourceSize'), 2)
+        return rect, rotated, offset, source, []
+    else:
+        size = parseNumbers(frameDict.get('spriteSize'), 2)
+        offset = parseNumbers(frameDict.get('spriteOffset'), 2)
+        source = parseNumbers(frameDict.get('spriteSourceSize'), 2)
+        textureRect = parseNumbers(frameDict.get('textureRect'), 4)
+        rect = [textureRect[0], textureRect[1], size[0], size[1]]
+        rotated = bool(frameDict.get('textureRotated', False))
+        return rect, rotated, offset, source, frameDict.get('aliases', [])
+
+def convertFile(filename, output):
+    print('Converting ' + filename + ' to ' + output)
+    with open(filename, 'rb') as fp:
+        if hasattr(plistlib, 'load'):
+            pl = plistlib.load(fp)
+        else:
+            pl = plistlib.readPlist(fp)
+
+    metadata = pl.get('metadata', {})
+    format = int(metadata.get('format', 0))
+    if format < 0 or format > 3:
+        print('Skip ' + filename + ', format ' + str(format) + ' is not supported')
+        return False
+
+    strings = StringTable()
+    textureFileName = metadata.get('textureFileName')
+    textureOffset = strings.add(textureFileName) if textureFileName else NO_STRING
+
+    frames = bytearray()
+    aliases = bytearray()
+    framesDict = pl.get('frames', {})
+    for index, name in enumerate(sorted(framesDict.keys())):
+        rect, rotated, offset, source, frameAliases = convertFrame(framesDict[name], format)
+        frames += struct.pack('<I8fI', strings.add(name),
+                              rect[0], rect[1], rect[2], rect[3],
+                              offset[0], offset[1], source[0], source[1],
+                              1 if rotated else 0)
+        for alias in frameAliases:
+            aliases += struct.pack('<II', strings.add(alias), index)
+
+    header = struct.pack('<4sIIIII', MAGIC, VERSION, len(framesDict), len(aliases) // 8, len(strings.data), textureOffset)
+    with open(output, 'wb') as fp:
+        fp.write(header + bytes(frames) + bytes(aliases) + bytes(strings.data))
+    return True
+
+# -------------- entrance --------------
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Convert sprite sheet plists to binary sprite frames.')
+    parser.add_argument('files', nargs='+', help='the plist files to convert')
+    parser.add_argument('-o', '--output', help='the output file, only when converting a single file')
+    args = parser.parse_args()
+
+    if args.output and len(args.files) > 1:
+        parser.error('-o can only be used with a single file')
+
+    for filename in args.files:
+        if not os.path.isfile(filename):
+            print(filename + ' does not exist!')
+            continue
+        convertFile(filename, args.output or os.path.splitext(filename)[0] + '.ccsf')